@@ -180,6 +180,94 @@ static void sha3_512_absorb_example(void) {
   fputs("\n", stdout);
 }
 
+static void sha3_224_batch_example(void) {
+  ///! [sha3_224_batch]
+  // get 4 messages of 64, 128, 256, and 512 random bytes
+  uint8_t bufs[4][512] = { 0 };
+  rand_bytes(bufs, sizeof(bufs));
+  const uint8_t * const srcs[4] = { bufs[0], bufs[1], bufs[2], bufs[3] };
+  const size_t lens[4] = { 64, 128, 256, 512 };
+
+  // calculate sha3-224 hash of each message, write results to `hashes`
+  uint8_t hashes[4][28] = { 0 };
+  uint8_t * const dsts[4] = { hashes[0], hashes[1], hashes[2], hashes[3] };
+  sha3_224_batch(srcs, lens, 4, dsts);
+  ///! [sha3_224_batch]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  for (size_t i = 0; i < 4; i++) {
+    hex_write(stdout, hashes[i], sizeof(hashes[i]));
+    fputs((i < 3) ? " " : "\n", stdout);
+  }
+}
+
+static void sha3_256_batch_example(void) {
+  ///! [sha3_256_batch]
+  // get 4 messages of 64, 128, 256, and 512 random bytes
+  uint8_t bufs[4][512] = { 0 };
+  rand_bytes(bufs, sizeof(bufs));
+  const uint8_t * const srcs[4] = { bufs[0], bufs[1], bufs[2], bufs[3] };
+  const size_t lens[4] = { 64, 128, 256, 512 };
+
+  // calculate sha3-256 hash of each message, write results to `hashes`
+  uint8_t hashes[4][32] = { 0 };
+  uint8_t * const dsts[4] = { hashes[0], hashes[1], hashes[2], hashes[3] };
+  sha3_256_batch(srcs, lens, 4, dsts);
+  ///! [sha3_256_batch]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  for (size_t i = 0; i < 4; i++) {
+    hex_write(stdout, hashes[i], sizeof(hashes[i]));
+    fputs((i < 3) ? " " : "\n", stdout);
+  }
+}
+
+static void sha3_384_batch_example(void) {
+  ///! [sha3_384_batch]
+  // get 4 messages of 64, 128, 256, and 512 random bytes
+  uint8_t bufs[4][512] = { 0 };
+  rand_bytes(bufs, sizeof(bufs));
+  const uint8_t * const srcs[4] = { bufs[0], bufs[1], bufs[2], bufs[3] };
+  const size_t lens[4] = { 64, 128, 256, 512 };
+
+  // calculate sha3-384 hash of each message, write results to `hashes`
+  uint8_t hashes[4][48] = { 0 };
+  uint8_t * const dsts[4] = { hashes[0], hashes[1], hashes[2], hashes[3] };
+  sha3_384_batch(srcs, lens, 4, dsts);
+  ///! [sha3_384_batch]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  for (size_t i = 0; i < 4; i++) {
+    hex_write(stdout, hashes[i], sizeof(hashes[i]));
+    fputs((i < 3) ? " " : "\n", stdout);
+  }
+}
+
+static void sha3_512_batch_example(void) {
+  ///! [sha3_512_batch]
+  // get 4 messages of 64, 128, 256, and 512 random bytes
+  uint8_t bufs[4][512] = { 0 };
+  rand_bytes(bufs, sizeof(bufs));
+  const uint8_t * const srcs[4] = { bufs[0], bufs[1], bufs[2], bufs[3] };
+  const size_t lens[4] = { 64, 128, 256, 512 };
+
+  // calculate sha3-512 hash of each message, write results to `hashes`
+  uint8_t hashes[4][64] = { 0 };
+  uint8_t * const dsts[4] = { hashes[0], hashes[1], hashes[2], hashes[3] };
+  sha3_512_batch(srcs, lens, 4, dsts);
+  ///! [sha3_512_batch]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  for (size_t i = 0; i < 4; i++) {
+    hex_write(stdout, hashes[i], sizeof(hashes[i]));
+    fputs((i < 3) ? " " : "\n", stdout);
+  }
+}
+
 static void shake128_example(void) {
   ///! [shake128]
   // get 1024 random bytes
@@ -230,6 +318,36 @@ static void shake128_ctx_example(void) {
   ///! [shake128_ctx]
 }
 
+static void shake128_blocks_example(void) {
+  ///! [shake128_blocks]
+  // get 32 byte seed
+  uint8_t seed[32] = { 0 };
+  rand_bytes(seed, sizeof(seed));
+
+  // absorb seed
+  sha3_xof_t xof;
+  shake128_init(&xof);
+  shake128_absorb(&xof, seed, sizeof(seed));
+
+  // squeeze 2 whole blocks (168 bytes each)
+  uint8_t buf[2 * 168] = { 0 };
+  shake128_squeeze_blocks(&xof, buf, 2);
+
+  // xor bytes of third block in place, then move to the next block
+  const uint8_t *block = shake128_peek_block(&xof);
+  uint8_t x = 0;
+  for (size_t i = 0; i < 168; i++) {
+    x ^= block[i];
+  }
+  shake128_squeeze_blocks(&xof, NULL, 1);
+  ///! [shake128_blocks]
+
+  // print to stdout
+  printf("%s: x=%02x, ", __func__, x);
+  hex_write(stdout, buf, 32);
+  fputs(" ...\n", stdout);
+}
+
 static void shake256_example(void) {
   ///! [shake256]
   // get 1024 random bytes
@@ -280,6 +398,347 @@ static void shake256_ctx_example(void) {
   ///! [shake256_ctx]
 }
 
+static void shake256_blocks_example(void) {
+  ///! [shake256_blocks]
+  // get 32 byte seed
+  uint8_t seed[32] = { 0 };
+  rand_bytes(seed, sizeof(seed));
+
+  // absorb seed
+  sha3_xof_t xof;
+  shake256_init(&xof);
+  shake256_absorb(&xof, seed, sizeof(seed));
+
+  // squeeze 2 whole blocks (136 bytes each)
+  uint8_t buf[2 * 136] = { 0 };
+  shake256_squeeze_blocks(&xof, buf, 2);
+
+  // xor bytes of third block in place, then move to the next block
+  const uint8_t *block = shake256_peek_block(&xof);
+  uint8_t x = 0;
+  for (size_t i = 0; i < 136; i++) {
+    x ^= block[i];
+  }
+  shake256_squeeze_blocks(&xof, NULL, 1);
+  ///! [shake256_blocks]
+
+  // print to stdout
+  printf("%s: x=%02x, ", __func__, x);
+  hex_write(stdout, buf, 32);
+  fputs(" ...\n", stdout);
+}
+
+static void sha3_224_x4_example(void) {
+  ///! [sha3_224_x4]
+  // get 4 streams of 1024 random bytes
+  uint8_t bufs[4][1024] = { 0 };
+  rand_bytes(bufs, sizeof(bufs));
+
+  // init four-lane context
+  sha3_x4_t ctx;
+  sha3_224_x4_init(&ctx);
+
+  // absorb each stream in 256 byte chunks
+  for (size_t i = 0; i < sizeof(bufs[0]); i += 256) {
+    const uint8_t * const srcs[4] = { bufs[0] + i, bufs[1] + i, bufs[2] + i, bufs[3] + i };
+    const size_t lens[4] = { 256, 256, 256, 256 };
+    sha3_224_x4_absorb(&ctx, srcs, lens);
+  }
+
+  // get SHA3-224 hash of each stream
+  uint8_t hashes[4][28] = { 0 };
+  uint8_t * const dsts[4] = { hashes[0], hashes[1], hashes[2], hashes[3] };
+  sha3_224_x4_final(&ctx, dsts);
+  ///! [sha3_224_x4]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  for (size_t i = 0; i < 4; i++) {
+    hex_write(stdout, hashes[i], sizeof(hashes[i]));
+    fputs((i < 3) ? " " : "\n", stdout);
+  }
+}
+
+static void sha3_256_x4_example(void) {
+  ///! [sha3_256_x4]
+  // get 4 streams of 1024 random bytes
+  uint8_t bufs[4][1024] = { 0 };
+  rand_bytes(bufs, sizeof(bufs));
+
+  // init four-lane context
+  sha3_x4_t ctx;
+  sha3_256_x4_init(&ctx);
+
+  // absorb each stream in 256 byte chunks
+  for (size_t i = 0; i < sizeof(bufs[0]); i += 256) {
+    const uint8_t * const srcs[4] = { bufs[0] + i, bufs[1] + i, bufs[2] + i, bufs[3] + i };
+    const size_t lens[4] = { 256, 256, 256, 256 };
+    sha3_256_x4_absorb(&ctx, srcs, lens);
+  }
+
+  // get SHA3-256 hash of each stream
+  uint8_t hashes[4][32] = { 0 };
+  uint8_t * const dsts[4] = { hashes[0], hashes[1], hashes[2], hashes[3] };
+  sha3_256_x4_final(&ctx, dsts);
+  ///! [sha3_256_x4]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  for (size_t i = 0; i < 4; i++) {
+    hex_write(stdout, hashes[i], sizeof(hashes[i]));
+    fputs((i < 3) ? " " : "\n", stdout);
+  }
+}
+
+static void sha3_256_32_example(void) {
+  ///! [sha3_256_32]
+  // get 32 byte key and 8 32 byte node hashes
+  uint8_t key[32] = { 0 }, nodes[8][32] = { 0 };
+  rand_bytes(key, sizeof(key));
+  rand_bytes(nodes, sizeof(nodes));
+
+  // hash key
+  uint8_t hash[32] = { 0 };
+  sha3_256_32(key, hash);
+
+  // hash 8 node hashes at once
+  uint8_t hashes[8][32] = { 0 };
+  const uint8_t * const srcs[8] = { nodes[0], nodes[1], nodes[2], nodes[3], nodes[4], nodes[5], nodes[6], nodes[7] };
+  uint8_t * const dsts[8] = { hashes[0], hashes[1], hashes[2], hashes[3], hashes[4], hashes[5], hashes[6], hashes[7] };
+  sha3_256_32_x8(srcs, dsts);
+  ///! [sha3_256_32]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  hex_write(stdout, hash, sizeof(hash));
+  fputs(" ", stdout);
+  hex_write(stdout, hashes[0], sizeof(hashes[0]));
+  fputs(" ...\n", stdout);
+}
+
+static void sha3_256_64_example(void) {
+  ///! [sha3_256_64]
+  // get 4 pairs of 32 byte digests
+  uint8_t pairs[4][64] = { 0 };
+  rand_bytes(pairs, sizeof(pairs));
+
+  // hash first pair
+  uint8_t hash[32] = { 0 };
+  sha3_256_64(pairs[0], hash);
+
+  // hash all 4 pairs at once
+  uint8_t hashes[4][32] = { 0 };
+  const uint8_t * const srcs[4] = { pairs[0], pairs[1], pairs[2], pairs[3] };
+  uint8_t * const dsts[4] = { hashes[0], hashes[1], hashes[2], hashes[3] };
+  sha3_256_64_x4(srcs, dsts);
+  ///! [sha3_256_64]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  hex_write(stdout, hash, sizeof(hash));
+  fputs(" ", stdout);
+  hex_write(stdout, hashes[0], sizeof(hashes[0]));
+  fputs(" ...\n", stdout);
+}
+
+static void sha3_256_iterate_example(void) {
+  ///! [sha3_256_iterate]
+  // get 4 random 32 byte seeds
+  uint8_t seeds[4][32] = { 0 };
+  rand_bytes(seeds, sizeof(seeds));
+
+  // iterate SHA3-256 1000 times on first seed
+  uint8_t end[32] = { 0 };
+  sha3_256_iterate(seeds[0], 1000, end);
+
+  // iterate SHA3-256 1000 times on all 4 seeds at once
+  uint8_t ends[4][32] = { 0 };
+  const uint8_t * const srcs[4] = { seeds[0], seeds[1], seeds[2], seeds[3] };
+  uint8_t * const dsts[4] = { ends[0], ends[1], ends[2], ends[3] };
+  sha3_256_iterate_x4(srcs, 1000, dsts);
+  ///! [sha3_256_iterate]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  hex_write(stdout, end, sizeof(end));
+  fputs(" ", stdout);
+  hex_write(stdout, ends[0], sizeof(ends[0]));
+  fputs(" ...\n", stdout);
+}
+
+static void sha3_384_x4_example(void) {
+  ///! [sha3_384_x4]
+  // get 4 streams of 1024 random bytes
+  uint8_t bufs[4][1024] = { 0 };
+  rand_bytes(bufs, sizeof(bufs));
+
+  // init four-lane context
+  sha3_x4_t ctx;
+  sha3_384_x4_init(&ctx);
+
+  // absorb each stream in 256 byte chunks
+  for (size_t i = 0; i < sizeof(bufs[0]); i += 256) {
+    const uint8_t * const srcs[4] = { bufs[0] + i, bufs[1] + i, bufs[2] + i, bufs[3] + i };
+    const size_t lens[4] = { 256, 256, 256, 256 };
+    sha3_384_x4_absorb(&ctx, srcs, lens);
+  }
+
+  // get SHA3-384 hash of each stream
+  uint8_t hashes[4][48] = { 0 };
+  uint8_t * const dsts[4] = { hashes[0], hashes[1], hashes[2], hashes[3] };
+  sha3_384_x4_final(&ctx, dsts);
+  ///! [sha3_384_x4]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  for (size_t i = 0; i < 4; i++) {
+    hex_write(stdout, hashes[i], sizeof(hashes[i]));
+    fputs((i < 3) ? " " : "\n", stdout);
+  }
+}
+
+static void sha3_512_x4_example(void) {
+  ///! [sha3_512_x4]
+  // get 4 streams of 1024 random bytes
+  uint8_t bufs[4][1024] = { 0 };
+  rand_bytes(bufs, sizeof(bufs));
+
+  // init four-lane context
+  sha3_x4_t ctx;
+  sha3_512_x4_init(&ctx);
+
+  // absorb each stream in 256 byte chunks
+  for (size_t i = 0; i < sizeof(bufs[0]); i += 256) {
+    const uint8_t * const srcs[4] = { bufs[0] + i, bufs[1] + i, bufs[2] + i, bufs[3] + i };
+    const size_t lens[4] = { 256, 256, 256, 256 };
+    sha3_512_x4_absorb(&ctx, srcs, lens);
+  }
+
+  // get SHA3-512 hash of each stream
+  uint8_t hashes[4][64] = { 0 };
+  uint8_t * const dsts[4] = { hashes[0], hashes[1], hashes[2], hashes[3] };
+  sha3_512_x4_final(&ctx, dsts);
+  ///! [sha3_512_x4]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  for (size_t i = 0; i < 4; i++) {
+    hex_write(stdout, hashes[i], sizeof(hashes[i]));
+    fputs((i < 3) ? " " : "\n", stdout);
+  }
+}
+
+static void shake128_batch_example(void) {
+  ///! [shake128_batch]
+  // get 4 messages of 64, 128, 256, and 512 random bytes
+  uint8_t bufs[4][512] = { 0 };
+  rand_bytes(bufs, sizeof(bufs));
+  const uint8_t * const srcs[4] = { bufs[0], bufs[1], bufs[2], bufs[3] };
+  const size_t lens[4] = { 64, 128, 256, 512 };
+
+  // absorb each message into shake128, squeeze 32 bytes from each into `outs`
+  uint8_t outs[4][32] = { 0 };
+  uint8_t * const dsts[4] = { outs[0], outs[1], outs[2], outs[3] };
+  shake128_batch(srcs, lens, 4, dsts, sizeof(outs[0]));
+  ///! [shake128_batch]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  for (size_t i = 0; i < 4; i++) {
+    hex_write(stdout, outs[i], sizeof(outs[i]));
+    fputs((i < 3) ? " " : "\n", stdout);
+  }
+}
+
+static void shake256_batch_example(void) {
+  ///! [shake256_batch]
+  // get 4 messages of 64, 128, 256, and 512 random bytes
+  uint8_t bufs[4][512] = { 0 };
+  rand_bytes(bufs, sizeof(bufs));
+  const uint8_t * const srcs[4] = { bufs[0], bufs[1], bufs[2], bufs[3] };
+  const size_t lens[4] = { 64, 128, 256, 512 };
+
+  // absorb each message into shake256, squeeze 32 bytes from each into `outs`
+  uint8_t outs[4][32] = { 0 };
+  uint8_t * const dsts[4] = { outs[0], outs[1], outs[2], outs[3] };
+  shake256_batch(srcs, lens, 4, dsts, sizeof(outs[0]));
+  ///! [shake256_batch]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  for (size_t i = 0; i < 4; i++) {
+    hex_write(stdout, outs[i], sizeof(outs[i]));
+    fputs((i < 3) ? " " : "\n", stdout);
+  }
+}
+
+static void shake256_chain_example(void) {
+  ///! [shake256_chain]
+  // get 4 random 32 byte seeds
+  uint8_t seeds[4][32] = { 0 };
+  rand_bytes(seeds, sizeof(seeds));
+
+  // iterate SHAKE256 1000 times on first seed
+  uint8_t end[32] = { 0 };
+  shake256_chain(seeds[0], 1000, end);
+
+  // iterate SHAKE256 1000 times on all 4 seeds at once
+  uint8_t ends[4][32] = { 0 };
+  const uint8_t * const srcs[4] = { seeds[0], seeds[1], seeds[2], seeds[3] };
+  uint8_t * const dsts[4] = { ends[0], ends[1], ends[2], ends[3] };
+  shake256_chain_x4(srcs, 1000, dsts);
+  ///! [shake256_chain]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  hex_write(stdout, end, sizeof(end));
+  fputs(" ", stdout);
+  hex_write(stdout, ends[0], sizeof(ends[0]));
+  fputs(" ...\n", stdout);
+}
+
+static void shake128_sample12_example(void) {
+  ///! [shake128_sample12]
+  // ML-KEM-768: expand 3x3 matrix of polynomials from 32 byte seed rho;
+  // seed for row i, column j is rho || j || i
+  uint8_t rho[32] = { 0 }, seeds[9][34] = { 0 };
+  rand_bytes(rho, sizeof(rho));
+  for (size_t k = 0; k < 9; k++) {
+    for (size_t i = 0; i < 32; i++) {
+      seeds[k][i] = rho[i];
+    }
+    seeds[k][32] = k % 3;
+    seeds[k][33] = k / 3;
+  }
+
+  // sample first 8 polynomials at once, then the last one
+  uint16_t a[9][256] = { 0 };
+  const uint8_t * const srcs[8] = { seeds[0], seeds[1], seeds[2], seeds[3], seeds[4], seeds[5], seeds[6], seeds[7] };
+  uint16_t * const dsts[8] = { a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7] };
+  shake128_sample12_x8(srcs, 34, 3329, dsts, 256);
+  shake128_sample12(seeds[8], 34, 3329, a[8], 256);
+  ///! [shake128_sample12]
+
+  // print to stdout
+  printf("%s: %u %u %u ...\n", __func__, a[0][0], a[0][1], a[0][2]);
+}
+
+static void shake128_sample23_example(void) {
+  ///! [shake128_sample23]
+  // ML-DSA: sample polynomial from 34 byte seed rho || s || r
+  uint8_t seed[34] = { 0 };
+  rand_bytes(seed, 32);
+  seed[32] = 1; // column
+  seed[33] = 0; // row
+
+  uint32_t a[256] = { 0 };
+  shake128_sample23(seed, sizeof(seed), 8380417, a, 256);
+  ///! [shake128_sample23]
+
+  // print to stdout
+  printf("%s: %u %u %u ...\n", __func__, a[0], a[1], a[2]);
+}
+
 static void hmac_sha3_224_example(void) {
   ///! [hmac_sha3_224]
   // key and key size, in bytes (w/o trailing NUL)
@@ -484,6 +943,126 @@ static void hmac_sha3_512_absorb_example(void) {
   fputs("\n", stdout);
 }
 
+static void hmac_sha3_224_batch_example(void) {
+  ///! [hmac_sha3_224_batch]
+  // key and key size, in bytes (w/o trailing NUL)
+  const uint8_t key[] = "secret!"; // key
+  const size_t key_len = sizeof(key) - 1; // key size
+
+  // get 4 messages of 64, 128, 256, and 512 random bytes
+  uint8_t bufs[4][512] = { 0 };
+  rand_bytes(bufs, sizeof(bufs));
+  const uint8_t * const msgs[4] = { bufs[0], bufs[1], bufs[2], bufs[3] };
+  const size_t lens[4] = { 64, 128, 256, 512 };
+
+  // calculate HMAC-SHA3-224 of each message, write results to `macs`
+  uint8_t macs[4][28] = { 0 };
+  uint8_t * const dsts[4] = { macs[0], macs[1], macs[2], macs[3] };
+  hmac_sha3_224_batch(key, key_len, msgs, lens, 4, dsts);
+
+  // verify MACs
+  const uint8_t * const exps[4] = { macs[0], macs[1], macs[2], macs[3] };
+  const _Bool ok = hmac_sha3_224_batch_verify(key, key_len, msgs, lens, 4, exps, NULL);
+  ///! [hmac_sha3_224_batch]
+
+  // print to stdout
+  printf("%s: ok=%d ", __func__, ok);
+  for (size_t i = 0; i < 4; i++) {
+    hex_write(stdout, macs[i], sizeof(macs[i]));
+    fputs((i < 3) ? " " : "\n", stdout);
+  }
+}
+
+static void hmac_sha3_256_batch_example(void) {
+  ///! [hmac_sha3_256_batch]
+  // key and key size, in bytes (w/o trailing NUL)
+  const uint8_t key[] = "secret!"; // key
+  const size_t key_len = sizeof(key) - 1; // key size
+
+  // get 4 messages of 64, 128, 256, and 512 random bytes
+  uint8_t bufs[4][512] = { 0 };
+  rand_bytes(bufs, sizeof(bufs));
+  const uint8_t * const msgs[4] = { bufs[0], bufs[1], bufs[2], bufs[3] };
+  const size_t lens[4] = { 64, 128, 256, 512 };
+
+  // calculate HMAC-SHA3-256 of each message, write results to `macs`
+  uint8_t macs[4][32] = { 0 };
+  uint8_t * const dsts[4] = { macs[0], macs[1], macs[2], macs[3] };
+  hmac_sha3_256_batch(key, key_len, msgs, lens, 4, dsts);
+
+  // verify MACs
+  const uint8_t * const exps[4] = { macs[0], macs[1], macs[2], macs[3] };
+  const _Bool ok = hmac_sha3_256_batch_verify(key, key_len, msgs, lens, 4, exps, NULL);
+  ///! [hmac_sha3_256_batch]
+
+  // print to stdout
+  printf("%s: ok=%d ", __func__, ok);
+  for (size_t i = 0; i < 4; i++) {
+    hex_write(stdout, macs[i], sizeof(macs[i]));
+    fputs((i < 3) ? " " : "\n", stdout);
+  }
+}
+
+static void hmac_sha3_384_batch_example(void) {
+  ///! [hmac_sha3_384_batch]
+  // key and key size, in bytes (w/o trailing NUL)
+  const uint8_t key[] = "secret!"; // key
+  const size_t key_len = sizeof(key) - 1; // key size
+
+  // get 4 messages of 64, 128, 256, and 512 random bytes
+  uint8_t bufs[4][512] = { 0 };
+  rand_bytes(bufs, sizeof(bufs));
+  const uint8_t * const msgs[4] = { bufs[0], bufs[1], bufs[2], bufs[3] };
+  const size_t lens[4] = { 64, 128, 256, 512 };
+
+  // calculate HMAC-SHA3-384 of each message, write results to `macs`
+  uint8_t macs[4][48] = { 0 };
+  uint8_t * const dsts[4] = { macs[0], macs[1], macs[2], macs[3] };
+  hmac_sha3_384_batch(key, key_len, msgs, lens, 4, dsts);
+
+  // verify MACs
+  const uint8_t * const exps[4] = { macs[0], macs[1], macs[2], macs[3] };
+  const _Bool ok = hmac_sha3_384_batch_verify(key, key_len, msgs, lens, 4, exps, NULL);
+  ///! [hmac_sha3_384_batch]
+
+  // print to stdout
+  printf("%s: ok=%d ", __func__, ok);
+  for (size_t i = 0; i < 4; i++) {
+    hex_write(stdout, macs[i], sizeof(macs[i]));
+    fputs((i < 3) ? " " : "\n", stdout);
+  }
+}
+
+static void hmac_sha3_512_batch_example(void) {
+  ///! [hmac_sha3_512_batch]
+  // key and key size, in bytes (w/o trailing NUL)
+  const uint8_t key[] = "secret!"; // key
+  const size_t key_len = sizeof(key) - 1; // key size
+
+  // get 4 messages of 64, 128, 256, and 512 random bytes
+  uint8_t bufs[4][512] = { 0 };
+  rand_bytes(bufs, sizeof(bufs));
+  const uint8_t * const msgs[4] = { bufs[0], bufs[1], bufs[2], bufs[3] };
+  const size_t lens[4] = { 64, 128, 256, 512 };
+
+  // calculate HMAC-SHA3-512 of each message, write results to `macs`
+  uint8_t macs[4][64] = { 0 };
+  uint8_t * const dsts[4] = { macs[0], macs[1], macs[2], macs[3] };
+  hmac_sha3_512_batch(key, key_len, msgs, lens, 4, dsts);
+
+  // verify MACs
+  const uint8_t * const exps[4] = { macs[0], macs[1], macs[2], macs[3] };
+  const _Bool ok = hmac_sha3_512_batch_verify(key, key_len, msgs, lens, 4, exps, NULL);
+  ///! [hmac_sha3_512_batch]
+
+  // print to stdout
+  printf("%s: ok=%d ", __func__, ok);
+  for (size_t i = 0; i < 4; i++) {
+    hex_write(stdout, macs[i], sizeof(macs[i]));
+    fputs((i < 3) ? " " : "\n", stdout);
+  }
+}
+
 static void cshake128_example(void) {
   ///! [cshake128]
   const uint8_t custom[] = "hello"; // customization string
@@ -644,6 +1223,70 @@ static void kmac128_example(void) {
   fputs("\n", stdout);
 }
 
+static void kmac128_batch_example(void) {
+  ///! [kmac128_batch]
+  // key
+  const uint8_t key[] = {
+    0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+    0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57,
+    0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+  };
+
+  // derive subkeys for 3 tenants: message is the tenant name,
+  // customization string is the subkey label
+  const uint8_t * const msgs[3] = { (const uint8_t*) "alice", (const uint8_t*) "bob", (const uint8_t*) "carol" };
+  const size_t lens[3] = { 5, 3, 5 };
+  const uint8_t * const customs[3] = { (const uint8_t*) "enc", (const uint8_t*) "enc", (const uint8_t*) "mac" };
+  const size_t custom_lens[3] = { 3, 3, 3 };
+
+  // write 32, 32, and 64 byte subkeys to `subkeys`
+  uint8_t subkeys[3][64] = { 0 };
+  uint8_t * const dsts[3] = { subkeys[0], subkeys[1], subkeys[2] };
+  const size_t dst_lens[3] = { 32, 32, 64 };
+  kmac128_batch(key, sizeof(key), msgs, lens, 3, customs, custom_lens, dsts, dst_lens);
+  ///! [kmac128_batch]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  for (size_t i = 0; i < 3; i++) {
+    hex_write(stdout, subkeys[i], dst_lens[i]);
+    fputs((i < 2) ? " " : "\n", stdout);
+  }
+}
+
+static void kmac256_batch_example(void) {
+  ///! [kmac256_batch]
+  // key
+  const uint8_t key[] = {
+    0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47,
+    0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,
+    0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57,
+    0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,
+  };
+
+  // derive subkeys for 3 tenants: message is the tenant name,
+  // customization string is the subkey label
+  const uint8_t * const msgs[3] = { (const uint8_t*) "alice", (const uint8_t*) "bob", (const uint8_t*) "carol" };
+  const size_t lens[3] = { 5, 3, 5 };
+  const uint8_t * const customs[3] = { (const uint8_t*) "enc", (const uint8_t*) "enc", (const uint8_t*) "mac" };
+  const size_t custom_lens[3] = { 3, 3, 3 };
+
+  // write 32, 32, and 64 byte subkeys to `subkeys`
+  uint8_t subkeys[3][64] = { 0 };
+  uint8_t * const dsts[3] = { subkeys[0], subkeys[1], subkeys[2] };
+  const size_t dst_lens[3] = { 32, 32, 64 };
+  kmac256_batch(key, sizeof(key), msgs, lens, 3, customs, custom_lens, dsts, dst_lens);
+  ///! [kmac256_batch]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  for (size_t i = 0; i < 3; i++) {
+    hex_write(stdout, subkeys[i], dst_lens[i]);
+    fputs((i < 2) ? " " : "\n", stdout);
+  }
+}
+
 static void kmac128_xof_example(void) {
   ///! [kmac128_xof]
   const uint8_t key[] = "secret!"; // secret key
@@ -845,6 +1488,64 @@ static void tuplehash128_example(void) {
   fputs("\n", stdout);
 }
 
+static void tuplehash128_batch_example(void) {
+  ///! [tuplehash128_batch]
+  // table of 3 rows (id, name, email), stored column-major
+  const tuplehash_str_t strs[] = {
+    // id column
+    { (const uint8_t*) "1", 1 }, { (const uint8_t*) "2", 1 }, { (const uint8_t*) "3", 1 },
+    // name column
+    { (const uint8_t*) "alice", 5 }, { (const uint8_t*) "bob", 3 }, { (const uint8_t*) "carol", 5 },
+    // email column
+    { (const uint8_t*) "a@example.com", 13 }, { (const uint8_t*) "b@example.com", 13 }, { (const uint8_t*) "c@example.com", 13 },
+  };
+
+  // customization string
+  static const uint8_t custom[] = "users";
+
+  // calculate TupleHash128 of each row, write 32 bytes for each row to `hashes`
+  uint8_t hashes[3][32] = { 0 };
+  uint8_t * const dsts[3] = { hashes[0], hashes[1], hashes[2] };
+  tuplehash128_batch(strs, 3, 3, custom, sizeof(custom) - 1, dsts, sizeof(hashes[0]));
+  ///! [tuplehash128_batch]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  for (size_t i = 0; i < 3; i++) {
+    hex_write(stdout, hashes[i], sizeof(hashes[i]));
+    fputs((i < 2) ? " " : "\n", stdout);
+  }
+}
+
+static void tuplehash256_batch_example(void) {
+  ///! [tuplehash256_batch]
+  // table of 3 rows (id, name, email), stored column-major
+  const tuplehash_str_t strs[] = {
+    // id column
+    { (const uint8_t*) "1", 1 }, { (const uint8_t*) "2", 1 }, { (const uint8_t*) "3", 1 },
+    // name column
+    { (const uint8_t*) "alice", 5 }, { (const uint8_t*) "bob", 3 }, { (const uint8_t*) "carol", 5 },
+    // email column
+    { (const uint8_t*) "a@example.com", 13 }, { (const uint8_t*) "b@example.com", 13 }, { (const uint8_t*) "c@example.com", 13 },
+  };
+
+  // customization string
+  static const uint8_t custom[] = "users";
+
+  // calculate TupleHash256 of each row, write 32 bytes for each row to `hashes`
+  uint8_t hashes[3][32] = { 0 };
+  uint8_t * const dsts[3] = { hashes[0], hashes[1], hashes[2] };
+  tuplehash256_batch(strs, 3, 3, custom, sizeof(custom) - 1, dsts, sizeof(hashes[0]));
+  ///! [tuplehash256_batch]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  for (size_t i = 0; i < 3; i++) {
+    hex_write(stdout, hashes[i], sizeof(hashes[i]));
+    fputs((i < 2) ? " " : "\n", stdout);
+  }
+}
+
 static void tuplehash128_xof_example(void) {
   ///! [tuplehash128_xof]
   // byte strings
@@ -1381,6 +2082,34 @@ static void turboshake256_xof_example(void) {
   fputs("\n", stdout);
   ///! [turboshake256_xof]
 }
+static void turboshake128_keyed_example(void) {
+  ///! [turboshake128_keyed]
+  // get random 16 byte key (e.g., once at startup)
+  uint8_t k[16] = { 0 };
+  rand_bytes(k, sizeof(k));
+
+  // process key once
+  turboshake128_key_t key;
+  turboshake128_key_init(&key, k, sizeof(k));
+
+  // hash table: get 64-bit bucket hash of item
+  const uint8_t item[] = "hello";
+  const uint64_t h = turboshake128_keyed_u64(&key, item, sizeof(item) - 1);
+
+  // bloom filter: get 4 64-bit hashes of item
+  uint64_t hs[4] = { 0 };
+  turboshake128_keyed_u64s(&key, item, sizeof(item) - 1, hs, 4);
+
+  // bulk insert: hash 8 items at once
+  const uint8_t *items[8] = { item, item, item, item, item, item, item, item };
+  const size_t lens[8] = { 5, 4, 3, 2, 1, 0, 5, 5 };
+  uint64_t bulk[8] = { 0 };
+  turboshake128_keyed_u64_x8(&key, items, lens, bulk);
+  ///! [turboshake128_keyed]
+
+  // print to stdout
+  printf("%s: h=%016llx, hs[1]=%016llx, bulk[1]=%016llx\n", __func__, (unsigned long long) h, (unsigned long long) hs[1], (unsigned long long) bulk[1]);
+}
 
 static void turboshake256_custom_xof_example(void) {
   ///! [turboshake256_custom_xof]
@@ -1489,6 +2218,183 @@ static void k12_xof_example(void) {
   ///! [k12_xof]
 }
 
+static void sha3_multi_example(void) {
+  ///! [sha3_multi]
+  // get 1024 random bytes
+  uint8_t buf[1024] = { 0 };
+  rand_bytes(buf, sizeof(buf));
+
+  // calculate SHA3-256, SHA3-512, and SHAKE256 in a single pass
+  const sha3_algo_t algos[] = { SHA3_ALGO_SHA3_256, SHA3_ALGO_SHA3_512, SHA3_ALGO_SHAKE256 };
+  sha3_multi_t ctx;
+  sha3_multi_init(&ctx, algos, 3);
+
+  // absorb `buf` in 32 byte chunks
+  for (size_t i = 0; i < sizeof(buf); i += 32) {
+    sha3_multi_absorb(&ctx, buf + i, 32);
+  }
+
+  // get results
+  uint8_t sha3_256_hash[32] = { 0 }, sha3_512_hash[64] = { 0 }, shake256_out[64] = { 0 };
+  sha3_multi_final(&ctx, 0, sha3_256_hash, sizeof(sha3_256_hash));
+  sha3_multi_final(&ctx, 1, sha3_512_hash, sizeof(sha3_512_hash));
+  sha3_multi_final(&ctx, 2, shake256_out, sizeof(shake256_out));
+  ///! [sha3_multi]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  hex_write(stdout, sha3_256_hash, sizeof(sha3_256_hash));
+  fputs(" ", stdout);
+  hex_write(stdout, sha3_512_hash, sizeof(sha3_512_hash));
+  fputs(" ", stdout);
+  hex_write(stdout, shake256_out, sizeof(shake256_out));
+  fputs("\n", stdout);
+}
+
+static void sha3_mgr_example(void) {
+  ///! [sha3_mgr]
+  // get 16 messages of random lengths (up to 1024 bytes)
+  uint8_t bufs[16][1024] = { 0 };
+  uint16_t lens[16] = { 0 };
+  rand_bytes(bufs, sizeof(bufs));
+  rand_bytes(lens, sizeof(lens));
+
+  // init SHA3-256 job manager with a maximum latency of 100us
+  sha3_mgr_t mgr;
+  sha3_mgr_init(&mgr, SHA3_ALGO_SHA3_256, 100);
+
+  // submit jobs as messages "arrive"; finished jobs may be returned by
+  // any call, in any order
+  sha3_job_t jobs[16];
+  uint8_t hashes[16][32] = { 0 };
+  size_t num_done = 0;
+  for (size_t i = 0; i < 16; i++) {
+    jobs[i] = (sha3_job_t) { .src = bufs[i], .len = lens[i] % 1024, .dst = hashes[i] };
+    if (sha3_mgr_submit(&mgr, jobs + i)) {
+      num_done++;
+    }
+  }
+
+  // flush remaining jobs
+  while (sha3_mgr_flush(&mgr)) {
+    num_done++;
+  }
+  ///! [sha3_mgr]
+
+  // print to stdout
+  printf("%s: %zu jobs: ", __func__, num_done);
+  hex_write(stdout, hashes[0], sizeof(hashes[0]));
+  fputs(" ...\n", stdout);
+}
+
+static void sha3_merkle_example(void) {
+  ///! [sha3_merkle]
+  // get 20 random leaves of 100 bytes each
+  uint8_t data[20][100] = { 0 };
+  rand_bytes(data, sizeof(data));
+  const uint8_t *leaves[20];
+  size_t lens[20];
+  for (size_t i = 0; i < 20; i++) {
+    leaves[i] = data[i];
+    lens[i] = sizeof(data[i]);
+  }
+
+  // build SHA3-256 merkle tree (20 leaves have 41 nodes)
+  uint8_t nodes[41][32];
+  sha3_merkle_t tree;
+  sha3_merkle_build(&tree, SHA3_ALGO_SHA3_256, leaves, lens, 20, nodes[0]);
+  const uint8_t *root = sha3_merkle_root(&tree);
+
+  // get inclusion proof for leaf 7
+  uint8_t proof[SHA3_MERKLE_MAX_DEPTH][32];
+  size_t proof_len = 0;
+  sha3_merkle_proof(&tree, 7, proof[0], &proof_len);
+
+  // verify inclusion proof
+  const _Bool ok = sha3_merkle_verify(SHA3_ALGO_SHA3_256, root, 20, 7, leaves[7], lens[7], proof[0], proof_len);
+  ///! [sha3_merkle]
+
+  // print to stdout
+  printf("%s: nodes=%zu, proof_len=%zu, ok=%d, root=", __func__, sha3_merkle_num_nodes(20), proof_len, ok);
+  hex_write(stdout, root, 32);
+  fputs("\n", stdout);
+}
+
+static void keccak_p1600_example(void) {
+  ///! [keccak_p1600]
+  // get random 200 byte state
+  uint64_t s[25] = { 0 };
+  rand_bytes((uint8_t*) s, sizeof(s));
+
+  // apply 24 round permutation (keccak-f[1600]), then 12 round
+  // permutation (keccak-p[1600, 12])
+  // (returns false if the number of rounds is greater than 24)
+  keccak_p1600(s, 24);
+  keccak_p1600(s, 12);
+  ///! [keccak_p1600]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  hex_write(stdout, (uint8_t*) s, sizeof(s));
+  fputs("\n", stdout);
+}
+
+static void sha3_sponge_example(void) {
+  ///! [sha3_sponge]
+  // get 1024 random bytes
+  uint8_t buf[1024] = { 0 };
+  rand_bytes(buf, sizeof(buf));
+
+  // init sponge with 168 byte rate, 24 round permutation, and padding
+  // byte 0x1f (equivalent to shake128)
+  // (returns false if a parameter is out of range)
+  sha3_sponge_t sponge;
+  sha3_sponge_init(&sponge, 168, 24, 0x1f);
+
+  // absorb `buf` in two chunks
+  // (returns false if the sponge has already been squeezed)
+  sha3_sponge_absorb(&sponge, buf, 512);
+  sha3_sponge_absorb(&sponge, buf + 512, 512);
+
+  // squeeze 32 bytes of output into `out`
+  // (returns false if the sponge has been used for duplex calls)
+  uint8_t out[32] = { 0 };
+  sha3_sponge_squeeze(&sponge, out, sizeof(out));
+  ///! [sha3_sponge]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  hex_write(stdout, out, sizeof(out));
+  fputs("\n", stdout);
+}
+
+static void sha3_sponge_duplex_example(void) {
+  ///! [sha3_sponge_duplex]
+  // init sponge with 168 byte rate, 12 round permutation, and padding
+  // byte 0x0b
+  sha3_sponge_t sponge;
+  sha3_sponge_init(&sponge, 168, 12, 0x0b);
+
+  // absorb first message, squeeze 16 byte tag
+  // (returns false if the input is not shorter than the rate or the
+  // output is longer than the rate)
+  uint8_t tag0[16] = { 0 };
+  sha3_sponge_duplex(&sponge, (const uint8_t*) "hello", 5, tag0, sizeof(tag0));
+
+  // absorb second message, squeeze 16 byte tag which depends on both
+  // messages
+  uint8_t tag1[16] = { 0 };
+  sha3_sponge_duplex(&sponge, (const uint8_t*) "world", 5, tag1, sizeof(tag1));
+  ///! [sha3_sponge_duplex]
+
+  // print to stdout
+  printf("%s: ", __func__);
+  hex_write(stdout, tag0, sizeof(tag0));
+  fputs(", ", stdout);
+  hex_write(stdout, tag1, sizeof(tag1));
+  fputs("\n", stdout);
+}
+
 static void sha3_backend_example(void) {
   ///! [sha3_backend]
   // get backend name
@@ -1499,6 +2405,40 @@ static void sha3_backend_example(void) {
   ///! [sha3_backend]
 }
 
+static void sha3_batch_lanes_example(void) {
+  ///! [sha3_batch_lanes]
+  // get number of states permuted together by batch functions
+  const size_t num_lanes = sha3_batch_lanes();
+  ///! [sha3_batch_lanes]
+
+  // print to stdout
+  printf("%s: num_lanes=%zu\n", __func__, num_lanes);
+}
+
+static void sha3_avx512_ymm_example(void) {
+  ///! [sha3_avx512_ymm]
+  // use 256-bit permutation instead of 512-bit permutation
+  // (returns false if the backend is not avx512)
+  const _Bool ok = sha3_avx512_ymm(1);
+
+  // get 1024 random bytes
+  uint8_t buf[1024] = { 0 };
+  rand_bytes(buf, sizeof(buf));
+
+  // calculate sha3-256 hash of `buf`, write results to `hash`
+  uint8_t hash[32] = { 0 };
+  sha3_256(buf, sizeof(buf), hash);
+
+  // switch back to 512-bit permutation
+  sha3_avx512_ymm(0);
+  ///! [sha3_avx512_ymm]
+
+  // print to stdout
+  printf("%s: ok=%d, hash=", __func__, ok);
+  hex_write(stdout, hash, sizeof(hash));
+  fputs("\n", stdout);
+}
+
 int main(void) {
   sha3_224_example();
   sha3_224_absorb_example();
@@ -1508,10 +2448,28 @@ int main(void) {
   sha3_384_absorb_example();
   sha3_512_example();
   sha3_512_absorb_example();
+  sha3_224_batch_example();
+  sha3_256_batch_example();
+  sha3_384_batch_example();
+  sha3_512_batch_example();
   shake128_example();
   shake128_ctx_example();
+  shake128_blocks_example();
   shake256_example();
   shake256_ctx_example();
+  shake256_blocks_example();
+  sha3_224_x4_example();
+  sha3_256_x4_example();
+  sha3_384_x4_example();
+  sha3_512_x4_example();
+  sha3_256_32_example();
+  sha3_256_64_example();
+  sha3_256_iterate_example();
+  shake128_batch_example();
+  shake256_batch_example();
+  shake256_chain_example();
+  shake128_sample12_example();
+  shake128_sample23_example();
   hmac_sha3_224_example();
   hmac_sha3_224_absorb_example();
   hmac_sha3_256_example();
@@ -1520,17 +2478,25 @@ int main(void) {
   hmac_sha3_384_absorb_example();
   hmac_sha3_512_example();
   hmac_sha3_512_absorb_example();
+  hmac_sha3_224_batch_example();
+  hmac_sha3_256_batch_example();
+  hmac_sha3_384_batch_example();
+  hmac_sha3_512_batch_example();
   cshake128_example();
   cshake128_xof_example();
   cshake256_example();
   cshake256_xof_example();
   kmac128_example();
+  kmac128_batch_example();
+  kmac256_batch_example();
   kmac128_xof_example();
   kmac128_xof_once_example();
   kmac256_example();
   kmac256_xof_example();
   kmac256_xof_once_example();
   tuplehash128_example();
+  tuplehash128_batch_example();
+  tuplehash256_batch_example();
   tuplehash128_xof_example();
   tuplehash128_xof_once_example();
   tuplehash256_example();
@@ -1549,11 +2515,20 @@ int main(void) {
   turboshake256_example();
   turboshake256_custom_example();
   turboshake256_xof_example();
+  turboshake128_keyed_example();
   turboshake256_custom_xof_example();
   k12_once_example();
   k12_custom_once_example();
   k12_xof_example();
+  sha3_multi_example();
+  sha3_mgr_example();
+  sha3_merkle_example();
+  keccak_p1600_example();
+  sha3_sponge_example();
+  sha3_sponge_duplex_example();
   sha3_backend_example();
+  sha3_batch_lanes_example();
+  sha3_avx512_ymm_example();
 
   return 0;
 }
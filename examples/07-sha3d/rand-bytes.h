@@ -0,0 +1 @@
+../../rand-bytes.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../sha3.c
\ No newline at end of file
@@ -0,0 +1 @@
+../../sha3.h
\ No newline at end of file
@@ -0,0 +1,205 @@
+//
+// sha3d-test: local client harness for sha3d.
+//
+// Forks several client processes which submit requests with random
+// payloads, algorithms, and digest lengths to the daemon and check
+// each completion against a digest calculated locally.
+//
+// Usage: sha3d-test <socket-path> [num_clients] [num_reqs] [max_inflight]
+//
+// Options:
+//   num_clients   Number of client processes (default: 8).
+//   num_reqs      Number of requests per client (default: 1000).
+//   max_inflight  Maximum number of pending requests per client
+//                 (default: 2, maximum: 64).
+//
+// Prints "ok" and exits with a zero status code if every completion
+// matched, or prints an error and exits with a non-zero status code
+// otherwise.
+//
+#define _GNU_SOURCE // memfd_create()
+#include <stdbool.h> // bool
+#include <stdint.h> // uint8_t
+#include <stdio.h> // printf()
+#include <stdlib.h> // atoi(), malloc()
+#include <string.h> // memcmp()
+#include <time.h> // nanosleep()
+#include <err.h> // err(), errx()
+#include <sys/wait.h> // waitpid()
+#include "sha3d.h"
+#include "rand-bytes.h"
+
+// maximum payload length used by test, in bytes
+#define MAX_LEN 1024
+
+// number of connection attempts (daemon may still be starting)
+#define NUM_CONNECT_TRIES 50
+
+// expected result for request
+typedef struct {
+  uint32_t len; // digest length
+  uint8_t digest[SHA3D_MAX_DIGEST_LEN]; // digest
+} exp_t;
+
+// calculate expected digest for payload, return digest length
+static size_t hash(const sha3_algo_t algo, const uint8_t * const src, const size_t len, uint8_t * const dst, const size_t dst_len) {
+  switch (algo) {
+  case SHA3_ALGO_SHA3_224:
+    sha3_224(src, len, dst);
+    return 28;
+  case SHA3_ALGO_SHA3_256:
+    sha3_256(src, len, dst);
+    return 32;
+  case SHA3_ALGO_SHA3_384:
+    sha3_384(src, len, dst);
+    return 48;
+  case SHA3_ALGO_SHA3_512:
+    sha3_512(src, len, dst);
+    return 64;
+  case SHA3_ALGO_SHAKE128:
+    shake128(src, len, dst, dst_len);
+    return dst_len;
+  case SHA3_ALGO_SHAKE256:
+    shake256(src, len, dst, dst_len);
+    return dst_len;
+  case SHA3_ALGO_TURBOSHAKE128:
+    turboshake128(src, len, dst, dst_len);
+    return dst_len;
+  case SHA3_ALGO_TURBOSHAKE256:
+    turboshake256(src, len, dst, dst_len);
+    return dst_len;
+  default:
+    return 0;
+  }
+}
+
+// connect to daemon, retrying while daemon starts
+static void connect_or_die(sha3d_client_t * const client, const char * const path) {
+  for (size_t i = 0; i < NUM_CONNECT_TRIES; i++) {
+    if (sha3d_client_init(client, path)) {
+      return;
+    }
+
+    // wait 100ms before retrying
+    const struct timespec ts = { .tv_nsec = 100000000 };
+    nanosleep(&ts, NULL);
+  }
+
+  err(-1, "sha3d_client_init()");
+}
+
+// reap one completion and check it, return number of failures (0 or 1)
+static size_t reap(sha3d_client_t * const client, const exp_t * const exps, const size_t num_reqs) {
+  sha3d_cqe_t cqe;
+  if (!sha3d_client_reap(client, &cqe, true)) {
+    err(-1, "sha3d_client_reap()");
+  }
+
+  if (cqe.id >= num_reqs) {
+    warnx("unknown request ID: %lu", (unsigned long) cqe.id);
+    return 1;
+  }
+
+  const exp_t * const exp = exps + cqe.id;
+  if (cqe.status || cqe.len != exp->len || memcmp(cqe.digest, exp->digest, exp->len)) {
+    warnx("request %lu: digest mismatch (status = %d)", (unsigned long) cqe.id, cqe.status);
+    return 1;
+  }
+
+  return 0;
+}
+
+// run client, return number of failures
+static size_t run_client(const char * const path, const size_t num_reqs, const size_t max_inflight) {
+  exp_t * const exps = malloc(num_reqs * sizeof(exp_t));
+  if (!exps) {
+    err(-1, "malloc()");
+  }
+
+  sha3d_client_t client;
+  connect_or_die(&client, path);
+
+  size_t num_fails = 0, num_inflight = 0;
+  for (size_t id = 0; id < num_reqs; id++) {
+    // wait for room
+    uint8_t *slot;
+    while (num_inflight >= max_inflight || !(slot = sha3d_client_slot(&client))) {
+      num_fails += reap(&client, exps, num_reqs);
+      num_inflight--;
+    }
+
+    // pick random algorithm, payload length, and digest length
+    uint16_t r[3];
+    rand_bytes(r, sizeof(r));
+    const sha3_algo_t algo = r[0] % SHA3_ALGO_LAST;
+    const size_t len = r[1] % (MAX_LEN + 1),
+                 dst_len = 1 + r[2] % SHA3D_MAX_DIGEST_LEN;
+
+    // write random payload directly to slot
+    rand_bytes(slot, len);
+
+    // calculate expected digest
+    exps[id].len = hash(algo, slot, len, exps[id].digest, dst_len);
+
+    // submit request, notify daemon
+    sha3d_client_submit(&client, id, algo, len, dst_len);
+    if (!sha3d_client_kick(&client)) {
+      err(-1, "sha3d_client_kick()");
+    }
+    num_inflight++;
+  }
+
+  // drain remaining completions
+  while (num_inflight-- > 0) {
+    num_fails += reap(&client, exps, num_reqs);
+  }
+
+  sha3d_client_fini(&client);
+  free(exps);
+
+  return num_fails;
+}
+
+int main(int argc, char *argv[]) {
+  // check command-line arguments
+  if (argc < 2 || argc > 5) {
+    fprintf(stderr, "Usage: %s <socket-path> [num_clients] [num_reqs] [max_inflight]\n", argv[0]);
+    return -1;
+  }
+  const char * const path = argv[1];
+  const size_t num_clients = (argc > 2) ? (size_t) atoi(argv[2]) : 8,
+               num_reqs = (argc > 3) ? (size_t) atoi(argv[3]) : 1000,
+               max_inflight = (argc > 4) ? (size_t) atoi(argv[4]) : 2;
+  if (!num_clients || !max_inflight || max_inflight > SHA3D_RING_LEN) {
+    errx(-1, "invalid arguments");
+  }
+
+  // fork clients
+  for (size_t i = 0; i < num_clients; i++) {
+    const pid_t pid = fork();
+    if (pid < 0) {
+      err(-1, "fork()");
+    } else if (pid == 0) {
+      exit(run_client(path, num_reqs, max_inflight) ? 1 : 0);
+    }
+  }
+
+  // wait for clients
+  size_t num_fails = 0;
+  for (size_t i = 0; i < num_clients; i++) {
+    int status;
+    if (wait(&status) < 0) {
+      err(-1, "wait()");
+    }
+
+    num_fails += !WIFEXITED(status) || WEXITSTATUS(status);
+  }
+
+  if (num_fails > 0) {
+    printf("%zu of %zu clients failed\n", num_fails, num_clients);
+    return -1;
+  }
+
+  printf("ok\n");
+  return 0;
+}
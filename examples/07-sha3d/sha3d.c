@@ -0,0 +1,386 @@
+//
+// sha3d: hashing daemon which aggregates small requests from many
+// client processes into batches for the multi-buffer batch functions
+// (e.g. `sha3_256_batch()`).
+//
+// Clients pass payloads through shared memory rings (see sha3d.h), so
+// the daemon hashes payloads in place without copying them.
+//
+// Usage: sha3d [-w usec] [-b count] <socket-path>
+//
+// Options:
+//   -w usec   Batching window, in microseconds (default: 100).  If fewer
+//             than `count` requests are pending, the daemon waits up to
+//             this long for more requests before hashing.  Use 0 to
+//             disable.
+//   -b count  Minimum batch size (default: multi-buffer lane count of
+//             the backend, see `sha3_batch_lanes()`).
+//
+#define _GNU_SOURCE // memfd_create(), ppoll(), accept4()
+#include <stdbool.h> // bool
+#include <stdint.h> // uint8_t
+#include <stdio.h> // fprintf()
+#include <stdlib.h> // atoi(), exit()
+#include <string.h> // memset()
+#include <signal.h> // sigaction()
+#include <poll.h> // poll(), ppoll()
+#include <fcntl.h> // O_NONBLOCK
+#include <err.h> // err(), warn()
+#include <sys/stat.h> // fstat()
+#include "sha3d.h"
+
+// maximum number of clients
+#define MAX_CLIENTS 64
+
+// maximum number of pending requests
+#define MAX_REQS (MAX_CLIENTS * SHA3D_RING_LEN)
+
+// connected client
+typedef struct {
+  int sock; // client socket
+  sha3d_shm_t *shm; // shared memory region
+} client_t;
+
+// pending request
+typedef struct {
+  size_t client; // client offset
+  uint32_t slot; // payload slot
+  sha3d_sqe_t sqe; // copy of submission entry
+  sha3d_cqe_t cqe; // completion entry
+} req_t;
+
+// digest lengths, indexed by algorithm (0 for XOFs)
+static const uint8_t DIGEST_LENS[SHA3_ALGO_LAST] = {
+  [SHA3_ALGO_SHA3_224] = 28,
+  [SHA3_ALGO_SHA3_256] = 32,
+  [SHA3_ALGO_SHA3_384] = 48,
+  [SHA3_ALGO_SHA3_512] = 64,
+};
+
+static client_t clients[MAX_CLIENTS];
+static size_t num_clients = 0;
+
+static req_t reqs[MAX_REQS];
+
+// statistics
+static size_t num_reqs_total = 0, num_batches = 0, max_batch = 0;
+
+// set by signal handler
+static volatile sig_atomic_t done = 0;
+
+static void on_signal(int sig) {
+  (void) sig; // unused
+  done = 1;
+}
+
+// accept new client and map its shared memory region
+static void accept_client(const int listen_sock) {
+  const int sock = accept4(listen_sock, NULL, NULL, SOCK_CLOEXEC);
+  if (sock < 0) {
+    warn("accept4()");
+    return;
+  }
+
+  if (num_clients == MAX_CLIENTS) {
+    warnx("too many clients");
+    close(sock);
+    return;
+  }
+
+  // receive magic number and shared memory file descriptor
+  uint32_t magic = 0;
+  struct iovec iov = { .iov_base = &magic, .iov_len = sizeof(magic) };
+  union {
+    struct cmsghdr hdr;
+    uint8_t buf[CMSG_SPACE(sizeof(int))];
+  } cmsg_buf;
+  struct msghdr msg = {
+    .msg_iov = &iov,
+    .msg_iovlen = 1,
+    .msg_control = cmsg_buf.buf,
+    .msg_controllen = sizeof(cmsg_buf.buf),
+  };
+  const ssize_t len = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+  const struct cmsghdr * const cmsg = CMSG_FIRSTHDR(&msg);
+  if (len != sizeof(magic) || magic != SHA3D_MAGIC || !cmsg || cmsg->cmsg_type != SCM_RIGHTS) {
+    warnx("invalid client handshake");
+    close(sock);
+    return;
+  }
+
+  int fd;
+  memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+
+  // check size of shared memory region, then map it
+  struct stat st;
+  sha3d_shm_t *shm = MAP_FAILED;
+  if (!fstat(fd, &st) && st.st_size >= (off_t) sizeof(sha3d_shm_t)) {
+    shm = mmap(NULL, sizeof(sha3d_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (shm == MAP_FAILED) {
+    warnx("invalid shared memory region");
+    close(sock);
+    return;
+  }
+
+  // make socket non-blocking, add client
+  fcntl(sock, F_SETFL, fcntl(sock, F_GETFL) | O_NONBLOCK);
+  clients[num_clients++] = (client_t) { .sock = sock, .shm = shm };
+}
+
+// remove client
+static void remove_client(const size_t i) {
+  close(clients[i].sock);
+  munmap(clients[i].shm, sizeof(sha3d_shm_t));
+  clients[i] = clients[--num_clients];
+}
+
+// read doorbell bytes from readable clients and remove disconnected
+// clients
+static void drain_clients(const struct pollfd * const pfds) {
+  // walk backwards so remove_client() does not skip clients
+  for (size_t i = num_clients; i > 0; i--) {
+    if (!pfds[i - 1].revents) {
+      continue;
+    }
+
+    uint8_t buf[256];
+    ssize_t len;
+    while ((len = read(clients[i - 1].sock, buf, sizeof(buf))) > 0);
+    if (len == 0 || (len < 0 && errno != EAGAIN && errno != EINTR)) {
+      remove_client(i - 1);
+    }
+  }
+}
+
+// get number of pending submissions for client (clamped to ring size)
+static uint32_t num_pending(const sha3d_shm_t * const shm) {
+  const uint32_t n = __atomic_load_n(&(shm->sq_tail), __ATOMIC_ACQUIRE) - shm->sq_head;
+  return (n > SHA3D_RING_LEN) ? SHA3D_RING_LEN : n;
+}
+
+// hash batch of payloads with given algorithm
+static void hash_batch(const sha3_algo_t algo, const uint8_t * const srcs[], const size_t lens[], const size_t n, uint8_t * const dsts[]) {
+  switch (algo) {
+  case SHA3_ALGO_SHA3_224:
+    sha3_224_batch(srcs, lens, n, dsts);
+    break;
+  case SHA3_ALGO_SHA3_256:
+    sha3_256_batch(srcs, lens, n, dsts);
+    break;
+  case SHA3_ALGO_SHA3_384:
+    sha3_384_batch(srcs, lens, n, dsts);
+    break;
+  case SHA3_ALGO_SHA3_512:
+    sha3_512_batch(srcs, lens, n, dsts);
+    break;
+  case SHA3_ALGO_SHAKE128:
+    // squeeze maximum length; shorter outputs are prefixes
+    shake128_batch(srcs, lens, n, dsts, SHA3D_MAX_DIGEST_LEN);
+    break;
+  case SHA3_ALGO_SHAKE256:
+    // squeeze maximum length; shorter outputs are prefixes
+    shake256_batch(srcs, lens, n, dsts, SHA3D_MAX_DIGEST_LEN);
+    break;
+  case SHA3_ALGO_TURBOSHAKE128:
+    // no batch function; hash sequentially
+    for (size_t i = 0; i < n; i++) {
+      turboshake128(srcs[i], lens[i], dsts[i], SHA3D_MAX_DIGEST_LEN);
+    }
+    break;
+  case SHA3_ALGO_TURBOSHAKE256:
+    // no batch function; hash sequentially
+    for (size_t i = 0; i < n; i++) {
+      turboshake256(srcs[i], lens[i], dsts[i], SHA3D_MAX_DIGEST_LEN);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+// collect pending requests from all clients, hash them in batches
+// grouped by algorithm, then post completions and notify clients
+static void process(void) {
+  static const uint8_t *srcs[MAX_REQS];
+  static size_t lens[MAX_REQS];
+  static uint8_t *dsts[MAX_REQS];
+
+  // collect pending requests
+  size_t num_reqs = 0;
+  for (size_t i = 0; i < num_clients; i++) {
+    const sha3d_shm_t * const shm = clients[i].shm;
+    const uint32_t head = shm->sq_head, n = num_pending(shm);
+    for (uint32_t j = 0; j < n; j++) {
+      req_t * const req = reqs + num_reqs++;
+      req->client = i;
+      req->slot = (head + j) % SHA3D_RING_LEN;
+
+      // copy entry so the client cannot change it while it is in use
+      req->sqe = shm->sqes[req->slot];
+
+      // validate entry
+      const sha3d_sqe_t * const sqe = &(req->sqe);
+      memset(&(req->cqe), 0, sizeof(sha3d_cqe_t));
+      req->cqe.id = sqe->id;
+      if (sqe->algo >= SHA3_ALGO_LAST || sqe->len > SHA3D_SLOT_LEN || (!DIGEST_LENS[sqe->algo] && sqe->dst_len > SHA3D_MAX_DIGEST_LEN)) {
+        req->cqe.status = -EINVAL;
+      } else {
+        req->cqe.len = DIGEST_LENS[sqe->algo] ? DIGEST_LENS[sqe->algo] : sqe->dst_len;
+      }
+    }
+  }
+
+  if (!num_reqs) {
+    return;
+  }
+
+  // hash requests in batches by algorithm
+  for (size_t algo = 0; algo < SHA3_ALGO_LAST; algo++) {
+    size_t n = 0;
+    for (size_t i = 0; i < num_reqs; i++) {
+      if (reqs[i].sqe.algo == algo && !reqs[i].cqe.status) {
+        // point at payload in shared memory (no copy)
+        srcs[n] = clients[reqs[i].client].shm->slots[reqs[i].slot];
+        lens[n] = reqs[i].sqe.len;
+        dsts[n] = reqs[i].cqe.digest;
+        n++;
+      }
+    }
+
+    if (n > 0) {
+      hash_batch(algo, srcs, lens, n, dsts);
+
+      // update statistics
+      num_batches++;
+      max_batch = (n > max_batch) ? n : max_batch;
+    }
+  }
+  num_reqs_total += num_reqs;
+
+  // post completions in submission order, then notify clients
+  for (size_t i = 0, j = 0; i < num_clients; i++) {
+    sha3d_shm_t * const shm = clients[i].shm;
+    uint32_t cq_tail = shm->cq_tail;
+    const uint32_t sq_head = shm->sq_head;
+
+    // requests are grouped by client in submission order
+    size_t n = 0;
+    for (; j < num_reqs && reqs[j].client == i; j++, n++) {
+      shm->cqes[cq_tail++ % SHA3D_RING_LEN] = reqs[j].cqe;
+    }
+
+    if (n > 0) {
+      // publish completions, consume submissions
+      __atomic_store_n(&(shm->cq_tail), cq_tail, __ATOMIC_RELEASE);
+      __atomic_store_n(&(shm->sq_head), sq_head + n, __ATOMIC_RELEASE);
+
+      // notify client (ignore errors; a full socket buffer means the
+      // client has unread notifications already)
+      const uint8_t byte = 0;
+      if (write(clients[i].sock, &byte, 1) < 0 && errno != EAGAIN) {
+        warn("write()");
+      }
+    }
+  }
+}
+
+// wait up to `usec` microseconds for more requests (batching window)
+static void wait_for_more(const long usec, struct pollfd * const pfds) {
+  const struct timespec ts = { .tv_sec = usec / 1000000, .tv_nsec = (usec % 1000000) * 1000 };
+  if (ppoll(pfds, num_clients, &ts, NULL) > 0) {
+    drain_clients(pfds);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  // parse command-line arguments
+  long window = 100; // batching window, in microseconds
+  size_t min_batch = sha3_batch_lanes(); // minimum batch size
+  int argi = 1;
+  while (argi < argc - 2) {
+    if (!strcmp(argv[argi], "-w")) {
+      window = atol(argv[argi + 1]);
+    } else if (!strcmp(argv[argi], "-b")) {
+      min_batch = atol(argv[argi + 1]);
+    } else {
+      break;
+    }
+    argi += 2;
+  }
+  if (argi != argc - 1) {
+    fprintf(stderr, "Usage: %s [-w usec] [-b count] <socket-path>\n", argv[0]);
+    return -1;
+  }
+  const char * const path = argv[argi];
+
+  // handle SIGINT and SIGTERM (no SA_RESTART, so poll() is interrupted)
+  struct sigaction sa = { .sa_handler = on_signal };
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+  signal(SIGPIPE, SIG_IGN);
+
+  // create listening socket
+  struct sockaddr_un addr = { .sun_family = AF_UNIX };
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  const int listen_sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listen_sock < 0) {
+    err(-1, "socket()");
+  }
+  unlink(path);
+  if (bind(listen_sock, (struct sockaddr*) &addr, sizeof(addr)) || listen(listen_sock, MAX_CLIENTS)) {
+    err(-1, "bind()/listen()");
+  }
+
+  struct pollfd pfds[MAX_CLIENTS + 1];
+  while (!done) {
+    // poll clients and listening socket (last)
+    for (size_t i = 0; i < num_clients; i++) {
+      pfds[i] = (struct pollfd) { .fd = clients[i].sock, .events = POLLIN };
+    }
+    pfds[num_clients] = (struct pollfd) { .fd = listen_sock, .events = POLLIN };
+
+    if (poll(pfds, num_clients + 1, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      err(-1, "poll()");
+    }
+
+    // read doorbells first (accept_client() changes client offsets)
+    const bool new_client = pfds[num_clients].revents;
+    drain_clients(pfds);
+    if (new_client) {
+      accept_client(listen_sock);
+    }
+
+    // count pending requests
+    size_t n = 0;
+    for (size_t i = 0; i < num_clients; i++) {
+      n += num_pending(clients[i].shm);
+    }
+
+    if (n > 0 && n < min_batch && window > 0) {
+      // too few requests to fill the lanes; wait for more
+      for (size_t i = 0; i < num_clients; i++) {
+        pfds[i] = (struct pollfd) { .fd = clients[i].sock, .events = POLLIN };
+      }
+      wait_for_more(window, pfds);
+    }
+
+    process();
+  }
+
+  // print statistics
+  fprintf(stderr, "sha3d: %zu requests, %zu batches (avg %.1f, max %zu requests per batch)\n", num_reqs_total, num_batches, num_batches ? (double) num_reqs_total / num_batches : 0.0, max_batch);
+
+  // clean up
+  while (num_clients > 0) {
+    remove_client(num_clients - 1);
+  }
+  close(listen_sock);
+  unlink(path);
+
+  return 0;
+}
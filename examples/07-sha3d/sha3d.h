@@ -0,0 +1,244 @@
+//
+// sha3d.h: sha3d protocol definitions and client functions.
+//
+// Each client shares a memory region with the daemon which contains a
+// submission ring, a completion ring, and one payload slot per ring
+// entry:
+//
+// 1. The client creates the region with memfd_create() and passes the
+//    file descriptor to the daemon over the Unix socket (SCM_RIGHTS).
+// 2. To submit a request, the client writes the payload directly into
+//    the slot for the next submission entry (no copies), fills in the
+//    entry, advances the submission tail, and writes one byte to the
+//    socket as a doorbell.
+// 3. The daemon collects pending entries from every client, hashes
+//    them in batches with the multi-buffer batch functions, writes
+//    digests to the completion ring (in submission order), advances the
+//    completion tail, and writes one byte to the client socket.
+//
+// Ring indices are free-running 32-bit counters; entry `i` lives at
+// offset `i % SHA3D_RING_LEN`.  Producers publish indices with release
+// stores and consumers read them with acquire loads.
+//
+#ifndef SHA3D_H
+#define SHA3D_H
+
+#include <stdbool.h> // bool
+#include <stdint.h> // uint8_t, uint32_t, uint64_t
+#include <string.h> // memset(), strlen()
+#include <unistd.h> // read(), write(), close(), ftruncate()
+#include <errno.h> // errno
+#include <sys/mman.h> // mmap(), memfd_create()
+#include <sys/socket.h> // socket(), sendmsg()
+#include <sys/un.h> // struct sockaddr_un
+#include "sha3.h" // sha3_algo_t
+
+// number of entries in submission and completion rings (power of 2)
+#define SHA3D_RING_LEN 64
+
+// maximum payload length, in bytes
+#define SHA3D_SLOT_LEN 4096
+
+// maximum digest length, in bytes
+#define SHA3D_MAX_DIGEST_LEN 64
+
+// magic number sent with shared memory file descriptor
+#define SHA3D_MAGIC 0x64336873 // "sh3d"
+
+// submission entry
+typedef struct {
+  uint64_t id; // request ID (copied to completion entry)
+  uint32_t algo; // algorithm (sha3_algo_t)
+  uint32_t len; // payload length, in bytes
+  uint32_t dst_len; // digest length for XOFs, in bytes (ignored for SHA3)
+} sha3d_sqe_t;
+
+// completion entry
+typedef struct {
+  uint64_t id; // request ID
+  int32_t status; // 0 on success, or negative errno value
+  uint32_t len; // digest length, in bytes
+  uint8_t digest[SHA3D_MAX_DIGEST_LEN]; // digest
+} sha3d_cqe_t;
+
+// shared memory region
+typedef struct {
+  uint32_t sq_head; // submission ring head (written by daemon)
+  uint32_t sq_tail; // submission ring tail (written by client)
+  uint32_t cq_head; // completion ring head (written by client)
+  uint32_t cq_tail; // completion ring tail (written by daemon)
+  sha3d_sqe_t sqes[SHA3D_RING_LEN]; // submission entries
+  sha3d_cqe_t cqes[SHA3D_RING_LEN]; // completion entries
+  uint8_t slots[SHA3D_RING_LEN][SHA3D_SLOT_LEN]; // payloads
+} sha3d_shm_t;
+
+// client context
+typedef struct {
+  int sock; // socket
+  sha3d_shm_t *shm; // shared memory region
+} sha3d_client_t;
+
+// Connect to daemon listening on Unix socket `path`, create shared
+// memory region, and pass it to the daemon.
+//
+// Returns false on error (with errno set).
+static inline bool sha3d_client_init(sha3d_client_t * const client, const char * const path) {
+  // create shared memory region
+  const int fd = memfd_create("sha3d", MFD_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  if (ftruncate(fd, sizeof(sha3d_shm_t))) {
+    close(fd);
+    return false;
+  }
+
+  // map shared memory region
+  client->shm = mmap(NULL, sizeof(sha3d_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (client->shm == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+
+  // connect to daemon
+  struct sockaddr_un addr = { .sun_family = AF_UNIX };
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  client->sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (client->sock < 0 || connect(client->sock, (struct sockaddr*) &addr, sizeof(addr))) {
+    if (client->sock >= 0) {
+      close(client->sock);
+    }
+    munmap(client->shm, sizeof(sha3d_shm_t));
+    close(fd);
+    return false;
+  }
+
+  // send magic number and shared memory file descriptor
+  uint32_t magic = SHA3D_MAGIC;
+  struct iovec iov = { .iov_base = &magic, .iov_len = sizeof(magic) };
+  union {
+    struct cmsghdr hdr;
+    uint8_t buf[CMSG_SPACE(sizeof(int))];
+  } cmsg_buf;
+  memset(&cmsg_buf, 0, sizeof(cmsg_buf));
+  struct msghdr msg = {
+    .msg_iov = &iov,
+    .msg_iovlen = 1,
+    .msg_control = cmsg_buf.buf,
+    .msg_controllen = sizeof(cmsg_buf.buf),
+  };
+  struct cmsghdr * const cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+  const bool ok = sendmsg(client->sock, &msg, 0) == sizeof(magic);
+
+  // daemon has its own reference to the region now
+  const int saved_errno = errno;
+  close(fd);
+  if (!ok) {
+    close(client->sock);
+    munmap(client->shm, sizeof(sha3d_shm_t));
+  }
+  errno = saved_errno;
+
+  return ok;
+}
+
+// Disconnect from daemon and unmap shared memory region.
+static inline void sha3d_client_fini(sha3d_client_t * const client) {
+  close(client->sock);
+  munmap(client->shm, sizeof(sha3d_shm_t));
+}
+
+// Get payload slot for next submission, or NULL if the submission ring
+// is full (wait for completions with `sha3d_client_reap()`).
+//
+// Write the payload directly to the returned slot, then call
+// `sha3d_client_submit()`.
+static inline uint8_t *sha3d_client_slot(sha3d_client_t * const client) {
+  sha3d_shm_t * const shm = client->shm;
+  const uint32_t tail = shm->sq_tail;
+
+  // completions are returned in submission order, so the slot for
+  // submission `tail` is free once completion `tail - SHA3D_RING_LEN`
+  // has been reaped
+  if (tail - shm->cq_head >= SHA3D_RING_LEN) {
+    return NULL;
+  }
+
+  return shm->slots[tail % SHA3D_RING_LEN];
+}
+
+// Submit request with ID `id` for payload of `len` bytes previously
+// written to the slot returned by `sha3d_client_slot()`.  `dst_len` is
+// the digest length for XOFs (ignored for SHA3).
+//
+// Does not notify the daemon; call `sha3d_client_kick()` after
+// submitting one or more requests.
+static inline void sha3d_client_submit(sha3d_client_t * const client, const uint64_t id, const sha3_algo_t algo, const size_t len, const size_t dst_len) {
+  sha3d_shm_t * const shm = client->shm;
+  const uint32_t tail = shm->sq_tail;
+
+  // populate entry
+  sha3d_sqe_t * const sqe = shm->sqes + (tail % SHA3D_RING_LEN);
+  sqe->id = id;
+  sqe->algo = algo;
+  sqe->len = len;
+  sqe->dst_len = dst_len;
+
+  // publish entry
+  __atomic_store_n(&(shm->sq_tail), tail + 1, __ATOMIC_RELEASE);
+}
+
+// Notify daemon of new submissions.
+//
+// Returns false on error (with errno set).
+static inline bool sha3d_client_kick(sha3d_client_t * const client) {
+  const uint8_t byte = 0;
+  while (write(client->sock, &byte, 1) != 1) {
+    if (errno != EINTR) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Pop next completion entry into `cqe`.  If there are no completions
+// and `wait` is true, then block until the daemon posts one.
+//
+// Returns false if there are no completions (and `wait` is false), or
+// on error (with errno set).
+static inline bool sha3d_client_reap(sha3d_client_t * const client, sha3d_cqe_t * const cqe, const bool wait) {
+  sha3d_shm_t * const shm = client->shm;
+
+  while (true) {
+    const uint32_t head = shm->cq_head;
+    if (head != __atomic_load_n(&(shm->cq_tail), __ATOMIC_ACQUIRE)) {
+      // copy entry, release it
+      *cqe = shm->cqes[head % SHA3D_RING_LEN];
+      __atomic_store_n(&(shm->cq_head), head + 1, __ATOMIC_RELEASE);
+      return true;
+    }
+
+    if (!wait) {
+      errno = EAGAIN;
+      return false;
+    }
+
+    // wait for notification from daemon
+    uint8_t buf[64];
+    const ssize_t len = read(client->sock, buf, sizeof(buf));
+    if (len == 0) {
+      errno = ECONNRESET; // daemon went away
+      return false;
+    } else if (len < 0 && errno != EINTR) {
+      return false;
+    }
+  }
+}
+
+#endif /* SHA3D_H */
@@ -1,9 +1,12 @@
 // main.c: sha3 test application
+#define _DEFAULT_SOURCE // pread(), syscall() (used by read-file.h)
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h> // errno
 #include "hex.h" // hex_write()
+#include "read-file.h" // read_file()
 #include "sha3.h"
 
 // shake128 handler
@@ -115,48 +118,174 @@ static void do_k12(const uint8_t * const msg, const size_t msg_len, const size_t
   fputs("\n", stdout);
 }
 
+// read file at `path` with read_file(), pass each chunk to `cb`.  prints
+// an error message and exits on error.
+static void read_file_or_die(const char * const path, const read_file_cb_t cb, void * const cb_data) {
+  if (!read_file(path, cb, cb_data)) {
+    fprintf(stderr, "Error: %s: %s\n", path, strerror(errno));
+    exit(-1);
+  }
+}
+
+// define file handler for fixed-length hash function
+#define DEF_FILE_HASH(NAME, SIZE) \
+  /* absorb chunk of file data */ \
+  static void file_absorb_ ## NAME (void *data, const uint8_t *buf, size_t len) { \
+    if (!NAME ## _absorb((sha3_t*) data, buf, len)) { \
+      fprintf(stderr, "Error: " #NAME "_absorb() failed\n"); \
+      exit(-1); \
+    } \
+  } \
+  \
+  /* hash file, print result */ \
+  static void do_file_ ## NAME (const char * const path, const size_t out_len) { \
+    (void) out_len; /* unused */ \
+    sha3_t hash; \
+    NAME ## _init(&hash); \
+    read_file_or_die(path, file_absorb_ ## NAME, &hash); \
+    \
+    uint8_t buf[SIZE]; \
+    NAME ## _final(&hash, buf); \
+    hex_write(stdout, buf, sizeof(buf)); \
+    fputs("\n", stdout); \
+  }
+
+// define file handler for XOF
+#define DEF_FILE_XOF(NAME, CTX_TYPE) \
+  /* absorb chunk of file data */ \
+  static void file_absorb_ ## NAME (void *data, const uint8_t *buf, size_t len) { \
+    if (!NAME ## _absorb((CTX_TYPE*) data, buf, len)) { \
+      fprintf(stderr, "Error: " #NAME "_absorb() failed\n"); \
+      exit(-1); \
+    } \
+  } \
+  \
+  /* hash file, print first `out_len` bytes of result */ \
+  static void do_file_ ## NAME (const char * const path, const size_t out_len) { \
+    CTX_TYPE ctx; \
+    NAME ## _init(&ctx); \
+    read_file_or_die(path, file_absorb_ ## NAME, &ctx); \
+    \
+    uint8_t buf[64]; \
+    for (size_t i = 0; i < out_len; i += sizeof(buf)) { \
+      /* squeeze and print */ \
+      const size_t len = (out_len - i < sizeof(buf)) ? out_len - i : sizeof(buf); \
+      NAME ## _squeeze(&ctx, buf, len); \
+      hex_write(stdout, buf, len); \
+    } \
+    \
+    fputs("\n", stdout); \
+  }
+
+DEF_FILE_HASH(sha3_224, 28)
+DEF_FILE_HASH(sha3_256, 32)
+DEF_FILE_HASH(sha3_384, 48)
+DEF_FILE_HASH(sha3_512, 64)
+DEF_FILE_XOF(shake128, sha3_xof_t)
+DEF_FILE_XOF(shake256, sha3_xof_t)
+DEF_FILE_XOF(turboshake128, turboshake_t)
+DEF_FILE_XOF(turboshake256, turboshake_t)
+
+// growable buffer (used to read file for k12, which does not have an
+// iterative absorb API)
+typedef struct {
+  uint8_t *ptr; // buffer
+  size_t len, cap; // length and capacity, in bytes
+} file_buf_t;
+
+// append chunk of file data to buffer
+static void file_buf_append(void *data, const uint8_t *buf, size_t len) {
+  file_buf_t * const fb = (file_buf_t*) data;
+  if (fb->len + len > fb->cap) {
+    // grow buffer
+    const size_t cap = (fb->len + len > 2 * fb->cap) ? fb->len + len : 2 * fb->cap;
+    uint8_t * const ptr = realloc(fb->ptr, cap);
+    if (!ptr) {
+      fprintf(stderr, "Error: realloc() failed\n");
+      exit(-1);
+    }
+
+    fb->ptr = ptr;
+    fb->cap = cap;
+  }
+
+  memcpy(fb->ptr + fb->len, buf, len);
+  fb->len += len;
+}
+
+// k12 file handler
+static void do_file_k12(const char * const path, const size_t out_len) {
+  // read entire file into memory
+  file_buf_t fb = { 0 };
+  read_file_or_die(path, file_buf_append, &fb);
+
+  // hash and print
+  do_k12(fb.ptr, fb.len, out_len);
+  free(fb.ptr);
+}
+
 // available hash functions
 static const struct {
   const char *name;
   const size_t size;
   void (*hash_func)(const uint8_t *, size_t, uint8_t *);
   void (*xof_func)(const uint8_t *, size_t, size_t);
+  void (*file_func)(const char *, size_t);
+  const sha3_algo_t multi_algo; // multi-digest algorithm ID
 } fns[] = {{
   .name = "sha3-224",
   .size = 28,
   .hash_func = sha3_224,
+  .file_func = do_file_sha3_224,
+  .multi_algo = SHA3_ALGO_SHA3_224,
 }, {
   .name = "sha3-256",
   .size = 32,
   .hash_func = sha3_256,
+  .file_func = do_file_sha3_256,
+  .multi_algo = SHA3_ALGO_SHA3_256,
 }, {
   .name = "sha3-384",
   .size = 48,
   .hash_func = sha3_384,
+  .file_func = do_file_sha3_384,
+  .multi_algo = SHA3_ALGO_SHA3_384,
 }, {
   .name = "sha3-512",
   .size = 64,
   .hash_func = sha3_512,
+  .file_func = do_file_sha3_512,
+  .multi_algo = SHA3_ALGO_SHA3_512,
 }, {
   .name = "shake128",
   .size = 16, // default size
   .xof_func = do_shake128,
+  .file_func = do_file_shake128,
+  .multi_algo = SHA3_ALGO_SHAKE128,
 }, {
   .name = "shake256",
   .size = 32, // default size
   .xof_func = do_shake256,
+  .file_func = do_file_shake256,
+  .multi_algo = SHA3_ALGO_SHAKE256,
 }, {
   .name = "turboshake128",
   .size = 32,
   .xof_func = do_turboshake128,
+  .file_func = do_file_turboshake128,
+  .multi_algo = SHA3_ALGO_TURBOSHAKE128,
 }, {
   .name = "turboshake256",
   .size = 64,
   .xof_func = do_turboshake256,
+  .file_func = do_file_turboshake256,
+  .multi_algo = SHA3_ALGO_TURBOSHAKE256,
 }, {
   .name = "k12",
   .size = 32,
   .xof_func = do_k12,
+  .file_func = do_file_k12,
+  .multi_algo = SHA3_ALGO_LAST, // not supported by -m
 }};
 
 // number of hash functions
@@ -175,8 +304,94 @@ static size_t get_fn_ofs(const char * const name) {
   return NUM_FNS;
 }
 
+// absorb chunk of file data into multi-digest context
+static void file_absorb_multi(void *data, const uint8_t *buf, size_t len) {
+  if (!sha3_multi_absorb((sha3_multi_t*) data, buf, len)) {
+    fprintf(stderr, "Error: sha3_multi_absorb() failed\n");
+    exit(-1);
+  }
+}
+
+// multi-digest handler: hash message (or file at `path` if `path` is
+// non-NULL) with each algorithm in comma-separated list `names` in a
+// single pass, then print one result per line.
+static void do_multi(const char * const names, const uint8_t * const msg, const size_t msg_len, const char * const path, const size_t xof_size) {
+  size_t ofs[SHA3_MULTI_MAX_ALGOS]; // function offsets
+  sha3_algo_t algos[SHA3_MULTI_MAX_ALGOS]; // algorithm IDs
+  size_t num_algos = 0;
+
+  // parse comma-separated list of algorithm names
+  for (const char *name = names; *name;) {
+    const size_t name_len = strcspn(name, ",");
+    char buf[32] = { 0 };
+    memcpy(buf, name, (name_len < sizeof(buf) - 1) ? name_len : sizeof(buf) - 1);
+
+    // get function offset
+    const size_t fn_ofs = get_fn_ofs(buf);
+    if (fn_ofs == NUM_FNS) {
+      fprintf(stderr, "Unknown algorithm: %s\n", buf);
+      exit(-1);
+    } else if (fns[fn_ofs].multi_algo == SHA3_ALGO_LAST) {
+      fprintf(stderr, "Algorithm not supported by -m: %s\n", buf);
+      exit(-1);
+    } else if (num_algos == SHA3_MULTI_MAX_ALGOS) {
+      fprintf(stderr, "Too many algorithms (maximum is %d)\n", SHA3_MULTI_MAX_ALGOS);
+      exit(-1);
+    }
+
+    // add algorithm
+    ofs[num_algos] = fn_ofs;
+    algos[num_algos++] = fns[fn_ofs].multi_algo;
+
+    // skip to next name
+    name += name_len + (name[name_len] == ',');
+  }
+
+  // init context
+  sha3_multi_t ctx;
+  if (!sha3_multi_init(&ctx, algos, num_algos)) {
+    fprintf(stderr, "Error: sha3_multi_init() failed\n");
+    exit(-1);
+  }
+
+  // absorb file contents or message
+  if (path) {
+    read_file_or_die(path, file_absorb_multi, &ctx);
+  } else {
+    file_absorb_multi(&ctx, msg, msg_len);
+  }
+
+  // print results
+  for (size_t i = 0; i < num_algos; i++) {
+    // get output size (use xof_size for XOFs if specified)
+    const size_t out_len = (xof_size && fns[ofs[i]].xof_func) ? xof_size : fns[ofs[i]].size;
+
+    // get output
+    uint8_t * const buf = malloc(out_len ? out_len : 1);
+    if (!buf) {
+      fprintf(stderr, "Error: malloc() failed\n");
+      exit(-1);
+    }
+    sha3_multi_final(&ctx, i, buf, out_len);
+
+    // print name and output
+    printf("%s: ", fns[ofs[i]].name);
+    hex_write(stdout, buf, out_len);
+    free(buf);
+    fputs("\n", stdout);
+  }
+}
+
 // usage format string
 #define USAGE "Usage: %s <algo> <data> [xof-size]\n" \
+              "       %s <algo> -f <path> [xof-size]\n" \
+              "       %s -m <algo,...> <data> [xof-size]\n" \
+              "       %s -m <algo,...> -f <path> [xof-size]\n" \
+              "\n" \
+              "Options:\n" \
+              "  -f <path>      Hash contents of file at <path> instead of <data>.\n" \
+              "  -m <algo,...>  Hash input with several algorithms in a single pass\n" \
+              "                 (all algorithms except k12).\n" \
               "\n" \
               "Algorithms:\n" \
               "- sha3-224\n" \
@@ -198,19 +413,48 @@ static size_t get_fn_ofs(const char * const name) {
               "\n" \
               "  # get first 40 bytes of SHAKE128-XOF output of string \"foo\"\n" \
               "  %s shake128-xof foo 40\n" \
-              "  f84e95cb5fbd2038863ab27d3cdeac295ad2d4ab96ad1f4b070c0bf36078ef0881db3194a9d0f3dd\n"
+              "  f84e95cb5fbd2038863ab27d3cdeac295ad2d4ab96ad1f4b070c0bf36078ef0881db3194a9d0f3dd\n" \
+              "\n" \
+              "  # get SHA3-256 hash of file \"foo.iso\"\n" \
+              "  %s sha3-256 -f foo.iso\n" \
+              "\n" \
+              "  # get SHA3-256, SHA3-512, and SHAKE256 hashes of file \"foo.iso\",\n" \
+              "  # reading the file once\n" \
+              "  %s -m sha3-256,sha3-512,shake256 -f foo.iso\n"
 
 int main(int argc, char *argv[]) {
   // check command-line arguments
   if (argc < 3) {
     const char *app = (argc > 0) ? argv[0] : "sha3";
-    fprintf(stderr, USAGE, app, app, app);
+    fprintf(stderr, USAGE, app, app, app, app, app, app, app, app);
     return -1;
   }
 
-  // get message and message length
-  const uint8_t * const msg = (uint8_t*) argv[2];
-  const size_t len = strlen(argv[2]);
+  if (!strcmp(argv[1], "-m")) {
+    // multi-digest mode: check arguments
+    if (argc < 4) {
+      fprintf(stderr, "Missing input for -m\n");
+      return -1;
+    }
+
+    if (!strcmp(argv[3], "-f")) {
+      // check for path
+      if (argc < 5) {
+        fprintf(stderr, "Missing path for -f\n");
+        return -1;
+      }
+
+      // hash file contents, print results
+      const size_t xof_size = (argc == 6) ? (size_t) atoi(argv[5]) : 0;
+      do_multi(argv[2], NULL, 0, argv[4], xof_size);
+    } else {
+      // hash message, print results
+      const size_t xof_size = (argc == 5) ? (size_t) atoi(argv[4]) : 0;
+      do_multi(argv[2], (uint8_t*) argv[3], strlen(argv[3]), NULL, xof_size);
+    }
+
+    return 0;
+  }
 
   // get function offset
   const size_t ofs = get_fn_ofs(argv[1]);
@@ -219,6 +463,25 @@ int main(int argc, char *argv[]) {
     return -1;
   }
 
+  if (!strcmp(argv[2], "-f")) {
+    // check for path
+    if (argc < 4) {
+      fprintf(stderr, "Missing path for -f\n");
+      return -1;
+    }
+
+    // get output size from argument, or use default output size
+    const size_t out_size = (argc == 5 && fns[ofs].xof_func) ? (size_t) atoi(argv[4]) : fns[ofs].size;
+
+    // hash file contents, print result
+    fns[ofs].file_func(argv[3], out_size);
+    return 0;
+  }
+
+  // get message and message length
+  const uint8_t * const msg = (uint8_t*) argv[2];
+  const size_t len = strlen(argv[2]);
+
   if (fns[ofs].xof_func) {
     // get output size from argument, or use default output size
     const size_t out_size = (argc == 4) ? (size_t) atoi(argv[3]) : fns[ofs].size;
@@ -0,0 +1,504 @@
+#ifndef READ_FILE_H
+#define READ_FILE_H
+
+// read-file.h: read the contents of a file in large chunks and pass
+// each chunk to a callback (used by top-level main.c).
+//
+// By default files are read sequentially with `pread()`.
+//
+// If `USE_IO_URING` is defined (`make IO_URING=1`), then regular files
+// are read with Linux io_uring instead: `READ_FILE_NUM_BUFS` reads are
+// kept in flight so the kernel can fill the next buffers while the
+// callback is processing the current buffer.  This hides the read
+// latency behind `absorb()` and lets a single thread hash at disk
+// bandwidth instead of alternating between waiting for a read and
+// hashing it.  If io_uring or the `IORING_OP_READ` opcode is not
+// available at run-time (old kernel, seccomp filter, etc), then
+// `read_file()` silently falls back to `pread()`.
+//
+// Notes:
+// - The io_uring path uses the raw system calls and the kernel
+//   `<linux/io_uring.h>` header, so it does not depend on liburing.
+// - Files which are not seekable (pipes, character devices, etc) are
+//   read with `read()`.
+// - Files are always read until end of file, not until the size
+//   reported by `fstat()`.  The io_uring path only keeps reads in flight
+//   up to the reported size, then finishes with `pread()`, so files
+//   which grow while being read and files which report a size of zero
+//   (procfs, sysfs) give the same result as the `pread()` path.
+// - Requires `pread()` and `syscall()`, so define `_DEFAULT_SOURCE`
+//   before including any system headers when compiling with
+//   `-std=c11`.
+
+#include <stdbool.h> // bool
+#include <stdint.h> // uint8_t
+#include <stdlib.h> // malloc(), free()
+#include <errno.h> // errno
+#include <fcntl.h> // open(), posix_fadvise()
+#include <unistd.h> // pread(), read(), close()
+#include <sys/stat.h> // fstat()
+
+#ifdef USE_IO_URING
+#include <string.h> // memset()
+#include <sys/mman.h> // mmap(), munmap()
+#include <sys/syscall.h> // SYS_io_uring_*
+#include <linux/io_uring.h> // struct io_uring_*
+#endif /* USE_IO_URING */
+
+// size of each read buffer, in bytes
+#ifndef READ_FILE_BUF_LEN
+#define READ_FILE_BUF_LEN (1 << 20)
+#endif /* READ_FILE_BUF_LEN */
+
+// number of read buffers (and maximum number of reads in flight) used
+// by the io_uring reader
+#ifndef READ_FILE_NUM_BUFS
+#define READ_FILE_NUM_BUFS 4
+#endif /* READ_FILE_NUM_BUFS */
+
+// callback which is passed each chunk of file data, in order.
+typedef void (*read_file_cb_t)(void *cb_data, const uint8_t *buf, size_t len);
+
+// Read `len` bytes at offset `ofs` of `fd` into `buf`, retrying on
+// short reads and interrupts.  Uses `read()` if `seekable` is false.
+//
+// Returns the number of bytes read (less than `len` at end of file), or
+// -1 on error.
+static ssize_t read_file_pread_full(const int fd, const bool seekable, uint8_t * const buf, const size_t len, off_t ofs) {
+  size_t num_bytes = 0;
+  while (num_bytes < len) {
+    const ssize_t n = seekable ? pread(fd, buf + num_bytes, len - num_bytes, ofs) : read(fd, buf + num_bytes, len - num_bytes);
+    if (n < 0 && errno == EINTR) {
+      continue; // interrupted, retry
+    } else if (n < 0) {
+      return -1; // error
+    } else if (n == 0) {
+      break; // end of file
+    }
+
+    num_bytes += n;
+    ofs += n;
+  }
+
+  return num_bytes;
+}
+
+// Read contents of `fd` from offset `ofs` until end of file into
+// `READ_FILE_BUF_LEN` byte buffer `buf`, and pass each chunk to `cb`.
+//
+// Returns true on success and false on error (with errno set).
+static bool read_file_pread_from(const int fd, const bool seekable, uint8_t * const buf, off_t ofs, const read_file_cb_t cb, void * const cb_data) {
+  for (;;) {
+    const ssize_t len = read_file_pread_full(fd, seekable, buf, READ_FILE_BUF_LEN, ofs);
+    if (len < 0) {
+      return false;
+    } else if (len == 0) {
+      return true; // end of file
+    }
+
+    cb(cb_data, buf, len);
+    ofs += len;
+  }
+}
+
+// Read contents of `fd` sequentially with `pread()` (or `read()` for
+// files which are not seekable), and pass each chunk to `cb`.
+//
+// Returns true on success and false on error (with errno set).
+static bool read_file_pread(const int fd, const read_file_cb_t cb, void * const cb_data) {
+  uint8_t * const buf = malloc(READ_FILE_BUF_LEN);
+  if (!buf) {
+    return false;
+  }
+
+  // pipes and character devices do not support pread()
+  const bool seekable = lseek(fd, 0, SEEK_CUR) != -1;
+
+  const bool ok = read_file_pread_from(fd, seekable, buf, 0, cb, cb_data);
+
+  // free buffer (preserving errno)
+  const int saved_errno = errno;
+  free(buf);
+  errno = saved_errno;
+
+  return ok;
+}
+
+#ifdef USE_IO_URING
+// io_uring submission and completion rings
+typedef struct {
+  int fd; // ring file descriptor
+
+  // mapped regions
+  void *sq_ptr, *cq_ptr;
+  size_t sq_len, cq_len;
+  struct io_uring_sqe *sqes;
+  size_t sqes_len;
+
+  // submission ring fields
+  unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+
+  // completion ring fields
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  struct io_uring_cqe *cqes;
+} read_file_ring_t;
+
+// Check whether the kernel supports `IORING_OP_READ` (Linux 5.6).
+// Older kernels create the ring, but complete every read with
+// `-EINVAL`.  `IORING_REGISTER_PROBE` was added in the same release,
+// so it failing also means the opcode is not supported.
+static bool read_file_ring_probe(const int ring_fd) {
+  const size_t num_ops = IORING_OP_READ + 1;
+  struct io_uring_probe * const probe = calloc(1, sizeof(struct io_uring_probe) + num_ops * sizeof(struct io_uring_probe_op));
+  if (!probe) {
+    return false;
+  }
+
+  const bool ok = !syscall(SYS_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, num_ops) &&
+                  probe->last_op >= IORING_OP_READ &&
+                  (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+
+  free(probe);
+  return ok;
+}
+
+// Create io_uring with room for `num_entries` submissions.
+//
+// Returns false if io_uring or `IORING_OP_READ` is not available.
+static bool read_file_ring_init(read_file_ring_t * const ring, const unsigned num_entries) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  memset(ring, 0, sizeof(read_file_ring_t));
+
+  // create ring
+  ring->fd = syscall(SYS_io_uring_setup, num_entries, &params);
+  if (ring->fd < 0) {
+    return false;
+  }
+
+  // check for read opcode
+  if (!read_file_ring_probe(ring->fd)) {
+    close(ring->fd);
+    return false;
+  }
+
+  // get ring sizes.  if the kernel supports IORING_FEAT_SINGLE_MMAP,
+  // then the submission and completion rings share a single mapping.
+  ring->sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    ring->sq_len = ring->cq_len = (ring->sq_len > ring->cq_len) ? ring->sq_len : ring->cq_len;
+  }
+
+  // map submission ring
+  ring->sq_ptr = mmap(NULL, ring->sq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+  if (ring->sq_ptr == MAP_FAILED) {
+    close(ring->fd);
+    return false;
+  }
+
+  // map completion ring
+  ring->cq_ptr = single_mmap ? ring->sq_ptr : mmap(NULL, ring->cq_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+  if (ring->cq_ptr == MAP_FAILED) {
+    munmap(ring->sq_ptr, ring->sq_len);
+    close(ring->fd);
+    return false;
+  }
+
+  // map submission queue entries
+  ring->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+  ring->sqes = mmap(NULL, ring->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+  if (ring->sqes == MAP_FAILED) {
+    if (!single_mmap) {
+      munmap(ring->cq_ptr, ring->cq_len);
+    }
+    munmap(ring->sq_ptr, ring->sq_len);
+    close(ring->fd);
+    return false;
+  }
+
+  // get submission ring fields
+  uint8_t * const sq = ring->sq_ptr;
+  ring->sq_head = (unsigned*) (sq + params.sq_off.head);
+  ring->sq_tail = (unsigned*) (sq + params.sq_off.tail);
+  ring->sq_mask = (unsigned*) (sq + params.sq_off.ring_mask);
+  ring->sq_array = (unsigned*) (sq + params.sq_off.array);
+
+  // get completion ring fields
+  uint8_t * const cq = ring->cq_ptr;
+  ring->cq_head = (unsigned*) (cq + params.cq_off.head);
+  ring->cq_tail = (unsigned*) (cq + params.cq_off.tail);
+  ring->cq_mask = (unsigned*) (cq + params.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe*) (cq + params.cq_off.cqes);
+
+  // return success
+  return true;
+}
+
+// Unmap and close io_uring.
+static void read_file_ring_fini(read_file_ring_t * const ring) {
+  munmap(ring->sqes, ring->sqes_len);
+  if (ring->cq_ptr != ring->sq_ptr) {
+    munmap(ring->cq_ptr, ring->cq_len);
+  }
+  munmap(ring->sq_ptr, ring->sq_len);
+  close(ring->fd);
+}
+
+// Queue read of `len` bytes at offset `ofs` of `fd` into `buf`, tagged
+// with `id`.  Does not submit the read to the kernel; see
+// `read_file_ring_enter()`.
+static void read_file_ring_queue(read_file_ring_t * const ring, const int fd, uint8_t * const buf, const size_t len, const off_t ofs, const uint64_t id) {
+  // get submission entry at tail of ring
+  const unsigned tail = *ring->sq_tail;
+  const unsigned idx = tail & *ring->sq_mask;
+  struct io_uring_sqe * const sqe = ring->sqes + idx;
+
+  // populate read request
+  memset(sqe, 0, sizeof(struct io_uring_sqe));
+  sqe->opcode = IORING_OP_READ;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t) (uintptr_t) buf;
+  sqe->len = len;
+  sqe->off = ofs;
+  sqe->user_data = id;
+
+  // publish entry (store-release so kernel sees populated entry)
+  ring->sq_array[idx] = idx;
+  __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+// Submit `num_sqes` queued reads and wait for at least `min_complete`
+// completions.
+//
+// Returns false on error.
+static bool read_file_ring_enter(read_file_ring_t * const ring, const unsigned num_sqes, const unsigned min_complete) {
+  const unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+  while (syscall(SYS_io_uring_enter, ring->fd, num_sqes, min_complete, flags, NULL, 0) < 0) {
+    if (errno != EINTR) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Pop completion entry from ring.  Returns false if the completion ring
+// is empty.
+static bool read_file_ring_pop(read_file_ring_t * const ring, uint64_t * const id, int32_t * const res) {
+  const unsigned head = *ring->cq_head;
+  if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) {
+    return false; // ring is empty
+  }
+
+  // read completion entry
+  const struct io_uring_cqe * const cqe = ring->cqes + (head & *ring->cq_mask);
+  *id = cqe->user_data;
+  *res = cqe->res;
+
+  // release entry
+  __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+
+  return true;
+}
+
+// Read contents of regular file `fd` with io_uring, keeping up to
+// `READ_FILE_NUM_BUFS` reads in flight, and pass each chunk to `cb` in
+// file order.
+//
+// Reads are only queued up to `size` (the size reported by `fstat()`).
+// The rest of the file, starting at the end of the last complete chunk
+// or at the first short chunk, is read with `pread()` until end of
+// file.
+//
+// Returns 1 on success, 0 on error (with errno set), and -1 if io_uring
+// is not available.
+static int read_file_uring(const int fd, const off_t size, const read_file_cb_t cb, void * const cb_data) {
+  // read buffers; buffer `i % READ_FILE_NUM_BUFS` holds chunk `i`
+  struct {
+    uint8_t *buf; // buffer
+    size_t len; // requested length, in bytes
+    off_t ofs; // file offset
+    int32_t res; // completion result (valid when done is true)
+    bool done; // is read complete?
+  } bufs[READ_FILE_NUM_BUFS] = { 0 };
+
+  read_file_ring_t ring;
+  if (!read_file_ring_init(&ring, READ_FILE_NUM_BUFS)) {
+    return -1;
+  }
+
+  // allocate buffers
+  uint8_t * const mem = malloc((size_t) READ_FILE_NUM_BUFS * READ_FILE_BUF_LEN);
+  if (!mem) {
+    read_file_ring_fini(&ring);
+    return 0;
+  }
+
+  // queue initial reads
+  off_t next_ofs = 0;
+  unsigned num_queued = 0;
+  for (size_t i = 0; i < READ_FILE_NUM_BUFS && next_ofs < size; i++) {
+    bufs[i].buf = mem + i * READ_FILE_BUF_LEN;
+    bufs[i].len = (size - next_ofs < READ_FILE_BUF_LEN) ? (size_t) (size - next_ofs) : READ_FILE_BUF_LEN;
+    bufs[i].ofs = next_ofs;
+    read_file_ring_queue(&ring, fd, bufs[i].buf, bufs[i].len, bufs[i].ofs, i);
+    next_ofs += bufs[i].len;
+    num_queued++;
+  }
+
+  int ret = 1;
+  off_t tail_ofs = 0; // offset of first byte not passed to callback
+  unsigned num_unread = num_queued; // number of chunks not yet consumed
+  unsigned num_pending = num_queued; // number of reads without a completion
+  for (size_t i = 0; num_unread > 0; i = (i + 1) % READ_FILE_NUM_BUFS) {
+    // wait for current buffer, submitting any queued reads
+    while (!bufs[i].done) {
+      uint64_t id;
+      int32_t res;
+      if (read_file_ring_pop(&ring, &id, &res)) {
+        bufs[id].res = res;
+        bufs[id].done = true;
+        num_pending--;
+      } else if (!read_file_ring_enter(&ring, num_queued, 1)) {
+        ret = 0;
+        goto done;
+      } else {
+        num_queued = 0;
+      }
+    }
+
+    // check for read error
+    if (bufs[i].res < 0) {
+      errno = -bufs[i].res;
+      ret = 0;
+      goto done;
+    }
+
+    // finish short read (e.g. interrupted) synchronously
+    size_t len = bufs[i].res;
+    if (len > 0 && len < bufs[i].len) {
+      const ssize_t n = read_file_pread_full(fd, true, bufs[i].buf + len, bufs[i].len - len, bufs[i].ofs + len);
+      if (n < 0) {
+        ret = 0;
+        goto done;
+      }
+      len += n;
+    }
+
+    // mark buffer as consumed
+    bufs[i].done = false;
+    num_unread--;
+
+    // pass chunk to callback while the remaining reads are in flight
+    if (len > 0) {
+      cb(cb_data, bufs[i].buf, len);
+    }
+    tail_ofs = bufs[i].ofs + len;
+
+    if (len < bufs[i].len) {
+      // reached end of file before the reported size (file was
+      // truncated or size is wrong), finish with pread()
+      break;
+    }
+
+    // queue next read into this buffer
+    if (next_ofs < size) {
+      bufs[i].len = (size - next_ofs < READ_FILE_BUF_LEN) ? (size_t) (size - next_ofs) : READ_FILE_BUF_LEN;
+      bufs[i].ofs = next_ofs;
+      read_file_ring_queue(&ring, fd, bufs[i].buf, bufs[i].len, bufs[i].ofs, i);
+      next_ofs += bufs[i].len;
+      num_queued++;
+      num_unread++;
+      num_pending++;
+
+      // submit without waiting so the read starts immediately
+      if (!read_file_ring_enter(&ring, num_queued, 0)) {
+        ret = 0;
+        goto done;
+      }
+      num_queued = 0;
+    }
+  }
+
+done:
+  {
+    // drain outstanding reads before reusing or freeing buffers
+    // (preserving errno)
+    const int saved_errno = errno;
+    while (num_pending > 0 && read_file_ring_enter(&ring, num_queued, 1)) {
+      uint64_t id;
+      int32_t res;
+      num_queued = 0;
+      while (read_file_ring_pop(&ring, &id, &res)) {
+        num_pending--;
+      }
+    }
+
+    read_file_ring_fini(&ring);
+    errno = saved_errno;
+  }
+
+  // read remainder of file (data past the reported size) until end of
+  // file
+  if (ret == 1 && !read_file_pread_from(fd, true, mem, tail_ofs, cb, cb_data)) {
+    ret = 0;
+  }
+
+  // free buffers (preserving errno)
+  const int saved_errno = errno;
+  free(mem);
+  errno = saved_errno;
+
+  return ret;
+}
+#endif /* USE_IO_URING */
+
+// Read contents of file at `path` and pass each chunk of data to `cb`
+// in order, along with `cb_data`.
+//
+// Returns true on success and false on error (with errno set).
+static bool read_file(const char * const path, const read_file_cb_t cb, void * const cb_data) {
+  // open file
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  // get file type and size
+  struct stat st;
+  if (fstat(fd, &st)) {
+    const int saved_errno = errno;
+    close(fd);
+    errno = saved_errno;
+    return false;
+  }
+
+  // hint that file will be read sequentially (errors are ignored)
+  if (S_ISREG(st.st_mode)) {
+    (void) posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  }
+
+  int ret = -1;
+#ifdef USE_IO_URING
+  if (S_ISREG(st.st_mode)) {
+    // read with io_uring (returns -1 if io_uring is unavailable)
+    ret = read_file_uring(fd, st.st_size, cb, cb_data);
+  }
+#endif /* USE_IO_URING */
+
+  if (ret == -1) {
+    // read with pread()
+    ret = read_file_pread(fd, cb, cb_data);
+  }
+
+  // close file (preserving errno)
+  const int saved_errno = errno;
+  close(fd);
+  errno = saved_errno;
+
+  return ret == 1;
+}
+
+#endif /* READ_FILE_H */
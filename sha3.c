@@ -23,6 +23,7 @@
 #include <stdbool.h> // true, false
 #include <stdint.h> // uint64_t
 #include <string.h> // memcpy()
+#include <time.h> // timespec_get()
 #include "sha3.h"
 
 // available backends
@@ -30,9 +31,13 @@
 // each backend implements a permute_n_<backend>() function, which is
 // wrapped in a #if/#endif pair below.
 //
-// there are currently 5 backends, but only 2 of them -- scalar and
-// avx512 -- are auto-detected.  the remaining three are experimental
-// neon backends and are currently slower than the scalar backend.
+// there are currently 10 backends, but only 3 of them -- scalar,
+// avx512, and bit-interleaved 32-bit -- are auto-detected.  avx2, the
+// lane-complementing scalar backend, the two-state scalar backend, and
+// the neon-sha3 backend (ARMv8.2 SHA3 extension; opt-in until it has
+// been run and benchmarked on real aarch64 hardware) are selectable but
+// not auto-detected, and the remaining three are experimental neon
+// backends which are currently slower than the scalar backend.
 //
 // To add a new backend:
 //
@@ -69,6 +74,10 @@
 #define BACKEND_DIET_NEON 4   // Neon backend, fewer registers.  Slower than scalar.
 #define BACKEND_HYBRID 5      // Hybrid scalar/neon backend.  Slower than scalar.
 #define BACKEND_AVX2 6        // AVX2 backend
+#define BACKEND_LCOMP 7       // Lane-complementing scalar backend
+#define BACKEND_BI32 8        // Bit-interleaved 32-bit backend
+#define BACKEND_SCALAR_X2 9   // Scalar backend, two-state batch kernel
+#define BACKEND_NEON_SHA3 10  // Neon backend with ARMv8.2 SHA3 extension
 
 // if BACKEND is defined and set to 0 (the default), then unset it
 // and auto-detect the appropriate backend below
@@ -82,8 +91,13 @@
 #define BACKEND BACKEND_AVX512
 #elif 0 && defined(__AVX2__)
 #define BACKEND BACKEND_AVX2
+#elif 0 && defined(__ARM_FEATURE_SHA3)
+#define BACKEND BACKEND_NEON_SHA3
 #elif 0 && defined(__ARM_NEON)
 #define BACKEND BACKEND_NEON
+#elif UINTPTR_MAX == 0xffffffff
+// 32-bit target: 64-bit rotates are expensive, use bit interleaving
+#define BACKEND BACKEND_BI32
 #else
 // no optimized backend detected, fall back to scalar
 #define BACKEND BACKEND_SCALAR
@@ -102,7 +116,8 @@
 // align memory to N bytes
 #define ALIGN(N) __attribute__((aligned(N)))
 
-// Iota round constants.
+// Iota round constants.  The bit-interleaved 32-bit backend has its own
+// table (`BI32_RCS`), but this table is still used by `keccak_p1600()`.
 static const uint64_t RCS[] = {
   0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
   0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
@@ -112,11 +127,118 @@ static const uint64_t RCS[] = {
   0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL,
 };
 
-#if (BACKEND == BACKEND_SCALAR) || defined(TEST_SHA3)
+/**
+ * @brief Fused scalar Keccak round.
+ *
+ * Apply one round of Keccak permutation (theta, rho, pi, chi, and iota)
+ * to the 25 local lane variables with prefix `s` (e.g. `s00`, `s01`,
+ * ..., `s24`) and write the result to the 25 local lane variables with
+ * prefix `d`.
+ *
+ * Rho and pi are folded into the lane selection, so no temporary state
+ * array is needed.  Calling this twice with the prefixes swapped
+ * renames the lanes back to their original variables instead of
+ * copying them.
+ *
+ * @param[in] s Prefix of source lane variables.
+ * @param[out] d Prefix of destination lane variables.
+ * @param[in] rc Iota round constant.
+ *
+ * @note Used by the scalar backends and by the hybrid multi-buffer
+ * kernel (see `MB_HYBRID`).
+ */
+#define SCALAR_ROUND(s, d, rc) do { \
+  /* theta */ \
+  const uint64_t c0 = s ## 00 ^ s ## 05 ^ s ## 10 ^ s ## 15 ^ s ## 20, \
+                 c1 = s ## 01 ^ s ## 06 ^ s ## 11 ^ s ## 16 ^ s ## 21, \
+                 c2 = s ## 02 ^ s ## 07 ^ s ## 12 ^ s ## 17 ^ s ## 22, \
+                 c3 = s ## 03 ^ s ## 08 ^ s ## 13 ^ s ## 18 ^ s ## 23, \
+                 c4 = s ## 04 ^ s ## 09 ^ s ## 14 ^ s ## 19 ^ s ## 24; \
+  const uint64_t t0 = c4 ^ ROL(c1, 1), \
+                 t1 = c0 ^ ROL(c2, 1), \
+                 t2 = c1 ^ ROL(c3, 1), \
+                 t3 = c2 ^ ROL(c4, 1), \
+                 t4 = c3 ^ ROL(c0, 1); \
+  \
+  /* rho, pi, chi, and iota: row 0 */ \
+  { \
+    const uint64_t b0 = s ## 00 ^ t0, \
+                   b1 = ROL(s ## 06 ^ t1, 44), \
+                   b2 = ROL(s ## 12 ^ t2, 43), \
+                   b3 = ROL(s ## 18 ^ t3, 21), \
+                   b4 = ROL(s ## 24 ^ t4, 14); \
+    d ## 00 = b0 ^ (~b1 & b2) ^ (rc); \
+    d ## 01 = b1 ^ (~b2 & b3); \
+    d ## 02 = b2 ^ (~b3 & b4); \
+    d ## 03 = b3 ^ (~b4 & b0); \
+    d ## 04 = b4 ^ (~b0 & b1); \
+  } \
+  \
+  /* rho, pi, and chi: row 1 */ \
+  { \
+    const uint64_t b0 = ROL(s ## 03 ^ t3, 28), \
+                   b1 = ROL(s ## 09 ^ t4, 20), \
+                   b2 = ROL(s ## 10 ^ t0,  3), \
+                   b3 = ROL(s ## 16 ^ t1, 45), \
+                   b4 = ROL(s ## 22 ^ t2, 61); \
+    d ## 05 = b0 ^ (~b1 & b2); \
+    d ## 06 = b1 ^ (~b2 & b3); \
+    d ## 07 = b2 ^ (~b3 & b4); \
+    d ## 08 = b3 ^ (~b4 & b0); \
+    d ## 09 = b4 ^ (~b0 & b1); \
+  } \
+  \
+  /* rho, pi, and chi: row 2 */ \
+  { \
+    const uint64_t b0 = ROL(s ## 01 ^ t1,  1), \
+                   b1 = ROL(s ## 07 ^ t2,  6), \
+                   b2 = ROL(s ## 13 ^ t3, 25), \
+                   b3 = ROL(s ## 19 ^ t4,  8), \
+                   b4 = ROL(s ## 20 ^ t0, 18); \
+    d ## 10 = b0 ^ (~b1 & b2); \
+    d ## 11 = b1 ^ (~b2 & b3); \
+    d ## 12 = b2 ^ (~b3 & b4); \
+    d ## 13 = b3 ^ (~b4 & b0); \
+    d ## 14 = b4 ^ (~b0 & b1); \
+  } \
+  \
+  /* rho, pi, and chi: row 3 */ \
+  { \
+    const uint64_t b0 = ROL(s ## 04 ^ t4, 27), \
+                   b1 = ROL(s ## 05 ^ t0, 36), \
+                   b2 = ROL(s ## 11 ^ t1, 10), \
+                   b3 = ROL(s ## 17 ^ t2, 15), \
+                   b4 = ROL(s ## 23 ^ t3, 56); \
+    d ## 15 = b0 ^ (~b1 & b2); \
+    d ## 16 = b1 ^ (~b2 & b3); \
+    d ## 17 = b2 ^ (~b3 & b4); \
+    d ## 18 = b3 ^ (~b4 & b0); \
+    d ## 19 = b4 ^ (~b0 & b1); \
+  } \
+  \
+  /* rho, pi, and chi: row 4 */ \
+  { \
+    const uint64_t b0 = ROL(s ## 02 ^ t2, 62), \
+                   b1 = ROL(s ## 08 ^ t3, 55), \
+                   b2 = ROL(s ## 14 ^ t4, 39), \
+                   b3 = ROL(s ## 15 ^ t0, 41), \
+                   b4 = ROL(s ## 21 ^ t1,  2); \
+    d ## 20 = b0 ^ (~b1 & b2); \
+    d ## 21 = b1 ^ (~b2 & b3); \
+    d ## 22 = b2 ^ (~b3 & b4); \
+    d ## 23 = b3 ^ (~b4 & b0); \
+    d ## 24 = b4 ^ (~b0 & b1); \
+  } \
+} while (0)
+
+#if (BACKEND == BACKEND_SCALAR) || (BACKEND == BACKEND_SCALAR_X2) || (BACKEND == BACKEND_LCOMP) || (BACKEND == BACKEND_BI32) || defined(TEST_SHA3)
 // The scalar Keccak step functions in this block are only built if one
 // of the following conditions is true:
 //
-// * we are using the scalar backend, or
+// * we are using one of the scalar backends (scalar, two-state scalar,
+//   or lane-complementing scalar), or
+// * we are using the bit-interleaved 32-bit backend, which uses the
+//   scalar permutation for 12 rounds (see `permute_12()`), or
 // * we are building the test suite.
 //
 // The scalar Keccak step functions in this block are not built for
@@ -285,27 +407,626 @@ static inline void iota(uint64_t a[static 25], const int i) {
  *
  * Apply `num_rounds` of Keccak permutation.
  *
+ * The state is loaded into 25 local variables and the rounds are
+ * unrolled two at a time with SCALAR_ROUND(), alternating between the
+ * `a` and `e` variables so the compiler can keep the state in registers
+ * without copying it between rounds.
+ *
  * @param[in,out] a Keccak state (array of 25 64-bit integers).
- * @param[in] num_rounds Number of rounds (12 or 24).
+ * @param[in] num_rounds Number of rounds (12 or 24).  Must be even.
  *
  * @note Only built when using the scalar backend or when building the
  * test suite.
  */
 static inline void permute_n_scalar(uint64_t a[static 25], const size_t num_rounds) {
+  uint64_t a00 = a[ 0], a01 = a[ 1], a02 = a[ 2], a03 = a[ 3], a04 = a[ 4],
+           a05 = a[ 5], a06 = a[ 6], a07 = a[ 7], a08 = a[ 8], a09 = a[ 9],
+           a10 = a[10], a11 = a[11], a12 = a[12], a13 = a[13], a14 = a[14],
+           a15 = a[15], a16 = a[16], a17 = a[17], a18 = a[18], a19 = a[19],
+           a20 = a[20], a21 = a[21], a22 = a[22], a23 = a[23], a24 = a[24];
+  uint64_t e00, e01, e02, e03, e04, e05, e06, e07, e08, e09, e10, e11, e12,
+           e13, e14, e15, e16, e17, e18, e19, e20, e21, e22, e23, e24;
+
+  // two rounds per iteration (a to e, then e back to a), so num_rounds
+  // must be even: an odd count would read past the end of RCS and
+  // leave the state in the e variables.  keccak_p1600() applies the
+  // first round of odd round counts separately.
+  for (size_t i = (SHA3_NUM_ROUNDS - num_rounds); __builtin_expect(i < SHA3_NUM_ROUNDS, 1); i += 2) {
+    SCALAR_ROUND(a, e, RCS[i]);
+    SCALAR_ROUND(e, a, RCS[i + 1]);
+  }
+
+  a[ 0] = a00; a[ 1] = a01; a[ 2] = a02; a[ 3] = a03; a[ 4] = a04;
+  a[ 5] = a05; a[ 6] = a06; a[ 7] = a07; a[ 8] = a08; a[ 9] = a09;
+  a[10] = a10; a[11] = a11; a[12] = a12; a[13] = a13; a[14] = a14;
+  a[15] = a15; a[16] = a16; a[17] = a17; a[18] = a18; a[19] = a19;
+  a[20] = a20; a[21] = a21; a[22] = a22; a[23] = a23; a[24] = a24;
+}
+
+/**
+ * @brief Two-state scalar Keccak permutation.
+ *
+ * Apply `num_rounds` of Keccak permutation to two independent Keccak
+ * states.  The rounds of both states are issued back to back in the
+ * same loop body, so an out-of-order core always has independent work
+ * to schedule while one state is waiting on the theta to rho to chi
+ * dependency chain of the other.
+ *
+ * @param[in,out] a First Keccak state (array of 25 64-bit integers).
+ * @param[in,out] b Second Keccak state (array of 25 64-bit integers).
+ * @param[in] num_rounds Number of rounds (12 or 24).  Must be even.
+ *
+ * @note Only built when using one of the scalar backends or when
+ * building the test suite.
+ */
+static inline void permute_n_x2(uint64_t a[static 25], uint64_t b[static 25], const size_t num_rounds) {
+  uint64_t a00 = a[ 0], a01 = a[ 1], a02 = a[ 2], a03 = a[ 3], a04 = a[ 4],
+           a05 = a[ 5], a06 = a[ 6], a07 = a[ 7], a08 = a[ 8], a09 = a[ 9],
+           a10 = a[10], a11 = a[11], a12 = a[12], a13 = a[13], a14 = a[14],
+           a15 = a[15], a16 = a[16], a17 = a[17], a18 = a[18], a19 = a[19],
+           a20 = a[20], a21 = a[21], a22 = a[22], a23 = a[23], a24 = a[24];
+  uint64_t b00 = b[ 0], b01 = b[ 1], b02 = b[ 2], b03 = b[ 3], b04 = b[ 4],
+           b05 = b[ 5], b06 = b[ 6], b07 = b[ 7], b08 = b[ 8], b09 = b[ 9],
+           b10 = b[10], b11 = b[11], b12 = b[12], b13 = b[13], b14 = b[14],
+           b15 = b[15], b16 = b[16], b17 = b[17], b18 = b[18], b19 = b[19],
+           b20 = b[20], b21 = b[21], b22 = b[22], b23 = b[23], b24 = b[24];
+  uint64_t e00, e01, e02, e03, e04, e05, e06, e07, e08, e09, e10, e11, e12,
+           e13, e14, e15, e16, e17, e18, e19, e20, e21, e22, e23, e24;
+  uint64_t f00, f01, f02, f03, f04, f05, f06, f07, f08, f09, f10, f11, f12,
+           f13, f14, f15, f16, f17, f18, f19, f20, f21, f22, f23, f24;
+
+  for (size_t i = (SHA3_NUM_ROUNDS - num_rounds); __builtin_expect(i < SHA3_NUM_ROUNDS, 1); i += 2) {
+    SCALAR_ROUND(a, e, RCS[i]);
+    SCALAR_ROUND(b, f, RCS[i]);
+    SCALAR_ROUND(e, a, RCS[i + 1]);
+    SCALAR_ROUND(f, b, RCS[i + 1]);
+  }
+
+  a[ 0] = a00; a[ 1] = a01; a[ 2] = a02; a[ 3] = a03; a[ 4] = a04;
+  a[ 5] = a05; a[ 6] = a06; a[ 7] = a07; a[ 8] = a08; a[ 9] = a09;
+  a[10] = a10; a[11] = a11; a[12] = a12; a[13] = a13; a[14] = a14;
+  a[15] = a15; a[16] = a16; a[17] = a17; a[18] = a18; a[19] = a19;
+  a[20] = a20; a[21] = a21; a[22] = a22; a[23] = a23; a[24] = a24;
+
+  b[ 0] = b00; b[ 1] = b01; b[ 2] = b02; b[ 3] = b03; b[ 4] = b04;
+  b[ 5] = b05; b[ 6] = b06; b[ 7] = b07; b[ 8] = b08; b[ 9] = b09;
+  b[10] = b10; b[11] = b11; b[12] = b12; b[13] = b13; b[14] = b14;
+  b[15] = b15; b[16] = b16; b[17] = b17; b[18] = b18; b[19] = b19;
+  b[20] = b20; b[21] = b21; b[22] = b22; b[23] = b23; b[24] = b24;
+}
+#endif /* (BACKEND == BACKEND_SCALAR) || (BACKEND == BACKEND_SCALAR_X2) || (BACKEND == BACKEND_LCOMP) || (BACKEND == BACKEND_BI32) || defined(TEST_SHA3) */
+
+#if (BACKEND == BACKEND_LCOMP) || defined(TEST_SHA3)
+// The lane-complementing scalar backend stores lanes 1, 2, 8, 12, 17,
+// and 20 complemented for the duration of the permutation.  Theta, rho,
+// pi, and iota are unchanged, because complementing commutes with XOR
+// (an even number of complemented inputs) and with rotation.  Chi is
+// rewritten so that the complemented lanes stay complemented, which
+// replaces the 25 NOTs per round in chi() with 5.
+//
+// The lanes are complemented on entry to and restored on exit from
+// permute_n_lcomp(), so the state seen by the rest of the library is
+// identical to the scalar backend.
+
+/**
+ * @brief Chi step of lane-complementing Keccak permutation.
+ *
+ * Equivalent to chi() when lanes 1, 2, 8, 12, 17, and 20 of both `src`
+ * and `dst` are stored complemented.
+ *
+ * @param[out] dst Destination Keccak state (array of 25 64-bit integers).
+ * @param[in] src Source Keccak state (array of 25 64-bit integers).
+ *
+ * @note Only built when using the lane-complementing scalar backend or
+ * when building the test suite.
+ */
+static inline void chi_lcomp(uint64_t dst[static 25], const uint64_t src[static 25]) {
+  const uint64_t n13 = ~src[13], n18 = ~src[18], n21 = ~src[21];
+  const uint64_t n2 = ~src[2], n9 = ~src[9];
+
+  dst[ 0] = src[ 0] ^ (src[ 1] | src[ 2]);
+  dst[ 1] = src[ 1] ^ (n2 | src[ 3]);
+  dst[ 2] = src[ 2] ^ (src[ 3] & src[ 4]);
+  dst[ 3] = src[ 3] ^ (src[ 4] | src[ 0]);
+  dst[ 4] = src[ 4] ^ (src[ 0] & src[ 1]);
+
+  dst[ 5] = src[ 5] ^ (src[ 6] | src[ 7]);
+  dst[ 6] = src[ 6] ^ (src[ 7] & src[ 8]);
+  dst[ 7] = src[ 7] ^ (src[ 8] | n9);
+  dst[ 8] = src[ 8] ^ (src[ 9] | src[ 5]);
+  dst[ 9] = src[ 9] ^ (src[ 5] & src[ 6]);
+
+  dst[10] = src[10] ^ (src[11] | src[12]);
+  dst[11] = src[11] ^ (src[12] & src[13]);
+  dst[12] = src[12] ^ (n13 & src[14]);
+  dst[13] = n13 ^ (src[14] | src[10]);
+  dst[14] = src[14] ^ (src[10] & src[11]);
+
+  dst[15] = src[15] ^ (src[16] & src[17]);
+  dst[16] = src[16] ^ (src[17] | src[18]);
+  dst[17] = src[17] ^ (n18 | src[19]);
+  dst[18] = n18 ^ (src[19] & src[15]);
+  dst[19] = src[19] ^ (src[15] | src[16]);
+
+  dst[20] = src[20] ^ (n21 & src[22]);
+  dst[21] = n21 ^ (src[22] | src[23]);
+  dst[22] = src[22] ^ (src[23] & src[24]);
+  dst[23] = src[23] ^ (src[24] | src[20]);
+  dst[24] = src[24] ^ (src[20] & src[21]);
+}
+
+/**
+ * @brief Complement lanes 1, 2, 8, 12, 17, and 20 of Keccak state.
+ *
+ * Converts between the normal and lane-complemented state
+ * representations (the operation is its own inverse).
+ *
+ * @param[in,out] a Keccak state (array of 25 64-bit integers).
+ *
+ * @note Only built when using the lane-complementing scalar backend or
+ * when building the test suite.
+ */
+static inline void lcomp_flip(uint64_t a[static 25]) {
+  a[ 1] = ~a[ 1];
+  a[ 2] = ~a[ 2];
+  a[ 8] = ~a[ 8];
+  a[12] = ~a[12];
+  a[17] = ~a[17];
+  a[20] = ~a[20];
+}
+
+/**
+ * @brief Lane-complementing scalar Keccak permutation.
+ *
+ * Apply `num_rounds` of Keccak permutation.  Produces the same result
+ * as permute_n_scalar(), but uses 5 NOTs per round instead of 25.
+ *
+ * @param[in,out] a Keccak state (array of 25 64-bit integers).
+ * @param[in] num_rounds Number of rounds (12 or 24).
+ *
+ * @note Only built when using the lane-complementing scalar backend or
+ * when building the test suite.
+ */
+static inline void permute_n_lcomp(uint64_t a[static 25], const size_t num_rounds) {
   uint64_t tmp[25] = { 0 };
+  lcomp_flip(a);
   for (size_t i = (SHA3_NUM_ROUNDS - num_rounds); __builtin_expect(i < SHA3_NUM_ROUNDS, 1); i++) {
     theta(a);
     rho(a);
     pi(tmp, a);
-    chi(a, tmp);
+    chi_lcomp(a, tmp);
     iota(a, i);
   }
+  lcomp_flip(a);
+}
+#endif /* (BACKEND == BACKEND_LCOMP) || defined(TEST_SHA3) */
+
+#if (BACKEND == BACKEND_BI32) || defined(TEST_SHA3)
+// The bit-interleaved backend is intended for 32-bit targets, where
+// every 64-bit rotate becomes a pair of double-word shifts.  Each lane
+// is split into two 32-bit words: one with the even bits of the lane
+// and one with the odd bits.  In this form a 64-bit rotate is two
+// 32-bit rotates (swapping the words if the rotate count is odd), and
+// every other step operates on 32-bit words as-is.
+//
+// The state is interleaved on entry to and de-interleaved on exit from
+// permute_n_bi32(), so the state seen by the rest of the library is
+// identical to the scalar backend.
+
+// 32-bit rotate left (safe for n = 0)
+#define ROL32(v, n) (((v) << (n)) | ((v) >> ((32 - (n)) & 31)))
+
+// Iota round constants in bit-interleaved form ({ even, odd }).
+static const uint32_t BI32_RCS[24][2] = {
+  { 0x00000001U, 0x00000000U }, { 0x00000000U, 0x00000089U },
+  { 0x00000000U, 0x8000008bU }, { 0x00000000U, 0x80008080U },
+  { 0x00000001U, 0x0000008bU }, { 0x00000001U, 0x00008000U },
+  { 0x00000001U, 0x80008088U }, { 0x00000001U, 0x80000082U },
+  { 0x00000000U, 0x0000000bU }, { 0x00000000U, 0x0000000aU },
+  { 0x00000001U, 0x00008082U }, { 0x00000000U, 0x00008003U },
+  { 0x00000001U, 0x0000808bU }, { 0x00000001U, 0x8000000bU },
+  { 0x00000001U, 0x8000008aU }, { 0x00000001U, 0x80000081U },
+  { 0x00000000U, 0x80000081U }, { 0x00000000U, 0x80000008U },
+  { 0x00000000U, 0x00000083U }, { 0x00000000U, 0x80008003U },
+  { 0x00000001U, 0x80008088U }, { 0x00000000U, 0x80000088U },
+  { 0x00000001U, 0x00008000U }, { 0x00000000U, 0x80008082U },
+};
+
+/**
+ * @brief Gather even bits of 32-bit word into low half and odd bits into
+ * high half.
+ * @param[in] x Input word.
+ * @return Unshuffled word.
+ *
+ * @note Only built when using the bit-interleaved 32-bit backend or
+ * when building the test suite.
+ */
+static inline uint32_t bi32_unshuffle(uint32_t x) {
+  uint32_t t;
+  t = (x ^ (x >> 1)) & 0x22222222U; x ^= t ^ (t << 1);
+  t = (x ^ (x >> 2)) & 0x0c0c0c0cU; x ^= t ^ (t << 2);
+  t = (x ^ (x >> 4)) & 0x00f000f0U; x ^= t ^ (t << 4);
+  t = (x ^ (x >> 8)) & 0x0000ff00U; x ^= t ^ (t << 8);
+  return x;
+}
+
+/**
+ * @brief Inverse of `bi32_unshuffle()`.
+ * @param[in] x Unshuffled word.
+ * @return Shuffled word.
+ *
+ * @note Only built when using the bit-interleaved 32-bit backend or
+ * when building the test suite.
+ */
+static inline uint32_t bi32_shuffle(uint32_t x) {
+  uint32_t t;
+  t = (x ^ (x >> 8)) & 0x0000ff00U; x ^= t ^ (t << 8);
+  t = (x ^ (x >> 4)) & 0x00f000f0U; x ^= t ^ (t << 4);
+  t = (x ^ (x >> 2)) & 0x0c0c0c0cU; x ^= t ^ (t << 2);
+  t = (x ^ (x >> 1)) & 0x22222222U; x ^= t ^ (t << 1);
+  return x;
+}
+
+// Bit-interleaved 64-bit rotate left.
+//
+// Rotate the lane stored as even bits `e` and odd bits `o` left by the
+// constant `n` bits, and store the result in `de` and `dodd`.  If `n`
+// is odd, the even and odd words trade places.
+#define BI32_ROL(de, dodd, e, o, n) do { \
+  if ((n) & 1) { \
+    (de) = ROL32((o), ((n) + 1) / 2); \
+    (dodd) = ROL32((e), (n) / 2); \
+  } else { \
+    (de) = ROL32((e), (n) / 2); \
+    (dodd) = ROL32((o), (n) / 2); \
+  } \
+} while (0)
+
+/**
+ * @brief Bit-interleaved 32-bit Keccak permutation.
+ *
+ * Apply `num_rounds` of Keccak permutation.  Produces the same result
+ * as permute_n_scalar(), but only uses 32-bit operations inside the
+ * round loop.
+ *
+ * @param[in,out] a Keccak state (array of 25 64-bit integers).
+ * @param[in] num_rounds Number of rounds (12 or 24).
+ *
+ * @note Only built when using the bit-interleaved 32-bit backend or
+ * when building the test suite.
+ */
+static inline void permute_n_bi32(uint64_t a[static 25], const size_t num_rounds) {
+  uint32_t e[25], o[25]; // even and odd bits of each lane
+
+  // interleave
+  for (size_t i = 0; i < 25; i++) {
+    const uint32_t lo = bi32_unshuffle((uint32_t) a[i]),
+                   hi = bi32_unshuffle((uint32_t) (a[i] >> 32));
+    e[i] = (lo & 0xffffU) | (hi << 16);
+    o[i] = (lo >> 16) | (hi & 0xffff0000U);
+  }
+
+  for (size_t r = (SHA3_NUM_ROUNDS - num_rounds); __builtin_expect(r < SHA3_NUM_ROUNDS, 1); r++) {
+    // theta
+    uint32_t ce[5], co[5], de[5], dodd[5];
+    for (size_t x = 0; x < 5; x++) {
+      ce[x] = e[x] ^ e[x + 5] ^ e[x + 10] ^ e[x + 15] ^ e[x + 20];
+      co[x] = o[x] ^ o[x + 5] ^ o[x + 10] ^ o[x + 15] ^ o[x + 20];
+    }
+    for (size_t x = 0; x < 5; x++) {
+      de[x] = ce[(x + 4) % 5] ^ ROL32(co[(x + 1) % 5], 1);
+      dodd[x] = co[(x + 4) % 5] ^ ce[(x + 1) % 5];
+    }
+
+    // rho and pi
+    uint32_t be[25], bo[25];
+    BI32_ROL(be[ 0], bo[ 0], e[ 0] ^ de[0], o[ 0] ^ dodd[0],  0);
+    BI32_ROL(be[ 1], bo[ 1], e[ 6] ^ de[1], o[ 6] ^ dodd[1], 44);
+    BI32_ROL(be[ 2], bo[ 2], e[12] ^ de[2], o[12] ^ dodd[2], 43);
+    BI32_ROL(be[ 3], bo[ 3], e[18] ^ de[3], o[18] ^ dodd[3], 21);
+    BI32_ROL(be[ 4], bo[ 4], e[24] ^ de[4], o[24] ^ dodd[4], 14);
+    BI32_ROL(be[ 5], bo[ 5], e[ 3] ^ de[3], o[ 3] ^ dodd[3], 28);
+    BI32_ROL(be[ 6], bo[ 6], e[ 9] ^ de[4], o[ 9] ^ dodd[4], 20);
+    BI32_ROL(be[ 7], bo[ 7], e[10] ^ de[0], o[10] ^ dodd[0],  3);
+    BI32_ROL(be[ 8], bo[ 8], e[16] ^ de[1], o[16] ^ dodd[1], 45);
+    BI32_ROL(be[ 9], bo[ 9], e[22] ^ de[2], o[22] ^ dodd[2], 61);
+    BI32_ROL(be[10], bo[10], e[ 1] ^ de[1], o[ 1] ^ dodd[1],  1);
+    BI32_ROL(be[11], bo[11], e[ 7] ^ de[2], o[ 7] ^ dodd[2],  6);
+    BI32_ROL(be[12], bo[12], e[13] ^ de[3], o[13] ^ dodd[3], 25);
+    BI32_ROL(be[13], bo[13], e[19] ^ de[4], o[19] ^ dodd[4],  8);
+    BI32_ROL(be[14], bo[14], e[20] ^ de[0], o[20] ^ dodd[0], 18);
+    BI32_ROL(be[15], bo[15], e[ 4] ^ de[4], o[ 4] ^ dodd[4], 27);
+    BI32_ROL(be[16], bo[16], e[ 5] ^ de[0], o[ 5] ^ dodd[0], 36);
+    BI32_ROL(be[17], bo[17], e[11] ^ de[1], o[11] ^ dodd[1], 10);
+    BI32_ROL(be[18], bo[18], e[17] ^ de[2], o[17] ^ dodd[2], 15);
+    BI32_ROL(be[19], bo[19], e[23] ^ de[3], o[23] ^ dodd[3], 56);
+    BI32_ROL(be[20], bo[20], e[ 2] ^ de[2], o[ 2] ^ dodd[2], 62);
+    BI32_ROL(be[21], bo[21], e[ 8] ^ de[3], o[ 8] ^ dodd[3], 55);
+    BI32_ROL(be[22], bo[22], e[14] ^ de[4], o[14] ^ dodd[4], 39);
+    BI32_ROL(be[23], bo[23], e[15] ^ de[0], o[15] ^ dodd[0], 41);
+    BI32_ROL(be[24], bo[24], e[21] ^ de[1], o[21] ^ dodd[1],  2);
+
+    // chi
+    e[ 0] = be[ 0] ^ (~be[ 1] & be[ 2]); o[ 0] = bo[ 0] ^ (~bo[ 1] & bo[ 2]);
+    e[ 1] = be[ 1] ^ (~be[ 2] & be[ 3]); o[ 1] = bo[ 1] ^ (~bo[ 2] & bo[ 3]);
+    e[ 2] = be[ 2] ^ (~be[ 3] & be[ 4]); o[ 2] = bo[ 2] ^ (~bo[ 3] & bo[ 4]);
+    e[ 3] = be[ 3] ^ (~be[ 4] & be[ 0]); o[ 3] = bo[ 3] ^ (~bo[ 4] & bo[ 0]);
+    e[ 4] = be[ 4] ^ (~be[ 0] & be[ 1]); o[ 4] = bo[ 4] ^ (~bo[ 0] & bo[ 1]);
+
+    e[ 5] = be[ 5] ^ (~be[ 6] & be[ 7]); o[ 5] = bo[ 5] ^ (~bo[ 6] & bo[ 7]);
+    e[ 6] = be[ 6] ^ (~be[ 7] & be[ 8]); o[ 6] = bo[ 6] ^ (~bo[ 7] & bo[ 8]);
+    e[ 7] = be[ 7] ^ (~be[ 8] & be[ 9]); o[ 7] = bo[ 7] ^ (~bo[ 8] & bo[ 9]);
+    e[ 8] = be[ 8] ^ (~be[ 9] & be[ 5]); o[ 8] = bo[ 8] ^ (~bo[ 9] & bo[ 5]);
+    e[ 9] = be[ 9] ^ (~be[ 5] & be[ 6]); o[ 9] = bo[ 9] ^ (~bo[ 5] & bo[ 6]);
+
+    e[10] = be[10] ^ (~be[11] & be[12]); o[10] = bo[10] ^ (~bo[11] & bo[12]);
+    e[11] = be[11] ^ (~be[12] & be[13]); o[11] = bo[11] ^ (~bo[12] & bo[13]);
+    e[12] = be[12] ^ (~be[13] & be[14]); o[12] = bo[12] ^ (~bo[13] & bo[14]);
+    e[13] = be[13] ^ (~be[14] & be[10]); o[13] = bo[13] ^ (~bo[14] & bo[10]);
+    e[14] = be[14] ^ (~be[10] & be[11]); o[14] = bo[14] ^ (~bo[10] & bo[11]);
+
+    e[15] = be[15] ^ (~be[16] & be[17]); o[15] = bo[15] ^ (~bo[16] & bo[17]);
+    e[16] = be[16] ^ (~be[17] & be[18]); o[16] = bo[16] ^ (~bo[17] & bo[18]);
+    e[17] = be[17] ^ (~be[18] & be[19]); o[17] = bo[17] ^ (~bo[18] & bo[19]);
+    e[18] = be[18] ^ (~be[19] & be[15]); o[18] = bo[18] ^ (~bo[19] & bo[15]);
+    e[19] = be[19] ^ (~be[15] & be[16]); o[19] = bo[19] ^ (~bo[15] & bo[16]);
+
+    e[20] = be[20] ^ (~be[21] & be[22]); o[20] = bo[20] ^ (~bo[21] & bo[22]);
+    e[21] = be[21] ^ (~be[22] & be[23]); o[21] = bo[21] ^ (~bo[22] & bo[23]);
+    e[22] = be[22] ^ (~be[23] & be[24]); o[22] = bo[22] ^ (~bo[23] & bo[24]);
+    e[23] = be[23] ^ (~be[24] & be[20]); o[23] = bo[23] ^ (~bo[24] & bo[20]);
+    e[24] = be[24] ^ (~be[20] & be[21]); o[24] = bo[24] ^ (~bo[20] & bo[21]);
+    // iota
+    e[0] ^= BI32_RCS[r][0];
+    o[0] ^= BI32_RCS[r][1];
+  }
+
+  // de-interleave
+  for (size_t i = 0; i < 25; i++) {
+    const uint32_t lo = bi32_shuffle((e[i] & 0xffffU) | (o[i] << 16)),
+                   hi = bi32_shuffle((e[i] >> 16) | (o[i] & 0xffff0000U));
+    a[i] = ((uint64_t) hi << 32) | lo;
+  }
 }
-#endif /* (BACKEND == BACKEND_SCALAR) || defined(TEST_SHA3) */
+#endif /* (BACKEND == BACKEND_BI32) || defined(TEST_SHA3) */
 
 #if BACKEND == BACKEND_AVX512
 #include <immintrin.h>
 
+/**
+ * @brief Theta step of AVX-512 Keccak permutation.
+ *
+ * @param[in,out] r Rows of Keccak state (5 AVX-512 registers).
+ */
+static inline void avx512_theta(__m512i r[static 5]) {
+  __m512i r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3], r4 = r[4];
+
+  // theta
+  {
+    // permute ids
+    static const __m512i I0 = { 4, 0, 1, 2, 3 },
+                         I1 = { 1, 2, 3, 4, 0 };
+
+    // c = xor(r0, r1, r2, r3, r4)
+    const __m512i r01 = _mm512_maskz_xor_epi64(0x1f, r0, r1),
+                  r23 = _mm512_maskz_xor_epi64(0x1f, r2, r3),
+                  c = _mm512_maskz_ternarylogic_epi64(0x1f, r01, r23, r4, 0x96);
+
+    // d = xor(permute(i0, c), permute(i1, rol(c, 1)))
+    const __m512i d0 = _mm512_permutexvar_epi64(I0, c),
+                  d1 = _mm512_permutexvar_epi64(I1, _mm512_rol_epi64(c, 1)),
+                  d = _mm512_xor_epi64(d0, d1);
+
+    // row = xor(row, d)
+    r0 = _mm512_xor_epi64(r0, d);
+    r1 = _mm512_xor_epi64(r1, d);
+    r2 = _mm512_xor_epi64(r2, d);
+    r3 = _mm512_xor_epi64(r3, d);
+    r4 = _mm512_xor_epi64(r4, d);
+  }
+
+  r[0] = r0; r[1] = r1; r[2] = r2; r[3] = r3; r[4] = r4;
+}
+
+/**
+ * @brief Rho step of AVX-512 Keccak permutation.
+ *
+ * @param[in,out] r Rows of Keccak state (5 AVX-512 registers).
+ */
+static inline void avx512_rho(__m512i r[static 5]) {
+  __m512i r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3], r4 = r[4];
+
+  // rho
+  {
+    // rotate values
+    //
+    // note: switching from maskz_load_epi64()s to static const
+    // __m512i incurs a 500 cycle penalty; leaving them for now
+    static const uint64_t V0_VALS[5] ALIGN(64) = { 0, 1, 62, 28, 27 },
+                          V1_VALS[5] ALIGN(64) = { 36, 44, 6, 55, 20 },
+                          V2_VALS[5] ALIGN(64) = { 3, 10, 43, 25, 39 },
+                          V3_VALS[5] ALIGN(64) = { 41, 45, 15, 21, 8 },
+                          V4_VALS[5] ALIGN(64) = { 18, 2, 61, 56, 14 };
+
+    // rotate rows
+    r0 = _mm512_rolv_epi64(r0, _mm512_maskz_load_epi64(0x1f, V0_VALS));
+    r1 = _mm512_rolv_epi64(r1, _mm512_maskz_load_epi64(0x1f, V1_VALS));
+    r2 = _mm512_rolv_epi64(r2, _mm512_maskz_load_epi64(0x1f, V2_VALS));
+    r3 = _mm512_rolv_epi64(r3, _mm512_maskz_load_epi64(0x1f, V3_VALS));
+    r4 = _mm512_rolv_epi64(r4, _mm512_maskz_load_epi64(0x1f, V4_VALS));
+  }
+
+  r[0] = r0; r[1] = r1; r[2] = r2; r[3] = r3; r[4] = r4;
+}
+
+/**
+ * @brief Pi step of AVX-512 Keccak permutation.
+ *
+ * @param[in,out] r Rows of Keccak state (5 AVX-512 registers).
+ */
+static inline void avx512_pi(__m512i r[static 5]) {
+  __m512i r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3], r4 = r[4];
+
+  // pi
+  //
+  // The cells are permuted across all rows of the state array.  each
+  // output row is the combination of three permutations:
+  //
+  // - e0: row 0 and row 1
+  // - e2: row 2 and row 3
+  // - e4: row 4 and row 0
+  //
+  // the IDs for each permutation are merged into a single array
+  // (T*_IDS) to reduce register pressure, and the permute operations
+  // are masked so that each permutation only uses the relevant IDs.
+  //
+  // afterwards, the permutations are combined to form a temporary
+  // row:
+  //
+  //   t0 = t0e0 | t0e2 | t0e4
+  //
+  // once the permutations for all rows are complete, the temporary
+  // rows are saved to the actual row registers:
+  //
+  //   r0 = t0
+  //
+  {
+    // permute ids
+    static const __m512i T0_IDS = { 0, 8 + 1, 2, 8 + 3, 4 },
+                         T1_IDS = { 3, 8 + 4, 0, 8 + 1, 2 },
+                         T2_IDS = { 1, 8 + 2, 3, 8 + 4, 0 },
+                         T3_IDS = { 4, 8 + 0, 1, 8 + 2, 3 },
+                         T4_IDS = { 2, 8 + 3, 4, 8 + 0, 1 };
+
+    __m512i t0, t1, t2, t3, t4;
+    {
+      // permute r0
+      const __m512i t0e0 = _mm512_maskz_permutex2var_epi64(0x03, r0, T0_IDS, r1),
+                    t0e2 = _mm512_maskz_permutex2var_epi64(0x0c, r2, T0_IDS, r3),
+                    t0e4 = _mm512_maskz_permutex2var_epi64(0x10, r4, T0_IDS, r0);
+
+      // permute r1
+      const __m512i t1e0 = _mm512_maskz_permutex2var_epi64(0x03, r0, T1_IDS, r1),
+                    t1e2 = _mm512_maskz_permutex2var_epi64(0x0c, r2, T1_IDS, r3),
+                    t1e4 = _mm512_maskz_permutex2var_epi64(0x10, r4, T1_IDS, r0);
+
+      // permute r2
+      const __m512i t2e0 = _mm512_maskz_permutex2var_epi64(0x03, r0, T2_IDS, r1),
+                    t2e2 = _mm512_maskz_permutex2var_epi64(0x0c, r2, T2_IDS, r3),
+                    t2e4 = _mm512_maskz_permutex2var_epi64(0x10, r4, T2_IDS, r0);
+
+      // permute r3
+      const __m512i t3e0 = _mm512_maskz_permutex2var_epi64(0x03, r0, T3_IDS, r1),
+                    t3e2 = _mm512_maskz_permutex2var_epi64(0x0c, r2, T3_IDS, r3),
+                    t3e4 = _mm512_maskz_permutex2var_epi64(0x10, r4, T3_IDS, r0);
+
+      // permute r4
+      const __m512i t4e0 = _mm512_maskz_permutex2var_epi64(0x03, r0, T4_IDS, r1),
+                    t4e2 = _mm512_maskz_permutex2var_epi64(0x0c, r2, T4_IDS, r3),
+                    t4e4 = _mm512_maskz_permutex2var_epi64(0x10, r4, T4_IDS, r0);
+
+      // combine permutes: tN = e0 | e2 | e4
+      t0 = _mm512_maskz_ternarylogic_epi64(0x1f, t0e0, t0e2, t0e4, 0xfe);
+      t1 = _mm512_maskz_ternarylogic_epi64(0x1f, t1e0, t1e2, t1e4, 0xfe);
+      t2 = _mm512_maskz_ternarylogic_epi64(0x1f, t2e0, t2e2, t2e4, 0xfe);
+      t3 = _mm512_maskz_ternarylogic_epi64(0x1f, t3e0, t3e2, t3e4, 0xfe);
+      t4 = _mm512_maskz_ternarylogic_epi64(0x1f, t4e0, t4e2, t4e4, 0xfe);
+    }
+
+    // store rows
+    r0 = t0;
+    r1 = t1;
+    r2 = t2;
+    r3 = t3;
+    r4 = t4;
+  }
+
+  r[0] = r0; r[1] = r1; r[2] = r2; r[3] = r3; r[4] = r4;
+}
+
+/**
+ * @brief Chi step of AVX-512 Keccak permutation.
+ *
+ * @param[in,out] r Rows of Keccak state (5 AVX-512 registers).
+ */
+static inline void avx512_chi(__m512i r[static 5]) {
+  __m512i r0 = r[0], r1 = r[1], r2 = r[2], r3 = r[3], r4 = r[4];
+
+  // chi
+  {
+    // permute ids
+    static const __m512i P0 = { 1, 2, 3, 4, 0 },
+                         P1 = { 2, 3, 4, 0, 1 };
+
+    {
+      // r0 ^= ~e0 & e1
+      const __m512i t0_e0 = _mm512_maskz_permutexvar_epi64(0x1f, P0, r0),
+                    t0_e1 = _mm512_maskz_permutexvar_epi64(0x1f, P1, r0);
+      r0 = _mm512_maskz_ternarylogic_epi64(0x1f, r0, t0_e0, t0_e1, 0xd2);
+    }
+
+    {
+      // r1 ^= ~e0 & e1
+      const __m512i t1_e0 = _mm512_maskz_permutexvar_epi64(0x1f, P0, r1),
+                    t1_e1 = _mm512_maskz_permutexvar_epi64(0x1f, P1, r1);
+      r1 = _mm512_maskz_ternarylogic_epi64(0x1f, r1, t1_e0, t1_e1, 0xd2);
+    }
+
+    {
+      // r2 ^= ~e0 & e1
+      const __m512i t2_e0 = _mm512_maskz_permutexvar_epi64(0x1f, P0, r2),
+                    t2_e1 = _mm512_maskz_permutexvar_epi64(0x1f, P1, r2);
+      r2 = _mm512_maskz_ternarylogic_epi64(0x1f, r2, t2_e0, t2_e1, 0xd2);
+    }
+
+    {
+      // r3 ^= ~e0 & e1
+      const __m512i t3_e0 = _mm512_maskz_permutexvar_epi64(0x1f, P0, r3),
+                    t3_e1 = _mm512_maskz_permutexvar_epi64(0x1f, P1, r3);
+      r3 = _mm512_maskz_ternarylogic_epi64(0x1f, r3, t3_e0, t3_e1, 0xd2);
+    }
+
+    {
+      // r4 ^= ~e0 & e1
+      const __m512i t4_e0 = _mm512_maskz_permutexvar_epi64(0x1f, P0, r4),
+                    t4_e1 = _mm512_maskz_permutexvar_epi64(0x1f, P1, r4);
+      r4 = _mm512_maskz_ternarylogic_epi64(0x1f, r4, t4_e0, t4_e1, 0xd2);
+    }
+  }
+
+  r[0] = r0; r[1] = r1; r[2] = r2; r[3] = r3; r[4] = r4;
+}
+
+/**
+ * @brief Iota step of AVX-512 Keccak permutation.
+ *
+ * @param[in,out] r Rows of Keccak state (5 AVX-512 registers).
+ * @param[in] i Round index (0-23).
+ */
+static inline void avx512_iota(__m512i r[static 5], const size_t i) {
+  // xor round constant to first cell
+  r[0] = _mm512_mask_xor_epi64(r[0], 1, r[0], _mm512_maskz_loadu_epi64(1, RCS + i));
+}
+
+/**
+ * @brief Apply one round of the Keccak permutation to a state stored in
+ * AVX-512 registers.
+ *
+ * Used by `permute_n_avx512()`.  See `permute_n_avx512()` for the
+ * register layout.  `permute_n_avx512_x2()` calls the step functions
+ * directly so the steps of two states can be interleaved.
+ *
+ * @param[in,out] r Rows of Keccak state (5 AVX-512 registers).
+ * @param[in] i Round index (0-23).
+ */
+static inline void avx512_round(__m512i r[static 5], const size_t i) {
+  avx512_theta(r);
+  avx512_rho(r);
+  avx512_pi(r);
+  avx512_chi(r);
+  avx512_iota(r, i);
+}
+
 /**
  * @brief AVX-512 Keccak permutation.
  *
@@ -339,188 +1060,260 @@ static inline void permute_n_scalar(uint64_t a[static 25], const size_t num_roun
  */
 static inline void permute_n_avx512(uint64_t s[static 25], const size_t num_rounds) {
   // load rows (r0-r4)
-  __m512i r0 = _mm512_maskz_loadu_epi64(0x1f, s +  0), // row 0
-          r1 = _mm512_maskz_loadu_epi64(0x1f, s +  5), // row 1
-          r2 = _mm512_maskz_loadu_epi64(0x1f, s + 10), // row 2
-          r3 = _mm512_maskz_loadu_epi64(0x1f, s + 15), // row 3
-          r4 = _mm512_maskz_loadu_epi64(0x1f, s + 20); // row 4
+  __m512i r[5] = {
+    _mm512_maskz_loadu_epi64(0x1f, s +  0), // row 0
+    _mm512_maskz_loadu_epi64(0x1f, s +  5), // row 1
+    _mm512_maskz_loadu_epi64(0x1f, s + 10), // row 2
+    _mm512_maskz_loadu_epi64(0x1f, s + 15), // row 3
+    _mm512_maskz_loadu_epi64(0x1f, s + 20), // row 4
+  };
+
+  // loop over rounds
+  for (size_t i = (SHA3_NUM_ROUNDS - num_rounds); __builtin_expect(i < SHA3_NUM_ROUNDS, 1); i++) {
+    avx512_round(r, i);
+  }
+
+  // store rows
+  _mm512_mask_storeu_epi64(s + 5 * 0, 0x1f, r[0]);
+  _mm512_mask_storeu_epi64(s + 5 * 1, 0x1f, r[1]);
+  _mm512_mask_storeu_epi64(s + 5 * 2, 0x1f, r[2]);
+  _mm512_mask_storeu_epi64(s + 5 * 3, 0x1f, r[3]);
+  _mm512_mask_storeu_epi64(s + 5 * 4, 0x1f, r[4]);
+}
+
+/**
+ * @brief Two-state AVX-512 Keccak permutation.
+ *
+ * Permute two independent Keccak states with `num_rounds` rounds.  The
+ * states are stored in two separate sets of 5 AVX-512 registers (same
+ * layout as `permute_n_avx512()`), and each step of the round (theta,
+ * rho, pi, chi, and iota) is issued for both states before the next
+ * step.  The two instruction streams have no dependencies on each
+ * other, so the CPU can overlap the latency of the permute and ternary
+ * logic instructions of one state with the other state.
+ *
+ * Used by `permute_mb_12()` for groups of 2 states (e.g. KangarooTwelve
+ * two-leaf tails), where it is faster than the 8-way multi-buffer
+ * kernel, which transposes all 8 lanes regardless of how many states
+ * are in use.
+ *
+ * @param[in,out] a First Keccak state (array of 25 64-bit integers).
+ * @param[in,out] b Second Keccak state (array of 25 64-bit integers).
+ * @param[in] num_rounds Number of rounds (12 or 24).
+ */
+static inline void permute_n_avx512_x2(uint64_t a[static 25], uint64_t b[static 25], const size_t num_rounds) {
+  // load rows of both states
+  __m512i ra[5], rb[5];
+  for (size_t i = 0; i < 5; i++) {
+    ra[i] = _mm512_maskz_loadu_epi64(0x1f, a + 5 * i);
+    rb[i] = _mm512_maskz_loadu_epi64(0x1f, b + 5 * i);
+  }
+
+  // loop over rounds, interleaving each step of both states
+  for (size_t i = (SHA3_NUM_ROUNDS - num_rounds); __builtin_expect(i < SHA3_NUM_ROUNDS, 1); i++) {
+    avx512_theta(ra);
+    avx512_theta(rb);
+    avx512_rho(ra);
+    avx512_rho(rb);
+    avx512_pi(ra);
+    avx512_pi(rb);
+    avx512_chi(ra);
+    avx512_chi(rb);
+    avx512_iota(ra, i);
+    avx512_iota(rb, i);
+  }
+
+  // store rows of both states
+  for (size_t i = 0; i < 5; i++) {
+    _mm512_mask_storeu_epi64(a + 5 * i, 0x1f, ra[i]);
+    _mm512_mask_storeu_epi64(b + 5 * i, 0x1f, rb[i]);
+  }
+}
+
+#ifdef __AVX512VL__
+/**
+ * @brief AVX-512VL Keccak permutation on 256-bit registers.
+ *
+ * @param[in,out] s Keccak state (array of 25 64-bit integers).
+ * @param[in] num_rounds Number of rounds (12 or 24).
+ *
+ * Same steps as `permute_n_avx512()`, but using the 256-bit (ymm)
+ * forms of the AVX-512VL instructions (`vpternlogq`, `vprolq`,
+ * `vprolvq`, `vpermq`, and `vpermt2q`) instead of 512-bit (zmm)
+ * registers.  On some Intel CPUs (e.g. Skylake-SP and Cascade Lake),
+ * 512-bit instructions lower the core clock frequency for a while
+ * afterwards, which slows down the rest of the process.  The 256-bit
+ * forms do not.
+ *
+ * The state layout is the same as `permute_n_avx2()`: columns 0-3 of
+ * each row are stored in one 256-bit register (r0_lo-r4_lo), and
+ * column 4 of each row is stored in the first 64-bit lane of another
+ * 256-bit register (r0_hi-r4_hi).  The remaining lanes of r0_hi-r4_hi
+ * are ignored.
+ *
+ * Two-source permutes (`vpermt2q`) use indices 0-3 to select columns
+ * 0-3 from the `lo` register and index 4 to select column 4 from the
+ * `hi` register, so the theta, pi, and chi steps can move cells
+ * between columns 0-3 and column 4 with a single instruction.
+ *
+ * Selected at run-time with `sha3_avx512_ymm()`.
+ */
+static inline void permute_n_avx512vl(uint64_t s[static 25], const size_t num_rounds) {
+  // load rows
+  __m256i r0_lo = _mm256_loadu_si256((__m256i*) (s +  0)), /* row 0, cols 0-3 */
+          r1_lo = _mm256_loadu_si256((__m256i*) (s +  5)), /* row 1, cols 0-3 */
+          r2_lo = _mm256_loadu_si256((__m256i*) (s + 10)), /* row 2, cols 0-3 */
+          r3_lo = _mm256_loadu_si256((__m256i*) (s + 15)), /* row 3, cols 0-3 */
+          r4_lo = _mm256_loadu_si256((__m256i*) (s + 20)), /* row 4, cols 0-3 */
+          r0_hi = _mm256_maskz_loadu_epi64(1, s +  4), /* row 0, col 4 */
+          r1_hi = _mm256_maskz_loadu_epi64(1, s +  9), /* row 1, col 4 */
+          r2_hi = _mm256_maskz_loadu_epi64(1, s + 14), /* row 2, col 4 */
+          r3_hi = _mm256_maskz_loadu_epi64(1, s + 19), /* row 3, col 4 */
+          r4_hi = _mm256_maskz_loadu_epi64(1, s + 24); /* row 4, col 4 */
 
   // loop over rounds
   for (size_t i = (SHA3_NUM_ROUNDS - num_rounds); __builtin_expect(i < SHA3_NUM_ROUNDS, 1); i++) {
     // theta
     {
-      // permute ids
-      static const __m512i I0 = { 4, 0, 1, 2, 3 },
-                           I1 = { 1, 2, 3, 4, 0 };
+      // i0 = { 4, 0, 1, 2, 3 }, i1 = { 1, 2, 3, 4, 0 }
+      static const __m256i I0_LO = { 4, 0, 1, 2 },
+                           I0_HI = { 3 },
+                           I1_LO = { 1, 2, 3, 4 };
 
       // c = xor(r0, r1, r2, r3, r4)
-      const __m512i r01 = _mm512_maskz_xor_epi64(0x1f, r0, r1),
-                    r23 = _mm512_maskz_xor_epi64(0x1f, r2, r3),
-                    c = _mm512_maskz_ternarylogic_epi64(0x1f, r01, r23, r4, 0x96);
+      const __m256i c_lo = _mm256_ternarylogic_epi64(_mm256_ternarylogic_epi64(r0_lo, r1_lo, r2_lo, 0x96), r3_lo, r4_lo, 0x96),
+                    c_hi = _mm256_ternarylogic_epi64(_mm256_ternarylogic_epi64(r0_hi, r1_hi, r2_hi, 0x96), r3_hi, r4_hi, 0x96);
 
       // d = xor(permute(i0, c), permute(i1, rol(c, 1)))
-      const __m512i d0 = _mm512_permutexvar_epi64(I0, c),
-                    d1 = _mm512_permutexvar_epi64(I1, _mm512_rol_epi64(c, 1)),
-                    d = _mm512_xor_epi64(d0, d1);
-
-      // row = xor(row, d)
-      r0 = _mm512_xor_epi64(r0, d);
-      r1 = _mm512_xor_epi64(r1, d);
-      r2 = _mm512_xor_epi64(r2, d);
-      r3 = _mm512_xor_epi64(r3, d);
-      r4 = _mm512_xor_epi64(r4, d);
+      const __m256i d0_lo = _mm256_permutex2var_epi64(c_lo, I0_LO, c_hi),
+                    d1_lo = _mm256_rol_epi64(_mm256_permutex2var_epi64(c_lo, I1_LO, c_hi), 1),
+                    d0_hi = _mm256_permutexvar_epi64(I0_HI, c_lo),
+                    d1_hi = _mm256_rol_epi64(c_lo, 1);
+
+      // row = xor(row, d0, d1)
+      r0_lo = _mm256_ternarylogic_epi64(r0_lo, d0_lo, d1_lo, 0x96);
+      r1_lo = _mm256_ternarylogic_epi64(r1_lo, d0_lo, d1_lo, 0x96);
+      r2_lo = _mm256_ternarylogic_epi64(r2_lo, d0_lo, d1_lo, 0x96);
+      r3_lo = _mm256_ternarylogic_epi64(r3_lo, d0_lo, d1_lo, 0x96);
+      r4_lo = _mm256_ternarylogic_epi64(r4_lo, d0_lo, d1_lo, 0x96);
+      r0_hi = _mm256_ternarylogic_epi64(r0_hi, d0_hi, d1_hi, 0x96);
+      r1_hi = _mm256_ternarylogic_epi64(r1_hi, d0_hi, d1_hi, 0x96);
+      r2_hi = _mm256_ternarylogic_epi64(r2_hi, d0_hi, d1_hi, 0x96);
+      r3_hi = _mm256_ternarylogic_epi64(r3_hi, d0_hi, d1_hi, 0x96);
+      r4_hi = _mm256_ternarylogic_epi64(r4_hi, d0_hi, d1_hi, 0x96);
     }
 
     // rho
     {
       // rotate values
-      //
-      // note: switching from maskz_load_epi64()s to static const
-      // __m512i incurs a 500 cycle penalty; leaving them for now
-      static const uint64_t V0_VALS[5] ALIGN(64) = { 0, 1, 62, 28, 27 },
-                            V1_VALS[5] ALIGN(64) = { 36, 44, 6, 55, 20 },
-                            V2_VALS[5] ALIGN(64) = { 3, 10, 43, 25, 39 },
-                            V3_VALS[5] ALIGN(64) = { 41, 45, 15, 21, 8 },
-                            V4_VALS[5] ALIGN(64) = { 18, 2, 61, 56, 14 };
+      static const __m256i V0_LO = {  0,  1, 62, 28 },
+                           V1_LO = { 36, 44,  6, 55 },
+                           V2_LO = {  3, 10, 43, 25 },
+                           V3_LO = { 41, 45, 15, 21 },
+                           V4_LO = { 18,  2, 61, 56 };
 
       // rotate rows
-      r0 = _mm512_rolv_epi64(r0, _mm512_maskz_load_epi64(0x1f, V0_VALS));
-      r1 = _mm512_rolv_epi64(r1, _mm512_maskz_load_epi64(0x1f, V1_VALS));
-      r2 = _mm512_rolv_epi64(r2, _mm512_maskz_load_epi64(0x1f, V2_VALS));
-      r3 = _mm512_rolv_epi64(r3, _mm512_maskz_load_epi64(0x1f, V3_VALS));
-      r4 = _mm512_rolv_epi64(r4, _mm512_maskz_load_epi64(0x1f, V4_VALS));
+      r0_lo = _mm256_rolv_epi64(r0_lo, V0_LO); r0_hi = _mm256_rol_epi64(r0_hi, 27);
+      r1_lo = _mm256_rolv_epi64(r1_lo, V1_LO); r1_hi = _mm256_rol_epi64(r1_hi, 20);
+      r2_lo = _mm256_rolv_epi64(r2_lo, V2_LO); r2_hi = _mm256_rol_epi64(r2_hi, 39);
+      r3_lo = _mm256_rolv_epi64(r3_lo, V3_LO); r3_hi = _mm256_rol_epi64(r3_hi,  8);
+      r4_lo = _mm256_rolv_epi64(r4_lo, V4_LO); r4_hi = _mm256_rol_epi64(r4_hi, 14);
     }
 
     // pi
     //
-    // The cells are permuted across all rows of the state array.  each
-    // output row is the combination of three permutations:
-    //
-    // - e0: row 0 and row 1
-    // - e2: row 2 and row 3
-    // - e4: row 4 and row 0
-    //
-    // the IDs for each permutation are merged into a single array
-    // (T*_IDS) to reduce register pressure, and the permute operations
-    // are masked so that each permutation only uses the relevant IDs.
-    //
-    // afterwards, the permutations are combined to form a temporary
-    // row:
+    // Lane x of output row y comes from column ((x + 3y) % 5) of input
+    // row x, so the permute IDs for output row y (T*_IDS) are the same
+    // for every input row.  Each input row is permuted with a mask
+    // which keeps only its own lane, and the masked permutes are
+    // combined with an or:
     //
-    //   t0 = t0e0 | t0e2 | t0e4
+    //   t1_lo = t1e0 | t1e1 | t1e2 | t1e3
     //
-    // once the permutations for all rows are complete, the temporary
-    // rows are saved to the actual row registers:
-    //
-    //   r0 = t0
+    // Column 4 of each output row comes from input row 4 (H*_IDS).
     //
+    // Output row 0 is the diagonal of the input rows, so it only needs
+    // blends.
     {
       // permute ids
-      static const __m512i T0_IDS = { 0, 8 + 1, 2, 8 + 3, 4 },
-                           T1_IDS = { 3, 8 + 4, 0, 8 + 1, 2 },
-                           T2_IDS = { 1, 8 + 2, 3, 8 + 4, 0 },
-                           T3_IDS = { 4, 8 + 0, 1, 8 + 2, 3 },
-                           T4_IDS = { 2, 8 + 3, 4, 8 + 0, 1 };
-
-      __m512i t0, t1, t2, t3, t4;
-      {
-        // permute r0
-        const __m512i t0e0 = _mm512_maskz_permutex2var_epi64(0x03, r0, T0_IDS, r1),
-                      t0e2 = _mm512_maskz_permutex2var_epi64(0x0c, r2, T0_IDS, r3),
-                      t0e4 = _mm512_maskz_permutex2var_epi64(0x10, r4, T0_IDS, r0);
-
-        // permute r1
-        const __m512i t1e0 = _mm512_maskz_permutex2var_epi64(0x03, r0, T1_IDS, r1),
-                      t1e2 = _mm512_maskz_permutex2var_epi64(0x0c, r2, T1_IDS, r3),
-                      t1e4 = _mm512_maskz_permutex2var_epi64(0x10, r4, T1_IDS, r0);
-
-        // permute r2
-        const __m512i t2e0 = _mm512_maskz_permutex2var_epi64(0x03, r0, T2_IDS, r1),
-                      t2e2 = _mm512_maskz_permutex2var_epi64(0x0c, r2, T2_IDS, r3),
-                      t2e4 = _mm512_maskz_permutex2var_epi64(0x10, r4, T2_IDS, r0);
-
-        // permute r3
-        const __m512i t3e0 = _mm512_maskz_permutex2var_epi64(0x03, r0, T3_IDS, r1),
-                      t3e2 = _mm512_maskz_permutex2var_epi64(0x0c, r2, T3_IDS, r3),
-                      t3e4 = _mm512_maskz_permutex2var_epi64(0x10, r4, T3_IDS, r0);
-
-        // permute r4
-        const __m512i t4e0 = _mm512_maskz_permutex2var_epi64(0x03, r0, T4_IDS, r1),
-                      t4e2 = _mm512_maskz_permutex2var_epi64(0x0c, r2, T4_IDS, r3),
-                      t4e4 = _mm512_maskz_permutex2var_epi64(0x10, r4, T4_IDS, r0);
-
-        // combine permutes: tN = e0 | e2 | e4
-        t0 = _mm512_maskz_ternarylogic_epi64(0x1f, t0e0, t0e2, t0e4, 0xfe);
-        t1 = _mm512_maskz_ternarylogic_epi64(0x1f, t1e0, t1e2, t1e4, 0xfe);
-        t2 = _mm512_maskz_ternarylogic_epi64(0x1f, t2e0, t2e2, t2e4, 0xfe);
-        t3 = _mm512_maskz_ternarylogic_epi64(0x1f, t3e0, t3e2, t3e4, 0xfe);
-        t4 = _mm512_maskz_ternarylogic_epi64(0x1f, t4e0, t4e2, t4e4, 0xfe);
-      }
+      static const __m256i T1_IDS = { 3, 4, 0, 1 }, H0_IDS = { 4 },
+                           T2_IDS = { 1, 2, 3, 4 }, H1_IDS = { 2 },
+                           T3_IDS = { 4, 0, 1, 2 }, H2_IDS = { 0 },
+                           T4_IDS = { 2, 3, 4, 0 }, H3_IDS = { 3 },
+                                                    H4_IDS = { 1 };
+
+      // output row 0: diagonal
+      const __m256i t0_lo = _mm256_mask_blend_epi64(0x08, _mm256_mask_blend_epi64(0x04, _mm256_mask_blend_epi64(0x02, r0_lo, r1_lo), r2_lo), r3_lo);
+
+      // permute rows 1-4
+#define PI_VL(IDS) _mm256_or_si256(_mm256_ternarylogic_epi64( \
+  _mm256_maskz_permutex2var_epi64(0x01, r0_lo, IDS, r0_hi), \
+  _mm256_maskz_permutex2var_epi64(0x02, r1_lo, IDS, r1_hi), \
+  _mm256_maskz_permutex2var_epi64(0x04, r2_lo, IDS, r2_hi), \
+  0xfe), _mm256_maskz_permutex2var_epi64(0x08, r3_lo, IDS, r3_hi))
+      const __m256i t1_lo = PI_VL(T1_IDS),
+                    t2_lo = PI_VL(T2_IDS),
+                    t3_lo = PI_VL(T3_IDS),
+                    t4_lo = PI_VL(T4_IDS);
+#undef PI_VL
+
+      // column 4 of rows 0-4
+      const __m256i t0_hi = _mm256_permutex2var_epi64(r4_lo, H0_IDS, r4_hi),
+                    t1_hi = _mm256_permutex2var_epi64(r4_lo, H1_IDS, r4_hi),
+                    t2_hi = _mm256_permutex2var_epi64(r4_lo, H2_IDS, r4_hi),
+                    t3_hi = _mm256_permutex2var_epi64(r4_lo, H3_IDS, r4_hi),
+                    t4_hi = _mm256_permutex2var_epi64(r4_lo, H4_IDS, r4_hi);
 
       // store rows
-      r0 = t0;
-      r1 = t1;
-      r2 = t2;
-      r3 = t3;
-      r4 = t4;
+      r0_lo = t0_lo; r0_hi = t0_hi;
+      r1_lo = t1_lo; r1_hi = t1_hi;
+      r2_lo = t2_lo; r2_hi = t2_hi;
+      r3_lo = t3_lo; r3_hi = t3_hi;
+      r4_lo = t4_lo; r4_hi = t4_hi;
     }
 
     // chi
     {
       // permute ids
-      static const __m512i P0 = { 1, 2, 3, 4, 0 },
-                           P1 = { 2, 3, 4, 0, 1 };
-
-      {
-        // r0 ^= ~e0 & e1
-        const __m512i t0_e0 = _mm512_maskz_permutexvar_epi64(0x1f, P0, r0),
-                      t0_e1 = _mm512_maskz_permutexvar_epi64(0x1f, P1, r0);
-        r0 = _mm512_maskz_ternarylogic_epi64(0x1f, r0, t0_e0, t0_e1, 0xd2);
-      }
-
-      {
-        // r1 ^= ~e0 & e1
-        const __m512i t1_e0 = _mm512_maskz_permutexvar_epi64(0x1f, P0, r1),
-                      t1_e1 = _mm512_maskz_permutexvar_epi64(0x1f, P1, r1);
-        r1 = _mm512_maskz_ternarylogic_epi64(0x1f, r1, t1_e0, t1_e1, 0xd2);
-      }
-
-      {
-        // r2 ^= ~e0 & e1
-        const __m512i t2_e0 = _mm512_maskz_permutexvar_epi64(0x1f, P0, r2),
-                      t2_e1 = _mm512_maskz_permutexvar_epi64(0x1f, P1, r2);
-        r2 = _mm512_maskz_ternarylogic_epi64(0x1f, r2, t2_e0, t2_e1, 0xd2);
-      }
-
-      {
-        // r3 ^= ~e0 & e1
-        const __m512i t3_e0 = _mm512_maskz_permutexvar_epi64(0x1f, P0, r3),
-                      t3_e1 = _mm512_maskz_permutexvar_epi64(0x1f, P1, r3);
-        r3 = _mm512_maskz_ternarylogic_epi64(0x1f, r3, t3_e0, t3_e1, 0xd2);
-      }
-
-      {
-        // r4 ^= ~e0 & e1
-        const __m512i t4_e0 = _mm512_maskz_permutexvar_epi64(0x1f, P0, r4),
-                      t4_e1 = _mm512_maskz_permutexvar_epi64(0x1f, P1, r4);
-        r4 = _mm512_maskz_ternarylogic_epi64(0x1f, r4, t4_e0, t4_e1, 0xd2);
-      }
+      static const __m256i P0 = { 1, 2, 3, 4 },
+                           P1 = { 2, 3, 4, 0 };
+
+      // row ^= ~e0 & e1
+#define CHI_VL(LO, HI) do { \
+  const __m256i e0_lo = _mm256_permutex2var_epi64(LO, P0, HI), \
+                e1_lo = _mm256_permutex2var_epi64(LO, P1, HI), \
+                e1_hi = _mm256_shuffle_epi32(LO, 0x0e); \
+  HI = _mm256_ternarylogic_epi64(HI, LO, e1_hi, 0xd2); \
+  LO = _mm256_ternarylogic_epi64(LO, e0_lo, e1_lo, 0xd2); \
+} while (0)
+      CHI_VL(r0_lo, r0_hi); // r0
+      CHI_VL(r1_lo, r1_hi); // r1
+      CHI_VL(r2_lo, r2_hi); // r2
+      CHI_VL(r3_lo, r3_hi); // r3
+      CHI_VL(r4_lo, r4_hi); // r4
+#undef CHI_VL
     }
 
     // iota
     {
       // xor round constant to first cell
-      r0 = _mm512_mask_xor_epi64(r0, 1, r0, _mm512_maskz_loadu_epi64(1, RCS + i));
+      r0_lo = _mm256_mask_xor_epi64(r0_lo, 1, r0_lo, _mm256_maskz_loadu_epi64(1, RCS + i));
     }
   }
 
   // store rows
-  _mm512_mask_storeu_epi64(s + 5 * 0, 0x1f, r0);
-  _mm512_mask_storeu_epi64(s + 5 * 1, 0x1f, r1);
-  _mm512_mask_storeu_epi64(s + 5 * 2, 0x1f, r2);
-  _mm512_mask_storeu_epi64(s + 5 * 3, 0x1f, r3);
-  _mm512_mask_storeu_epi64(s + 5 * 4, 0x1f, r4);
-}
+  _mm256_storeu_si256((__m256i*) (s +  0), r0_lo); /* row 0, cols 0-3 */
+  _mm256_storeu_si256((__m256i*) (s +  5), r1_lo); /* row 1, cols 0-3 */
+  _mm256_storeu_si256((__m256i*) (s + 10), r2_lo); /* row 2, cols 0-3 */
+  _mm256_storeu_si256((__m256i*) (s + 15), r3_lo); /* row 3, cols 0-3 */
+  _mm256_storeu_si256((__m256i*) (s + 20), r4_lo); /* row 4, cols 0-3 */
+  _mm256_mask_storeu_epi64(s +  4, 1, r0_hi); /* row 0, col 4 */
+  _mm256_mask_storeu_epi64(s +  9, 1, r1_hi); /* row 1, col 4 */
+  _mm256_mask_storeu_epi64(s + 14, 1, r2_hi); /* row 2, col 4 */
+  _mm256_mask_storeu_epi64(s + 19, 1, r3_hi); /* row 3, col 4 */
+  _mm256_mask_storeu_epi64(s + 24, 1, r4_hi); /* row 4, col 4 */
+}
+#endif /* __AVX512VL__ */
 #endif /* BACKEND == BACKEND_AVX512 */
 
 #if BACKEND == BACKEND_AVX2
@@ -1512,38 +2305,815 @@ static inline void permute_n_hybrid(uint64_t a[static 25], const size_t num_roun
 }
 #endif /* (BACKEND == BACKEND_HYBRID) */
 
-// map permute_n() to active backend
-#if BACKEND == BACKEND_AVX512
-#define permute_n permute_n_avx512 // use avx512 backend
-#elif BACKEND == BACKEND_AVX2
-#define permute_n permute_n_avx2 // use AVX2 backend
-#elif BACKEND == BACKEND_NEON
-#define permute_n permute_n_neon // use neon backend
-#elif BACKEND == BACKEND_DIET_NEON
-#define permute_n permute_n_diet_neon // use diet-neon backend
-#elif BACKEND == BACKEND_HYBRID
-#define permute_n permute_n_hybrid // use hybrid backend
-#elif BACKEND == BACKEND_SCALAR
-#define permute_n permute_n_scalar // use scalar backend
-#else
-#error "unknown sha3 backend"
-#endif /* BACKEND */
+#if BACKEND == BACKEND_NEON_SHA3
+#include <arm_neon.h>
 
-/**
- * @brief 24 round Keccak permutation.
- * @param[in,out] a Keccak state (array of 25 64-bit integers).
- */
-static inline void permute_24(uint64_t s[static 25]) {
-  permute_n(s, 24);
-}
+// The neon-sha3 backend uses the ARMv8.2 SHA3 extension instructions
+// (EOR3, RAX1, XAR, and BCAX), which provide the three-way XOR,
+// rotate-and-XOR, and and-not-XOR operations that plain Neon lacks.
+//
+// Each of the 25 lanes of the Keccak state is stored in its own 128-bit
+// register, with one Keccak state per 64-bit lane of the register, so
+// there are no shuffles; the 128-bit registers are used like 64-bit
+// scalar registers which happen to hold two states at once.  The
+// single-state permutation uses the same kernel with both 64-bit lanes
+// holding the same state.
 
 /**
- * @brief 12 round Keccak permutation.
- * @param[in,out] a Keccak state (array of 25 64-bit integers).
- * @note Only used by TurboSHAKE and KangarooTwelve.
+ * @brief Fused neon-sha3 Keccak round.
+ *
+ * Same as `SCALAR_ROUND()`, but for 25 local `uint64x2_t` lane
+ * variables, using EOR3 for the theta column parity, RAX1 for the theta
+ * `c[x-1] ^ rol(c[x+1], 1)` step, XAR for the theta XOR and the rho
+ * rotate (XAR rotates right, so each rho offset `n` becomes `64 - n`),
+ * and BCAX for chi.
+ *
+ * @param[in] s Prefix of source lane variables.
+ * @param[out] d Prefix of destination lane variables.
+ * @param[in] rc Iota round constant (`uint64x2_t`).
  */
-static inline void permute_12(uint64_t s[static 25]) {
-  permute_n(s, 12);
+#define NEON_SHA3_ROUND(s, d, rc) do { \
+  /* theta */ \
+  const uint64x2_t c0 = veor3q_u64(veor3q_u64(s ## 00, s ## 05, s ## 10), s ## 15, s ## 20), \
+                   c1 = veor3q_u64(veor3q_u64(s ## 01, s ## 06, s ## 11), s ## 16, s ## 21), \
+                   c2 = veor3q_u64(veor3q_u64(s ## 02, s ## 07, s ## 12), s ## 17, s ## 22), \
+                   c3 = veor3q_u64(veor3q_u64(s ## 03, s ## 08, s ## 13), s ## 18, s ## 23), \
+                   c4 = veor3q_u64(veor3q_u64(s ## 04, s ## 09, s ## 14), s ## 19, s ## 24); \
+  const uint64x2_t t0 = vrax1q_u64(c4, c1), \
+                   t1 = vrax1q_u64(c0, c2), \
+                   t2 = vrax1q_u64(c1, c3), \
+                   t3 = vrax1q_u64(c2, c4), \
+                   t4 = vrax1q_u64(c3, c0); \
+  \
+  /* rho, pi, chi, and iota: row 0 */ \
+  { \
+    const uint64x2_t b0 = veorq_u64(s ## 00, t0), \
+                     b1 = vxarq_u64(s ## 06, t1, 20), \
+                     b2 = vxarq_u64(s ## 12, t2, 21), \
+                     b3 = vxarq_u64(s ## 18, t3, 43), \
+                     b4 = vxarq_u64(s ## 24, t4, 50); \
+    d ## 00 = veorq_u64(vbcaxq_u64(b0, b2, b1), (rc)); \
+    d ## 01 = vbcaxq_u64(b1, b3, b2); \
+    d ## 02 = vbcaxq_u64(b2, b4, b3); \
+    d ## 03 = vbcaxq_u64(b3, b0, b4); \
+    d ## 04 = vbcaxq_u64(b4, b1, b0); \
+  } \
+  \
+  /* rho, pi, and chi: row 1 */ \
+  { \
+    const uint64x2_t b0 = vxarq_u64(s ## 03, t3, 36), \
+                     b1 = vxarq_u64(s ## 09, t4, 44), \
+                     b2 = vxarq_u64(s ## 10, t0, 61), \
+                     b3 = vxarq_u64(s ## 16, t1, 19), \
+                     b4 = vxarq_u64(s ## 22, t2,  3); \
+    d ## 05 = vbcaxq_u64(b0, b2, b1); \
+    d ## 06 = vbcaxq_u64(b1, b3, b2); \
+    d ## 07 = vbcaxq_u64(b2, b4, b3); \
+    d ## 08 = vbcaxq_u64(b3, b0, b4); \
+    d ## 09 = vbcaxq_u64(b4, b1, b0); \
+  } \
+  \
+  /* rho, pi, and chi: row 2 */ \
+  { \
+    const uint64x2_t b0 = vxarq_u64(s ## 01, t1, 63), \
+                     b1 = vxarq_u64(s ## 07, t2, 58), \
+                     b2 = vxarq_u64(s ## 13, t3, 39), \
+                     b3 = vxarq_u64(s ## 19, t4, 56), \
+                     b4 = vxarq_u64(s ## 20, t0, 46); \
+    d ## 10 = vbcaxq_u64(b0, b2, b1); \
+    d ## 11 = vbcaxq_u64(b1, b3, b2); \
+    d ## 12 = vbcaxq_u64(b2, b4, b3); \
+    d ## 13 = vbcaxq_u64(b3, b0, b4); \
+    d ## 14 = vbcaxq_u64(b4, b1, b0); \
+  } \
+  \
+  /* rho, pi, and chi: row 3 */ \
+  { \
+    const uint64x2_t b0 = vxarq_u64(s ## 04, t4, 37), \
+                     b1 = vxarq_u64(s ## 05, t0, 28), \
+                     b2 = vxarq_u64(s ## 11, t1, 54), \
+                     b3 = vxarq_u64(s ## 17, t2, 49), \
+                     b4 = vxarq_u64(s ## 23, t3,  8); \
+    d ## 15 = vbcaxq_u64(b0, b2, b1); \
+    d ## 16 = vbcaxq_u64(b1, b3, b2); \
+    d ## 17 = vbcaxq_u64(b2, b4, b3); \
+    d ## 18 = vbcaxq_u64(b3, b0, b4); \
+    d ## 19 = vbcaxq_u64(b4, b1, b0); \
+  } \
+  \
+  /* rho, pi, and chi: row 4 */ \
+  { \
+    const uint64x2_t b0 = vxarq_u64(s ## 02, t2,  2), \
+                     b1 = vxarq_u64(s ## 08, t3,  9), \
+                     b2 = vxarq_u64(s ## 14, t4, 25), \
+                     b3 = vxarq_u64(s ## 15, t0, 23), \
+                     b4 = vxarq_u64(s ## 21, t1, 62); \
+    d ## 20 = vbcaxq_u64(b0, b2, b1); \
+    d ## 21 = vbcaxq_u64(b1, b3, b2); \
+    d ## 22 = vbcaxq_u64(b2, b4, b3); \
+    d ## 23 = vbcaxq_u64(b3, b0, b4); \
+    d ## 24 = vbcaxq_u64(b4, b1, b0); \
+  } \
+} while (0)
+
+/**
+ * @brief Two-state neon-sha3 Keccak permutation.
+ *
+ * Apply `num_rounds` of Keccak permutation to two independent Keccak
+ * states.  State `a` is stored in the low 64-bit lane and state `b` in
+ * the high 64-bit lane of each register.
+ *
+ * @param[in,out] a First Keccak state (array of 25 64-bit integers).
+ * @param[in,out] b Second Keccak state (array of 25 64-bit integers).
+ * @param[in] num_rounds Number of rounds (12 or 24).  Must be even.
+ */
+static inline void permute_n_neon_sha3_x2(uint64_t a[static 25], uint64_t b[static 25], const size_t num_rounds) {
+  // load lane N of both states into register sN
+#define NEON_SHA3_LOAD(N) vcombine_u64(vld1_u64(a + (N)), vld1_u64(b + (N)))
+  uint64x2_t s00 = NEON_SHA3_LOAD( 0), s01 = NEON_SHA3_LOAD( 1), s02 = NEON_SHA3_LOAD( 2), s03 = NEON_SHA3_LOAD( 3), s04 = NEON_SHA3_LOAD( 4),
+             s05 = NEON_SHA3_LOAD( 5), s06 = NEON_SHA3_LOAD( 6), s07 = NEON_SHA3_LOAD( 7), s08 = NEON_SHA3_LOAD( 8), s09 = NEON_SHA3_LOAD( 9),
+             s10 = NEON_SHA3_LOAD(10), s11 = NEON_SHA3_LOAD(11), s12 = NEON_SHA3_LOAD(12), s13 = NEON_SHA3_LOAD(13), s14 = NEON_SHA3_LOAD(14),
+             s15 = NEON_SHA3_LOAD(15), s16 = NEON_SHA3_LOAD(16), s17 = NEON_SHA3_LOAD(17), s18 = NEON_SHA3_LOAD(18), s19 = NEON_SHA3_LOAD(19),
+             s20 = NEON_SHA3_LOAD(20), s21 = NEON_SHA3_LOAD(21), s22 = NEON_SHA3_LOAD(22), s23 = NEON_SHA3_LOAD(23), s24 = NEON_SHA3_LOAD(24);
+#undef NEON_SHA3_LOAD
+  uint64x2_t e00, e01, e02, e03, e04, e05, e06, e07, e08, e09, e10, e11, e12,
+             e13, e14, e15, e16, e17, e18, e19, e20, e21, e22, e23, e24;
+
+  // loop over rounds (two rounds per iteration)
+  for (size_t i = (SHA3_NUM_ROUNDS - num_rounds); __builtin_expect(i < SHA3_NUM_ROUNDS, 1); i += 2) {
+    NEON_SHA3_ROUND(s, e, vdupq_n_u64(RCS[i]));
+    NEON_SHA3_ROUND(e, s, vdupq_n_u64(RCS[i + 1]));
+  }
+
+  // store low lanes to `a` and high lanes to `b`.  when `a` and `b`
+  // are the same state (see `permute_n_neon_sha3()`), both stores write
+  // the same value
+#define NEON_SHA3_STORE(N, V) do { \
+  vst1_u64(a + (N), vget_low_u64(V)); \
+  vst1_u64(b + (N), vget_high_u64(V)); \
+} while (0)
+  NEON_SHA3_STORE(0, s00); NEON_SHA3_STORE(1, s01); NEON_SHA3_STORE(2, s02); NEON_SHA3_STORE(3, s03); NEON_SHA3_STORE(4, s04);
+  NEON_SHA3_STORE(5, s05); NEON_SHA3_STORE(6, s06); NEON_SHA3_STORE(7, s07); NEON_SHA3_STORE(8, s08); NEON_SHA3_STORE(9, s09);
+  NEON_SHA3_STORE(10, s10); NEON_SHA3_STORE(11, s11); NEON_SHA3_STORE(12, s12); NEON_SHA3_STORE(13, s13); NEON_SHA3_STORE(14, s14);
+  NEON_SHA3_STORE(15, s15); NEON_SHA3_STORE(16, s16); NEON_SHA3_STORE(17, s17); NEON_SHA3_STORE(18, s18); NEON_SHA3_STORE(19, s19);
+  NEON_SHA3_STORE(20, s20); NEON_SHA3_STORE(21, s21); NEON_SHA3_STORE(22, s22); NEON_SHA3_STORE(23, s23); NEON_SHA3_STORE(24, s24);
+#undef NEON_SHA3_STORE
+}
+
+/**
+ * @brief neon-sha3 Keccak permutation.
+ *
+ * Single-state wrapper around `permute_n_neon_sha3_x2()`, with both
+ * 64-bit lanes of each register holding the same state.  This costs the
+ * same number of instructions as a single-lane kernel.
+ *
+ * @param[in,out] s Keccak state (array of 25 64-bit integers).
+ * @param[in] num_rounds Number of rounds (12 or 24).  Must be even.
+ */
+static inline void permute_n_neon_sha3(uint64_t s[static 25], const size_t num_rounds) {
+  permute_n_neon_sha3_x2(s, s, num_rounds);
+}
+#endif /* BACKEND == BACKEND_NEON_SHA3 */
+
+// map permute_n() to active backend
+#if BACKEND == BACKEND_AVX512
+#define permute_n permute_n_avx512 // use avx512 backend
+#elif BACKEND == BACKEND_AVX2
+#define permute_n permute_n_avx2 // use AVX2 backend
+#elif BACKEND == BACKEND_NEON
+#define permute_n permute_n_neon // use neon backend
+#elif BACKEND == BACKEND_DIET_NEON
+#define permute_n permute_n_diet_neon // use diet-neon backend
+#elif BACKEND == BACKEND_HYBRID
+#define permute_n permute_n_hybrid // use hybrid backend
+#elif (BACKEND == BACKEND_SCALAR) || (BACKEND == BACKEND_SCALAR_X2)
+#define permute_n permute_n_scalar // use scalar backend
+#elif BACKEND == BACKEND_LCOMP
+#define permute_n permute_n_lcomp // use lane-complementing scalar backend
+#elif BACKEND == BACKEND_BI32
+#define permute_n permute_n_bi32 // use bit-interleaved 32-bit backend
+#elif BACKEND == BACKEND_NEON_SHA3
+#define permute_n permute_n_neon_sha3 // use neon-sha3 backend
+#else
+#error "unknown sha3 backend"
+#endif /* BACKEND */
+
+// Fixed round count kernels.
+//
+// Callers only ever use 24 rounds (SHA-3, SHAKE, and friends) or 12
+// rounds (TurboSHAKE and KangarooTwelve), so the 24 and 12 round
+// wrappers below are built as separate out-of-line functions with the
+// backend permutation flattened into them.  This gives each backend one
+// kernel per round count where the number of rounds is a compile-time
+// constant, so the compiler can unroll the round loop and fold the
+// round constant loads, instead of one generic kernel with a runtime
+// loop bound.
+#define PERMUTE_FIXED __attribute__((noinline, flatten))
+
+#if BACKEND == BACKEND_AVX2
+// On the avx2 backend the flattened single-state kernels are slower
+// than the generic kernel (about 5% for 24 rounds), so `permute_24()`
+// and `permute_12()` are not specialized.  The multi-buffer kernels
+// are still specialized.
+#define PERMUTE_FIXED_SINGLE inline
+#else
+#define PERMUTE_FIXED_SINGLE PERMUTE_FIXED
+#endif /* BACKEND == BACKEND_AVX2 */
+
+#if (BACKEND == BACKEND_AVX512) && defined(__AVX512VL__)
+// Run-time switch between the 512-bit (zmm) avx512 permutation and the
+// 256-bit (ymm) AVX-512VL permutation.  When set, the 512-bit
+// multi-buffer kernel is also replaced by a 4-way 256-bit multi-buffer
+// kernel, so no zmm instructions are executed.  Set with
+// `sha3_avx512_ymm()`.
+#define AVX512_YMM
+static _Bool avx512_ymm = false;
+#endif /* (BACKEND == BACKEND_AVX512) && defined(__AVX512VL__) */
+
+/**
+ * @brief 24 round Keccak permutation.
+ * @param[in,out] a Keccak state (array of 25 64-bit integers).
+ */
+static PERMUTE_FIXED_SINGLE void permute_24(uint64_t s[static 25]) {
+#ifdef AVX512_YMM
+  if (avx512_ymm) {
+    permute_n_avx512vl(s, 24);
+    return;
+  }
+#endif /* AVX512_YMM */
+  permute_n(s, 24);
+}
+
+/**
+ * @brief 12 round Keccak permutation.
+ * @param[in,out] a Keccak state (array of 25 64-bit integers).
+ * @note Only used by TurboSHAKE and KangarooTwelve.
+ */
+static PERMUTE_FIXED_SINGLE void permute_12(uint64_t s[static 25]) {
+#if BACKEND == BACKEND_BI32
+  // the cost of interleaving and de-interleaving the state is only
+  // recovered over more than 12 rounds (i686 static instruction
+  // counts: scalar ~11.9k, bi32 ~12.5k), so use the scalar kernel
+  permute_n_scalar(s, 12);
+#else
+#ifdef AVX512_YMM
+  if (avx512_ymm) {
+    permute_n_avx512vl(s, 12);
+    return;
+  }
+#endif /* AVX512_YMM */
+  permute_n(s, 12);
+#endif /* BACKEND == BACKEND_BI32 */
+}
+
+/**
+ * @brief Apply single Keccak round to state.
+ *
+ * Apply round `i` of the Keccak permutation to state `a` with
+ * SCALAR_ROUND().
+ *
+ * Used by `permute_any()` for the first round of an odd number of
+ * rounds, because several backends (scalar, scalar-x2, and neon-sha3)
+ * unroll the round loop two rounds at a time.
+ *
+ * @param[in,out] a Keccak state (array of 25 64-bit integers).
+ * @param[in] i Round index.
+ */
+static inline void permute_round(uint64_t a[static 25], const size_t i) {
+  const uint64_t a00 = a[ 0], a01 = a[ 1], a02 = a[ 2], a03 = a[ 3], a04 = a[ 4],
+                 a05 = a[ 5], a06 = a[ 6], a07 = a[ 7], a08 = a[ 8], a09 = a[ 9],
+                 a10 = a[10], a11 = a[11], a12 = a[12], a13 = a[13], a14 = a[14],
+                 a15 = a[15], a16 = a[16], a17 = a[17], a18 = a[18], a19 = a[19],
+                 a20 = a[20], a21 = a[21], a22 = a[22], a23 = a[23], a24 = a[24];
+  uint64_t e00, e01, e02, e03, e04, e05, e06, e07, e08, e09, e10, e11, e12,
+           e13, e14, e15, e16, e17, e18, e19, e20, e21, e22, e23, e24;
+
+  SCALAR_ROUND(a, e, RCS[i]);
+
+  a[ 0] = e00; a[ 1] = e01; a[ 2] = e02; a[ 3] = e03; a[ 4] = e04;
+  a[ 5] = e05; a[ 6] = e06; a[ 7] = e07; a[ 8] = e08; a[ 9] = e09;
+  a[10] = e10; a[11] = e11; a[12] = e12; a[13] = e13; a[14] = e14;
+  a[15] = e15; a[16] = e16; a[17] = e17; a[18] = e18; a[19] = e19;
+  a[20] = e20; a[21] = e21; a[22] = e22; a[23] = e23; a[24] = e24;
+}
+
+/**
+ * @brief Keccak permutation with any number of rounds.
+ *
+ * Apply the last `num_rounds` rounds of the Keccak permutation with the
+ * generic (non-fixed) kernel.  Handles odd round counts by applying the
+ * first round with `permute_round()`.
+ *
+ * Used by `keccak_p1600()` and `permute_batch()` for round counts
+ * other than 12 and 24.
+ *
+ * @param[in,out] s Keccak state (array of 25 64-bit integers).
+ * @param[in] num_rounds Number of rounds (0 to 24).
+ */
+static inline void permute_any(uint64_t s[static 25], const size_t num_rounds) {
+  if (num_rounds & 1) {
+    // apply first round of odd round count, leaving an even number of
+    // rounds for permute_n()
+    permute_round(s, SHA3_NUM_ROUNDS - num_rounds);
+  }
+
+  if (num_rounds > 1) {
+#ifdef AVX512_YMM
+    if (avx512_ymm) {
+      permute_n_avx512vl(s, num_rounds & ~1U);
+      return;
+    }
+#endif /* AVX512_YMM */
+    permute_n(s, num_rounds & ~1U);
+  }
+}
+
+// Multi-buffer permutation.
+//
+// The multi-buffer kernel permutes MB_NUM_LANES independent Keccak
+// states at once.  The states are stored in an array of `sha3_state_t`
+// and are transposed on load so that register `i` holds word `i` of
+// every state (one state per 64-bit lane).  This layout needs no
+// shuffles in the theta, rho, pi, or chi steps, so the cost of a round
+// is roughly the same as one scalar round.
+//
+// If `MB_HYBRID` is defined (`make MB_HYBRID=1`), then the avx512 and
+// avx2 multi-buffer kernels permute one extra state in general purpose
+// registers, with its scalar rounds interleaved between the vector
+// rounds, so the integer ports have work while the vector ports are
+// busy.  This gives a 9-way (avx512) or 5-way (avx2) kernel.
+//
+// The two-state scalar backend has no vector registers, so its
+// "multi-buffer" kernel is `permute_n_x2()`, which permutes two states
+// with their scalar instructions interleaved.
+//
+// The neon-sha3 backend keeps one state in each 64-bit lane of its
+// 128-bit registers, so its multi-buffer kernel is
+// `permute_n_neon_sha3_x2()` with two different states.
+//
+// Backends without a multi-buffer kernel fall back to permuting each
+// state with `permute_n()`.
+#if BACKEND == BACKEND_AVX512
+#define MB_VEC_LANES 8 // number of lanes (states) in multi-buffer registers
+typedef __m512i mb_vec_t; // multi-buffer register (one word of each state)
+
+// rotate left immediate
+#define MB_ROL(v, n) _mm512_rol_epi64((v), (n))
+
+// broadcast 64-bit value to all lanes
+#define MB_SET1(v) _mm512_set1_epi64(v)
+#elif BACKEND == BACKEND_AVX2
+#define MB_VEC_LANES 4 // number of lanes (states) in multi-buffer registers
+typedef __m256i mb_vec_t; // multi-buffer register (one word of each state)
+
+// rotate left immediate
+#define MB_ROL(v, n) AVX2_ROLI((v), (n))
+
+// broadcast 64-bit value to all lanes
+#define MB_SET1(v) _mm256_set1_epi64x(v)
+#elif BACKEND == BACKEND_SCALAR_X2
+#define MB_NUM_LANES 2 // two-state interleaved scalar kernel
+#elif BACKEND == BACKEND_NEON_SHA3
+#define MB_NUM_LANES 2 // two states per 128-bit neon register
+#else
+#define MB_NUM_LANES 1 // no multi-buffer kernel
+#endif /* BACKEND */
+
+#ifdef MB_VEC_LANES
+#ifdef MB_HYBRID
+#define MB_NUM_LANES (MB_VEC_LANES + 1) // vector lanes plus one scalar lane
+#else
+#define MB_NUM_LANES MB_VEC_LANES // number of lanes (states) in multi-buffer kernel
+#endif /* MB_HYBRID */
+#endif /* MB_VEC_LANES */
+
+#if (BACKEND == BACKEND_AVX512) || (BACKEND == BACKEND_AVX2)
+/**
+ * @brief Load first `n` Keccak states from `s` into multi-buffer
+ * registers.
+ *
+ * Lanes greater than or equal to `n` are zero.
+ *
+ * @param[out] a Multi-buffer registers.
+ * @param[in] s Array of Keccak states.
+ * @param[in] n Number of states (1 to MB_VEC_LANES).
+ */
+static inline void mb_load(mb_vec_t a[static 25], const sha3_state_t * const s, const size_t n) {
+#if BACKEND == BACKEND_AVX512
+  // gather word i of states 0-7 (stride 25 words) into register i
+  static const __m512i IDS = { 0, 25, 50, 75, 100, 125, 150, 175 };
+  const __mmask8 mask = (1 << n) - 1;
+  for (size_t i = 0; i < 25; i++) {
+    a[i] = _mm512_mask_i64gather_epi64(_mm512_setzero_si512(), mask, IDS, (const long long*) (s->u64 + i), 8);
+  }
+#elif BACKEND == BACKEND_AVX2
+  // gather word i of states 0-3 (stride 25 words) into register i
+  static const __m256i IDS = { 0, 25, 50, 75 };
+  const __m256i mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(n), _mm256_setr_epi64x(0, 1, 2, 3));
+  for (size_t i = 0; i < 25; i++) {
+    a[i] = _mm256_mask_i64gather_epi64(_mm256_setzero_si256(), (const long long*) (s->u64 + i), IDS, mask, 8);
+  }
+#endif /* BACKEND */
+}
+
+/**
+ * @brief Store multi-buffer registers to first `n` Keccak states of
+ * `s`.
+ *
+ * States greater than or equal to `n` are not written.
+ *
+ * @param[out] s Array of Keccak states.
+ * @param[in] a Multi-buffer registers.
+ * @param[in] n Number of states (1 to MB_VEC_LANES).
+ */
+static inline void mb_store(sha3_state_t * const s, const mb_vec_t a[static 25], const size_t n) {
+#if BACKEND == BACKEND_AVX512
+  // scatter register i to word i of states 0-7 (stride 25 words)
+  static const __m512i IDS = { 0, 25, 50, 75, 100, 125, 150, 175 };
+  const __mmask8 mask = (1 << n) - 1;
+  for (size_t i = 0; i < 25; i++) {
+    _mm512_mask_i64scatter_epi64((long long*) (s->u64 + i), mask, IDS, a[i], 8);
+  }
+#elif BACKEND == BACKEND_AVX2
+  // avx2 has no scatter, so extract lanes
+  for (size_t i = 0; i < 25; i++) {
+    uint64_t tmp[4] ALIGN(32);
+    _mm256_store_si256((__m256i*) tmp, a[i]);
+    for (size_t j = 0; j < n; j++) {
+      s[j].u64[i] = tmp[j];
+    }
+  }
+#endif /* BACKEND */
+}
+
+/**
+ * @brief Define multi-buffer Keccak round function.
+ *
+ * Defines a function `NAME()` which applies one round of Keccak
+ * permutation to every lane of the multi-buffer registers `a` (type
+ * `VEC`), using the rotate-left-immediate macro `ROL()` and the
+ * broadcast macro `SET1()`.
+ *
+ * Used to define `mb_round()` and, for the ymm mode of the avx512
+ * backend, `mb_ymm_round()`.
+ */
+#define DEF_MB_ROUND(NAME, VEC, ROL, SET1) \
+  static inline void NAME(VEC a[static 25], const uint64_t rc) { \
+    /* theta */ \
+    const VEC c0 = a[0] ^ a[5] ^ a[10] ^ a[15] ^ a[20], \
+              c1 = a[1] ^ a[6] ^ a[11] ^ a[16] ^ a[21], \
+              c2 = a[2] ^ a[7] ^ a[12] ^ a[17] ^ a[22], \
+              c3 = a[3] ^ a[8] ^ a[13] ^ a[18] ^ a[23], \
+              c4 = a[4] ^ a[9] ^ a[14] ^ a[19] ^ a[24]; \
+    const VEC d0 = c4 ^ ROL(c1, 1), \
+              d1 = c0 ^ ROL(c2, 1), \
+              d2 = c1 ^ ROL(c3, 1), \
+              d3 = c2 ^ ROL(c4, 1), \
+              d4 = c3 ^ ROL(c0, 1); \
+  \
+    /* rho and pi */ \
+    const VEC b0 = a[0] ^ d0, \
+              b1 = ROL(a[6] ^ d1, 44), \
+              b2 = ROL(a[12] ^ d2, 43), \
+              b3 = ROL(a[18] ^ d3, 21), \
+              b4 = ROL(a[24] ^ d4, 14), \
+              b5 = ROL(a[3] ^ d3, 28), \
+              b6 = ROL(a[9] ^ d4, 20), \
+              b7 = ROL(a[10] ^ d0, 3), \
+              b8 = ROL(a[16] ^ d1, 45), \
+              b9 = ROL(a[22] ^ d2, 61), \
+              b10 = ROL(a[1] ^ d1, 1), \
+              b11 = ROL(a[7] ^ d2, 6), \
+              b12 = ROL(a[13] ^ d3, 25), \
+              b13 = ROL(a[19] ^ d4, 8), \
+              b14 = ROL(a[20] ^ d0, 18), \
+              b15 = ROL(a[4] ^ d4, 27), \
+              b16 = ROL(a[5] ^ d0, 36), \
+              b17 = ROL(a[11] ^ d1, 10), \
+              b18 = ROL(a[17] ^ d2, 15), \
+              b19 = ROL(a[23] ^ d3, 56), \
+              b20 = ROL(a[2] ^ d2, 62), \
+              b21 = ROL(a[8] ^ d3, 55), \
+              b22 = ROL(a[14] ^ d4, 39), \
+              b23 = ROL(a[15] ^ d0, 41), \
+              b24 = ROL(a[21] ^ d1, 2); \
+  \
+    /* chi */ \
+    a[0] = b0 ^ (~b1 & b2); \
+    a[1] = b1 ^ (~b2 & b3); \
+    a[2] = b2 ^ (~b3 & b4); \
+    a[3] = b3 ^ (~b4 & b0); \
+    a[4] = b4 ^ (~b0 & b1); \
+  \
+    a[5] = b5 ^ (~b6 & b7); \
+    a[6] = b6 ^ (~b7 & b8); \
+    a[7] = b7 ^ (~b8 & b9); \
+    a[8] = b8 ^ (~b9 & b5); \
+    a[9] = b9 ^ (~b5 & b6); \
+  \
+    a[10] = b10 ^ (~b11 & b12); \
+    a[11] = b11 ^ (~b12 & b13); \
+    a[12] = b12 ^ (~b13 & b14); \
+    a[13] = b13 ^ (~b14 & b10); \
+    a[14] = b14 ^ (~b10 & b11); \
+  \
+    a[15] = b15 ^ (~b16 & b17); \
+    a[16] = b16 ^ (~b17 & b18); \
+    a[17] = b17 ^ (~b18 & b19); \
+    a[18] = b18 ^ (~b19 & b15); \
+    a[19] = b19 ^ (~b15 & b16); \
+  \
+    a[20] = b20 ^ (~b21 & b22); \
+    a[21] = b21 ^ (~b22 & b23); \
+    a[22] = b22 ^ (~b23 & b24); \
+    a[23] = b23 ^ (~b24 & b20); \
+    a[24] = b24 ^ (~b20 & b21); \
+  \
+    /* iota */ \
+    a[0] ^= SET1(rc); \
+  }
+
+DEF_MB_ROUND(mb_round, mb_vec_t, MB_ROL, MB_SET1) // mb_round()
+
+/**
+ * @brief Multi-buffer Keccak permutation.
+ *
+ * Apply `num_rounds` of Keccak permutation to the first `n` Keccak
+ * states of `s`.
+ *
+ * If `MB_HYBRID` is defined and `n` is `MB_NUM_LANES`, then the last
+ * state is permuted in general purpose registers with SCALAR_ROUND(),
+ * interleaved with the vector rounds of the other states.
+ *
+ * @param[in,out] s Array of Keccak states.
+ * @param[in] n Number of states (1 to MB_NUM_LANES).
+ * @param[in] num_rounds Number of rounds (12 or 24).
+ */
+static inline void permute_n_mb(sha3_state_t * const s, const size_t n, const size_t num_rounds) {
+  mb_vec_t a[25];
+  mb_load(a, s, MIN(n, MB_VEC_LANES));
+
+#ifdef MB_HYBRID
+  if (n > MB_VEC_LANES) {
+    // permute last state in general purpose registers
+    uint64_t * const x = s[MB_VEC_LANES].u64;
+    uint64_t x00 = x[ 0], x01 = x[ 1], x02 = x[ 2], x03 = x[ 3], x04 = x[ 4],
+             x05 = x[ 5], x06 = x[ 6], x07 = x[ 7], x08 = x[ 8], x09 = x[ 9],
+             x10 = x[10], x11 = x[11], x12 = x[12], x13 = x[13], x14 = x[14],
+             x15 = x[15], x16 = x[16], x17 = x[17], x18 = x[18], x19 = x[19],
+             x20 = x[20], x21 = x[21], x22 = x[22], x23 = x[23], x24 = x[24];
+    uint64_t y00, y01, y02, y03, y04, y05, y06, y07, y08, y09, y10, y11, y12,
+             y13, y14, y15, y16, y17, y18, y19, y20, y21, y22, y23, y24;
+
+    for (size_t i = (SHA3_NUM_ROUNDS - num_rounds); i < SHA3_NUM_ROUNDS; i += 2) {
+      mb_round(a, RCS[i]);
+      SCALAR_ROUND(x, y, RCS[i]);
+      mb_round(a, RCS[i + 1]);
+      SCALAR_ROUND(y, x, RCS[i + 1]);
+    }
+
+    x[ 0] = x00; x[ 1] = x01; x[ 2] = x02; x[ 3] = x03; x[ 4] = x04;
+    x[ 5] = x05; x[ 6] = x06; x[ 7] = x07; x[ 8] = x08; x[ 9] = x09;
+    x[10] = x10; x[11] = x11; x[12] = x12; x[13] = x13; x[14] = x14;
+    x[15] = x15; x[16] = x16; x[17] = x17; x[18] = x18; x[19] = x19;
+    x[20] = x20; x[21] = x21; x[22] = x22; x[23] = x23; x[24] = x24;
+
+    mb_store(s, a, MB_VEC_LANES);
+    return;
+  }
+#endif /* MB_HYBRID */
+
+  for (size_t i = (SHA3_NUM_ROUNDS - num_rounds); i < SHA3_NUM_ROUNDS; i++) {
+    mb_round(a, RCS[i]);
+  }
+
+  mb_store(s, a, MIN(n, MB_VEC_LANES));
+}
+
+/**
+ * @brief 24 round multi-buffer Keccak permutation.
+ *
+ * Fixed round count version of `permute_n_mb()`.  See the "Fixed round
+ * count kernels" comment above `permute_24()`.
+ *
+ * @param[in,out] s Array of Keccak states.
+ * @param[in] n Number of states (1 to MB_NUM_LANES).
+ */
+static PERMUTE_FIXED void permute_mb_24(sha3_state_t * const s, const size_t n) {
+  permute_n_mb(s, n, 24);
+}
+
+/**
+ * @brief 12 round multi-buffer Keccak permutation.
+ *
+ * Fixed round count version of `permute_n_mb()`.  See the "Fixed round
+ * count kernels" comment above `permute_24()`.
+ *
+ * On the avx512 backend, pairs of states (e.g. KangarooTwelve two-leaf
+ * tails) are permuted with `permute_n_avx512_x2()` instead, which skips
+ * the 8-lane transpose.  At 24 rounds the transpose cost is small
+ * relative to the rounds and the 8-way kernel is slightly faster, so
+ * `permute_mb_24()` does not do this.
+ *
+ * @param[in,out] s Array of Keccak states.
+ * @param[in] n Number of states (1 to MB_NUM_LANES).
+ */
+static PERMUTE_FIXED void permute_mb_12(sha3_state_t * const s, const size_t n) {
+#if BACKEND == BACKEND_AVX512
+  if (n == 2) {
+    permute_n_avx512_x2(s[0].u64, s[1].u64, 12);
+    return;
+  }
+#endif /* BACKEND == BACKEND_AVX512 */
+  permute_n_mb(s, n, 12);
+}
+
+#ifdef AVX512_YMM
+// 4-way multi-buffer kernel for the ymm mode of the avx512 backend.
+//
+// Same layout as the avx2 multi-buffer kernel (register `i` holds word
+// `i` of 4 states), but built with the 256-bit forms of the AVX-512VL
+// instructions: rotates are a single vprolq, and loads and stores use
+// masked gathers and scatters.  Used by `permute_batch()` when the
+// ymm permutation is enabled with `sha3_avx512_ymm()`, so batch
+// functions keep multi-buffer throughput without running any zmm
+// instructions.
+#define MB_YMM_LANES 4 // number of lanes (states) in ymm multi-buffer registers
+
+DEF_MB_ROUND(mb_ymm_round, __m256i, _mm256_rol_epi64, _mm256_set1_epi64x) // mb_ymm_round()
+
+/**
+ * @brief 4-way ymm multi-buffer Keccak permutation.
+ *
+ * Apply `num_rounds` of Keccak permutation to the first `n` Keccak
+ * states of `s` with `mb_ymm_round()`.
+ *
+ * @param[in,out] s Array of Keccak states.
+ * @param[in] n Number of states (1 to MB_YMM_LANES).
+ * @param[in] num_rounds Number of rounds (12 or 24).
+ */
+static inline void permute_n_mb_ymm(sha3_state_t * const s, const size_t n, const size_t num_rounds) {
+  // gather word i of states 0-3 (stride 25 words) into register i
+  static const __m256i IDS = { 0, 25, 50, 75 };
+  const __mmask8 mask = (1 << n) - 1;
+  __m256i a[25];
+  for (size_t i = 0; i < 25; i++) {
+    a[i] = _mm256_mmask_i64gather_epi64(_mm256_setzero_si256(), mask, IDS, (const long long*) (s->u64 + i), 8);
+  }
+
+  for (size_t i = (SHA3_NUM_ROUNDS - num_rounds); i < SHA3_NUM_ROUNDS; i++) {
+    mb_ymm_round(a, RCS[i]);
+  }
+
+  // scatter register i to word i of states 0-3 (stride 25 words)
+  for (size_t i = 0; i < 25; i++) {
+    _mm256_mask_i64scatter_epi64((long long*) (s->u64 + i), mask, IDS, a[i], 8);
+  }
+}
+
+/**
+ * @brief 24 round 4-way ymm multi-buffer Keccak permutation.
+ *
+ * Fixed round count version of `permute_n_mb_ymm()`.  See the "Fixed
+ * round count kernels" comment above `permute_24()`.
+ *
+ * @param[in,out] s Array of Keccak states.
+ * @param[in] n Number of states (1 to MB_YMM_LANES).
+ */
+static PERMUTE_FIXED void permute_mb_ymm_24(sha3_state_t * const s, const size_t n) {
+  permute_n_mb_ymm(s, n, 24);
+}
+
+/**
+ * @brief 12 round 4-way ymm multi-buffer Keccak permutation.
+ *
+ * Fixed round count version of `permute_n_mb_ymm()`.  See the "Fixed
+ * round count kernels" comment above `permute_24()`.
+ *
+ * @param[in,out] s Array of Keccak states.
+ * @param[in] n Number of states (1 to MB_YMM_LANES).
+ */
+static PERMUTE_FIXED void permute_mb_ymm_12(sha3_state_t * const s, const size_t n) {
+  permute_n_mb_ymm(s, n, 12);
+}
+#endif /* AVX512_YMM */
+#elif BACKEND == BACKEND_SCALAR_X2
+/**
+ * @brief 24 round two-state scalar Keccak permutation.
+ *
+ * Fixed round count wrapper for `permute_n_x2()`.  See the "Fixed
+ * round count kernels" comment above `permute_24()`.
+ *
+ * @param[in,out] s Array of Keccak states.
+ * @param[in] n Number of states (1 or 2).
+ */
+static PERMUTE_FIXED void permute_mb_24(sha3_state_t * const s, const size_t n) {
+  if (n == 2) {
+    permute_n_x2(s[0].u64, s[1].u64, 24);
+  } else {
+    permute_n_scalar(s[0].u64, 24);
+  }
+}
+
+/**
+ * @brief 12 round two-state scalar Keccak permutation.
+ *
+ * Fixed round count wrapper for `permute_n_x2()`.  See the "Fixed
+ * round count kernels" comment above `permute_24()`.
+ *
+ * @param[in,out] s Array of Keccak states.
+ * @param[in] n Number of states (1 or 2).
+ */
+static PERMUTE_FIXED void permute_mb_12(sha3_state_t * const s, const size_t n) {
+  if (n == 2) {
+    permute_n_x2(s[0].u64, s[1].u64, 12);
+  } else {
+    permute_n_scalar(s[0].u64, 12);
+  }
+}
+#elif BACKEND == BACKEND_NEON_SHA3
+/**
+ * @brief 24 round two-state neon-sha3 Keccak permutation.
+ *
+ * Fixed round count wrapper for `permute_n_neon_sha3_x2()`.  See the
+ * "Fixed round count kernels" comment above `permute_24()`.
+ *
+ * @param[in,out] s Array of Keccak states.
+ * @param[in] n Number of states (1 or 2).
+ */
+static PERMUTE_FIXED void permute_mb_24(sha3_state_t * const s, const size_t n) {
+  permute_n_neon_sha3_x2(s[0].u64, s[n - 1].u64, 24);
+}
+
+/**
+ * @brief 12 round two-state neon-sha3 Keccak permutation.
+ *
+ * Fixed round count wrapper for `permute_n_neon_sha3_x2()`.  See the
+ * "Fixed round count kernels" comment above `permute_24()`.
+ *
+ * @param[in,out] s Array of Keccak states.
+ * @param[in] n Number of states (1 or 2).
+ */
+static PERMUTE_FIXED void permute_mb_12(sha3_state_t * const s, const size_t n) {
+  permute_n_neon_sha3_x2(s[0].u64, s[n - 1].u64, 12);
+}
+#endif /* BACKEND */
+
+/**
+ * @brief Permute array of Keccak states.
+ *
+ * Apply `num_rounds` of Keccak permutation to each of the `n` Keccak
+ * states in `s`, using the multi-buffer kernel if one is available.
+ *
+ * @param[in,out] s Array of Keccak states.
+ * @param[in] n Number of states.
+ * @param[in] num_rounds Number of rounds (0 to 24).  12 and 24 rounds
+ * use the fixed round count kernels; other round counts permute each
+ * state with `permute_any()`.
+ */
+static inline void permute_batch(sha3_state_t * const s, const size_t n, const size_t num_rounds) {
+  size_t i = 0;
+#if MB_NUM_LANES > 1
+  const _Bool use_mb = (num_rounds == 24 || num_rounds == 12);
+
+#ifdef AVX512_YMM
+  if (use_mb && avx512_ymm) {
+    // permute groups of up to 4 states with ymm multi-buffer kernel
+    // instead of 512-bit multi-buffer kernel
+    for (; n - i > 1; i += MIN(n - i, MB_YMM_LANES)) {
+      if (num_rounds == 24) {
+        permute_mb_ymm_24(s + i, MIN(n - i, MB_YMM_LANES));
+      } else {
+        permute_mb_ymm_12(s + i, MIN(n - i, MB_YMM_LANES));
+      }
+    }
+  }
+#endif /* AVX512_YMM */
+
+  // permute groups of up to MB_NUM_LANES states with multi-buffer
+  // kernel (a single remaining state is faster with permute_n())
+  for (; use_mb && n - i > 1; i += MIN(n - i, MB_NUM_LANES)) {
+    if (num_rounds == 24) {
+      permute_mb_24(s + i, MIN(n - i, MB_NUM_LANES));
+    } else {
+      permute_mb_12(s + i, MIN(n - i, MB_NUM_LANES));
+    }
+  }
+#endif /* MB_NUM_LANES > 1 */
+
+  // permute remaining states
+  for (; i < n; i++) {
+    switch (num_rounds) {
+    case 24:
+      permute_24(s[i].u64);
+      break;
+    case 12:
+      permute_12(s[i].u64);
+      break;
+    default:
+      permute_any(s[i].u64, num_rounds);
+    }
+  }
 }
 
 /**
@@ -1715,6 +3285,32 @@ static inline size_t absorb_12(sha3_state_t * const a, size_t num_bytes, const s
 //
 #define RATE(len) (200 - 2 * (len))
 
+/**
+ * @brief Build padded state from message which fits in one block.
+ *
+ * Used by `hash_once()`, `xof_once()`, and `xof12_once()` when the
+ * message is shorter than the rate.  Copies the message into the
+ * state, clears the rest of the state, and appends the suffix and
+ * padding in the same pass, so the state is ready for the final
+ * permutation.
+ *
+ * @param[out] a Keccak state.
+ * @param[in] rate Rate of hash function.
+ * @param[in] pad Suffix and first padding bit.
+ * @param[in] m Pointer to input message.
+ * @param[in] m_len Length of input message, in bytes.  Must be less
+ * than `rate`.
+ */
+static inline void once_block(sha3_state_t * const a, const size_t rate, const uint8_t pad, const uint8_t * const m, const size_t m_len) {
+  if (m_len) {
+    // (m may be NULL when m_len is zero)
+    memcpy(a->u8, m, m_len);
+  }
+  memset(a->u8 + m_len, 0, sizeof(sha3_state_t) - m_len);
+  a->u8[m_len] = pad;
+  a->u8[rate - 1] ^= 0x80;
+}
+
 /**
  * @brief One-shot function which hashes the input message and writes
  * the digest to the destination buffer.
@@ -1728,18 +3324,25 @@ static inline size_t absorb_12(sha3_state_t * const a, size_t num_bytes, const s
  * determine the rate of the hash function.
  */
 static inline void hash_once(const uint8_t *m, size_t m_len, uint8_t * const dst, const size_t dst_len) {
-  // init state
-  sha3_state_t a = { .u64 = { 0 } };
+  sha3_state_t a;
 
-  // absorb message, get new internal length
-  const size_t len = absorb(&a, 0, RATE(dst_len), m, m_len);
+  if (m_len < RATE(dst_len)) {
+    // message fits in one block; build padded block directly
+    once_block(&a, RATE(dst_len), 0x06, m, m_len);
+  } else {
+    // init state
+    memset(&a, 0, sizeof(a));
 
-  // append suffix and padding
-  // (note: suffix and padding are ambiguous in spec)
-  a.u8[len] ^= 0x06;
-  a.u8[RATE(dst_len)-1] ^= 0x80;
+    // absorb message, get new internal length
+    const size_t len = absorb(&a, 0, RATE(dst_len), m, m_len);
 
-  // final permutation
+    // append suffix and padding
+    // (note: suffix and padding are ambiguous in spec)
+    a.u8[len] ^= 0x06;
+    a.u8[RATE(dst_len)-1] ^= 0x80;
+  }
+
+  // final permutation
   permute_24(a.u64);
 
   // copy to destination
@@ -1979,6 +3582,70 @@ static inline void xof_squeeze(sha3_xof_t * const xof, const size_t rate, const
   xof_squeeze_raw(xof, rate, dst, dst_len);
 }
 
+/**
+ * @brief Finalize absorb (if necessary) and then squeeze whole blocks
+ * from this XOF context.
+ *
+ * Used by `shake128_squeeze_blocks()` and `shake256_squeeze_blocks()`.
+ * Copies `num_blocks` rate-sized blocks straight from the state,
+ * permuting after each one.  Only valid at a block boundary, so the
+ * read byte count is never updated.
+ *
+ * @param[in,out] xof XOF context.
+ * @param[in] rate Rate of XOF function.
+ * @param[in] pad Padding byte of XOF function.
+ * @param[out] dst Pointer to destination buffer (`num_blocks * rate`
+ * bytes).  If `NULL`, the blocks are skipped.
+ * @param[in] num_blocks Number of blocks.
+ *
+ * @return False if a partial block has already been squeezed, and
+ * true otherwise.
+ */
+static inline bool xof_squeeze_blocks(sha3_xof_t * const xof, const size_t rate, const uint8_t pad, uint8_t *dst, const size_t num_blocks) {
+  // check state
+  if (!xof->squeezing) {
+    // finalize absorb
+    xof_absorb_done(xof, rate, pad);
+  } else if (xof->num_bytes) {
+    // not at a block boundary, return false
+    return false;
+  }
+
+  for (size_t i = 0; i < num_blocks; i++) {
+    if (dst) {
+      memcpy(dst, xof->a.u8, rate); // copy block
+      dst += rate;
+    }
+    permute_24(xof->a.u64); // permute state
+  }
+
+  // return success
+  return true;
+}
+
+/**
+ * @brief Finalize absorb (if necessary) and then get pointer to the
+ * current output block of this XOF context.
+ *
+ * Used by `shake128_peek_block()` and `shake256_peek_block()`.
+ *
+ * @param[in,out] xof XOF context.
+ * @param[in] rate Rate of XOF function.
+ * @param[in] pad Padding byte of XOF function.
+ *
+ * @return Pointer to `rate` bytes of output in the state, or `NULL` if
+ * a partial block has already been squeezed.
+ */
+static inline const uint8_t *xof_peek_block(sha3_xof_t * const xof, const size_t rate, const uint8_t pad) {
+  // check state
+  if (!xof->squeezing) {
+    // finalize absorb
+    xof_absorb_done(xof, rate, pad);
+  }
+
+  return xof->num_bytes ? NULL : xof->a.u8;
+}
+
 /**
  * @brief One-shot XOF absorb and squeeze.
  *
@@ -1990,13 +3657,22 @@ static inline void xof_squeeze(sha3_xof_t * const xof, const size_t rate, const
  * @param[out] dst_len Length of destination buffer, in bytes.
  */
 static inline void xof_once(const size_t rate, const uint8_t pad, const uint8_t * const src, const size_t src_len, uint8_t * const dst, const size_t dst_len) {
-  // init
   sha3_xof_t xof;
-  xof_init(&xof);
 
-  // absorb
-  xof_absorb_raw(&xof, rate, src, src_len);
-  xof_absorb_done(&xof, rate, pad);
+  if (src_len < rate) {
+    // message fits in one block; build padded block directly
+    once_block(&xof.a, rate, pad, src, src_len);
+    permute_24(xof.a.u64);
+    xof.num_bytes = 0;
+    xof.squeezing = true;
+  } else {
+    // init
+    xof_init(&xof);
+
+    // absorb
+    xof_absorb_raw(&xof, rate, src, src_len);
+    xof_absorb_done(&xof, rate, pad);
+  }
 
   // squeeze
   xof_squeeze_raw(&xof, rate, dst, dst_len);
@@ -2150,13 +3826,22 @@ static inline void xof12_squeeze(sha3_xof12_t * const xof, const size_t rate, co
  * @param[out] dst_len Length of destination buffer, in bytes.
  */
 static inline void xof12_once(const size_t rate, const uint8_t pad, const uint8_t * const src, const size_t src_len, uint8_t * const dst, const size_t dst_len) {
-  // init
   sha3_xof12_t xof;
-  xof12_init(&xof);
 
-  // absorb
-  xof12_absorb_raw(&xof, rate, src, src_len);
-  xof12_absorb_done(&xof, rate, pad);
+  if (src_len < rate) {
+    // message fits in one block; build padded block directly
+    once_block(&xof.a, rate, pad, src, src_len);
+    permute_12(xof.a.u64);
+    xof.num_bytes = 0;
+    xof.squeezing = true;
+  } else {
+    // init
+    xof12_init(&xof);
+
+    // absorb
+    xof12_absorb_raw(&xof, rate, src, src_len);
+    xof12_absorb_done(&xof, rate, pad);
+  }
 
   // squeeze
   xof12_squeeze_raw(&xof, rate, dst, dst_len);
@@ -2179,6 +3864,16 @@ static inline void xof12_once(const size_t rate, const uint8_t pad, const uint8_
     xof_squeeze(xof, SHAKE ## BITS ## _RATE, SHAKE_PAD, dst, dst_len); \
   } \
   \
+  /* squeeze whole blocks from shake context */ \
+  _Bool shake ## BITS ## _squeeze_blocks(sha3_xof_t * const xof, uint8_t * const dst, const size_t num_blocks) { \
+    return xof_squeeze_blocks(xof, SHAKE ## BITS ## _RATE, SHAKE_PAD, dst, num_blocks); \
+  } \
+  \
+  /* get current output block of shake context */ \
+  const uint8_t *shake ## BITS ## _peek_block(sha3_xof_t * const xof) { \
+    return xof_peek_block(xof, SHAKE ## BITS ## _RATE, SHAKE_PAD); \
+  } \
+  \
   /* one-shot shake absorb and squeeze */ \
   void shake ## BITS(const uint8_t * const src, const size_t src_len, uint8_t * const dst, const size_t dst_len) { \
     xof_once(SHAKE ## BITS ## _RATE, SHAKE_PAD, src, src_len, dst, dst_len); \
@@ -2190,991 +3885,3194 @@ static inline void xof12_once(const size_t rate, const uint8_t pad, const uint8_
 #define SHAKE256_RATE RATE(32) // shake256 input rate, in bytes
 
 // declare shake functions
-DEF_SHAKE(128) // shake128_{init,absorb,squeeze}()
-DEF_SHAKE(256) // shake256_{init,absorb,squeeze}()
+DEF_SHAKE(128) // shake128_{init,absorb,squeeze,squeeze_blocks,peek_block}()
+DEF_SHAKE(256) // shake256_{init,absorb,squeeze,squeeze_blocks,peek_block}()
 
-// define hmac-sha3 iterative context and one-shot functions
-#define DEF_HMAC(BITS, OUT_LEN) \
-  /* init hmac-sha3 context */ \
-  void hmac_sha3_ ## BITS ## _init(hmac_sha3_t *hmac, const uint8_t *k, const size_t k_len) { \
-    /* clear finalized flag */ \
-    hmac->finalized = false; \
-  \
-    /* init key buffer */ \
-    uint8_t k_buf[RATE(OUT_LEN)] = { 0 }; \
-    if (k_len <= sizeof(k_buf)) { \
-      memcpy(k_buf, k, k_len); \
-    } else { \
-      sha3_ ## BITS(k, k_len, k_buf); \
-    } \
-  \
-    /* apply opad */ \
-    for (size_t i = 0; i < RATE(OUT_LEN); i++) { \
-      k_buf[i] ^= 0x5c; \
-    } \
-  \
-    /* init outer hash, absorb outer key */ \
-    sha3_ ## BITS ## _init(&(hmac->outer)); \
-    sha3_ ## BITS ## _absorb(&(hmac->outer), k_buf, sizeof(k_buf)); \
-  \
-    /* remove opad, apply ipad */ \
-    for (size_t i = 0; i < RATE(OUT_LEN); i++) { \
-      k_buf[i] ^= (0x5c ^ 0x36); \
-    } \
-  \
-    /* init outer hash, absorb inner key */ \
-    sha3_ ## BITS ## _init(&(hmac->inner)); \
-    sha3_ ## BITS ## _absorb(&(hmac->inner), k_buf, sizeof(k_buf)); \
-  } \
-  \
-  /* absorb data into hmac-sha3 context */ \
-  _Bool hmac_sha3_ ## BITS ## _absorb(hmac_sha3_t *hmac, const uint8_t *src, const size_t len) { \
-    return sha3_ ## BITS ## _absorb(&(hmac->inner), src, len); \
-  } \
-  \
-  /* finalize hmac-sha3 context */ \
-  void hmac_sha3_ ## BITS ## _final(hmac_sha3_t *hmac, uint8_t dst[static OUT_LEN]) { \
-    /* finalize inner hash into buffer */ \
-    uint8_t buf[OUT_LEN] = { 0 }; \
-    sha3_ ## BITS ## _final(&(hmac->inner), buf); \
-  \
-    /* absorb into outer hash */ \
-    sha3_ ## BITS ## _absorb(&(hmac->outer), buf, sizeof(buf)); \
-  \
-    /* finalize outer hash into destination */ \
-    sha3_ ## BITS ## _final(&(hmac->outer), dst); \
-  } \
-  \
-  /* one-shot hmac-sha3 */ \
-  void hmac_sha3_ ## BITS(const uint8_t * const k, const size_t k_len, const uint8_t * const m, const size_t m_len, uint8_t dst[static OUT_LEN]) { \
-    /* init */ \
-    hmac_sha3_t hmac; \
-    hmac_sha3_## BITS ##_init(&hmac, k, k_len); \
-  \
-    /* absorb */ \
-    hmac_sha3_## BITS ##_absorb(&hmac, m, m_len); \
-  \
-    /* finalize */ \
-    hmac_sha3_## BITS ##_final(&hmac, dst); \
+// Multi-buffer sponge engine.
+//
+// Runs many independent sponge computations ("jobs") in lockstep: each
+// active lane absorbs one block, then all lanes are permuted together
+// with `permute_batch()`.  When a lane's input is exhausted it is
+// padded, permuted, squeezed, and immediately refilled with the next
+// job, so short jobs do not wait for the longest job in the batch.
+//
+// Jobs are fetched with a callback so that callers do not need to
+// allocate an array of jobs, and job input can optionally be split into
+// segments (e.g. encoded length prefixes followed by data) with a
+// second callback.
+
+// size of per-lane scratch buffer passed to segment callback, in bytes
+#define MB_SCRATCH_LEN 16
+
+/**
+ * @brief Multi-buffer sponge job.
+ */
+typedef struct {
+  const sha3_state_t *init; /**< Initial state (NULL for zero state) */
+  const uint8_t *src; /**< Input (if the engine has a segment callback, this is only used by the callback) */
+  size_t src_len; /**< Input length, in bytes */
+  const uint8_t *src2; /**< Second input (only used by segment callbacks) */
+  size_t src2_len; /**< Second input length, in bytes */
+  uint8_t *dst; /**< Output buffer */
+  size_t dst_len; /**< Output length, in bytes */
+} mb_job_t;
+
+/**
+ * @brief Multi-buffer sponge engine parameters.
+ */
+typedef struct {
+  size_t rate; /**< Sponge rate, in bytes */
+  size_t num_rounds; /**< Number of rounds (12 or 24) */
+  uint8_t pad; /**< Padding byte */
+
+  /** Populate `job` with job `job_id`. */
+  void (*get_job)(void *cb_data, size_t job_id, mb_job_t *job);
+
+  /**
+   * Get input segment `seg_id` of job `job_id`, or return false if
+   * there are no more segments (optional).  `job` is the job populated
+   * by `get_job`, so inputs fetched by `get_job` can be cached in it
+   * instead of being fetched again for every segment.  `scratch` is a
+   * per-lane buffer which stays valid until the next call for the same
+   * lane.
+   */
+  _Bool (*next_seg)(void *cb_data, const mb_job_t *job, size_t job_id, size_t seg_id, uint8_t scratch[static MB_SCRATCH_LEN], const uint8_t **ptr, size_t *len);
+
+  void *cb_data; /**< Callback data */
+} mb_params_t;
+
+/**
+ * @brief Multi-buffer sponge lane.
+ */
+typedef struct {
+  mb_job_t job; /**< Current job */
+  size_t job_id; /**< Current job ID */
+  size_t seg_id; /**< ID of next input segment */
+  const uint8_t *ptr; /**< Remaining bytes of current input segment */
+  size_t len; /**< Length of remaining bytes of current input segment */
+  uint8_t scratch[MB_SCRATCH_LEN]; /**< Segment scratch buffer */
+} mb_lane_t;
+
+/**
+ * @brief XOR bytes into Keccak state at given byte offset.
+ *
+ * @param[in,out] a Keccak state.
+ * @param[in] ofs Byte offset into state.
+ * @param[in] src Source buffer.
+ * @param[in] len Source buffer length, in bytes.
+ */
+static inline void mb_xor(sha3_state_t * const a, size_t ofs, const uint8_t *src, size_t len) {
+  // xor 8 byte words
+  if ((ofs & 7) == 0) {
+    for (; len >= 8; ofs += 8, src += 8, len -= 8) {
+      uint64_t v;
+      memcpy(&v, src, 8);
+      a->u64[ofs / 8] ^= v;
+    }
   }
 
-// declare hmac-sha3 functions
-DEF_HMAC(224, 28) // hmac-sha3-224
-DEF_HMAC(256, 32) // hmac-sha3-224
-DEF_HMAC(384, 48) // hmac-sha3-224
-DEF_HMAC(512, 64) // hmac-sha3-224
+  // xor remaining bytes
+  for (size_t i = 0; i < len; i++) {
+    a->u8[ofs + i] ^= src[i];
+  }
+}
 
-// NIST SP 800-105 utility function.
-static inline size_t left_encode(uint8_t buf[static 9], const uint64_t n) {
-  if (n > 0x00ffffffffffffffULL) {
-    buf[0] = 8;
-    buf[1] = (n >> 56) & 0xff;
-    buf[2] = (n >> 40) & 0xff;
-    buf[3] = (n >> 32) & 0xff;
-    buf[4] = (n >> 24) & 0xff;
-    buf[5] = (n >> 16) & 0xff;
-    buf[6] = (n >> 8) & 0xff;
-    buf[7] = n & 0xff;
-    return 9;
-  } else if (n > 0x0000ffffffffffffULL) {
-    buf[0] = 7;
-    buf[1] = (n >> 56) & 0xff;
-    buf[2] = (n >> 40) & 0xff;
-    buf[3] = (n >> 32) & 0xff;
-    buf[4] = (n >> 24) & 0xff;
-    buf[5] = (n >> 16) & 0xff;
-    buf[6] = (n >> 8) & 0xff;
-    buf[7] = n & 0xff;
-    return 8;
-  } else if (n > 0x000000ffffffffffULL) {
-    buf[0] = 6;
-    buf[1] = (n >> 40) & 0xff;
-    buf[2] = (n >> 32) & 0xff;
-    buf[3] = (n >> 24) & 0xff;
-    buf[4] = (n >> 16) & 0xff;
-    buf[5] = (n >> 8) & 0xff;
-    buf[6] = n & 0xff;
-    return 7;
-  } else if (n > 0x00000000ffffffffULL) {
-    buf[0] = 5;
-    buf[1] = (n >> 32) & 0xff;
-    buf[2] = (n >> 24) & 0xff;
-    buf[3] = (n >> 16) & 0xff;
-    buf[4] = (n >> 8) & 0xff;
-    buf[5] = n & 0xff;
-    return 6;
-  } else if (n > 0x0000000000ffffffULL) {
-    buf[0] = 4;
-    buf[1] = (n >> 24) & 0xff;
-    buf[2] = (n >> 16) & 0xff;
-    buf[3] = (n >> 8) & 0xff;
-    buf[4] = n & 0xff;
-    return 5;
-  } else if (n > 0x000000000000ffffULL) {
-    buf[0] = 3;
-    buf[1] = (n >> 16) & 0xff;
-    buf[2] = (n >> 8) & 0xff;
-    buf[3] = n & 0xff;
-    return 4;
-  } else if (n > 0x00000000000000ffULL) {
-    buf[0] = 2;
-    buf[1] = (n >> 8) & 0xff;
-    buf[2] = n & 0xff;
-    return 3;
+/**
+ * @brief Load job into lane and initialize lane state.
+ *
+ * @param[in] params Engine parameters.
+ * @param[out] lane Lane.
+ * @param[out] a Lane state.
+ * @param[in] job_id Job ID.
+ */
+static inline void mb_lane_init(const mb_params_t * const params, mb_lane_t * const lane, sha3_state_t * const a, const size_t job_id) {
+  params->get_job(params->cb_data, job_id, &(lane->job));
+  lane->job_id = job_id;
+  lane->seg_id = 0;
+  lane->ptr = NULL;
+  lane->len = 0;
+
+  // init state
+  if (lane->job.init) {
+    memcpy(a, lane->job.init, sizeof(sha3_state_t));
   } else {
-    buf[0] = 1;
-    buf[1] = n & 0xff;
-    return 2;
+    memset(a, 0, sizeof(sha3_state_t));
   }
 }
 
-// NIST SP 800-105 utility function.
-static inline size_t right_encode(uint8_t buf[static 9], const uint64_t n) {
-  if (n > 0x00ffffffffffffffULL) {
-    buf[0] = (n >> 56) & 0xff;
-    buf[1] = (n >> 40) & 0xff;
-    buf[2] = (n >> 32) & 0xff;
-    buf[3] = (n >> 24) & 0xff;
-    buf[4] = (n >> 16) & 0xff;
-    buf[5] = (n >> 8) & 0xff;
-    buf[6] = n & 0xff;
-    buf[7] = 8;
-    return 9;
-  } else if (n > 0x0000ffffffffffffULL) {
-    buf[0] = (n >> 56) & 0xff;
-    buf[1] = (n >> 40) & 0xff;
-    buf[2] = (n >> 32) & 0xff;
-    buf[3] = (n >> 24) & 0xff;
-    buf[4] = (n >> 16) & 0xff;
-    buf[5] = (n >> 8) & 0xff;
-    buf[6] = n & 0xff;
-    buf[7] = 7;
-    return 8;
-  } else if (n > 0x000000ffffffffffULL) {
-    buf[0] = (n >> 40) & 0xff;
-    buf[1] = (n >> 32) & 0xff;
-    buf[2] = (n >> 24) & 0xff;
-    buf[3] = (n >> 16) & 0xff;
-    buf[4] = (n >> 8) & 0xff;
-    buf[5] = n & 0xff;
-    buf[6] = 6;
-    return 7;
-  } else if (n > 0x00000000ffffffffULL) {
-    buf[0] = (n >> 32) & 0xff;
-    buf[1] = (n >> 24) & 0xff;
-    buf[2] = (n >> 16) & 0xff;
-    buf[3] = (n >> 8) & 0xff;
-    buf[4] = n & 0xff;
-    buf[5] = 5;
-    return 6;
-  } else if (n > 0x0000000000ffffffULL) {
-    buf[0] = (n >> 24) & 0xff;
-    buf[1] = (n >> 16) & 0xff;
-    buf[2] = (n >> 8) & 0xff;
-    buf[3] = n & 0xff;
-    buf[4] = 4;
-    return 5;
-  } else if (n > 0x000000000000ffffULL) {
-    buf[0] = (n >> 16) & 0xff;
-    buf[1] = (n >> 8) & 0xff;
-    buf[2] = n & 0xff;
-    buf[3] = 3;
-    return 4;
-  } else if (n > 0x00000000000000ffULL) {
-    buf[0] = (n >> 8) & 0xff;
-    buf[1] = n & 0xff;
-    buf[2] = 2;
-    return 3;
-  } else {
-    buf[0] = n & 0xff;
-    buf[1] = 1;
-    return 2;
+/**
+ * @brief Advance lane to next input segment.
+ *
+ * @param[in] params Engine parameters.
+ * @param[in,out] lane Lane.
+ *
+ * @return False if there are no more input segments.
+ */
+static inline _Bool mb_lane_next(const mb_params_t * const params, mb_lane_t * const lane) {
+  if (params->next_seg) {
+    return params->next_seg(params->cb_data, &(lane->job), lane->job_id, lane->seg_id++, lane->scratch, &(lane->ptr), &(lane->len));
+  } else if (lane->seg_id == 0) {
+    // no segment callback; input is a single segment
+    lane->seg_id = 1;
+    lane->ptr = lane->job.src;
+    lane->len = lane->job.src_len;
+    return true;
   }
+
+  return false;
 }
 
-// kangarootwelve length encoding.
-// (similar to right_encode(), but slightly different)
-static inline size_t k12_length_encode(uint8_t buf[static 9], const uint64_t n) {
-  if (n > 0x00ffffffffffffffULL) {
-    buf[0] = (n >> 56) & 0xff;
-    buf[1] = (n >> 40) & 0xff;
-    buf[2] = (n >> 32) & 0xff;
-    buf[3] = (n >> 24) & 0xff;
-    buf[4] = (n >> 16) & 0xff;
-    buf[5] = (n >> 8) & 0xff;
-    buf[6] = n & 0xff;
-    buf[7] = 8;
-    return 9;
-  } else if (n > 0x0000ffffffffffffULL) {
-    buf[0] = (n >> 56) & 0xff;
-    buf[1] = (n >> 40) & 0xff;
-    buf[2] = (n >> 32) & 0xff;
-    buf[3] = (n >> 24) & 0xff;
-    buf[4] = (n >> 16) & 0xff;
-    buf[5] = (n >> 8) & 0xff;
-    buf[6] = n & 0xff;
-    buf[7] = 7;
-    return 8;
-  } else if (n > 0x000000ffffffffffULL) {
-    buf[0] = (n >> 40) & 0xff;
-    buf[1] = (n >> 32) & 0xff;
-    buf[2] = (n >> 24) & 0xff;
-    buf[3] = (n >> 16) & 0xff;
-    buf[4] = (n >> 8) & 0xff;
-    buf[5] = n & 0xff;
-    buf[6] = 6;
-    return 7;
-  } else if (n > 0x00000000ffffffffULL) {
-    buf[0] = (n >> 32) & 0xff;
-    buf[1] = (n >> 24) & 0xff;
-    buf[2] = (n >> 16) & 0xff;
-    buf[3] = (n >> 8) & 0xff;
-    buf[4] = n & 0xff;
-    buf[5] = 5;
-    return 6;
-  } else if (n > 0x0000000000ffffffULL) {
-    buf[0] = (n >> 24) & 0xff;
-    buf[1] = (n >> 16) & 0xff;
-    buf[2] = (n >> 8) & 0xff;
-    buf[3] = n & 0xff;
-    buf[4] = 4;
-    return 5;
-  } else if (n > 0x000000000000ffffULL) {
-    buf[0] = (n >> 16) & 0xff;
-    buf[1] = (n >> 8) & 0xff;
-    buf[2] = n & 0xff;
-    buf[3] = 3;
-    return 4;
-  } else if (n > 0x00000000000000ffULL) {
-    buf[0] = (n >> 8) & 0xff;
-    buf[1] = n & 0xff;
-    buf[2] = 2;
-    return 3;
-  } else if (n > 0) {
-    buf[0] = n & 0xff;
-    buf[1] = 1;
-    return 2;
+/**
+ * @brief Absorb next block of input into lane state.
+ *
+ * If the input is exhausted before the block is full, then the padding
+ * is applied to the state.
+ *
+ * @param[in] params Engine parameters.
+ * @param[in,out] lane Lane.
+ * @param[in,out] a Lane state.
+ *
+ * @return True if the block was padded (the state is ready to be
+ * squeezed after the next permutation).
+ */
+static inline _Bool mb_lane_absorb(const mb_params_t * const params, mb_lane_t * const lane, sha3_state_t * const a) {
+  const size_t rate = params->rate;
+  size_t num_bytes = 0;
+  while (num_bytes < rate) {
+    if (!lane->len) {
+      // get next segment, or stop if input is exhausted
+      if (!mb_lane_next(params, lane)) {
+        break;
+      }
+      continue;
+    }
+
+    // absorb bytes from current segment
+    const size_t len = MIN(rate - num_bytes, lane->len);
+    mb_xor(a, num_bytes, lane->ptr, len);
+    num_bytes += len;
+    lane->ptr += len;
+    lane->len -= len;
+  }
+
+  if (num_bytes < rate) {
+    // input exhausted; append suffix and padding
+    a->u8[num_bytes] ^= params->pad;
+    a->u8[rate - 1] ^= 0x80;
+    return true;
+  }
+
+  return false;
+}
+
+/**
+ * @brief Squeeze output from padded and permuted state.
+ *
+ * @param[in] rate Rate, in bytes.
+ * @param[in] num_rounds Number of rounds (12 or 24).
+ * @param[in] a State (padded and permuted).
+ * @param[out] dst Output buffer.
+ * @param[in] dst_len Output length, in bytes.
+ */
+static inline void mb_squeeze(const size_t rate, const size_t num_rounds, const sha3_state_t * const a, uint8_t * const dst, const size_t dst_len) {
+  if (dst_len <= rate) {
+    // common case: output fits in one block
+    memcpy(dst, a->u8, dst_len);
+  } else if (num_rounds == SHA3_NUM_ROUNDS) {
+    // squeeze remaining blocks with single-state permutation
+    sha3_xof_t xof = { .a = *a, .squeezing = true };
+    xof_squeeze_raw(&xof, rate, dst, dst_len);
   } else {
-    buf[0] = 0;
-    return 1;
+    // squeeze remaining blocks with single-state permutation
+    sha3_xof12_t xof = { .a = *a, .squeezing = true };
+    xof12_squeeze_raw(&xof, rate, dst, dst_len);
   }
 }
 
-// Write prefix for encode_string() to the given buffer.  Accepts the
-// length of the string, in bytes.
-//
-// Returns the length of the prefix, in bytes.
-static inline size_t encode_string_prefix(uint8_t buf[static 9], const size_t num_bytes) {
-  return left_encode(buf, (uint64_t) num_bytes << 3);
+/**
+ * @brief Squeeze output of finished lane.
+ *
+ * @param[in] params Engine parameters.
+ * @param[in] lane Lane.
+ * @param[in] a Lane state (padded and permuted).
+ */
+static inline void mb_lane_squeeze(const mb_params_t * const params, const mb_lane_t * const lane, const sha3_state_t * const a) {
+  mb_squeeze(params->rate, params->num_rounds, a, lane->job.dst, lane->job.dst_len);
+}
+
+/**
+ * @brief Run jobs with multi-buffer sponge engine.
+ *
+ * @param[in] params Engine parameters.
+ * @param[in] num_jobs Number of jobs.
+ */
+static void mb_run(const mb_params_t * const params, const size_t num_jobs) {
+  sha3_state_t s[MB_NUM_LANES]; // lane states (contiguous for permute_batch())
+  mb_lane_t lanes[MB_NUM_LANES]; // lanes
+  _Bool done[MB_NUM_LANES]; // lanes which were padded in this block
+  size_t num_lanes = 0, next_job = 0;
+
+  // fill lanes
+  for (; num_lanes < MB_NUM_LANES && next_job < num_jobs; num_lanes++) {
+    mb_lane_init(params, lanes + num_lanes, s + num_lanes, next_job++);
+  }
+
+  while (num_lanes > 0) {
+    // absorb one block into each lane, then permute all lanes together
+    for (size_t i = 0; i < num_lanes; i++) {
+      done[i] = mb_lane_absorb(params, lanes + i, s + i);
+    }
+    permute_batch(s, num_lanes, params->num_rounds);
+
+    // squeeze finished lanes, then refill or remove them
+    for (size_t i = 0; i < num_lanes;) {
+      if (!done[i]) {
+        i++;
+        continue;
+      }
+
+      mb_lane_squeeze(params, lanes + i, s + i);
+
+      if (next_job < num_jobs) {
+        // refill lane with next job
+        mb_lane_init(params, lanes + i, s + i, next_job++);
+        i++;
+      } else if (i < --num_lanes) {
+        // no jobs left; move last lane into this slot and check it
+        lanes[i] = lanes[num_lanes];
+        s[i] = s[num_lanes];
+        done[i] = done[num_lanes];
+      }
+    }
+  }
 }
 
+/**
+ * @brief Arrays of inputs and outputs for batch functions.
+ */
 typedef struct {
-  uint8_t prefix[9]; // bytepad prefix
-  size_t prefix_len; // length of bytepad prefix, in bytes
-  size_t pad_len; // number of padding bytes after prefix and data
-} bytepad_t;
+  const sha3_state_t *init; /**< Initial state (NULL for zero state) */
+  const uint8_t * const *srcs; /**< Input buffers */
+  const size_t *lens; /**< Input lengths, in bytes (NULL if every input is `src_len` bytes) */
+  size_t src_len; /**< Input length, in bytes (if `lens` is NULL) */
+  uint8_t * const *dsts; /**< Output buffers */
+  size_t dst_len; /**< Output length, in bytes */
+} mb_arrays_t;
 
-// write bytepad() prefix to buffer, then return structure containing
-// the length of the prefix, in bytes, and the total number of
-static inline bytepad_t bytepad(const size_t data_len, const size_t width) {
-  bytepad_t r = { { 0 }, 0, 0 };
-  const size_t prefix_len = left_encode(r.prefix, width);
-  const size_t total_len = prefix_len + data_len;
-  const size_t padded_len = (total_len / width + ((total_len % width) ? 1 : 0)) * width;
+/**
+ * @brief Get job from batch arrays (`mb_params_t.get_job` callback).
+ *
+ * @param[in] cb_data Batch arrays (`mb_arrays_t`).
+ * @param[in] job_id Job ID.
+ * @param[out] job Job.
+ */
+static void mb_arrays_get_job(void * const cb_data, const size_t job_id, mb_job_t * const job) {
+  const mb_arrays_t * const arrays = cb_data;
+  job->init = arrays->init;
+  job->src = arrays->srcs[job_id];
+  job->src_len = arrays->lens ? arrays->lens[job_id] : arrays->src_len;
+  job->dst = arrays->dsts[job_id];
+  job->dst_len = arrays->dst_len;
+}
 
-  r.prefix_len = prefix_len;
-  r.pad_len = padded_len - total_len;
+/**
+ * @brief Hash batch of messages with multi-buffer sponge engine.
+ *
+ * @param[in] rate Rate, in bytes.
+ * @param[in] pad Padding byte.
+ * @param[in] num_rounds Number of rounds (12 or 24).
+ * @param[in] srcs Input buffers.
+ * @param[in] lens Input lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[out] dsts Output buffers.
+ * @param[in] dst_len Output length, in bytes.
+ */
+static inline void hash_batch(const size_t rate, const uint8_t pad, const size_t num_rounds, const uint8_t * const srcs[], const size_t lens[], const size_t n, uint8_t * const dsts[], const size_t dst_len) {
+  mb_arrays_t arrays = { .srcs = srcs, .lens = lens, .dsts = dsts, .dst_len = dst_len };
+  const mb_params_t params = {
+    .rate = rate,
+    .num_rounds = num_rounds,
+    .pad = pad,
+    .get_job = mb_arrays_get_job,
+    .cb_data = &arrays,
+  };
 
-  return r;
+  mb_run(&params, n);
 }
 
-// cshake padding byte
-#define CSHAKE_PAD 0x04
+// define sha3 batch function
+#define DEF_HASH_BATCH(BITS, OUT_LEN) \
+  /* hash batch of messages */ \
+  void sha3_ ## BITS ## _batch(const uint8_t * const srcs[], const size_t lens[], const size_t n, uint8_t * const dsts[]) { \
+    hash_batch(RATE(OUT_LEN), 0x06, SHA3_NUM_ROUNDS, srcs, lens, n, dsts, OUT_LEN); \
+  }
 
-// define cshake one-shot and iterative context functions
-#define DEF_CSHAKE(BITS) \
-  /* absorb data into cshake context */ \
-  _Bool cshake ## BITS ## _xof_absorb(sha3_xof_t * const xof, const uint8_t * const msg, const size_t len) { \
-    return xof_absorb(xof, SHAKE ## BITS ## _RATE, msg, len); \
+// declare sha3 batch functions
+DEF_HASH_BATCH(224, 28) // sha3_224_batch()
+DEF_HASH_BATCH(256, 32) // sha3_256_batch()
+DEF_HASH_BATCH(384, 48) // sha3_384_batch()
+DEF_HASH_BATCH(512, 64) // sha3_512_batch()
+
+// define shake batch function
+#define DEF_SHAKE_BATCH(BITS) \
+  /* absorb batch of messages into shake, squeeze `dst_len` bytes from each */ \
+  void shake ## BITS ## _batch(const uint8_t * const srcs[], const size_t lens[], const size_t n, uint8_t * const dsts[], const size_t dst_len) { \
+    hash_batch(SHAKE ## BITS ## _RATE, SHAKE_PAD, SHA3_NUM_ROUNDS, srcs, lens, n, dsts, dst_len); \
+  }
+
+// declare shake batch functions
+DEF_SHAKE_BATCH(128) // shake128_batch()
+DEF_SHAKE_BATCH(256) // shake256_batch()
+
+// Four-lane iterative hash contexts.
+//
+// Each lane absorbs its chunk directly into its state.  A lane with a
+// full block is not permuted until it has more input (or is
+// finalized), so lanes which fill their blocks in different calls can
+// still share a multi-buffer permutation.
+
+/**
+ * @brief Permute full lanes of four-lane hash context together.
+ *
+ * @param[in,out] ctx Four-lane hash context.
+ * @param[in] rate Hash function rate.
+ */
+static inline void x4_permute_full(sha3_x4_t * const ctx, const size_t rate) {
+  // find full lanes
+  size_t ids[4], n = 0;
+  for (size_t i = 0; i < 4; i++) {
+    if (ctx->num_bytes[i] == rate) {
+      ids[n++] = i;
+      ctx->num_bytes[i] = 0;
+    }
+  }
+
+  if (n == 4) {
+    // common case: every lane is full; permute in place
+    permute_batch(ctx->a, 4, SHA3_NUM_ROUNDS);
+  } else if (n > 0) {
+    // copy full lanes to contiguous states, permute, copy back
+    sha3_state_t s[4];
+    for (size_t i = 0; i < n; i++) {
+      s[i] = ctx->a[ids[i]];
+    }
+    permute_batch(s, n, SHA3_NUM_ROUNDS);
+    for (size_t i = 0; i < n; i++) {
+      ctx->a[ids[i]] = s[i];
+    }
+  }
+}
+
+/**
+ * @brief Absorb chunks into four-lane hash context.
+ *
+ * Used by `sha3_224_x4_absorb()`, `sha3_256_x4_absorb()`,
+ * `sha3_384_x4_absorb()` and `sha3_512_x4_absorb()`.
+ *
+ * @param[in,out] ctx Four-lane hash context.
+ * @param[in] rate Hash function rate.
+ * @param[in] srcs Source buffers.
+ * @param[in] lens Source buffer lengths, in bytes.
+ *
+ * @return True if data was absorbed, and false if the context has
+ * already been finalized.
+ */
+static inline bool x4_absorb(sha3_x4_t * const ctx, const size_t rate, const uint8_t * const srcs[4], const size_t lens[4]) {
+  if (ctx->finalized) {
+    // context already finalized, return false
+    return false;
+  }
+
+  const uint8_t *ptrs[4] = { srcs[0], srcs[1], srcs[2], srcs[3] };
+  size_t rems[4] = { lens[0], lens[1], lens[2], lens[3] };
+
+  while (true) {
+    // fill the current block of each lane
+    bool more = false;
+    for (size_t i = 0; i < 4; i++) {
+      if (rems[i] && ctx->num_bytes[i] < rate) {
+        const size_t len = MIN(rate - ctx->num_bytes[i], rems[i]);
+        mb_xor(ctx->a + i, ctx->num_bytes[i], ptrs[i], len);
+        ctx->num_bytes[i] += len;
+        ptrs[i] += len;
+        rems[i] -= len;
+      }
+
+      more |= (rems[i] > 0);
+    }
+
+    if (!more) {
+      // all input absorbed; leave full lanes for the next call
+      return true;
+    }
+
+    // lanes with remaining input are full; permute them (and any other
+    // full lanes)
+    x4_permute_full(ctx, rate);
+  }
+}
+
+/**
+ * @brief Finalize four-lane hash context.
+ *
+ * Used by `sha3_224_x4_final()`, `sha3_256_x4_final()`,
+ * `sha3_384_x4_final()` and `sha3_512_x4_final()`.
+ *
+ * @param[in,out] ctx Four-lane hash context.
+ * @param[in] rate Hash function rate.
+ * @param[out] dsts Destination buffers.
+ * @param[in] dst_len Length of each destination buffer, in bytes.
+ *
+ * @note May be called more than once without affecting the final digest values.
+ */
+static inline void x4_final(sha3_x4_t * const ctx, const size_t rate, uint8_t * const dsts[4], const size_t dst_len) {
+  if (!ctx->finalized) {
+    // mark context as final
+    ctx->finalized = true;
+
+    // permute pending full lanes
+    x4_permute_full(ctx, rate);
+
+    // append suffix and padding
+    for (size_t i = 0; i < 4; i++) {
+      ctx->a[i].u8[ctx->num_bytes[i]] ^= 0x06;
+      ctx->a[i].u8[rate - 1] ^= 0x80;
+    }
+
+    // permute
+    permute_batch(ctx->a, 4, SHA3_NUM_ROUNDS);
+  }
+
+  // copy to destinations
+  for (size_t i = 0; i < 4; i++) {
+    memcpy(dsts[i], ctx->a[i].u8, dst_len);
+  }
+}
+
+// define four-lane iterative hash context functions
+#define DEF_HASH_X4(BITS, OUT_LEN) \
+  /* Initialize four-lane iterative hash context. */ \
+  void sha3_ ## BITS ## _x4_init(sha3_x4_t * const ctx) { \
+    memset(ctx, 0, sizeof(sha3_x4_t)); \
   } \
   \
-  /* squeeze data from cshake context */ \
-  void cshake ## BITS ## _xof_squeeze(sha3_xof_t * const xof, uint8_t * const dst, const size_t len) { \
-    xof_squeeze(xof, SHAKE ## BITS ## _RATE, CSHAKE_PAD, dst, len); \
+  /* Absorb chunks into four-lane iterative hash context. */ \
+  _Bool sha3_ ## BITS ## _x4_absorb(sha3_x4_t * const ctx, const uint8_t * const srcs[4], const size_t lens[4]) { \
+    return x4_absorb(ctx, RATE(OUT_LEN), srcs, lens); \
   } \
   \
-  /* initialize cshake context */ \
-  void cshake ## BITS ## _xof_init(sha3_xof_t * const xof, const cshake_params_t params) { \
-    static const uint8_t PAD[SHAKE ## BITS ## _RATE] = { 0 }; \
-  \
-    if (!params.name_len && !params.custom_len) { \
-      /* cshake w/o nist prefix and domain is shake */ \
-      shake ## BITS ## _init(xof); \
+  /* Finalize four-lane iterative hash context. */ \
+  void sha3_ ## BITS ## _x4_final(sha3_x4_t * const ctx, uint8_t * const dsts[4]) { \
+    x4_final(ctx, RATE(OUT_LEN), dsts, OUT_LEN); \
+  }
+
+// declare four-lane iterative hash context functions
+DEF_HASH_X4(224, 28) // sha3_224_x4_{init,absorb,final}()
+DEF_HASH_X4(256, 32) // sha3_256_x4_{init,absorb,final}()
+DEF_HASH_X4(384, 48) // sha3_384_x4_{init,absorb,final}()
+DEF_HASH_X4(512, 64) // sha3_512_x4_{init,absorb,final}()
+
+/**
+ * @brief Load fixed-length input message and padding into state.
+ *
+ * Used by `sha3_256_32()`, `sha3_256_64()`, and their four-lane and
+ * eight-lane variants.  The input message is copied directly into the
+ * state lanes and the suffix and padding are written as whole lanes,
+ * so the state is ready for the single final permutation.
+ *
+ * @param[out] a Keccak state.
+ * @param[in] src Input message.
+ * @param[in] src_len Input message length, in bytes.  Must be a
+ * multiple of 8 and less than `rate`.
+ * @param[in] rate Hash function rate.
+ */
+static inline void hash_fixed_load(sha3_state_t * const a, const uint8_t * const src, const size_t src_len, const size_t rate) {
+  // load message, clear remaining lanes
+  memcpy(a->u8, src, src_len);
+  memset(a->u8 + src_len, 0, sizeof(sha3_state_t) - src_len);
+
+  // append suffix and padding
+  a->u64[src_len / 8] = 0x06;
+  a->u64[rate / 8 - 1] ^= 0x8000000000000000ULL;
+}
+
+/**
+ * @brief Hash `n` fixed-length input messages.
+ *
+ * Used by the four-lane and eight-lane variants of `sha3_256_32()` and
+ * `sha3_256_64()`.
+ *
+ * @param[in] srcs Array of `n` input messages.
+ * @param[in] src_len Input message length, in bytes.
+ * @param[in] n Number of messages (at most 8).
+ * @param[out] dsts Array of `n` destination buffers.
+ * @param[in] dst_len Length of each destination buffer, in bytes.
+ */
+static inline void hash_fixed_xn(const uint8_t * const srcs[], const size_t src_len, const size_t n, uint8_t * const dsts[], const size_t dst_len) {
+  sha3_state_t a[8];
+  for (size_t i = 0; i < n; i++) {
+    hash_fixed_load(a + i, srcs[i], src_len, RATE(dst_len));
+  }
+
+  permute_batch(a, n, SHA3_NUM_ROUNDS);
+
+  for (size_t i = 0; i < n; i++) {
+    memcpy(dsts[i], a[i].u8, dst_len);
+  }
+}
+
+// define fixed-length hash functions
+#define DEF_HASH_FIXED(BITS, OUT_LEN, SRC_LEN) \
+  /* Hash fixed-length message. */ \
+  void sha3_ ## BITS ## _ ## SRC_LEN(const uint8_t src[static SRC_LEN], uint8_t dst[static OUT_LEN]) { \
+    sha3_state_t a; \
+    hash_fixed_load(&a, src, SRC_LEN, RATE(OUT_LEN)); \
+    permute_24(a.u64); \
+    memcpy(dst, a.u8, OUT_LEN); \
+  } \
   \
-      /* FIXME: padding will be wrong on subsequent absorb() calls */ \
-      return; \
-    } \
+  /* Hash four fixed-length messages. */ \
+  void sha3_ ## BITS ## _ ## SRC_LEN ## _x4(const uint8_t * const srcs[4], uint8_t * const dsts[4]) { \
+    hash_fixed_xn(srcs, SRC_LEN, 4, dsts, OUT_LEN); \
+  } \
   \
-    /* build nist function name prefix */ \
-    uint8_t name_buf[9] = { 0 }; \
-    const size_t name_len = encode_string_prefix(name_buf, params.name_len); \
-  \
-    /* build custom string prefix */ \
-    uint8_t custom_buf[9] = { 0 }; \
-    const size_t custom_len = encode_string_prefix(custom_buf, params.custom_len); \
-  \
-    const size_t raw_len = name_len + params.name_len + custom_len + params.custom_len; \
-  \
-    /* build bytepad prefix */ \
-    const bytepad_t bp = bytepad(raw_len, SHAKE ## BITS ## _RATE); \
-  \
-    /* init xof */ \
-    xof_init(xof); \
+  /* Hash eight fixed-length messages. */ \
+  void sha3_ ## BITS ## _ ## SRC_LEN ## _x8(const uint8_t * const srcs[8], uint8_t * const dsts[8]) { \
+    hash_fixed_xn(srcs, SRC_LEN, 8, dsts, OUT_LEN); \
+  }
+
+// declare fixed-length hash functions
+DEF_HASH_FIXED(256, 32, 32) // sha3_256_32{,_x4,_x8}()
+DEF_HASH_FIXED(256, 32, 64) // sha3_256_64{,_x4,_x8}()
+
+#if (BACKEND == BACKEND_AVX512) || (BACKEND == BACKEND_AVX2)
+/**
+ * @brief Iterate fixed-length hash on chains in multi-buffer registers.
+ *
+ * Used by `chain_xn()`.  The states are loaded into the multi-buffer
+ * registers once, and stored once after the last iteration.  Between
+ * iterations the chaining values stay in registers 0-3, and registers
+ * 4-24 are reset to the padded block (suffix in register 4, final
+ * padding bit in the last rate register, zero elsewhere).
+ *
+ * @param[in,out] s Array of `num_chains` Keccak states (chaining value
+ * in the first 32 bytes of each state).
+ * @param[in] num_chains Number of chains (1 to MB_VEC_LANES).
+ * @param[in] n Number of iterations.
+ * @param[in] rate Hash function rate.
+ * @param[in] pad Suffix and first padding bit (0x06 for SHA3, 0x1f for SHAKE).
+ */
+static inline void chain_mb(sha3_state_t * const s, const size_t num_chains, const size_t n, const size_t rate, const uint8_t pad) {
+  const mb_vec_t zero = MB_SET1(0),
+                 suffix = MB_SET1(pad),
+                 last = MB_SET1(0x8000000000000000ULL);
+  mb_vec_t a[25];
+  mb_load(a, s, num_chains);
+
+  for (size_t j = 0; j < n; j++) {
+    // keep chaining value in registers 0-3, reset the rest of the block
+    a[4] = suffix;
+    for (size_t i = 5; i < 25; i++) {
+      a[i] = zero;
+    }
+    a[rate / 8 - 1] ^= last;
+
+    for (size_t i = 0; i < SHA3_NUM_ROUNDS; i++) {
+      mb_round(a, RCS[i]);
+    }
+  }
+
+  mb_store(s, a, num_chains);
+}
+#endif /* (BACKEND == BACKEND_AVX512) || (BACKEND == BACKEND_AVX2) */
+
+/**
+ * @brief Iterate fixed-length hash on independent 32 byte chains.
+ *
+ * Used by `sha3_256_iterate()`, `shake256_chain()`, and their
+ * four-lane and eight-lane variants.  Replaces each 32 byte chaining
+ * value `x` with `H(x)` `n` times.  The chaining value is the first 4
+ * lanes of the state after each permutation, so each iteration only
+ * resets the remaining lanes and the padding before the next
+ * permutation.
+ *
+ * On the avx512 and avx2 backends, multiple chains are iterated with
+ * `chain_mb()`, which keeps the states in registers for all `n`
+ * iterations.
+ *
+ * @param[in] seeds Array of `num_chains` 32 byte seeds.
+ * @param[in] num_chains Number of chains (at most 8).
+ * @param[in] n Number of iterations.
+ * @param[in] rate Hash function rate.
+ * @param[in] pad Suffix and first padding bit (0x06 for SHA3, 0x1f for SHAKE).
+ * @param[out] dsts Array of `num_chains` 32 byte destination buffers.
+ */
+static inline void chain_xn(const uint8_t * const seeds[], const size_t num_chains, const size_t n, const size_t rate, const uint8_t pad, uint8_t * const dsts[]) {
+  sha3_state_t a[8];
+  for (size_t i = 0; i < num_chains; i++) {
+    memcpy(a[i].u8, seeds[i], 32);
+  }
+
+#if (BACKEND == BACKEND_AVX512) || (BACKEND == BACKEND_AVX2)
+#ifdef AVX512_YMM
+  const _Bool use_mb = (num_chains > 1) && !avx512_ymm;
+#else
+  const _Bool use_mb = num_chains > 1;
+#endif /* AVX512_YMM */
+
+  if (use_mb) {
+    // iterate groups of chains in multi-buffer registers
+    for (size_t i = 0; i < num_chains; i += MB_VEC_LANES) {
+      chain_mb(a + i, MIN(num_chains - i, MB_VEC_LANES), n, rate, pad);
+    }
+
+    for (size_t i = 0; i < num_chains; i++) {
+      memcpy(dsts[i], a[i].u8, 32);
+    }
+    return;
+  }
+#endif /* (BACKEND == BACKEND_AVX512) || (BACKEND == BACKEND_AVX2) */
+
+  for (size_t j = 0; j < n; j++) {
+    for (size_t i = 0; i < num_chains; i++) {
+      // keep chaining value in lanes 0-3, clear remaining lanes, then
+      // append suffix and padding
+      memset(a[i].u64 + 4, 0, sizeof(sha3_state_t) - 32);
+      a[i].u64[4] = pad;
+      a[i].u64[rate / 8 - 1] ^= 0x8000000000000000ULL;
+    }
+
+    permute_batch(a, num_chains, SHA3_NUM_ROUNDS);
+  }
+
+  for (size_t i = 0; i < num_chains; i++) {
+    memcpy(dsts[i], a[i].u8, 32);
+  }
+}
+
+// define hash chain functions
+#define DEF_CHAIN(NAME, RATE, PAD) \
+  /* Iterate hash on 32 byte seed. */ \
+  void NAME(const uint8_t seed[static 32], const size_t n, uint8_t dst[static 32]) { \
+    uint8_t * const dsts[1] = { dst }; \
+    chain_xn(&seed, 1, n, (RATE), (PAD), dsts); \
+  } \
   \
-    /* absorb bytepad prefix */ \
-    (void) cshake ## BITS ## _xof_absorb(xof, bp.prefix, bp.prefix_len); \
+  /* Iterate hash on four 32 byte seeds. */ \
+  void NAME ## _x4(const uint8_t * const seeds[4], const size_t n, uint8_t * const dsts[4]) { \
+    chain_xn(seeds, 4, n, (RATE), (PAD), dsts); \
+  } \
   \
-    /* absorb name string */ \
-    (void) cshake ## BITS ## _xof_absorb(xof, name_buf, name_len); \
-    if (params.name_len > 0) { \
-      (void) cshake ## BITS ## _xof_absorb(xof, params.name, params.name_len); \
+  /* Iterate hash on eight 32 byte seeds. */ \
+  void NAME ## _x8(const uint8_t * const seeds[8], const size_t n, uint8_t * const dsts[8]) { \
+    chain_xn(seeds, 8, n, (RATE), (PAD), dsts); \
+  }
+
+// declare hash chain functions
+DEF_CHAIN(sha3_256_iterate, RATE(32), 0x06) // sha3_256_iterate{,_x4,_x8}()
+DEF_CHAIN(shake256_chain, SHAKE256_RATE, SHAKE_PAD) // shake256_chain{,_x4,_x8}()
+
+/**
+ * @brief Parse 12-bit rejection samples from SHAKE128 output block.
+ *
+ * Used by `shake128_sample12()` and its four-lane and eight-lane
+ * variants.  Each group of 3 bytes is split into two 12-bit
+ * little-endian values, and values less than `q` are kept (FIPS 203,
+ * Algorithm 7).
+ *
+ * @param[in] b Output block (`SHAKE128_RATE` bytes).
+ * @param[in] q Upper bound (exclusive).
+ * @param[out] dst Destination array.
+ * @param[in] num Number of values already in destination array.
+ * @param[in] n Length of destination array.
+ *
+ * @return Updated number of values in destination array.
+ */
+static inline size_t sample12_block(const uint8_t * const b, const uint32_t q, uint16_t * const dst, size_t num, const size_t n) {
+  size_t i = 0;
+
+  // store both values unconditionally and advance past accepted ones
+  // while there is room for two values (avoids unpredictable branches)
+  for (; i < SHAKE128_RATE && num + 2 <= n; i += 3) {
+    const uint16_t d0 = b[i] | ((uint16_t) (b[i + 1] & 0xf) << 8),
+                   d1 = (b[i + 1] >> 4) | ((uint16_t) b[i + 2] << 4);
+    dst[num] = d0;
+    num += (d0 < q);
+    dst[num] = d1;
+    num += (d1 < q);
+  }
+
+  // fill remaining value
+  for (; i < SHAKE128_RATE && num < n; i += 3) {
+    const uint16_t d0 = b[i] | ((uint16_t) (b[i + 1] & 0xf) << 8),
+                   d1 = (b[i + 1] >> 4) | ((uint16_t) b[i + 2] << 4);
+    if (d0 < q) {
+      dst[num++] = d0;
+    } else if (d1 < q) {
+      dst[num++] = d1;
+    }
+  }
+
+  return num;
+}
+
+/**
+ * @brief Parse 23-bit rejection samples from SHAKE128 output block.
+ *
+ * Used by `shake128_sample23()` and its four-lane and eight-lane
+ * variants.  Each group of 3 bytes is read as a 24-bit little-endian
+ * value, the top bit is cleared, and values less than `q` are kept
+ * (FIPS 204, Algorithm 14).
+ *
+ * @param[in] b Output block (`SHAKE128_RATE` bytes).
+ * @param[in] q Upper bound (exclusive).
+ * @param[out] dst Destination array.
+ * @param[in] num Number of values already in destination array.
+ * @param[in] n Length of destination array.
+ *
+ * @return Updated number of values in destination array.
+ */
+static inline size_t sample23_block(const uint8_t * const b, const uint32_t q, uint32_t * const dst, size_t num, const size_t n) {
+  // store value unconditionally and advance past accepted ones (avoids
+  // unpredictable branches)
+  for (size_t i = 0; i < SHAKE128_RATE && num < n; i += 3) {
+    const uint32_t d = b[i] | ((uint32_t) b[i + 1] << 8) | ((uint32_t) (b[i + 2] & 0x7f) << 16);
+    dst[num] = d;
+    num += (d < q);
+  }
+
+  return num;
+}
+
+// SHAKE128 rate is a multiple of 3, so samples never span output blocks
+_Static_assert(SHAKE128_RATE % 3 == 0, "SHAKE128_RATE is not a multiple of 3");
+
+// define shake128 rejection sampling functions
+#define DEF_SAMPLE(BITS, TYPE) \
+  /* Absorb seeds, then parse samples directly from the rate bytes of \
+   * each state until every destination array is full. */ \
+  static inline void sample ## BITS ## _xn(const uint8_t * const seeds[], const size_t seed_len, const size_t num_seeds, const uint32_t q, TYPE * const dsts[], const size_t n) { \
+    sha3_state_t a[8] = { 0 }; \
+    size_t nums[8] = { 0 }; \
+    \
+    for (size_t i = 0; i < num_seeds; i++) { \
+      /* absorb seed, append suffix and padding */ \
+      const size_t len = absorb(a + i, 0, SHAKE128_RATE, seeds[i], seed_len); \
+      a[i].u8[len] ^= SHAKE_PAD; \
+      a[i].u8[SHAKE128_RATE - 1] ^= 0x80; \
     } \
-  \
-    /* absorb custom string */ \
-    (void) cshake ## BITS ## _xof_absorb(xof, custom_buf, custom_len); \
-    if (params.custom_len > 0) { \
-      (void) cshake ## BITS ## _xof_absorb(xof, params.custom, params.custom_len); \
+    \
+    for (bool more = (n > 0); more;) { \
+      /* squeeze next block of each state */ \
+      permute_batch(a, num_seeds, SHA3_NUM_ROUNDS); \
+      \
+      more = false; \
+      for (size_t i = 0; i < num_seeds; i++) { \
+        nums[i] = sample ## BITS ## _block(a[i].u8, q, dsts[i], nums[i], n); \
+        more |= (nums[i] < n); \
+      } \
     } \
+  } \
   \
-    /* absorb padding */ \
-    for (size_t ofs = 0; ofs < bp.pad_len; ofs += sizeof(PAD)) { \
-      const size_t len = MIN(bp.pad_len - ofs, sizeof(PAD)); \
-      (void) cshake ## BITS ## _xof_absorb(xof, PAD, len); \
+  /* Sample values from SHAKE128 output. */ \
+  _Bool shake128_sample ## BITS(const uint8_t * const seed, const size_t seed_len, const TYPE q, TYPE * const dst, const size_t n) { \
+    if (!q || q > (1UL << BITS)) { \
+      return false; \
     } \
+    TYPE * const dsts[1] = { dst }; \
+    sample ## BITS ## _xn(&seed, seed_len, 1, q, dsts, n); \
+    return true; \
   } \
   \
-  /* one-shot cshake */ \
-  void cshake ## BITS ( \
-    const cshake_params_t params, \
-    const uint8_t * const msg, const size_t msg_len, \
-    uint8_t * const dst, const size_t dst_len \
-  ) { \
-    if (!params.name_len && !params.custom_len) { \
-      /* cshake w/o nist prefix and domain is shake */ \
-      shake ## BITS (msg, msg_len, dst, dst_len); \
-      return; \
+  /* Sample values from SHAKE128 output of four seeds. */ \
+  _Bool shake128_sample ## BITS ## _x4(const uint8_t * const seeds[4], const size_t seed_len, const TYPE q, TYPE * const dsts[4], const size_t n) { \
+    if (!q || q > (1UL << BITS)) { \
+      return false; \
     } \
+    sample ## BITS ## _xn(seeds, seed_len, 4, q, dsts, n); \
+    return true; \
+  } \
   \
-    /* init */ \
-    sha3_xof_t xof; \
-    cshake ## BITS ## _xof_init(&xof, params); \
-  \
-    /* absorb */ \
-    (void) cshake ## BITS ## _xof_absorb(&xof, msg, msg_len); \
-  \
-    /* squeeze */ \
-    cshake ## BITS ## _xof_squeeze(&xof, dst, dst_len); \
+  /* Sample values from SHAKE128 output of eight seeds. */ \
+  _Bool shake128_sample ## BITS ## _x8(const uint8_t * const seeds[8], const size_t seed_len, const TYPE q, TYPE * const dsts[8], const size_t n) { \
+    if (!q || q > (1UL << BITS)) { \
+      return false; \
+    } \
+    sample ## BITS ## _xn(seeds, seed_len, 8, q, dsts, n); \
+    return true; \
   }
 
-// declare cshake functions
-DEF_CSHAKE(128) // cshake128
-DEF_CSHAKE(256) // cshake256
+// declare shake128 rejection sampling functions
+DEF_SAMPLE(12, uint16_t) // shake128_sample12{,_x4,_x8}()
+DEF_SAMPLE(23, uint32_t) // shake128_sample23{,_x4,_x8}()
 
-// define kmac one-shot and xof functions
-#define DEF_KMAC(BITS) \
-  /* one-shot kmac (non-xof) */ \
-  void kmac ## BITS ( \
-    const kmac_params_t params, \
-    const uint8_t * const msg, const size_t msg_len, \
-    uint8_t * const dst, const size_t dst_len \
-  ) { \
-    static const uint8_t PAD[SHAKE ## BITS ## _RATE] = { 0 }; \
-    static const uint8_t NAME[4] = { 'K', 'M', 'A', 'C' }; \
-  \
-    /* build params */ \
-    const cshake_params_t cshake_params = { \
-      .name = NAME, \
-      .name_len = sizeof(NAME), \
-      .custom = params.custom, \
-      .custom_len = params.custom_len, \
-    }; \
-  \
-    /* build key prefix */ \
-    uint8_t key_buf[9] = { 0 }; \
-    const size_t key_buf_len = encode_string_prefix(key_buf, params.key_len); \
-  \
-    /* build bytepad prefix */ \
-    const bytepad_t bp = bytepad(key_buf_len + params.key_len, SHAKE ## BITS ## _RATE); \
-  \
-    /* init xof */ \
-    sha3_xof_t xof; \
-    cshake ## BITS ## _xof_init(&xof, cshake_params); \
-  \
-    /* absorb bytepad prefix */ \
-    (void) cshake ## BITS ## _xof_absorb(&xof, bp.prefix, bp.prefix_len); \
+// define hmac-sha3 iterative context and one-shot functions
+#define DEF_HMAC(BITS, OUT_LEN) \
+  /* init hmac-sha3 context */ \
+  void hmac_sha3_ ## BITS ## _init(hmac_sha3_t *hmac, const uint8_t *k, const size_t k_len) { \
+    /* clear finalized flag */ \
+    hmac->finalized = false; \
   \
-    /* absorb key */ \
-    (void) cshake ## BITS ## _xof_absorb(&xof, key_buf, key_buf_len); \
-    if (params.key_len > 0) { \
-      (void) cshake ## BITS ## _xof_absorb(&xof, params.key, params.key_len); \
+    /* init key buffer */ \
+    uint8_t k_buf[RATE(OUT_LEN)] = { 0 }; \
+    if (k_len <= sizeof(k_buf)) { \
+      memcpy(k_buf, k, k_len); \
+    } else { \
+      sha3_ ## BITS(k, k_len, k_buf); \
     } \
   \
-    /* absorb padding */ \
-    for (size_t ofs = 0; ofs < bp.pad_len; ofs += sizeof(PAD)) { \
-      const size_t len = MIN(bp.pad_len - ofs, sizeof(PAD)); \
-      (void) cshake ## BITS ## _xof_absorb(&xof, PAD, len); \
+    /* apply opad */ \
+    for (size_t i = 0; i < RATE(OUT_LEN); i++) { \
+      k_buf[i] ^= 0x5c; \
     } \
   \
-    /* absorb message */ \
-    (void) cshake ## BITS ## _xof_absorb(&xof, msg, msg_len); \
-  \
-    /* build output length suffix */ \
-    uint8_t suffix_buf[9] = { 0 }; \
-    const size_t suffix_buf_len = right_encode(suffix_buf, dst_len << 3); \
-  \
-    /* absorb output length suffix */ \
-    (void) cshake ## BITS ## _xof_absorb(&xof, suffix_buf, suffix_buf_len); \
+    /* init outer hash, absorb outer key */ \
+    sha3_ ## BITS ## _init(&(hmac->outer)); \
+    sha3_ ## BITS ## _absorb(&(hmac->outer), k_buf, sizeof(k_buf)); \
   \
-    /* squeeze */ \
-    cshake ## BITS ## _xof_squeeze(&xof, dst, dst_len); \
-  } \
+    /* remove opad, apply ipad */ \
+    for (size_t i = 0; i < RATE(OUT_LEN); i++) { \
+      k_buf[i] ^= (0x5c ^ 0x36); \
+    } \
   \
-  /* absorb data into kmac-xof context */ \
-  _Bool kmac ## BITS ## _xof_absorb(sha3_xof_t * const xof, const uint8_t * const msg, const size_t len) { \
-    return cshake ## BITS ## _xof_absorb(xof, msg, len); \
+    /* init outer hash, absorb inner key */ \
+    sha3_ ## BITS ## _init(&(hmac->inner)); \
+    sha3_ ## BITS ## _absorb(&(hmac->inner), k_buf, sizeof(k_buf)); \
   } \
   \
-  /* squeeze data from kmac-xof context */ \
-  void kmac ## BITS ## _xof_squeeze(sha3_xof_t * const xof, uint8_t * const dst, const size_t len) { \
-    if (!xof->squeezing) { \
-      /* append XOF length suffix */ \
-      const uint8_t SUFFIX[] = { 0, 1 }; \
-      (void) cshake ## BITS ## _xof_absorb(xof, SUFFIX, sizeof(SUFFIX)); \
-    } \
-    cshake ## BITS ## _xof_squeeze(xof, dst, len); \
+  /* absorb data into hmac-sha3 context */ \
+  _Bool hmac_sha3_ ## BITS ## _absorb(hmac_sha3_t *hmac, const uint8_t *src, const size_t len) { \
+    return sha3_ ## BITS ## _absorb(&(hmac->inner), src, len); \
   } \
   \
-  /* init kmac-xof context */ \
-  void kmac ## BITS ## _xof_init(sha3_xof_t * const xof, const kmac_params_t params) { \
-    static const uint8_t PAD[SHAKE ## BITS ## _RATE] = { 0 }; \
-    static const uint8_t NAME[4] = { 'K', 'M', 'A', 'C' }; \
-  \
-    /* build cshake params */ \
-    const cshake_params_t cshake_params = { \
-      .name = NAME, \
-      .name_len = sizeof(NAME), \
-      .custom = params.custom, \
-      .custom_len = params.custom_len, \
-    }; \
-  \
-    /* build key prefix */ \
-    uint8_t key_buf[9] = { 0 }; \
-    const size_t key_buf_len = encode_string_prefix(key_buf, params.key_len); \
+  /* finalize hmac-sha3 context */ \
+  void hmac_sha3_ ## BITS ## _final(hmac_sha3_t *hmac, uint8_t dst[static OUT_LEN]) { \
+    /* finalize inner hash into buffer */ \
+    uint8_t buf[OUT_LEN] = { 0 }; \
+    sha3_ ## BITS ## _final(&(hmac->inner), buf); \
   \
-    /* build bytepad prefix */ \
-    const bytepad_t bp = bytepad(key_buf_len + params.key_len, SHAKE ## BITS ## _RATE); \
+    /* absorb into outer hash */ \
+    sha3_ ## BITS ## _absorb(&(hmac->outer), buf, sizeof(buf)); \
   \
-    /* init xof */ \
-    cshake ## BITS ## _xof_init(xof, cshake_params); \
+    /* finalize outer hash into destination */ \
+    sha3_ ## BITS ## _final(&(hmac->outer), dst); \
+  } \
   \
-    /* absorb bytepad prefix */ \
-    (void) cshake ## BITS ## _xof_absorb(xof, bp.prefix, bp.prefix_len); \
+  /* one-shot hmac-sha3 */ \
+  void hmac_sha3_ ## BITS(const uint8_t * const k, const size_t k_len, const uint8_t * const m, const size_t m_len, uint8_t dst[static OUT_LEN]) { \
+    /* init */ \
+    hmac_sha3_t hmac; \
+    hmac_sha3_## BITS ##_init(&hmac, k, k_len); \
   \
-    /* absorb key */ \
-    (void) cshake ## BITS ## _xof_absorb(xof, key_buf, key_buf_len); \
-    if (params.key_len > 0) { \
-      (void) cshake ## BITS ## _xof_absorb(xof, params.key, params.key_len); \
-    } \
+    /* absorb */ \
+    hmac_sha3_## BITS ##_absorb(&hmac, m, m_len); \
   \
-    /* absorb padding */ \
-    for (size_t ofs = 0; ofs < bp.pad_len; ofs += sizeof(PAD)) { \
-      const size_t len = MIN(bp.pad_len - ofs, sizeof(PAD)); \
-      (void) cshake ## BITS ## _xof_absorb(xof, PAD, len); \
-    } \
-  } \
-  \
-  /* one-shot kmac-xof */ \
-  void kmac ## BITS ## _xof_once(const kmac_params_t params, const uint8_t * const src, const size_t src_len, uint8_t * const dst, const size_t dst_len) { \
-    sha3_xof_t xof; \
-    kmac ## BITS ## _xof_init(&xof, params); \
-    kmac ## BITS ## _xof_absorb(&xof, src, src_len); \
-    kmac ## BITS ## _xof_squeeze(&xof, dst, dst_len); \
+    /* finalize */ \
+    hmac_sha3_## BITS ##_final(&hmac, dst); \
   }
 
-// declare kmac functions
-DEF_KMAC(128) // kmac128
-DEF_KMAC(256) // kmac256
+// declare hmac-sha3 functions
+DEF_HMAC(224, 28) // hmac-sha3-224
+DEF_HMAC(256, 32) // hmac-sha3-224
+DEF_HMAC(384, 48) // hmac-sha3-224
+DEF_HMAC(512, 64) // hmac-sha3-224
 
-// define tuplehash and tuplehash-xof functions
-#define DEF_TUPLEHASH(BITS) \
-  /* init tuplehash context */ \
-  static inline void tuplehash ## BITS ## _init(sha3_xof_t * const xof, const tuplehash_params_t params, const size_t dst_len) { \
-    static const uint8_t NAME[] = { 'T', 'u', 'p', 'l', 'e', 'H', 'a', 's', 'h' }; \
-  \
-    /* build cshake ## BITS ##  params */ \
-    const cshake_params_t cshake_params = { \
-      .name = NAME, \
-      .name_len = sizeof(NAME), \
-      .custom = params.custom, \
-      .custom_len = params.custom_len, \
-    }; \
-  \
-    /* init xof */ \
-    cshake ## BITS ## _xof_init(xof, cshake_params); \
-  \
-    /* absorb tuples */ \
-    /* FIXME: length counter in 800-185 is wrong here */ \
-    for (size_t i = 0; i < params.num_strs; i++) { \
-      /* absorb length */ \
-      uint8_t buf[9] = { 0 }; \
-      const size_t buf_len = encode_string_prefix(buf, params.strs[i].len); \
-      (void) cshake ## BITS ## _xof_absorb(xof, buf, buf_len); \
-  \
-      /* absorb content */ \
-      if (params.strs[i].len > 0) { \
-        (void) cshake ## BITS ## _xof_absorb(xof, params.strs[i].ptr, params.strs[i].len); \
-      } \
-    } \
-  \
-    /* build output length suffix */ \
-    uint8_t suffix_buf[9] = { 0 }; \
-    const size_t suffix_buf_len = right_encode(suffix_buf, dst_len << 3); \
-  \
-    /* absorb output length suffix */ \
-    (void) cshake ## BITS ## _xof_absorb(xof, suffix_buf, suffix_buf_len); \
-  } \
-  \
-  /* one-shot tuplehash with fixed-length output (non-xof) */ \
-  void tuplehash ## BITS (const tuplehash_params_t params, uint8_t * const dst, const size_t dst_len) { \
-    /* init */ \
-    sha3_xof_t xof; \
-    tuplehash ## BITS ## _init(&xof, params, dst_len); \
-  \
-    /* squeeze */ \
-    cshake ## BITS ## _xof_squeeze(&xof, dst, dst_len); \
-  } \
-  \
-  /* init tuplehash context */ \
-  void tuplehash ## BITS ## _xof_init(sha3_xof_t * const xof, const tuplehash_params_t params) { \
-    tuplehash ## BITS ## _init(xof, params, 0); \
-  } \
-  \
-  /* squeeze data from tuplehash */ \
-  void tuplehash ## BITS ## _xof_squeeze(sha3_xof_t * const xof, uint8_t * const dst, const size_t dst_len) { \
-    cshake ## BITS ## _xof_squeeze(xof, dst, dst_len); \
-  } \
-  \
-  /* one-shot tuplehash-xof */ \
-  void tuplehash ## BITS ## _xof_once(const tuplehash_params_t params, uint8_t * const dst, const size_t dst_len) { \
-    /* init xof */ \
-    sha3_xof_t xof; \
-    tuplehash ## BITS ## _xof_init(&xof, params); \
-  \
-    /* squeeze */ \
-    cshake ## BITS ## _xof_squeeze(&xof, dst, dst_len); \
+/**
+ * @brief Calculate HMAC-SHA3 of batch of messages.
+ *
+ * Used by `hmac_sha3_224_batch()`, `hmac_sha3_256_batch()`,
+ * `hmac_sha3_384_batch()`, and `hmac_sha3_512_batch()`.
+ *
+ * The inner and outer key blocks are exactly one block, so the states
+ * of an initialized context are at a block boundary and can be used as
+ * initial states for the multi-buffer sponge engine.
+ *
+ * @param[in] hmac HMAC context initialized with key.
+ * @param[in] rate Hash function rate.
+ * @param[in] out_len Hash function output length, in bytes.
+ * @param[in] srcs Input messages.
+ * @param[in] lens Input message lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[out] dsts MAC buffers.
+ */
+static void hmac_batch(const hmac_sha3_t * const hmac, const size_t rate, const size_t out_len, const uint8_t * const srcs[], const size_t lens[], const size_t n, uint8_t * const dsts[]) {
+  // hash messages with inner state, write inner hashes to destination
+  mb_arrays_t arrays = {
+    .init = &(hmac->inner.a),
+    .srcs = srcs,
+    .lens = lens,
+    .dsts = dsts,
+    .dst_len = out_len,
+  };
+  const mb_params_t params = {
+    .rate = rate,
+    .num_rounds = SHA3_NUM_ROUNDS,
+    .pad = 0x06,
+    .get_job = mb_arrays_get_job,
+    .cb_data = &arrays,
+  };
+  mb_run(&params, n);
+
+  // hash inner hashes with outer state (in place: each inner hash
+  // fits in one block, so it is absorbed before the output is written)
+  arrays = (mb_arrays_t) {
+    .init = &(hmac->outer.a),
+    .srcs = (const uint8_t * const *) dsts,
+    .src_len = out_len,
+    .dsts = dsts,
+    .dst_len = out_len,
+  };
+  mb_run(&params, n);
+}
+
+// number of MACs calculated per chunk by hmac_batch_verify()
+#define HMAC_VERIFY_CHUNK_LEN 32
+
+/**
+ * @brief Verify HMAC-SHA3 of batch of messages.
+ *
+ * Used by `hmac_sha3_224_batch_verify()`,
+ * `hmac_sha3_256_batch_verify()`, `hmac_sha3_384_batch_verify()`, and
+ * `hmac_sha3_512_batch_verify()`.
+ *
+ * @param[in] hmac HMAC context initialized with key.
+ * @param[in] rate Hash function rate.
+ * @param[in] out_len Hash function output length, in bytes.
+ * @param[in] srcs Input messages.
+ * @param[in] lens Input message lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[in] macs Expected MACs.
+ * @param[out] oks Results (may be NULL).
+ *
+ * @return True if every MAC matched.
+ */
+static bool hmac_batch_verify(const hmac_sha3_t * const hmac, const size_t rate, const size_t out_len, const uint8_t * const srcs[], const size_t lens[], const size_t n, const uint8_t * const macs[], _Bool oks[]) {
+  bool all_ok = true;
+
+  // calculate MACs in chunks into stack buffer
+  uint8_t bufs[HMAC_VERIFY_CHUNK_LEN][64];
+  uint8_t *dsts[HMAC_VERIFY_CHUNK_LEN];
+  for (size_t i = 0; i < HMAC_VERIFY_CHUNK_LEN; i++) {
+    dsts[i] = bufs[i];
   }
 
-// declare tuplehash functions
-DEF_TUPLEHASH(128) // tuplehash128, tuplehash128-xof
-DEF_TUPLEHASH(256) // tuplehash256, tuplehash256-xof
+  for (size_t ofs = 0; ofs < n; ofs += HMAC_VERIFY_CHUNK_LEN) {
+    const size_t len = MIN(n - ofs, HMAC_VERIFY_CHUNK_LEN);
+    hmac_batch(hmac, rate, out_len, srcs + ofs, lens + ofs, len, dsts);
 
-// define parallelhash and parallelhash-xof functions
-#define DEF_PARALLELHASH(BITS) \
-  /* emit block for current xof into root xof */ \
-  static inline void parallelhash ## BITS ## _emit_block(parallelhash_t * const hash) { \
-    /* squeeze curr xof, absorb into root xof */ \
-    uint8_t buf[BITS / 4]; /* ph128: 32, ph256: 64 */ \
-    shake ## BITS ## _squeeze(&(hash->curr_xof), buf, sizeof(buf)); \
-    (void) cshake ## BITS ## _xof_absorb(&(hash->root_xof), buf, sizeof(buf)); \
-  \
-    /* increment block count */ \
-    hash->num_blocks++; \
-  } \
-  \
-  /* reset context for current internal xof */ \
-  static inline void parallelhash ## BITS ## _reset_curr_xof(parallelhash_t *hash) { \
-    /* init curr xof */ \
-    shake ## BITS ## _init(&(hash->curr_xof)); \
-    hash->ofs = 0; \
-  } \
-  \
-  /* init parallelhash context */ \
-  static inline void parallelhash ## BITS ## _init(parallelhash_t *hash, const parallelhash_params_t params) { \
-    static const uint8_t NAME[] = { 'P', 'a', 'r', 'a', 'l', 'l', 'e', 'l', 'H', 'a', 's', 'h' }; \
-  \
-    /* build root xof cshake params */ \
-    const cshake_params_t root_cshake_params = { \
-      .name = NAME, \
-      .name_len = sizeof(NAME), \
-      .custom = params.custom, \
-      .custom_len = params.custom_len, \
-    }; \
-  \
-    /* init root xof */ \
-    cshake ## BITS ## _xof_init(&(hash->root_xof), root_cshake_params); \
-  \
-    /* build block size */ \
-    uint8_t buf[9] = { 0 }; \
-    const size_t buf_len = left_encode(buf, params.block_len); \
-  \
-    /* absorb block length into root xof */ \
-    (void) cshake ## BITS ## _xof_absorb(&(hash->root_xof), buf, buf_len); \
-  \
-    /* set parameters */ \
-    hash->block_len = params.block_len; \
-    hash->num_blocks = 0; \
-    hash->squeezing = false; \
-  \
-    /* init curr xof */ \
-    parallelhash ## BITS ## _reset_curr_xof(hash); \
-  } \
-  \
-  /* absorb data into parallelhash context */ \
-  static inline void parallelhash ## BITS ## _absorb(parallelhash_t * const hash, const uint8_t *msg, size_t msg_len) { \
-    while (msg_len > 0) { \
-      const size_t len = MIN(msg_len, hash->block_len - hash->ofs); \
-      (void) shake ## BITS ## _absorb(&(hash->curr_xof), msg, len); \
-      msg += len; \
-      msg_len -= len; \
-  \
-      hash->ofs += len; \
-      if (hash->ofs == hash->block_len) { \
-        /* emit block, reset curr xof */ \
-        parallelhash ## BITS ## _emit_block(hash); \
-        parallelhash ## BITS ## _reset_curr_xof(hash); \
-      } \
-    } \
-  } \
-  \
-  /* squeeze data from parallelhash context */ \
-  static inline void parallelhash ## BITS ## _squeeze(parallelhash_t * const hash, uint8_t * const dst, const size_t dst_len) { \
-    if (!hash->squeezing) { \
-      /* mark as squeezing */ \
-      hash->squeezing = true; \
-  \
-      if (hash->ofs > 0) { \
-        /* squeeze curr xof, absorb into root xof */ \
-        parallelhash ## BITS ## _emit_block(hash); \
-      } \
-  \
-      { \
-        /* build num blocks suffix */ \
-        uint8_t buf[9] = { 0 }; \
-        const size_t len = right_encode(buf, hash->num_blocks); \
-  \
-        /* absorb num blocks suffix into root xof */ \
-        (void) cshake ## BITS ## _xof_absorb(&(hash->root_xof), buf, len); \
-      } \
-  \
-      { \
-        /* build output size suffix */ \
-        uint8_t buf[9] = { 0 }; \
-        const size_t len = right_encode(buf, dst_len << 3); \
-  \
-        /* absorb output size suffix into root xof */ \
-        (void) cshake ## BITS ## _xof_absorb(&(hash->root_xof), buf, len); \
-      } \
-    } \
-  \
-    if (dst_len > 0) { \
-      cshake ## BITS ## _xof_squeeze(&(hash->root_xof), dst, dst_len); \
-    } \
-  } \
-  \
-  /* one-shot fixed-length parallelhash (non-xof) */ \
-  void parallelhash ## BITS (const parallelhash_params_t params, const uint8_t * const src, const size_t src_len, uint8_t * const dst, const size_t dst_len) { \
-    /* init */ \
-    parallelhash_t hash; \
-    parallelhash ## BITS ## _init(&hash, params); \
-  \
-    /* absorb */ \
-    parallelhash ## BITS ## _absorb(&hash, src, src_len); \
-  \
-    /* squeeze */ \
-    parallelhash ## BITS ## _squeeze(&hash, dst, dst_len); \
-  } \
-  \
-  /* init parallelhash-xof context */ \
-  void parallelhash ## BITS ## _xof_init(parallelhash_t *hash, const parallelhash_params_t params) { \
-    parallelhash ## BITS ## _init(hash, params); \
-  } \
-  \
-  /* absorb data into parallelhash-xof context */ \
-  void parallelhash ## BITS ## _xof_absorb(parallelhash_t *hash, const uint8_t *msg, const size_t msg_len) { \
-    parallelhash ## BITS ## _absorb(hash, msg, msg_len); \
-  } \
-  \
-  /* squeeze data from parallelhash-xof context */ \
-  void parallelhash ## BITS ## _xof_squeeze(parallelhash_t *hash, uint8_t *dst, const size_t dst_len) { \
-    if (!hash->squeezing) { \
-      /* emit zero length */ \
-      parallelhash ## BITS ## _squeeze(hash, dst, 0); \
-    } \
-  \
-    parallelhash ## BITS ## _squeeze(hash, dst, dst_len); \
+    // compare without data-dependent branches
+    for (size_t i = 0; i < len; i++) {
+      uint8_t diff = 0;
+      for (size_t j = 0; j < out_len; j++) {
+        diff |= bufs[i][j] ^ macs[ofs + i][j];
+      }
+
+      const bool ok = !diff;
+      all_ok &= ok;
+      if (oks) {
+        oks[ofs + i] = ok;
+      }
+    }
+  }
+
+  return all_ok;
+}
+
+// define hmac-sha3 batch functions
+#define DEF_HMAC_BATCH(BITS, OUT_LEN) \
+  /* hmac-sha3 of batch of messages */ \
+  void hmac_sha3_ ## BITS ## _batch(const uint8_t * const k, const size_t k_len, const uint8_t * const srcs[], const size_t lens[], const size_t n, uint8_t * const dsts[]) { \
+    hmac_sha3_t hmac; \
+    hmac_sha3_ ## BITS ## _init(&hmac, k, k_len); \
+    hmac_batch(&hmac, RATE(OUT_LEN), OUT_LEN, srcs, lens, n, dsts); \
   } \
   \
-  /* one-shot parallelhash-xof */ \
-  void parallelhash ## BITS ## _xof_once(const parallelhash_params_t params, const uint8_t * const src, const size_t src_len, uint8_t * const dst, const size_t dst_len) { \
-    /* init */ \
-    parallelhash_t hash; \
-    parallelhash ## BITS ## _xof_init(&hash, params); \
-  \
-    /* absorb */ \
-    parallelhash ## BITS ## _xof_absorb(&hash, src, src_len); \
+  /* verify hmac-sha3 of batch of messages */ \
+  _Bool hmac_sha3_ ## BITS ## _batch_verify(const uint8_t * const k, const size_t k_len, const uint8_t * const srcs[], const size_t lens[], const size_t n, const uint8_t * const macs[], _Bool oks[]) { \
+    hmac_sha3_t hmac; \
+    hmac_sha3_ ## BITS ## _init(&hmac, k, k_len); \
+    return hmac_batch_verify(&hmac, RATE(OUT_LEN), OUT_LEN, srcs, lens, n, macs, oks); \
+  }
+
+// declare hmac-sha3 batch functions
+DEF_HMAC_BATCH(224, 28) // hmac_sha3_224_batch{,_verify}()
+DEF_HMAC_BATCH(256, 32) // hmac_sha3_256_batch{,_verify}()
+DEF_HMAC_BATCH(384, 48) // hmac_sha3_384_batch{,_verify}()
+DEF_HMAC_BATCH(512, 64) // hmac_sha3_512_batch{,_verify}()
+
+// NIST SP 800-105 utility function.
+static inline size_t left_encode(uint8_t buf[static 9], const uint64_t n) {
+  if (n > 0x00ffffffffffffffULL) {
+    buf[0] = 8;
+    buf[1] = (n >> 56) & 0xff;
+    buf[2] = (n >> 40) & 0xff;
+    buf[3] = (n >> 32) & 0xff;
+    buf[4] = (n >> 24) & 0xff;
+    buf[5] = (n >> 16) & 0xff;
+    buf[6] = (n >> 8) & 0xff;
+    buf[7] = n & 0xff;
+    return 9;
+  } else if (n > 0x0000ffffffffffffULL) {
+    buf[0] = 7;
+    buf[1] = (n >> 56) & 0xff;
+    buf[2] = (n >> 40) & 0xff;
+    buf[3] = (n >> 32) & 0xff;
+    buf[4] = (n >> 24) & 0xff;
+    buf[5] = (n >> 16) & 0xff;
+    buf[6] = (n >> 8) & 0xff;
+    buf[7] = n & 0xff;
+    return 8;
+  } else if (n > 0x000000ffffffffffULL) {
+    buf[0] = 6;
+    buf[1] = (n >> 40) & 0xff;
+    buf[2] = (n >> 32) & 0xff;
+    buf[3] = (n >> 24) & 0xff;
+    buf[4] = (n >> 16) & 0xff;
+    buf[5] = (n >> 8) & 0xff;
+    buf[6] = n & 0xff;
+    return 7;
+  } else if (n > 0x00000000ffffffffULL) {
+    buf[0] = 5;
+    buf[1] = (n >> 32) & 0xff;
+    buf[2] = (n >> 24) & 0xff;
+    buf[3] = (n >> 16) & 0xff;
+    buf[4] = (n >> 8) & 0xff;
+    buf[5] = n & 0xff;
+    return 6;
+  } else if (n > 0x0000000000ffffffULL) {
+    buf[0] = 4;
+    buf[1] = (n >> 24) & 0xff;
+    buf[2] = (n >> 16) & 0xff;
+    buf[3] = (n >> 8) & 0xff;
+    buf[4] = n & 0xff;
+    return 5;
+  } else if (n > 0x000000000000ffffULL) {
+    buf[0] = 3;
+    buf[1] = (n >> 16) & 0xff;
+    buf[2] = (n >> 8) & 0xff;
+    buf[3] = n & 0xff;
+    return 4;
+  } else if (n > 0x00000000000000ffULL) {
+    buf[0] = 2;
+    buf[1] = (n >> 8) & 0xff;
+    buf[2] = n & 0xff;
+    return 3;
+  } else {
+    buf[0] = 1;
+    buf[1] = n & 0xff;
+    return 2;
+  }
+}
+
+// NIST SP 800-105 utility function.
+static inline size_t right_encode(uint8_t buf[static 9], const uint64_t n) {
+  if (n > 0x00ffffffffffffffULL) {
+    buf[0] = (n >> 56) & 0xff;
+    buf[1] = (n >> 40) & 0xff;
+    buf[2] = (n >> 32) & 0xff;
+    buf[3] = (n >> 24) & 0xff;
+    buf[4] = (n >> 16) & 0xff;
+    buf[5] = (n >> 8) & 0xff;
+    buf[6] = n & 0xff;
+    buf[7] = 8;
+    return 9;
+  } else if (n > 0x0000ffffffffffffULL) {
+    buf[0] = (n >> 56) & 0xff;
+    buf[1] = (n >> 40) & 0xff;
+    buf[2] = (n >> 32) & 0xff;
+    buf[3] = (n >> 24) & 0xff;
+    buf[4] = (n >> 16) & 0xff;
+    buf[5] = (n >> 8) & 0xff;
+    buf[6] = n & 0xff;
+    buf[7] = 7;
+    return 8;
+  } else if (n > 0x000000ffffffffffULL) {
+    buf[0] = (n >> 40) & 0xff;
+    buf[1] = (n >> 32) & 0xff;
+    buf[2] = (n >> 24) & 0xff;
+    buf[3] = (n >> 16) & 0xff;
+    buf[4] = (n >> 8) & 0xff;
+    buf[5] = n & 0xff;
+    buf[6] = 6;
+    return 7;
+  } else if (n > 0x00000000ffffffffULL) {
+    buf[0] = (n >> 32) & 0xff;
+    buf[1] = (n >> 24) & 0xff;
+    buf[2] = (n >> 16) & 0xff;
+    buf[3] = (n >> 8) & 0xff;
+    buf[4] = n & 0xff;
+    buf[5] = 5;
+    return 6;
+  } else if (n > 0x0000000000ffffffULL) {
+    buf[0] = (n >> 24) & 0xff;
+    buf[1] = (n >> 16) & 0xff;
+    buf[2] = (n >> 8) & 0xff;
+    buf[3] = n & 0xff;
+    buf[4] = 4;
+    return 5;
+  } else if (n > 0x000000000000ffffULL) {
+    buf[0] = (n >> 16) & 0xff;
+    buf[1] = (n >> 8) & 0xff;
+    buf[2] = n & 0xff;
+    buf[3] = 3;
+    return 4;
+  } else if (n > 0x00000000000000ffULL) {
+    buf[0] = (n >> 8) & 0xff;
+    buf[1] = n & 0xff;
+    buf[2] = 2;
+    return 3;
+  } else {
+    buf[0] = n & 0xff;
+    buf[1] = 1;
+    return 2;
+  }
+}
+
+// kangarootwelve length encoding.
+// (similar to right_encode(), but slightly different)
+static inline size_t k12_length_encode(uint8_t buf[static 9], const uint64_t n) {
+  if (n > 0x00ffffffffffffffULL) {
+    buf[0] = (n >> 56) & 0xff;
+    buf[1] = (n >> 40) & 0xff;
+    buf[2] = (n >> 32) & 0xff;
+    buf[3] = (n >> 24) & 0xff;
+    buf[4] = (n >> 16) & 0xff;
+    buf[5] = (n >> 8) & 0xff;
+    buf[6] = n & 0xff;
+    buf[7] = 8;
+    return 9;
+  } else if (n > 0x0000ffffffffffffULL) {
+    buf[0] = (n >> 56) & 0xff;
+    buf[1] = (n >> 40) & 0xff;
+    buf[2] = (n >> 32) & 0xff;
+    buf[3] = (n >> 24) & 0xff;
+    buf[4] = (n >> 16) & 0xff;
+    buf[5] = (n >> 8) & 0xff;
+    buf[6] = n & 0xff;
+    buf[7] = 7;
+    return 8;
+  } else if (n > 0x000000ffffffffffULL) {
+    buf[0] = (n >> 40) & 0xff;
+    buf[1] = (n >> 32) & 0xff;
+    buf[2] = (n >> 24) & 0xff;
+    buf[3] = (n >> 16) & 0xff;
+    buf[4] = (n >> 8) & 0xff;
+    buf[5] = n & 0xff;
+    buf[6] = 6;
+    return 7;
+  } else if (n > 0x00000000ffffffffULL) {
+    buf[0] = (n >> 32) & 0xff;
+    buf[1] = (n >> 24) & 0xff;
+    buf[2] = (n >> 16) & 0xff;
+    buf[3] = (n >> 8) & 0xff;
+    buf[4] = n & 0xff;
+    buf[5] = 5;
+    return 6;
+  } else if (n > 0x0000000000ffffffULL) {
+    buf[0] = (n >> 24) & 0xff;
+    buf[1] = (n >> 16) & 0xff;
+    buf[2] = (n >> 8) & 0xff;
+    buf[3] = n & 0xff;
+    buf[4] = 4;
+    return 5;
+  } else if (n > 0x000000000000ffffULL) {
+    buf[0] = (n >> 16) & 0xff;
+    buf[1] = (n >> 8) & 0xff;
+    buf[2] = n & 0xff;
+    buf[3] = 3;
+    return 4;
+  } else if (n > 0x00000000000000ffULL) {
+    buf[0] = (n >> 8) & 0xff;
+    buf[1] = n & 0xff;
+    buf[2] = 2;
+    return 3;
+  } else if (n > 0) {
+    buf[0] = n & 0xff;
+    buf[1] = 1;
+    return 2;
+  } else {
+    buf[0] = 0;
+    return 1;
+  }
+}
+
+// Write prefix for encode_string() to the given buffer.  Accepts the
+// length of the string, in bytes.
+//
+// Returns the length of the prefix, in bytes.
+static inline size_t encode_string_prefix(uint8_t buf[static 9], const size_t num_bytes) {
+  return left_encode(buf, (uint64_t) num_bytes << 3);
+}
+
+typedef struct {
+  uint8_t prefix[9]; // bytepad prefix
+  size_t prefix_len; // length of bytepad prefix, in bytes
+  size_t pad_len; // number of padding bytes after prefix and data
+} bytepad_t;
+
+// write bytepad() prefix to buffer, then return structure containing
+// the length of the prefix, in bytes, and the total number of
+static inline bytepad_t bytepad(const size_t data_len, const size_t width) {
+  bytepad_t r = { { 0 }, 0, 0 };
+  const size_t prefix_len = left_encode(r.prefix, width);
+  const size_t total_len = prefix_len + data_len;
+  const size_t padded_len = (total_len / width + ((total_len % width) ? 1 : 0)) * width;
+
+  r.prefix_len = prefix_len;
+  r.pad_len = padded_len - total_len;
+
+  return r;
+}
+
+// cshake padding byte
+#define CSHAKE_PAD 0x04
+
+// define cshake one-shot and iterative context functions
+#define DEF_CSHAKE(BITS) \
+  /* absorb data into cshake context */ \
+  _Bool cshake ## BITS ## _xof_absorb(sha3_xof_t * const xof, const uint8_t * const msg, const size_t len) { \
+    return xof_absorb(xof, SHAKE ## BITS ## _RATE, msg, len); \
+  } \
   \
-    /* squeeze */ \
-    parallelhash ## BITS ## _xof_squeeze(&hash, dst, dst_len); \
+  /* squeeze data from cshake context */ \
+  void cshake ## BITS ## _xof_squeeze(sha3_xof_t * const xof, uint8_t * const dst, const size_t len) { \
+    xof_squeeze(xof, SHAKE ## BITS ## _RATE, CSHAKE_PAD, dst, len); \
+  } \
+  \
+  /* initialize cshake context */ \
+  void cshake ## BITS ## _xof_init(sha3_xof_t * const xof, const cshake_params_t params) { \
+    static const uint8_t PAD[SHAKE ## BITS ## _RATE] = { 0 }; \
+  \
+    if (!params.name_len && !params.custom_len) { \
+      /* cshake w/o nist prefix and domain is shake */ \
+      shake ## BITS ## _init(xof); \
+  \
+      /* FIXME: padding will be wrong on subsequent absorb() calls */ \
+      return; \
+    } \
+  \
+    /* build nist function name prefix */ \
+    uint8_t name_buf[9] = { 0 }; \
+    const size_t name_len = encode_string_prefix(name_buf, params.name_len); \
+  \
+    /* build custom string prefix */ \
+    uint8_t custom_buf[9] = { 0 }; \
+    const size_t custom_len = encode_string_prefix(custom_buf, params.custom_len); \
+  \
+    const size_t raw_len = name_len + params.name_len + custom_len + params.custom_len; \
+  \
+    /* build bytepad prefix */ \
+    const bytepad_t bp = bytepad(raw_len, SHAKE ## BITS ## _RATE); \
+  \
+    /* init xof */ \
+    xof_init(xof); \
+  \
+    /* absorb bytepad prefix */ \
+    (void) cshake ## BITS ## _xof_absorb(xof, bp.prefix, bp.prefix_len); \
+  \
+    /* absorb name string */ \
+    (void) cshake ## BITS ## _xof_absorb(xof, name_buf, name_len); \
+    if (params.name_len > 0) { \
+      (void) cshake ## BITS ## _xof_absorb(xof, params.name, params.name_len); \
+    } \
+  \
+    /* absorb custom string */ \
+    (void) cshake ## BITS ## _xof_absorb(xof, custom_buf, custom_len); \
+    if (params.custom_len > 0) { \
+      (void) cshake ## BITS ## _xof_absorb(xof, params.custom, params.custom_len); \
+    } \
+  \
+    /* absorb padding */ \
+    for (size_t ofs = 0; ofs < bp.pad_len; ofs += sizeof(PAD)) { \
+      const size_t len = MIN(bp.pad_len - ofs, sizeof(PAD)); \
+      (void) cshake ## BITS ## _xof_absorb(xof, PAD, len); \
+    } \
+  } \
+  \
+  /* one-shot cshake */ \
+  void cshake ## BITS ( \
+    const cshake_params_t params, \
+    const uint8_t * const msg, const size_t msg_len, \
+    uint8_t * const dst, const size_t dst_len \
+  ) { \
+    if (!params.name_len && !params.custom_len) { \
+      /* cshake w/o nist prefix and domain is shake */ \
+      shake ## BITS (msg, msg_len, dst, dst_len); \
+      return; \
+    } \
+  \
+    /* init */ \
+    sha3_xof_t xof; \
+    cshake ## BITS ## _xof_init(&xof, params); \
+  \
+    /* absorb */ \
+    (void) cshake ## BITS ## _xof_absorb(&xof, msg, msg_len); \
+  \
+    /* squeeze */ \
+    cshake ## BITS ## _xof_squeeze(&xof, dst, dst_len); \
+  }
+
+// declare cshake functions
+DEF_CSHAKE(128) // cshake128
+DEF_CSHAKE(256) // cshake256
+
+// define kmac one-shot and xof functions
+#define DEF_KMAC(BITS) \
+  /* one-shot kmac (non-xof) */ \
+  void kmac ## BITS ( \
+    const kmac_params_t params, \
+    const uint8_t * const msg, const size_t msg_len, \
+    uint8_t * const dst, const size_t dst_len \
+  ) { \
+    static const uint8_t PAD[SHAKE ## BITS ## _RATE] = { 0 }; \
+    static const uint8_t NAME[4] = { 'K', 'M', 'A', 'C' }; \
+  \
+    /* build params */ \
+    const cshake_params_t cshake_params = { \
+      .name = NAME, \
+      .name_len = sizeof(NAME), \
+      .custom = params.custom, \
+      .custom_len = params.custom_len, \
+    }; \
+  \
+    /* build key prefix */ \
+    uint8_t key_buf[9] = { 0 }; \
+    const size_t key_buf_len = encode_string_prefix(key_buf, params.key_len); \
+  \
+    /* build bytepad prefix */ \
+    const bytepad_t bp = bytepad(key_buf_len + params.key_len, SHAKE ## BITS ## _RATE); \
+  \
+    /* init xof */ \
+    sha3_xof_t xof; \
+    cshake ## BITS ## _xof_init(&xof, cshake_params); \
+  \
+    /* absorb bytepad prefix */ \
+    (void) cshake ## BITS ## _xof_absorb(&xof, bp.prefix, bp.prefix_len); \
+  \
+    /* absorb key */ \
+    (void) cshake ## BITS ## _xof_absorb(&xof, key_buf, key_buf_len); \
+    if (params.key_len > 0) { \
+      (void) cshake ## BITS ## _xof_absorb(&xof, params.key, params.key_len); \
+    } \
+  \
+    /* absorb padding */ \
+    for (size_t ofs = 0; ofs < bp.pad_len; ofs += sizeof(PAD)) { \
+      const size_t len = MIN(bp.pad_len - ofs, sizeof(PAD)); \
+      (void) cshake ## BITS ## _xof_absorb(&xof, PAD, len); \
+    } \
+  \
+    /* absorb message */ \
+    (void) cshake ## BITS ## _xof_absorb(&xof, msg, msg_len); \
+  \
+    /* build output length suffix */ \
+    uint8_t suffix_buf[9] = { 0 }; \
+    const size_t suffix_buf_len = right_encode(suffix_buf, dst_len << 3); \
+  \
+    /* absorb output length suffix */ \
+    (void) cshake ## BITS ## _xof_absorb(&xof, suffix_buf, suffix_buf_len); \
+  \
+    /* squeeze */ \
+    cshake ## BITS ## _xof_squeeze(&xof, dst, dst_len); \
+  } \
+  \
+  /* absorb data into kmac-xof context */ \
+  _Bool kmac ## BITS ## _xof_absorb(sha3_xof_t * const xof, const uint8_t * const msg, const size_t len) { \
+    return cshake ## BITS ## _xof_absorb(xof, msg, len); \
+  } \
+  \
+  /* squeeze data from kmac-xof context */ \
+  void kmac ## BITS ## _xof_squeeze(sha3_xof_t * const xof, uint8_t * const dst, const size_t len) { \
+    if (!xof->squeezing) { \
+      /* append XOF length suffix */ \
+      const uint8_t SUFFIX[] = { 0, 1 }; \
+      (void) cshake ## BITS ## _xof_absorb(xof, SUFFIX, sizeof(SUFFIX)); \
+    } \
+    cshake ## BITS ## _xof_squeeze(xof, dst, len); \
+  } \
+  \
+  /* init kmac-xof context */ \
+  void kmac ## BITS ## _xof_init(sha3_xof_t * const xof, const kmac_params_t params) { \
+    static const uint8_t PAD[SHAKE ## BITS ## _RATE] = { 0 }; \
+    static const uint8_t NAME[4] = { 'K', 'M', 'A', 'C' }; \
+  \
+    /* build cshake params */ \
+    const cshake_params_t cshake_params = { \
+      .name = NAME, \
+      .name_len = sizeof(NAME), \
+      .custom = params.custom, \
+      .custom_len = params.custom_len, \
+    }; \
+  \
+    /* build key prefix */ \
+    uint8_t key_buf[9] = { 0 }; \
+    const size_t key_buf_len = encode_string_prefix(key_buf, params.key_len); \
+  \
+    /* build bytepad prefix */ \
+    const bytepad_t bp = bytepad(key_buf_len + params.key_len, SHAKE ## BITS ## _RATE); \
+  \
+    /* init xof */ \
+    cshake ## BITS ## _xof_init(xof, cshake_params); \
+  \
+    /* absorb bytepad prefix */ \
+    (void) cshake ## BITS ## _xof_absorb(xof, bp.prefix, bp.prefix_len); \
+  \
+    /* absorb key */ \
+    (void) cshake ## BITS ## _xof_absorb(xof, key_buf, key_buf_len); \
+    if (params.key_len > 0) { \
+      (void) cshake ## BITS ## _xof_absorb(xof, params.key, params.key_len); \
+    } \
+  \
+    /* absorb padding */ \
+    for (size_t ofs = 0; ofs < bp.pad_len; ofs += sizeof(PAD)) { \
+      const size_t len = MIN(bp.pad_len - ofs, sizeof(PAD)); \
+      (void) cshake ## BITS ## _xof_absorb(xof, PAD, len); \
+    } \
+  } \
+  \
+  /* one-shot kmac-xof */ \
+  void kmac ## BITS ## _xof_once(const kmac_params_t params, const uint8_t * const src, const size_t src_len, uint8_t * const dst, const size_t dst_len) { \
+    sha3_xof_t xof; \
+    kmac ## BITS ## _xof_init(&xof, params); \
+    kmac ## BITS ## _xof_absorb(&xof, src, src_len); \
+    kmac ## BITS ## _xof_squeeze(&xof, dst, dst_len); \
+  }
+
+// declare kmac functions
+DEF_KMAC(128) // kmac128
+DEF_KMAC(256) // kmac256
+
+/**
+ * @brief KMAC batch (callback data for multi-buffer sponge engine).
+ */
+typedef struct {
+  size_t rate; /**< Rate, in bytes */
+  const sha3_state_t *init; /**< State after shared key block (NULL if messages have customization strings) */
+  const uint8_t *key; /**< Key */
+  size_t key_len; /**< Key length, in bytes */
+  const uint8_t * const *msgs; /**< Messages */
+  const size_t *lens; /**< Message lengths, in bytes */
+  const uint8_t * const *customs; /**< Customization strings (may be NULL) */
+  const size_t *custom_lens; /**< Customization string lengths, in bytes */
+  uint8_t * const *dsts; /**< Output buffers */
+  const size_t *dst_lens; /**< Output lengths, in bytes */
+} kmac_batch_t;
+
+/**
+ * @brief Get KMAC batch job (`mb_params_t.get_job` callback).
+ *
+ * @param[in] cb_data KMAC batch (`kmac_batch_t`).
+ * @param[in] job_id Job ID.
+ * @param[out] job Job.
+ */
+static void kmac_batch_get_job(void * const cb_data, const size_t job_id, mb_job_t * const job) {
+  const kmac_batch_t * const kb = cb_data;
+  job->init = kb->init;
+  job->dst = kb->dsts[job_id];
+  job->dst_len = kb->dst_lens[job_id];
+}
+
+/**
+ * @brief Get KMAC batch input segment (`mb_params_t.next_seg` callback).
+ *
+ * Without a shared state, the segments are the cSHAKE prefix block
+ * (bytepad prefix and encoded "KMAC" name, encoded customization
+ * string, and zero padding), the key block (bytepad prefix, encoded
+ * key, and zero padding), the message, and the encoded output length.
+ * With a shared state, only the message and the encoded output length.
+ *
+ * @param[in] cb_data KMAC batch (`kmac_batch_t`).
+ * @param[in] job Job (unused).
+ * @param[in] job_id Job ID.
+ * @param[in] seg_id Segment ID.
+ * @param[out] scratch Scratch buffer.
+ * @param[out] ptr Segment pointer.
+ * @param[out] len Segment length, in bytes.
+ *
+ * @return False if there are no more segments.
+ */
+static _Bool kmac_batch_next_seg(void * const cb_data, const mb_job_t * const job, const size_t job_id, size_t seg_id, uint8_t scratch[static MB_SCRATCH_LEN], const uint8_t ** const ptr, size_t * const len) {
+  static const uint8_t ZEROS[SHAKE128_RATE] = { 0 };
+  static const uint8_t NAME[4] = { 'K', 'M', 'A', 'C' };
+  const kmac_batch_t * const kb = cb_data;
+  (void) job; // unused
+
+  // skip prefix and key blocks if they are in the shared state
+  seg_id += kb->init ? 7 : 0;
+
+  switch (seg_id) {
+  case 0:
+    // cshake bytepad prefix and encoded name
+    *len = left_encode(scratch, kb->rate);
+    *len += encode_string_prefix(scratch + *len, sizeof(NAME));
+    memcpy(scratch + *len, NAME, sizeof(NAME));
+    *len += sizeof(NAME);
+    *ptr = scratch;
+    return true;
+  case 1:
+    // customization string prefix
+    *len = encode_string_prefix(scratch, kb->custom_lens[job_id]);
+    *ptr = scratch;
+    return true;
+  case 2:
+    // customization string
+    *ptr = kb->customs[job_id];
+    *len = kb->custom_lens[job_id];
+    return true;
+  case 3:
+    {
+      // cshake prefix block padding
+      uint8_t buf[9];
+      const size_t raw_len = 2 + sizeof(NAME) + encode_string_prefix(buf, kb->custom_lens[job_id]) + kb->custom_lens[job_id];
+      *ptr = ZEROS;
+      *len = bytepad(raw_len, kb->rate).pad_len;
+    }
+    return true;
+  case 4:
+    // key bytepad prefix and key prefix
+    *len = left_encode(scratch, kb->rate);
+    *len += encode_string_prefix(scratch + *len, kb->key_len);
+    *ptr = scratch;
+    return true;
+  case 5:
+    // key
+    *ptr = kb->key;
+    *len = kb->key_len;
+    return true;
+  case 6:
+    {
+      // key block padding
+      uint8_t buf[9];
+      *ptr = ZEROS;
+      *len = bytepad(encode_string_prefix(buf, kb->key_len) + kb->key_len, kb->rate).pad_len;
+    }
+    return true;
+  case 7:
+    // message
+    *ptr = kb->msgs[job_id];
+    *len = kb->lens[job_id];
+    return true;
+  case 8:
+    // encoded output length
+    *len = right_encode(scratch, kb->dst_lens[job_id] << 3);
+    *ptr = scratch;
+    return true;
+  default:
+    return false;
+  }
+}
+
+// define kmac batch functions
+#define DEF_KMAC_BATCH(BITS) \
+  /* kmac of batch of messages */ \
+  void kmac ## BITS ## _batch(const uint8_t * const key, const size_t key_len, const uint8_t * const msgs[], const size_t lens[], const size_t n, const uint8_t * const customs[], const size_t custom_lens[], uint8_t * const dsts[], const size_t dst_lens[]) { \
+    /* without customization strings, absorb key once and share state */ \
+    sha3_xof_t xof; \
+    if (!customs) { \
+      const kmac_params_t params = { .key = key, .key_len = key_len }; \
+      kmac ## BITS ## _xof_init(&xof, params); \
+    } \
+  \
+    kmac_batch_t kb = { \
+      .rate = SHAKE ## BITS ## _RATE, \
+      .init = customs ? NULL : &(xof.a), \
+      .key = key, \
+      .key_len = key_len, \
+      .msgs = msgs, \
+      .lens = lens, \
+      .customs = customs, \
+      .custom_lens = custom_lens, \
+      .dsts = dsts, \
+      .dst_lens = dst_lens, \
+    }; \
+    const mb_params_t params = { \
+      .rate = SHAKE ## BITS ## _RATE, \
+      .num_rounds = SHA3_NUM_ROUNDS, \
+      .pad = CSHAKE_PAD, \
+      .get_job = kmac_batch_get_job, \
+      .next_seg = kmac_batch_next_seg, \
+      .cb_data = &kb, \
+    }; \
+    mb_run(&params, n); \
+  }
+
+// declare kmac batch functions
+DEF_KMAC_BATCH(128) // kmac128_batch()
+DEF_KMAC_BATCH(256) // kmac256_batch()
+
+// define tuplehash and tuplehash-xof functions
+#define DEF_TUPLEHASH(BITS) \
+  /* init tuplehash context */ \
+  static inline void tuplehash ## BITS ## _init(sha3_xof_t * const xof, const tuplehash_params_t params, const size_t dst_len) { \
+    static const uint8_t NAME[] = { 'T', 'u', 'p', 'l', 'e', 'H', 'a', 's', 'h' }; \
+  \
+    /* build cshake ## BITS ##  params */ \
+    const cshake_params_t cshake_params = { \
+      .name = NAME, \
+      .name_len = sizeof(NAME), \
+      .custom = params.custom, \
+      .custom_len = params.custom_len, \
+    }; \
+  \
+    /* init xof */ \
+    cshake ## BITS ## _xof_init(xof, cshake_params); \
+  \
+    /* absorb tuples */ \
+    /* FIXME: length counter in 800-185 is wrong here */ \
+    for (size_t i = 0; i < params.num_strs; i++) { \
+      /* absorb length */ \
+      uint8_t buf[9] = { 0 }; \
+      const size_t buf_len = encode_string_prefix(buf, params.strs[i].len); \
+      (void) cshake ## BITS ## _xof_absorb(xof, buf, buf_len); \
+  \
+      /* absorb content */ \
+      if (params.strs[i].len > 0) { \
+        (void) cshake ## BITS ## _xof_absorb(xof, params.strs[i].ptr, params.strs[i].len); \
+      } \
+    } \
+  \
+    /* build output length suffix */ \
+    uint8_t suffix_buf[9] = { 0 }; \
+    const size_t suffix_buf_len = right_encode(suffix_buf, dst_len << 3); \
+  \
+    /* absorb output length suffix */ \
+    (void) cshake ## BITS ## _xof_absorb(xof, suffix_buf, suffix_buf_len); \
+  } \
+  \
+  /* one-shot tuplehash with fixed-length output (non-xof) */ \
+  void tuplehash ## BITS (const tuplehash_params_t params, uint8_t * const dst, const size_t dst_len) { \
+    /* init */ \
+    sha3_xof_t xof; \
+    tuplehash ## BITS ## _init(&xof, params, dst_len); \
+  \
+    /* squeeze */ \
+    cshake ## BITS ## _xof_squeeze(&xof, dst, dst_len); \
+  } \
+  \
+  /* init tuplehash context */ \
+  void tuplehash ## BITS ## _xof_init(sha3_xof_t * const xof, const tuplehash_params_t params) { \
+    tuplehash ## BITS ## _init(xof, params, 0); \
+  } \
+  \
+  /* squeeze data from tuplehash */ \
+  void tuplehash ## BITS ## _xof_squeeze(sha3_xof_t * const xof, uint8_t * const dst, const size_t dst_len) { \
+    cshake ## BITS ## _xof_squeeze(xof, dst, dst_len); \
+  } \
+  \
+  /* one-shot tuplehash-xof */ \
+  void tuplehash ## BITS ## _xof_once(const tuplehash_params_t params, uint8_t * const dst, const size_t dst_len) { \
+    /* init xof */ \
+    sha3_xof_t xof; \
+    tuplehash ## BITS ## _xof_init(&xof, params); \
+  \
+    /* squeeze */ \
+    cshake ## BITS ## _xof_squeeze(&xof, dst, dst_len); \
+  }
+
+// declare tuplehash functions
+DEF_TUPLEHASH(128) // tuplehash128, tuplehash128-xof
+DEF_TUPLEHASH(256) // tuplehash256, tuplehash256-xof
+
+/**
+ * @brief TupleHash batch (callback data for multi-buffer sponge engine).
+ */
+typedef struct {
+  const sha3_state_t *init; /**< Shared initial state */
+  const tuplehash_str_t *strs; /**< Column-major tuple elements */
+  size_t num_rows; /**< Number of rows */
+  size_t num_cols; /**< Number of columns */
+  uint8_t * const *dsts; /**< Output buffers */
+  size_t dst_len; /**< Output length, in bytes */
+} tuplehash_batch_t;
+
+/**
+ * @brief Get TupleHash batch job (`mb_params_t.get_job` callback).
+ *
+ * @param[in] cb_data TupleHash batch (`tuplehash_batch_t`).
+ * @param[in] job_id Job ID (row).
+ * @param[out] job Job.
+ */
+static void tuplehash_batch_get_job(void * const cb_data, const size_t job_id, mb_job_t * const job) {
+  const tuplehash_batch_t * const tb = cb_data;
+  job->init = tb->init;
+  job->dst = tb->dsts[job_id];
+  job->dst_len = tb->dst_len;
+}
+
+/**
+ * @brief Get TupleHash batch input segment (`mb_params_t.next_seg`
+ * callback).
+ *
+ * Even segments are encoded element lengths, odd segments are element
+ * contents, and the last segment is the encoded output length.
+ *
+ * @param[in] cb_data TupleHash batch (`tuplehash_batch_t`).
+ * @param[in] job Job (unused).
+ * @param[in] job_id Job ID (row).
+ * @param[in] seg_id Segment ID.
+ * @param[out] scratch Scratch buffer.
+ * @param[out] ptr Segment pointer.
+ * @param[out] len Segment length, in bytes.
+ *
+ * @return False if there are no more segments.
+ */
+static _Bool tuplehash_batch_next_seg(void * const cb_data, const mb_job_t * const job, const size_t job_id, const size_t seg_id, uint8_t scratch[static MB_SCRATCH_LEN], const uint8_t ** const ptr, size_t * const len) {
+  const tuplehash_batch_t * const tb = cb_data;
+  (void) job; // unused
+  const size_t col = seg_id / 2;
+
+  if (col < tb->num_cols) {
+    const tuplehash_str_t * const str = tb->strs + col * tb->num_rows + job_id;
+    if (seg_id & 1) {
+      // element contents
+      *ptr = str->ptr;
+      *len = str->len;
+    } else {
+      // encoded element length
+      *ptr = scratch;
+      *len = encode_string_prefix(scratch, str->len);
+    }
+    return true;
+  } else if (seg_id == 2 * tb->num_cols) {
+    // encoded output length
+    *ptr = scratch;
+    *len = right_encode(scratch, tb->dst_len << 3);
+    return true;
+  }
+
+  return false;
+}
+
+// define tuplehash batch functions
+#define DEF_TUPLEHASH_BATCH(BITS) \
+  /* tuplehash of each row of table of tuples */ \
+  void tuplehash ## BITS ## _batch(const tuplehash_str_t * const strs, const size_t num_rows, const size_t num_cols, const uint8_t * const custom, const size_t custom_len, uint8_t * const dsts[], const size_t dst_len) { \
+    static const uint8_t NAME[] = { 'T', 'u', 'p', 'l', 'e', 'H', 'a', 's', 'h' }; \
+  \
+    /* absorb name and customization string once */ \
+    const cshake_params_t cshake_params = { \
+      .name = NAME, \
+      .name_len = sizeof(NAME), \
+      .custom = custom, \
+      .custom_len = custom_len, \
+    }; \
+    sha3_xof_t xof; \
+    cshake ## BITS ## _xof_init(&xof, cshake_params); \
+  \
+    tuplehash_batch_t tb = { \
+      .init = &(xof.a), \
+      .strs = strs, \
+      .num_rows = num_rows, \
+      .num_cols = num_cols, \
+      .dsts = dsts, \
+      .dst_len = dst_len, \
+    }; \
+    const mb_params_t params = { \
+      .rate = SHAKE ## BITS ## _RATE, \
+      .num_rounds = SHA3_NUM_ROUNDS, \
+      .pad = CSHAKE_PAD, \
+      .get_job = tuplehash_batch_get_job, \
+      .next_seg = tuplehash_batch_next_seg, \
+      .cb_data = &tb, \
+    }; \
+    mb_run(&params, num_rows); \
+  }
+
+// declare tuplehash batch functions
+DEF_TUPLEHASH_BATCH(128) // tuplehash128_batch()
+DEF_TUPLEHASH_BATCH(256) // tuplehash256_batch()
+
+// define parallelhash and parallelhash-xof functions
+#define DEF_PARALLELHASH(BITS) \
+  /* emit block for current xof into root xof */ \
+  static inline void parallelhash ## BITS ## _emit_block(parallelhash_t * const hash) { \
+    /* squeeze curr xof, absorb into root xof */ \
+    uint8_t buf[BITS / 4]; /* ph128: 32, ph256: 64 */ \
+    shake ## BITS ## _squeeze(&(hash->curr_xof), buf, sizeof(buf)); \
+    (void) cshake ## BITS ## _xof_absorb(&(hash->root_xof), buf, sizeof(buf)); \
+  \
+    /* increment block count */ \
+    hash->num_blocks++; \
+  } \
+  \
+  /* reset context for current internal xof */ \
+  static inline void parallelhash ## BITS ## _reset_curr_xof(parallelhash_t *hash) { \
+    /* init curr xof */ \
+    shake ## BITS ## _init(&(hash->curr_xof)); \
+    hash->ofs = 0; \
+  } \
+  \
+  /* init parallelhash context */ \
+  static inline void parallelhash ## BITS ## _init(parallelhash_t *hash, const parallelhash_params_t params) { \
+    static const uint8_t NAME[] = { 'P', 'a', 'r', 'a', 'l', 'l', 'e', 'l', 'H', 'a', 's', 'h' }; \
+  \
+    /* build root xof cshake params */ \
+    const cshake_params_t root_cshake_params = { \
+      .name = NAME, \
+      .name_len = sizeof(NAME), \
+      .custom = params.custom, \
+      .custom_len = params.custom_len, \
+    }; \
+  \
+    /* init root xof */ \
+    cshake ## BITS ## _xof_init(&(hash->root_xof), root_cshake_params); \
+  \
+    /* build block size */ \
+    uint8_t buf[9] = { 0 }; \
+    const size_t buf_len = left_encode(buf, params.block_len); \
+  \
+    /* absorb block length into root xof */ \
+    (void) cshake ## BITS ## _xof_absorb(&(hash->root_xof), buf, buf_len); \
+  \
+    /* set parameters */ \
+    hash->block_len = params.block_len; \
+    hash->num_blocks = 0; \
+    hash->squeezing = false; \
+  \
+    /* init curr xof */ \
+    parallelhash ## BITS ## _reset_curr_xof(hash); \
+  } \
+  \
+  /* absorb data into parallelhash context */ \
+  static inline void parallelhash ## BITS ## _absorb(parallelhash_t * const hash, const uint8_t *msg, size_t msg_len) { \
+    while (msg_len > 0) { \
+      const size_t len = MIN(msg_len, hash->block_len - hash->ofs); \
+      (void) shake ## BITS ## _absorb(&(hash->curr_xof), msg, len); \
+      msg += len; \
+      msg_len -= len; \
+  \
+      hash->ofs += len; \
+      if (hash->ofs == hash->block_len) { \
+        /* emit block, reset curr xof */ \
+        parallelhash ## BITS ## _emit_block(hash); \
+        parallelhash ## BITS ## _reset_curr_xof(hash); \
+      } \
+    } \
+  } \
+  \
+  /* squeeze data from parallelhash context */ \
+  static inline void parallelhash ## BITS ## _squeeze(parallelhash_t * const hash, uint8_t * const dst, const size_t dst_len) { \
+    if (!hash->squeezing) { \
+      /* mark as squeezing */ \
+      hash->squeezing = true; \
+  \
+      if (hash->ofs > 0) { \
+        /* squeeze curr xof, absorb into root xof */ \
+        parallelhash ## BITS ## _emit_block(hash); \
+      } \
+  \
+      { \
+        /* build num blocks suffix */ \
+        uint8_t buf[9] = { 0 }; \
+        const size_t len = right_encode(buf, hash->num_blocks); \
+  \
+        /* absorb num blocks suffix into root xof */ \
+        (void) cshake ## BITS ## _xof_absorb(&(hash->root_xof), buf, len); \
+      } \
+  \
+      { \
+        /* build output size suffix */ \
+        uint8_t buf[9] = { 0 }; \
+        const size_t len = right_encode(buf, dst_len << 3); \
+  \
+        /* absorb output size suffix into root xof */ \
+        (void) cshake ## BITS ## _xof_absorb(&(hash->root_xof), buf, len); \
+      } \
+    } \
+  \
+    if (dst_len > 0) { \
+      cshake ## BITS ## _xof_squeeze(&(hash->root_xof), dst, dst_len); \
+    } \
+  } \
+  \
+  /* one-shot fixed-length parallelhash (non-xof) */ \
+  void parallelhash ## BITS (const parallelhash_params_t params, const uint8_t * const src, const size_t src_len, uint8_t * const dst, const size_t dst_len) { \
+    /* init */ \
+    parallelhash_t hash; \
+    parallelhash ## BITS ## _init(&hash, params); \
+  \
+    /* absorb */ \
+    parallelhash ## BITS ## _absorb(&hash, src, src_len); \
+  \
+    /* squeeze */ \
+    parallelhash ## BITS ## _squeeze(&hash, dst, dst_len); \
+  } \
+  \
+  /* init parallelhash-xof context */ \
+  void parallelhash ## BITS ## _xof_init(parallelhash_t *hash, const parallelhash_params_t params) { \
+    parallelhash ## BITS ## _init(hash, params); \
+  } \
+  \
+  /* absorb data into parallelhash-xof context */ \
+  void parallelhash ## BITS ## _xof_absorb(parallelhash_t *hash, const uint8_t *msg, const size_t msg_len) { \
+    parallelhash ## BITS ## _absorb(hash, msg, msg_len); \
+  } \
+  \
+  /* squeeze data from parallelhash-xof context */ \
+  void parallelhash ## BITS ## _xof_squeeze(parallelhash_t *hash, uint8_t *dst, const size_t dst_len) { \
+    if (!hash->squeezing) { \
+      /* emit zero length */ \
+      parallelhash ## BITS ## _squeeze(hash, dst, 0); \
+    } \
+  \
+    parallelhash ## BITS ## _squeeze(hash, dst, dst_len); \
+  } \
+  \
+  /* one-shot parallelhash-xof */ \
+  void parallelhash ## BITS ## _xof_once(const parallelhash_params_t params, const uint8_t * const src, const size_t src_len, uint8_t * const dst, const size_t dst_len) { \
+    /* init */ \
+    parallelhash_t hash; \
+    parallelhash ## BITS ## _xof_init(&hash, params); \
+  \
+    /* absorb */ \
+    parallelhash ## BITS ## _xof_absorb(&hash, src, src_len); \
+  \
+    /* squeeze */ \
+    parallelhash ## BITS ## _xof_squeeze(&hash, dst, dst_len); \
+  }
+
+// declare parallelhash functions
+DEF_PARALLELHASH(128) // parallelhash128, parallehash128-xof
+DEF_PARALLELHASH(256) // parallelhash256, parallehash256-xof
+
+// number of rounds
+#define TURBOSHAKE_NUM_ROUNDS 12
+
+// default turboshake pad byte (can be customized for domain separation)
+#define TURBOSHAKE_PAD 0x1f
+
+// init turboshake context with given pad byte.  returns false if the
+// pad byte is out of range.
+static inline _Bool turboshake_init(turboshake_t * const ts, const uint8_t pad) {
+  // check for valid pad
+  if (!pad || pad > 0x1f) {
+    // invalid pad
+    return false;
+  }
+
+  // init xof
+  xof12_init(&(ts->xof));
+  ts->pad = pad;
+
+  // return success
+  return true;
+}
+
+// define turboshake functions
+#define DEF_TURBOSHAKE(BITS) \
+  /* init turboshake context with custom pad byte.  returns false if the */ \
+  /* pad byte is out of range. */ \
+  _Bool turboshake ## BITS ## _init_custom(turboshake_t * const ts, const uint8_t pad) { \
+    return turboshake_init(ts, pad); \
+  } \
+  \
+  /* init turboshake context */ \
+  void turboshake ## BITS ## _init(turboshake_t * const ts) { \
+    (void) turboshake_init(ts, TURBOSHAKE_PAD); \
+  } \
+  \
+  /* absorb bytes into turboshake context. */ \
+  _Bool turboshake ## BITS ## _absorb(turboshake_t * const ts, const uint8_t * const m, const size_t len) { \
+    return xof12_absorb(&(ts->xof), SHAKE ## BITS ## _RATE, m, len); \
+  } \
+  \
+  /* squeeze bytes from turboshake context */ \
+  void turboshake ## BITS ## _squeeze(turboshake_t * const ts, uint8_t * const dst, const size_t dst_len) { \
+    xof12_squeeze(&(ts->xof), SHAKE ## BITS ## _RATE, ts->pad, dst, dst_len); \
+  } \
+  \
+  /* one-shot turboshake with default pad byte */ \
+  void turboshake ## BITS (const uint8_t * const src, const size_t src_len, uint8_t * const dst, const size_t dst_len) { \
+    xof12_once(SHAKE ## BITS ## _RATE, TURBOSHAKE_PAD, src, src_len, dst, dst_len); \
+  } \
+  \
+  /* one-shot turboshake with custom pad byte */ \
+  void turboshake ## BITS ## _custom(const uint8_t pad, const uint8_t * const src, const size_t src_len, uint8_t * const dst, const size_t dst_len) { \
+    xof12_once(SHAKE ## BITS ## _RATE, pad, src, src_len, dst, dst_len); \
+  }
+
+// declare turboshake functions
+DEF_TURBOSHAKE(128) // turboshake128
+DEF_TURBOSHAKE(256) // turboshake128
+
+// keyed turboshake128 hash domain separation byte
+#define TURBOSHAKE_KEYED_PAD 0x0d
+
+// Initialize keyed turboshake128 hash key.
+void turboshake128_key_init(turboshake128_key_t * const key, const uint8_t * const k, const size_t k_len) {
+  static const uint8_t PAD[SHAKE128_RATE] = { 0 };
+
+  // build key prefix and bytepad prefix
+  uint8_t key_buf[9] = { 0 };
+  const size_t key_buf_len = encode_string_prefix(key_buf, k_len);
+  const bytepad_t bp = bytepad(key_buf_len + k_len, SHAKE128_RATE);
+
+  // absorb bytepad prefix, key, and padding
+  sha3_xof12_t xof;
+  xof12_init(&xof);
+  xof12_absorb_raw(&xof, SHAKE128_RATE, bp.prefix, bp.prefix_len);
+  xof12_absorb_raw(&xof, SHAKE128_RATE, key_buf, key_buf_len);
+  xof12_absorb_raw(&xof, SHAKE128_RATE, k, k_len);
+  xof12_absorb_raw(&xof, SHAKE128_RATE, PAD, bp.pad_len);
+
+  // save state (the padded key is a whole number of blocks, so the
+  // state has just been permuted)
+  key->a = xof.a;
+}
+
+/**
+ * @brief Absorb message into copy of keyed turboshake128 hash key and
+ * append padding.
+ *
+ * Used by `turboshake128_keyed_u64()`, `turboshake128_keyed_u64s()`,
+ * and `turboshake128_keyed_u64_x8()`.  The final permutation is left
+ * to the caller.
+ *
+ * @param[in] key Keyed turboshake128 hash key.
+ * @param[out] xof XOF12 context.
+ * @param[in] src Source buffer.
+ * @param[in] len Source buffer length, in bytes.
+ */
+static inline void turboshake128_keyed_absorb(const turboshake128_key_t * const key, sha3_xof12_t * const xof, const uint8_t * const src, const size_t len) {
+  xof->a = key->a;
+  xof->num_bytes = 0;
+  xof12_absorb_raw(xof, SHAKE128_RATE, src, len);
+
+  // append suffix and padding
+  xof->a.u8[xof->num_bytes] ^= TURBOSHAKE_KEYED_PAD;
+  xof->a.u8[SHAKE128_RATE - 1] ^= 0x80;
+  xof->num_bytes = 0;
+  xof->squeezing = true;
+}
+
+// Calculate 64-bit keyed turboshake128 hash.
+uint64_t turboshake128_keyed_u64(const turboshake128_key_t * const key, const uint8_t * const src, const size_t len) {
+  sha3_xof12_t xof;
+  turboshake128_keyed_absorb(key, &xof, src, len);
+  permute_12(xof.a.u64);
+  return xof.a.u64[0];
+}
+
+// Calculate several 64-bit keyed turboshake128 hash values.
+void turboshake128_keyed_u64s(const turboshake128_key_t * const key, const uint8_t * const src, const size_t len, uint64_t * const dst, const size_t n) {
+  sha3_xof12_t xof;
+  turboshake128_keyed_absorb(key, &xof, src, len);
+  permute_12(xof.a.u64);
+  xof12_squeeze_raw(&xof, SHAKE128_RATE, (uint8_t*) dst, 8 * n);
+}
+
+// Calculate 64-bit keyed turboshake128 hashes of eight messages.
+void turboshake128_keyed_u64_x8(const turboshake128_key_t * const key, const uint8_t * const srcs[8], const size_t lens[8], uint64_t dst[8]) {
+  sha3_state_t a[8];
+  for (size_t i = 0; i < 8; i++) {
+    sha3_xof12_t xof;
+    turboshake128_keyed_absorb(key, &xof, srcs[i], lens[i]);
+    a[i] = xof.a;
+  }
+
+  permute_batch(a, 8, TURBOSHAKE_NUM_ROUNDS);
+
+  for (size_t i = 0; i < 8; i++) {
+    dst[i] = a[i].u64[0];
+  }
+}
+
+// kangarootwelve block size, in bytes
+#define K12_BLOCK_LEN 8192
+
+// pad byte for single kangarootwelve chunk (<= 8192 bytes)
+#define K12_PAD_SINGLE 0x07
+
+// pad byte for root kangarootwelve turboshake instance (> 8192 bytes)
+#define K12_PAD_ROOT 0x06
+
+// pad byte for child kangarootwelve turboshake instances (> 8192 bytes)
+#define K12_PAD_CHILD 0x0B
+
+// private kangarootwelve big context
+typedef struct {
+  turboshake_t *root, // root turboshake context
+               curr; // current child turboshake context
+  size_t num_bytes,  // num bytes in current block
+         num_blocks; // total number of blocks
+} k12_big_t;
+
+// init kangarootwelve big context
+static void k12_big_init(k12_big_t * const big, turboshake_t * const root) {
+  // init root context
+  turboshake128_init_custom(root, K12_PAD_ROOT);
+
+  big->root = root;
+  big->num_bytes = 0;
+  big->num_blocks = 0;
+}
+
+// maximum number of whole kangarootwelve leaves hashed together by
+// k12_big_leaves()
+#define K12_MAX_BATCH_LEAVES 8
+
+// hash whole leaves together with the multi-buffer engine and absorb
+// their chaining values into root
+static void k12_big_leaves(k12_big_t * const big, const uint8_t * const src, const size_t num_leaves) {
+  const uint8_t *srcs[K12_MAX_BATCH_LEAVES];
+  uint8_t cvs[K12_MAX_BATCH_LEAVES][32];
+  uint8_t *dsts[K12_MAX_BATCH_LEAVES];
+  for (size_t i = 0; i < num_leaves; i++) {
+    srcs[i] = src + i * K12_BLOCK_LEN;
+    dsts[i] = cvs[i];
+  }
+
+  mb_arrays_t arrays = { .srcs = srcs, .src_len = K12_BLOCK_LEN, .dsts = dsts, .dst_len = 32 };
+  const mb_params_t params = {
+    .rate = SHAKE128_RATE,
+    .num_rounds = TURBOSHAKE_NUM_ROUNDS,
+    .pad = K12_PAD_CHILD,
+    .get_job = mb_arrays_get_job,
+    .cb_data = &arrays,
+  };
+  mb_run(&params, num_leaves);
+
+  // absorb chaining values into root
+  turboshake128_absorb(big->root, cvs[0], num_leaves * sizeof(cvs[0]));
+  big->num_blocks += num_leaves;
+}
+
+// absorb data in child context
+static void k12_big_child_absorb(k12_big_t * const big, const uint8_t *src, size_t src_len) {
+  while (src_len > 0) {
+    if (MB_NUM_LANES > 1 && !big->num_bytes && src_len >= 2 * K12_BLOCK_LEN) {
+      // at least two whole leaves left, so hash them together with
+      // the multi-buffer engine instead of one at a time
+      const size_t num_leaves = MIN(src_len / K12_BLOCK_LEN, K12_MAX_BATCH_LEAVES);
+      k12_big_leaves(big, src, num_leaves);
+      src += num_leaves * K12_BLOCK_LEN;
+      src_len -= num_leaves * K12_BLOCK_LEN;
+      continue;
+    }
+
+    const size_t len = MIN(K12_BLOCK_LEN - big->num_bytes, src_len);
+
+    // absorb into child context
+    turboshake128_absorb(&(big->curr), src, len);
+
+    src += len;
+    src_len -= len;
+    big->num_bytes += len;
+
+    if (big->num_bytes == K12_BLOCK_LEN) {
+      // hash child
+      uint8_t buf[32] = { 0 };
+      turboshake128_squeeze(&(big->curr), buf, sizeof(buf));
+
+      // absorb hash into root
+      turboshake128_absorb(big->root, buf, sizeof(buf));
+
+      // reset child
+      turboshake128_init_custom(&(big->curr), K12_PAD_CHILD);
+
+      // clear byte count, increment block count
+      big->num_bytes = 0;
+      big->num_blocks++;
+    }
+  }
+}
+
+// absorb data in root context
+// (passes excess data to child context)
+static void k12_big_root_absorb(k12_big_t * const big, const uint8_t *src, size_t src_len) {
+  while (src_len > 0) {
+    const size_t len = MIN(K12_BLOCK_LEN - big->num_bytes, src_len);
+
+    // absorb into root context
+    turboshake128_absorb(big->root, src, len);
+
+    src += len;
+    src_len -= len;
+    big->num_bytes += len;
+
+    if (big->num_bytes == K12_BLOCK_LEN) {
+      // absorb trailer for first block
+      uint8_t buf[8] = { 3, 0, 0, 0, 0, 0, 0, 0 };
+      turboshake128_absorb(big->root, buf, sizeof(buf));
+
+      // init child
+      turboshake128_init_custom(&(big->curr), K12_PAD_CHILD);
+
+      // clear byte count, increment block count
+      big->num_bytes = 0;
+      big->num_blocks++;
+
+      // absorb rest of source in child
+      k12_big_child_absorb(big, src, src_len);
+      return;
+    }
+  }
+}
+
+// absorb data
+static void k12_big_absorb(k12_big_t * const big, const uint8_t *src, size_t src_len) {
+  if (big->num_blocks) {
+    // absorb successive blocks in child context
+    k12_big_child_absorb(big, src, src_len);
+  } else {
+    // absorb first block in root context
+    k12_big_root_absorb(big, src, src_len);
+  }
+}
+
+// finalize "big" kangarootwelve context
+static void k12_big_absorb_done(k12_big_t * const big) {
+  if (big->num_bytes > 0) {
+    // hash child, absorb into root
+    uint8_t buf[32] = { 0 };
+    turboshake128_squeeze(&(big->curr), buf, sizeof(buf));
+    turboshake128_absorb(big->root, buf, sizeof(buf));
+  }
+
+  // absorb number of leaves.  num_blocks counts the first block (which
+  // is absorbed by root) and every whole leaf; a trailing partial leaf
+  // is not counted.  so if the final leaf was whole, subtract the first
+  // block.
+  uint8_t buf[9] = { 0 };
+  const size_t buf_len = k12_length_encode(buf, big->num_bytes > 0 ? big->num_blocks : big->num_blocks - 1);
+  turboshake128_absorb(big->root, buf, buf_len);
+
+  // absorb tail
+  static const uint8_t tail[2] = { 0xff, 0xff };
+  turboshake128_absorb(big->root, tail, sizeof(tail));
+}
+
+// squeeze into destination
+void k12_squeeze(k12_t *k12, uint8_t *dst, const size_t dst_len) {
+  turboshake128_squeeze(&(k12->ts), dst, dst_len);
+}
+
+void k12_init(k12_t *k12, const uint8_t *src, const size_t src_len, const uint8_t *custom, const size_t custom_len) {
+  uint8_t cl_buf[9] = { 0 };
+  const size_t cl_buf_len = k12_length_encode(cl_buf, custom_len);
+
+  // get total size, in bytes
+  const size_t total_len = src_len + custom_len + cl_buf_len;
+  if (total_len <= K12_BLOCK_LEN) {
+    // total size is less than a single block, so create a single
+    // turboshake128 instance, absorb the source data and the custom
+    // string.
+
+    // init turboshake context with single node padding
+    turboshake128_init_custom(&(k12->ts), K12_PAD_SINGLE);
+
+    // absorb source, custom string, and custom string length
+    turboshake128_absorb(&(k12->ts), src, src_len);
+    turboshake128_absorb(&(k12->ts), custom, custom_len);
+    turboshake128_absorb(&(k12->ts), cl_buf, cl_buf_len);
+  } else {
+    // total size greater than a single block, so create an internal
+    // "big" kangarootwelve context, absorb the source data and the custom
+    // string into the context.
+    //
+    // (the internal kangarootwelve context takes care of multiplexing
+    // the block data between the root and child contexts)
+
+    // init turboshake context with root node padding
+    turboshake128_init_custom(&(k12->ts), K12_PAD_ROOT);
+
+    // init big context
+    k12_big_t big;
+    k12_big_init(&big, &(k12->ts));
+
+    // absorb source, custom string, and custom string length
+    k12_big_absorb(&big, src, src_len);
+    k12_big_absorb(&big, custom, custom_len);
+    k12_big_absorb(&big, cl_buf, cl_buf_len);
+    k12_big_absorb_done(&big);
+  }
+}
+
+// one-shot k12 with custom string
+void k12_custom_once(const uint8_t *src, const size_t src_len, const uint8_t *custom, const size_t custom_len, uint8_t *dst, const size_t dst_len) {
+  k12_t k12;
+  k12_init(&k12, src, src_len, custom, custom_len);
+  k12_squeeze(&k12, dst, dst_len);
+}
+
+// one-shot kangarootwelve w/o custom string
+void k12_once(const uint8_t *src, const size_t src_len, uint8_t *dst, const size_t dst_len) {
+  k12_custom_once(src, src_len, NULL, 0, dst, dst_len);
+}
+
+// multi-digest algorithm parameters, indexed by algorithm ID
+static const struct {
+  uint8_t rate; // rate, in bytes
+  uint8_t pad; // padding byte
+  uint8_t num_rounds; // number of rounds (24 or 12)
+  uint8_t size; // digest size, in bytes (0 for XOFs)
+} MULTI_ALGOS[SHA3_ALGO_LAST] = {
+  [SHA3_ALGO_SHA3_224] = { RATE(28), 0x06, SHA3_NUM_ROUNDS, 28 },
+  [SHA3_ALGO_SHA3_256] = { RATE(32), 0x06, SHA3_NUM_ROUNDS, 32 },
+  [SHA3_ALGO_SHA3_384] = { RATE(48), 0x06, SHA3_NUM_ROUNDS, 48 },
+  [SHA3_ALGO_SHA3_512] = { RATE(64), 0x06, SHA3_NUM_ROUNDS, 64 },
+  [SHA3_ALGO_SHAKE128] = { SHAKE128_RATE, SHAKE_PAD, SHA3_NUM_ROUNDS, 0 },
+  [SHA3_ALGO_SHAKE256] = { SHAKE256_RATE, SHAKE_PAD, SHA3_NUM_ROUNDS, 0 },
+  [SHA3_ALGO_TURBOSHAKE128] = { SHAKE128_RATE, TURBOSHAKE_PAD, TURBOSHAKE_NUM_ROUNDS, 0 },
+  [SHA3_ALGO_TURBOSHAKE256] = { SHAKE256_RATE, TURBOSHAKE_PAD, TURBOSHAKE_NUM_ROUNDS, 0 },
+};
+
+// multi-digest absorb chunk size, in bytes.  input is absorbed into
+// every state in chunks of this size so each chunk stays in L1 cache
+// while it is absorbed into each state.
+#define MULTI_CHUNK_LEN 8192
+
+// Initialize multi-digest context.
+_Bool sha3_multi_init(sha3_multi_t * const ctx, const sha3_algo_t * const algos, const size_t num_algos) {
+  // check number of algorithms
+  if (!num_algos || num_algos > SHA3_MULTI_MAX_ALGOS) {
+    return false;
+  }
+
+  memset(ctx, 0, sizeof(sha3_multi_t));
+  for (size_t i = 0; i < num_algos; i++) {
+    // check algorithm ID
+    if ((unsigned) algos[i] >= SHA3_ALGO_LAST) {
+      return false;
+    }
+
+    // find existing state with the same rate and number of rounds
+    const uint8_t rate = MULTI_ALGOS[algos[i]].rate,
+                  num_rounds = MULTI_ALGOS[algos[i]].num_rounds;
+    size_t state_id = 0;
+    while (state_id < i && (MULTI_ALGOS[ctx->algos[state_id]].rate != rate || MULTI_ALGOS[ctx->algos[state_id]].num_rounds != num_rounds)) {
+      state_id++;
+    }
+
+    // save algorithm and state index, add state if necessary
+    ctx->algos[i] = algos[i];
+    ctx->state_ids[i] = (state_id < i) ? ctx->state_ids[state_id] : ctx->num_states++;
+  }
+  ctx->num_algos = num_algos;
+
+  // return success
+  return true;
+}
+
+// Absorb data into multi-digest context.
+_Bool sha3_multi_absorb(sha3_multi_t * const ctx, const uint8_t *src, size_t len) {
+  // check context state
+  if (ctx->finalized) {
+    return false;
+  }
+
+  // get rate and number of rounds for each state
+  uint8_t rates[SHA3_MULTI_MAX_ALGOS] = { 0 }, num_rounds[SHA3_MULTI_MAX_ALGOS] = { 0 };
+  for (size_t i = 0; i < ctx->num_algos; i++) {
+    rates[ctx->state_ids[i]] = MULTI_ALGOS[ctx->algos[i]].rate;
+    num_rounds[ctx->state_ids[i]] = MULTI_ALGOS[ctx->algos[i]].num_rounds;
+  }
+
+  while (len > 0) {
+    // absorb chunk into each state
+    const size_t chunk_len = MIN(len, MULTI_CHUNK_LEN);
+    for (size_t i = 0; i < ctx->num_states; i++) {
+      if (num_rounds[i] == SHA3_NUM_ROUNDS) {
+        ctx->states[i].num_bytes = absorb(&(ctx->states[i].a), ctx->states[i].num_bytes, rates[i], src, chunk_len);
+      } else {
+        ctx->states[i].num_bytes = absorb_12(&(ctx->states[i].a), ctx->states[i].num_bytes, rates[i], src, chunk_len);
+      }
+    }
+
+    // update source pointer and length
+    src += chunk_len;
+    len -= chunk_len;
+  }
+
+  // return success
+  return true;
+}
+
+// Get output of algorithm from multi-digest context.
+_Bool sha3_multi_final(sha3_multi_t * const ctx, const size_t i, uint8_t * const dst, const size_t dst_len) {
+  // check algorithm offset
+  if (i >= ctx->num_algos) {
+    return false;
+  }
+
+  // mark context as final
+  ctx->finalized = true;
+
+  // get algorithm parameters and copy of shared state
+  const size_t rate = MULTI_ALGOS[ctx->algos[i]].rate,
+               size = MULTI_ALGOS[ctx->algos[i]].size;
+  const uint8_t pad = MULTI_ALGOS[ctx->algos[i]].pad;
+  const size_t state_id = ctx->state_ids[i];
+
+  if (MULTI_ALGOS[ctx->algos[i]].num_rounds == SHA3_NUM_ROUNDS) {
+    // copy state into xof context, append suffix and padding, permute
+    sha3_xof_t xof = { .num_bytes = ctx->states[state_id].num_bytes, .a = ctx->states[state_id].a };
+    xof_absorb_done(&xof, rate, pad);
+
+    // squeeze (clamp fixed-length hashes to digest size)
+    xof_squeeze_raw(&xof, rate, dst, size ? MIN(dst_len, size) : dst_len);
+  } else {
+    // copy state into xof12 context, append suffix and padding, permute
+    sha3_xof12_t xof = { .num_bytes = ctx->states[state_id].num_bytes, .a = ctx->states[state_id].a };
+    xof12_absorb_done(&xof, rate, pad);
+
+    // squeeze
+    xof12_squeeze_raw(&xof, rate, dst, dst_len);
+  }
+
+  // return success
+  return true;
+}
+
+// number of manager lanes.  the public manager context has room for
+// SHA3_MGR_MAX_LANES lanes, which is less than the lane count of the
+// 9-way hybrid avx512 kernel.
+#define MGR_NUM_LANES MIN(MB_NUM_LANES, SHA3_MGR_MAX_LANES)
+
+/**
+ * @brief Get current time, in microseconds.
+ *
+ * @return Current time, in microseconds.
+ */
+static inline uint64_t mgr_now(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * @brief Has the oldest busy lane waited longer than the maximum latency?
+ *
+ * @param[in] mgr Job manager.
+ *
+ * @return True if the maximum latency is enabled and has expired.
+ */
+static inline _Bool mgr_expired(const sha3_mgr_t * const mgr) {
+  if (!mgr->max_latency || !mgr->num_lanes) {
+    return false;
+  }
+
+  // find oldest lane
+  uint64_t oldest = mgr->lanes[0].time;
+  for (size_t i = 1; i < mgr->num_lanes; i++) {
+    oldest = MIN(oldest, mgr->lanes[i].time);
+  }
+
+  return mgr_now() - oldest > mgr->max_latency;
+}
+
+/**
+ * @brief Absorb next block into lane of job manager.
+ *
+ * @param[in,out] mgr Job manager.
+ * @param[in] i Lane offset.
+ *
+ * @return True if the block was padded.
+ */
+static inline _Bool mgr_lane_absorb(sha3_mgr_t * const mgr, const size_t i) {
+  const size_t rate = MULTI_ALGOS[mgr->algo].rate;
+  const size_t len = MIN(mgr->lanes[i].len, rate);
+
+  mb_xor(mgr->a + i, 0, mgr->lanes[i].ptr, len);
+  mgr->lanes[i].ptr += len;
+  mgr->lanes[i].len -= len;
+
+  if (len < rate) {
+    // input exhausted; append suffix and padding
+    mgr->a[i].u8[len] ^= MULTI_ALGOS[mgr->algo].pad;
+    mgr->a[i].u8[rate - 1] ^= 0x80;
+    return true;
+  }
+
+  return false;
+}
+
+/**
+ * @brief Permute busy lanes of job manager until at least one job
+ * finishes.
+ *
+ * Finished jobs are squeezed and moved to the finished job queue, and
+ * remaining lanes are compacted so busy lane states stay contiguous.
+ *
+ * @param[in,out] mgr Job manager.
+ */
+static void mgr_run(sha3_mgr_t * const mgr) {
+  const size_t rate = MULTI_ALGOS[mgr->algo].rate,
+               num_rounds = MULTI_ALGOS[mgr->algo].num_rounds,
+               size = MULTI_ALGOS[mgr->algo].size;
+
+  while (mgr->num_lanes > 0 && !mgr->num_done) {
+    // absorb one block into each lane, then permute all lanes together
+    _Bool done[SHA3_MGR_MAX_LANES];
+    for (size_t i = 0; i < mgr->num_lanes; i++) {
+      done[i] = mgr_lane_absorb(mgr, i);
+    }
+    permute_batch(mgr->a, mgr->num_lanes, num_rounds);
+
+    // squeeze finished lanes and remove them
+    for (size_t i = 0; i < mgr->num_lanes;) {
+      if (!done[i]) {
+        i++;
+        continue;
+      }
+
+      // squeeze output (fixed-length hashes use digest size)
+      sha3_job_t * const job = mgr->lanes[i].job;
+      mb_squeeze(rate, num_rounds, mgr->a + i, job->dst, size ? size : job->dst_len);
+
+      // append job to finished job queue
+      mgr->done[(mgr->done_ofs + mgr->num_done++) % SHA3_MGR_MAX_LANES] = job;
+
+      // move last lane into this slot and check it
+      if (i < --mgr->num_lanes) {
+        mgr->lanes[i] = mgr->lanes[mgr->num_lanes];
+        mgr->a[i] = mgr->a[mgr->num_lanes];
+        done[i] = done[mgr->num_lanes];
+      }
+    }
+  }
+}
+
+/**
+ * @brief Pop job from finished job queue of job manager.
+ *
+ * @param[in,out] mgr Job manager.
+ *
+ * @return Finished job, or `NULL` if the queue is empty.
+ */
+static inline sha3_job_t *mgr_pop(sha3_mgr_t * const mgr) {
+  if (!mgr->num_done) {
+    return NULL;
+  }
+
+  sha3_job_t * const job = mgr->done[mgr->done_ofs];
+  mgr->done_ofs = (mgr->done_ofs + 1) % SHA3_MGR_MAX_LANES;
+  mgr->num_done--;
+  return job;
+}
+
+// Initialize job manager.
+_Bool sha3_mgr_init(sha3_mgr_t * const mgr, const sha3_algo_t algo, const uint64_t max_latency) {
+  // check algorithm
+  if ((size_t) algo >= SHA3_ALGO_LAST) {
+    return false;
+  }
+
+  memset(mgr, 0, sizeof(sha3_mgr_t));
+  mgr->algo = algo;
+  mgr->max_latency = max_latency;
+
+  // return success
+  return true;
+}
+
+// Submit job to job manager.
+sha3_job_t *sha3_mgr_submit(sha3_mgr_t * const mgr, sha3_job_t * const job) {
+  // add job to free lane.  lanes are run below whenever every lane is
+  // busy, so busy lanes plus finished jobs are always less than the
+  // lane count between calls and there is always a free lane here.
+  const size_t i = mgr->num_lanes++;
+  memset(mgr->a + i, 0, sizeof(sha3_state_t));
+  mgr->lanes[i].job = job;
+  mgr->lanes[i].ptr = job->src;
+  mgr->lanes[i].len = job->len;
+  mgr->lanes[i].time = mgr->max_latency ? mgr_now() : 0;
+
+  // run lanes if they are all busy or the maximum latency has expired
+  if (!mgr->num_done && (mgr->num_lanes == MGR_NUM_LANES || mgr_expired(mgr))) {
+    mgr_run(mgr);
+  }
+
+  return mgr_pop(mgr);
+}
+
+// Return finished job if maximum latency has expired.
+sha3_job_t *sha3_mgr_poll(sha3_mgr_t * const mgr) {
+  if (!mgr->num_done && mgr_expired(mgr)) {
+    mgr_run(mgr);
+  }
+
+  return mgr_pop(mgr);
+}
+
+// Flush job manager.
+sha3_job_t *sha3_mgr_flush(sha3_mgr_t * const mgr) {
+  mgr_run(mgr);
+  return mgr_pop(mgr);
+}
+
+// merkle tree node size, in bytes
+#define MERKLE_NODE_LEN 32
+
+// merkle tree domain separation prefixes
+#define MERKLE_LEAF_PREFIX 0x00
+#define MERKLE_NODE_PREFIX 0x01
+
+// number of proofs verified per chunk by sha3_merkle_verify_batch()
+#define MERKLE_VERIFY_CHUNK_LEN 64
+
+/**
+ * @brief Merkle tree hash input.
+ */
+typedef struct {
+  const uint8_t *a; /**< First input segment */
+  size_t a_len; /**< First input segment length, in bytes */
+  const uint8_t *b; /**< Second input segment (may be NULL) */
+  size_t b_len; /**< Second input segment length, in bytes */
+  uint8_t *dst; /**< Output (32 bytes) */
+} merkle_input_t;
+
+/**
+ * @brief Merkle tree batch (callback data for multi-buffer sponge
+ * engine).
+ */
+typedef struct {
+  uint8_t prefix; /**< Domain separation prefix */
+
+  /** Populate `in` with input `i`. */
+  void (*get)(void *data, size_t i, merkle_input_t *in);
+  void *data; /**< Input callback data */
+} merkle_batch_t;
+
+/**
+ * @brief Get merkle tree job (`mb_params_t.get_job` callback).
+ *
+ * The input is fetched once here and cached in the job, so the input
+ * callback (and the user's leaf callback) is called once per input.
+ *
+ * @param[in] cb_data Merkle tree batch (`merkle_batch_t`).
+ * @param[in] job_id Job ID.
+ * @param[out] job Job.
+ */
+static void merkle_get_job(void * const cb_data, const size_t job_id, mb_job_t * const job) {
+  const merkle_batch_t * const mb = cb_data;
+  merkle_input_t in;
+  mb->get(mb->data, job_id, &in);
+
+  job->init = NULL;
+  job->src = in.a;
+  job->src_len = in.a_len;
+  job->src2 = in.b;
+  job->src2_len = in.b_len;
+  job->dst = in.dst;
+  job->dst_len = MERKLE_NODE_LEN;
+}
+
+/**
+ * @brief Get merkle tree input segment (`mb_params_t.next_seg`
+ * callback).
+ *
+ * The segments are the domain separation prefix and the two input
+ * segments cached in the job by `merkle_get_job()`.
+ *
+ * @param[in] cb_data Merkle tree batch (`merkle_batch_t`).
+ * @param[in] job Job.
+ * @param[in] job_id Job ID.
+ * @param[in] seg_id Segment ID.
+ * @param[out] scratch Scratch buffer.
+ * @param[out] ptr Segment pointer.
+ * @param[out] len Segment length, in bytes.
+ *
+ * @return False if there are no more segments.
+ */
+static _Bool merkle_next_seg(void * const cb_data, const mb_job_t * const job, const size_t job_id, const size_t seg_id, uint8_t scratch[static MB_SCRATCH_LEN], const uint8_t ** const ptr, size_t * const len) {
+  const merkle_batch_t * const mb = cb_data;
+  (void) job_id; // unused
+  if (seg_id == 0) {
+    // domain separation prefix
+    scratch[0] = mb->prefix;
+    *ptr = scratch;
+    *len = 1;
+    return true;
+  } else if (seg_id > 2) {
+    return false;
+  }
+
+  *ptr = (seg_id == 1) ? job->src : job->src2;
+  *len = (seg_id == 1) ? job->src_len : job->src2_len;
+  return true;
+}
+
+/**
+ * @brief Hash batch of merkle tree inputs with multi-buffer sponge
+ * engine.
+ *
+ * @param[in] algo Algorithm ID.
+ * @param[in] prefix Domain separation prefix.
+ * @param[in] get Input callback.
+ * @param[in] data Input callback data.
+ * @param[in] n Number of inputs.
+ */
+static void merkle_hash(const sha3_algo_t algo, const uint8_t prefix, void (*get)(void *, size_t, merkle_input_t *), void * const data, const size_t n) {
+  merkle_batch_t mb = { .prefix = prefix, .get = get, .data = data };
+  const mb_params_t params = {
+    .rate = MULTI_ALGOS[algo].rate,
+    .num_rounds = MULTI_ALGOS[algo].num_rounds,
+    .pad = MULTI_ALGOS[algo].pad,
+    .get_job = merkle_get_job,
+    .next_seg = merkle_next_seg,
+    .cb_data = &mb,
+  };
+  mb_run(&params, n);
+}
+
+/**
+ * @brief Is algorithm supported by merkle tree functions?
+ *
+ * @param[in] algo Algorithm ID.
+ *
+ * @return True if algorithm produces at least 32 bytes of output.
+ */
+static inline bool merkle_algo_ok(const sha3_algo_t algo) {
+  return algo == SHA3_ALGO_SHA3_256 ||
+         algo == SHA3_ALGO_SHAKE128 ||
+         algo == SHA3_ALGO_SHAKE256 ||
+         algo == SHA3_ALGO_TURBOSHAKE128 ||
+         algo == SHA3_ALGO_TURBOSHAKE256;
+}
+
+/**
+ * @brief Merkle tree leaf hash context.
+ */
+typedef struct {
+  sha3_merkle_leaf_cb_t cb; /**< Leaf callback */
+  void *cb_data; /**< Leaf callback data */
+  uint8_t *dst; /**< Leaf hashes */
+} merkle_leaves_t;
+
+/**
+ * @brief Get leaf hash input (`merkle_batch_t.get` callback).
+ *
+ * @param[in] data Leaf hash context (`merkle_leaves_t`).
+ * @param[in] i Leaf index.
+ * @param[out] in Input.
+ */
+static void merkle_leaves_get(void * const data, const size_t i, merkle_input_t * const in) {
+  const merkle_leaves_t * const ml = data;
+  ml->cb(ml->cb_data, i, &(in->a), &(in->a_len));
+  in->b = NULL;
+  in->b_len = 0;
+  in->dst = ml->dst + MERKLE_NODE_LEN * i;
+}
+
+/**
+ * @brief Get interior node input (`merkle_batch_t.get` callback).
+ *
+ * Node `i` of a level is the hash of nodes `2i` and `2i + 1` of the
+ * level below, which are adjacent in the node buffer.
+ *
+ * @param[in] data Pointer to first node of level below; the level
+ * being built starts immediately after it (`uint8_t *[2]`).
+ * @param[in] i Node index.
+ * @param[out] in Input.
+ */
+static void merkle_nodes_get(void * const data, const size_t i, merkle_input_t * const in) {
+  uint8_t * const * const levels = data;
+  in->a = levels[0] + 2 * MERKLE_NODE_LEN * i;
+  in->a_len = 2 * MERKLE_NODE_LEN;
+  in->b = NULL;
+  in->b_len = 0;
+  in->dst = levels[1] + MERKLE_NODE_LEN * i;
+}
+
+// Get number of nodes in merkle tree.
+size_t sha3_merkle_num_nodes(const size_t num_leaves) {
+  size_t r = num_leaves;
+  for (size_t n = num_leaves; n > 1; n = (n + 1) / 2) {
+    r += (n + 1) / 2;
+  }
+  return r;
+}
+
+// Build merkle tree from leaf callback.
+_Bool sha3_merkle_build_cb(sha3_merkle_t * const tree, const sha3_algo_t algo, sha3_merkle_leaf_cb_t cb, void * const cb_data, const size_t num_leaves, uint8_t * const nodes) {
+  // check algorithm and number of leaves
+  if (!merkle_algo_ok(algo) || !num_leaves) {
+    return false;
   }
 
-// declare parallelhash functions
-DEF_PARALLELHASH(128) // parallelhash128, parallehash128-xof
-DEF_PARALLELHASH(256) // parallelhash256, parallehash256-xof
+  tree->nodes = nodes;
+  tree->num_leaves = num_leaves;
+  tree->algo = algo;
 
-// number of rounds
-#define TURBOSHAKE_NUM_ROUNDS 12
+  // hash leaves
+  merkle_leaves_t ml = { .cb = cb, .cb_data = cb_data, .dst = nodes };
+  merkle_hash(algo, MERKLE_LEAF_PREFIX, merkle_leaves_get, &ml, num_leaves);
 
-// default turboshake pad byte (can be customized for domain separation)
-#define TURBOSHAKE_PAD 0x1f
+  // build levels
+  uint8_t *level = nodes;
+  for (size_t n = num_leaves; n > 1; n = (n + 1) / 2) {
+    uint8_t *levels[2] = { level, level + MERKLE_NODE_LEN * n };
 
-// init turboshake context with given pad byte.  returns false if the
-// pad byte is out of range.
-static inline _Bool turboshake_init(turboshake_t * const ts, const uint8_t pad) {
-  // check for valid pad
-  if (!pad || pad > 0x1f) {
-    // invalid pad
-    return false;
-  }
+    // hash pairs of nodes
+    merkle_hash(algo, MERKLE_NODE_PREFIX, merkle_nodes_get, levels, n / 2);
 
-  // init xof
-  xof12_init(&(ts->xof));
-  ts->pad = pad;
+    // promote odd node
+    if (n & 1) {
+      memcpy(levels[1] + MERKLE_NODE_LEN * (n / 2), levels[0] + MERKLE_NODE_LEN * (n - 1), MERKLE_NODE_LEN);
+    }
+
+    level = levels[1];
+  }
 
   // return success
   return true;
 }
 
-// define turboshake functions
-#define DEF_TURBOSHAKE(BITS) \
-  /* init turboshake context with custom pad byte.  returns false if the */ \
-  /* pad byte is out of range. */ \
-  _Bool turboshake ## BITS ## _init_custom(turboshake_t * const ts, const uint8_t pad) { \
-    return turboshake_init(ts, pad); \
-  } \
-  \
-  /* init turboshake context */ \
-  void turboshake ## BITS ## _init(turboshake_t * const ts) { \
-    (void) turboshake_init(ts, TURBOSHAKE_PAD); \
-  } \
-  \
-  /* absorb bytes into turboshake context. */ \
-  _Bool turboshake ## BITS ## _absorb(turboshake_t * const ts, const uint8_t * const m, const size_t len) { \
-    return xof12_absorb(&(ts->xof), SHAKE ## BITS ## _RATE, m, len); \
-  } \
-  \
-  /* squeeze bytes from turboshake context */ \
-  void turboshake ## BITS ## _squeeze(turboshake_t * const ts, uint8_t * const dst, const size_t dst_len) { \
-    xof12_squeeze(&(ts->xof), SHAKE ## BITS ## _RATE, ts->pad, dst, dst_len); \
-  } \
-  \
-  /* one-shot turboshake with default pad byte */ \
-  void turboshake ## BITS (const uint8_t * const src, const size_t src_len, uint8_t * const dst, const size_t dst_len) { \
-    xof12_once(SHAKE ## BITS ## _RATE, TURBOSHAKE_PAD, src, src_len, dst, dst_len); \
-  } \
-  \
-  /* one-shot turboshake with custom pad byte */ \
-  void turboshake ## BITS ## _custom(const uint8_t pad, const uint8_t * const src, const size_t src_len, uint8_t * const dst, const size_t dst_len) { \
-    xof12_once(SHAKE ## BITS ## _RATE, pad, src, src_len, dst, dst_len); \
-  }
+/**
+ * @brief Merkle tree leaf arrays (`sha3_merkle_build()` callback data).
+ */
+typedef struct {
+  const uint8_t * const *leaves; /**< Leaves */
+  const size_t *lens; /**< Leaf lengths, in bytes */
+} merkle_arrays_t;
 
-// declare turboshake functions
-DEF_TURBOSHAKE(128) // turboshake128
-DEF_TURBOSHAKE(256) // turboshake128
+/**
+ * @brief Get leaf from arrays (`sha3_merkle_leaf_cb_t` callback).
+ *
+ * @param[in] cb_data Leaf arrays (`merkle_arrays_t`).
+ * @param[in] i Leaf index.
+ * @param[out] ptr Leaf.
+ * @param[out] len Leaf length, in bytes.
+ */
+static void merkle_arrays_get(void * const cb_data, const size_t i, const uint8_t ** const ptr, size_t * const len) {
+  const merkle_arrays_t * const ma = cb_data;
+  *ptr = ma->leaves[i];
+  *len = ma->lens[i];
+}
 
-// kangarootwelve block size, in bytes
-#define K12_BLOCK_LEN 8192
+// Build merkle tree from array of leaves.
+_Bool sha3_merkle_build(sha3_merkle_t * const tree, const sha3_algo_t algo, const uint8_t * const leaves[], const size_t lens[], const size_t num_leaves, uint8_t * const nodes) {
+  merkle_arrays_t ma = { .leaves = leaves, .lens = lens };
+  return sha3_merkle_build_cb(tree, algo, merkle_arrays_get, &ma, num_leaves, nodes);
+}
 
-// pad byte for single kangarootwelve chunk (<= 8192 bytes)
-#define K12_PAD_SINGLE 0x07
+// Get root of merkle tree.
+const uint8_t *sha3_merkle_root(const sha3_merkle_t * const tree) {
+  return tree->nodes + MERKLE_NODE_LEN * (sha3_merkle_num_nodes(tree->num_leaves) - 1);
+}
 
-// pad byte for root kangarootwelve turboshake instance (> 8192 bytes)
-#define K12_PAD_ROOT 0x06
+// Get inclusion proof for leaf of merkle tree.
+_Bool sha3_merkle_proof(const sha3_merkle_t * const tree, const size_t i, uint8_t * const proof, size_t * const proof_len) {
+  // check leaf index
+  if (i >= tree->num_leaves) {
+    return false;
+  }
 
-// pad byte for child kangarootwelve turboshake instances (> 8192 bytes)
-#define K12_PAD_CHILD 0x0B
+  size_t len = 0;
+  const uint8_t *level = tree->nodes;
+  for (size_t n = tree->num_leaves, j = i; n > 1; n = (n + 1) / 2, j /= 2) {
+    // append sibling (promoted nodes have no sibling)
+    if ((j ^ 1) < n) {
+      memcpy(proof + MERKLE_NODE_LEN * len++, level + MERKLE_NODE_LEN * (j ^ 1), MERKLE_NODE_LEN);
+    }
 
-// private kangarootwelve big context
-typedef struct {
-  turboshake_t *root, // root turboshake context
-               curr; // current child turboshake context
-  size_t num_bytes,  // num bytes in current block
-         num_blocks; // total number of blocks
-} k12_big_t;
+    level += MERKLE_NODE_LEN * n;
+  }
 
-// init kangarootwelve big context
-static void k12_big_init(k12_big_t * const big, turboshake_t * const root) {
-  // init root context
-  turboshake128_init_custom(root, K12_PAD_ROOT);
+  // return success
+  *proof_len = len;
+  return true;
+}
 
-  big->root = root;
-  big->num_bytes = 0;
-  big->num_blocks = 0;
+/**
+ * @brief Merkle tree batch verification state.
+ */
+typedef struct {
+  const size_t *indices; /**< Leaf indices */
+  const uint8_t * const *leaves; /**< Leaves */
+  const size_t *lens; /**< Leaf lengths, in bytes */
+  const uint8_t * const *proofs; /**< Inclusion proofs */
+  size_t level; /**< Current level */
+  size_t ids[MERKLE_VERIFY_CHUNK_LEN]; /**< Offsets of proofs to hash at current level */
+  size_t ofs[MERKLE_VERIFY_CHUNK_LEN]; /**< Number of proof hashes consumed */
+  uint8_t curr[MERKLE_VERIFY_CHUNK_LEN][MERKLE_NODE_LEN]; /**< Current hashes */
+} merkle_verify_t;
+
+/**
+ * @brief Get leaf hash input for batch verification
+ * (`merkle_batch_t.get` callback).
+ *
+ * @param[in] data Verification state (`merkle_verify_t`).
+ * @param[in] i Proof offset.
+ * @param[out] in Input.
+ */
+static void merkle_verify_leaf_get(void * const data, const size_t i, merkle_input_t * const in) {
+  merkle_verify_t * const mv = data;
+  in->a = mv->leaves[i];
+  in->a_len = mv->lens[i];
+  in->b = NULL;
+  in->b_len = 0;
+  in->dst = mv->curr[i];
 }
 
-// absorb data in child context
-static void k12_big_child_absorb(k12_big_t * const big, const uint8_t *src, size_t src_len) {
-  while (src_len > 0) {
-    const size_t len = MIN(K12_BLOCK_LEN - big->num_bytes, src_len);
+/**
+ * @brief Get node input for batch verification (`merkle_batch_t.get`
+ * callback).
+ *
+ * Hashes the current hash with the next hash of the proof, in the
+ * order given by the position of the current node.  Each input fits in
+ * one block, so the current hash is absorbed before it is overwritten.
+ *
+ * @param[in] data Verification state (`merkle_verify_t`).
+ * @param[in] i Offset into list of proofs to hash at current level.
+ * @param[out] in Input.
+ */
+static void merkle_verify_node_get(void * const data, const size_t i, merkle_input_t * const in) {
+  merkle_verify_t * const mv = data;
+  const size_t id = mv->ids[i];
+  const uint8_t * const sibling = mv->proofs[id] + MERKLE_NODE_LEN * mv->ofs[id];
+  const bool is_right = (mv->indices[id] >> mv->level) & 1;
+
+  in->a = is_right ? sibling : mv->curr[id];
+  in->a_len = MERKLE_NODE_LEN;
+  in->b = is_right ? mv->curr[id] : sibling;
+  in->b_len = MERKLE_NODE_LEN;
+  in->dst = mv->curr[id];
+}
+
+// Verify batch of merkle tree inclusion proofs.
+_Bool sha3_merkle_verify_batch(const sha3_algo_t algo, const uint8_t root[static 32], const size_t num_leaves, const size_t n, const size_t indices[], const uint8_t * const leaves[], const size_t lens[], const uint8_t * const proofs[], const size_t proof_lens[], _Bool oks[]) {
+  if (!merkle_algo_ok(algo)) {
+    // unsupported algorithm; every proof is invalid
+    for (size_t i = 0; oks && i < n; i++) {
+      oks[i] = false;
+    }
+    return false;
+  }
 
-    // absorb into child context
-    turboshake128_absorb(&(big->curr), src, len);
+  bool all_ok = true;
+  merkle_verify_t mv;
+
+  for (size_t base = 0; base < n; base += MERKLE_VERIFY_CHUNK_LEN) {
+    const size_t len = MIN(n - base, MERKLE_VERIFY_CHUNK_LEN);
+    mv.indices = indices + base;
+    mv.leaves = leaves + base;
+    mv.lens = lens + base;
+    mv.proofs = proofs + base;
+    memset(mv.ofs, 0, sizeof(mv.ofs));
+
+    // hash leaves
+    merkle_hash(algo, MERKLE_LEAF_PREFIX, merkle_verify_leaf_get, &mv, len);
+
+    // hash up one level at a time
+    mv.level = 0;
+    for (size_t m = num_leaves; m > 1; m = (m + 1) / 2, mv.level++) {
+      // collect proofs which have a sibling at this level and hashes left
+      size_t num_ids = 0;
+      for (size_t i = 0; i < len; i++) {
+        const size_t j = mv.indices[i] >> mv.level;
+        if ((j ^ 1) < m && mv.ofs[i] < proof_lens[base + i]) {
+          mv.ids[num_ids++] = i;
+        }
+      }
 
-    src += len;
-    src_len -= len;
-    big->num_bytes += len;
+      merkle_hash(algo, MERKLE_NODE_PREFIX, merkle_verify_node_get, &mv, num_ids);
 
-    if (big->num_bytes == K12_BLOCK_LEN) {
-      // hash child
-      uint8_t buf[32] = { 0 };
-      turboshake128_squeeze(&(big->curr), buf, sizeof(buf));
+      for (size_t i = 0; i < num_ids; i++) {
+        mv.ofs[mv.ids[i]]++;
+      }
+    }
 
-      // absorb hash into root
-      turboshake128_absorb(big->root, buf, sizeof(buf));
+    // check results
+    for (size_t i = 0; i < len; i++) {
+      const bool ok = indices[base + i] < num_leaves && mv.ofs[i] == proof_lens[base + i] && !memcmp(mv.curr[i], root, MERKLE_NODE_LEN);
+      all_ok &= ok;
+      if (oks) {
+        oks[base + i] = ok;
+      }
+    }
+  }
 
-      // reset child
-      turboshake128_init_custom(&(big->curr), K12_PAD_CHILD);
+  return all_ok;
+}
 
-      // clear byte count, increment block count
-      big->num_bytes = 0;
-      big->num_blocks++;
+// Verify merkle tree inclusion proof.
+_Bool sha3_merkle_verify(const sha3_algo_t algo, const uint8_t root[static 32], const size_t num_leaves, const size_t i, const uint8_t * const leaf, const size_t leaf_len, const uint8_t * const proof, const size_t proof_len) {
+  return sha3_merkle_verify_batch(algo, root, num_leaves, 1, &i, &leaf, &leaf_len, &proof, &proof_len, NULL);
+}
+
+// Apply Keccak-p[1600, n] permutation to state.
+_Bool keccak_p1600(uint64_t s[static 25], const unsigned num_rounds) {
+  switch (num_rounds) {
+  case 24:
+    permute_24(s);
+    return true;
+  case 12:
+    permute_12(s);
+    return true;
+  default:
+    if (num_rounds > SHA3_NUM_ROUNDS) {
+      // invalid number of rounds
+      return false;
     }
+
+    permute_any(s, num_rounds);
+    return true;
   }
 }
 
-// absorb data in root context
-// (passes excess data to child context)
-static void k12_big_root_absorb(k12_big_t * const big, const uint8_t *src, size_t src_len) {
-  while (src_len > 0) {
-    const size_t len = MIN(K12_BLOCK_LEN - big->num_bytes, src_len);
+// Initialize sponge context.
+_Bool sha3_sponge_init(sha3_sponge_t * const sponge, const size_t rate, const unsigned num_rounds, const uint8_t pad) {
+  // check parameters
+  // (capacity must be non-zero, and the pad byte must not overlap the
+  // final padding bit)
+  if (!rate || rate >= sizeof(sponge->a.u8) || !num_rounds || num_rounds > SHA3_NUM_ROUNDS || !pad || pad > 0x7f) {
+    // invalid parameter
+    return false;
+  }
 
-    // absorb into root context
-    turboshake128_absorb(big->root, src, len);
+  memset(sponge, 0, sizeof(sha3_sponge_t));
+  sponge->rate = rate;
+  sponge->num_rounds = num_rounds;
+  sponge->pad = pad;
 
-    src += len;
-    src_len -= len;
-    big->num_bytes += len;
+  // return success
+  return true;
+}
 
-    if (big->num_bytes == K12_BLOCK_LEN) {
-      // absorb trailer for first block
-      uint8_t buf[8] = { 3, 0, 0, 0, 0, 0, 0, 0 };
-      turboshake128_absorb(big->root, buf, sizeof(buf));
+// sponge context modes
+// (SPONGE_MODE_INIT must be zero so that sha3_sponge_init() can clear
+// the context with memset())
+#define SPONGE_MODE_INIT 0 // freshly initialized
+#define SPONGE_MODE_ABSORB 1 // sha3_sponge_absorb() called
+#define SPONGE_MODE_SQUEEZE 2 // sha3_sponge_squeeze() called
+#define SPONGE_MODE_DUPLEX 3 // sha3_sponge_duplex() called
 
-      // init child
-      turboshake128_init_custom(&(big->curr), K12_PAD_CHILD);
+// Absorb data into sponge context.
+_Bool sha3_sponge_absorb(sha3_sponge_t * const sponge, const uint8_t *src, size_t src_len) {
+  // check context state
+  if (sponge->mode == SPONGE_MODE_SQUEEZE || sponge->mode == SPONGE_MODE_DUPLEX) {
+    // sponge has already been squeezed or duplexed, return error
+    return false;
+  }
+  sponge->mode = SPONGE_MODE_ABSORB;
 
-      // clear byte count, increment block count
-      big->num_bytes = 0;
-      big->num_blocks++;
+  while (src_len > 0) {
+    // xor chunk into state
+    const size_t len = MIN(src_len, sponge->rate - sponge->num_bytes);
+    for (size_t i = 0; i < len; i++) {
+      sponge->a.u8[sponge->num_bytes + i] ^= src[i];
+    }
 
-      // absorb rest of source in child
-      k12_big_child_absorb(big, src, src_len);
-      return;
+    // update counters
+    sponge->num_bytes += len;
+    src += len;
+    src_len -= len;
+
+    if (sponge->num_bytes == sponge->rate) {
+      // permute state
+      (void) keccak_p1600(sponge->a.u64, sponge->num_rounds);
+      sponge->num_bytes = 0;
     }
   }
-}
 
-// absorb data
-static void k12_big_absorb(k12_big_t * const big, const uint8_t *src, size_t src_len) {
-  if (big->num_blocks) {
-    // absorb successive blocks in child context
-    k12_big_child_absorb(big, src, src_len);
-  } else {
-    // absorb first block in root context
-    k12_big_root_absorb(big, src, src_len);
-  }
+  // return success
+  return true;
 }
 
-// finalize "big" kangarootwelve context
-static void k12_big_absorb_done(k12_big_t * const big) {
-  if (big->num_bytes > 0) {
-    // hash child, absorb into root
-    uint8_t buf[32] = { 0 };
-    turboshake128_squeeze(&(big->curr), buf, sizeof(buf));
-    turboshake128_absorb(big->root, buf, sizeof(buf));
+// Squeeze data from sponge context.
+_Bool sha3_sponge_squeeze(sha3_sponge_t * const sponge, uint8_t *dst, size_t dst_len) {
+  // check context state
+  if (sponge->mode == SPONGE_MODE_DUPLEX) {
+    // sponge has been used for duplex calls, return error
+    return false;
   }
 
-  // absorb block count
-  uint8_t buf[9] = { 0 };
-  const size_t buf_len = k12_length_encode(buf, big->num_blocks);
-  turboshake128_absorb(big->root, buf, buf_len);
+  if (sponge->mode != SPONGE_MODE_SQUEEZE) {
+    // append padding, permute, and switch to squeeze mode
+    sponge->a.u8[sponge->num_bytes] ^= sponge->pad;
+    sponge->a.u8[sponge->rate - 1] ^= 0x80;
+    (void) keccak_p1600(sponge->a.u64, sponge->num_rounds);
+    sponge->num_bytes = 0;
+    sponge->mode = SPONGE_MODE_SQUEEZE;
+  }
 
-  // absorb tail
-  static const uint8_t tail[2] = { 0xff, 0xff };
-  turboshake128_absorb(big->root, tail, sizeof(tail));
-}
+  while (dst_len > 0) {
+    if (sponge->num_bytes == sponge->rate) {
+      // permute state
+      (void) keccak_p1600(sponge->a.u64, sponge->num_rounds);
+      sponge->num_bytes = 0;
+    }
 
-// squeeze into destination
-void k12_squeeze(k12_t *k12, uint8_t *dst, const size_t dst_len) {
-  turboshake128_squeeze(&(k12->ts), dst, dst_len);
-}
+    // copy chunk to destination
+    const size_t len = MIN(dst_len, sponge->rate - sponge->num_bytes);
+    memcpy(dst, sponge->a.u8 + sponge->num_bytes, len);
 
-void k12_init(k12_t *k12, const uint8_t *src, const size_t src_len, const uint8_t *custom, const size_t custom_len) {
-  uint8_t cl_buf[9] = { 0 };
-  const size_t cl_buf_len = k12_length_encode(cl_buf, custom_len);
+    // update counters
+    sponge->num_bytes += len;
+    dst += len;
+    dst_len -= len;
+  }
 
-  // get total size, in bytes
-  const size_t total_len = src_len + custom_len + cl_buf_len;
-  if (total_len <= K12_BLOCK_LEN) {
-    // total size is less than a single block, so create a single
-    // turboshake128 instance, absorb the source data and the custom
-    // string.
+  // return success
+  return true;
+}
 
-    // init turboshake context with single node padding
-    turboshake128_init_custom(&(k12->ts), K12_PAD_SINGLE);
+// Duplex call: absorb and pad block, permute, then squeeze.
+_Bool sha3_sponge_duplex(sha3_sponge_t * const sponge, const uint8_t * const src, const size_t src_len, uint8_t * const dst, const size_t dst_len) {
+  // check parameters and context state
+  // (num_bytes is zero after absorbing exactly `rate` bytes, so check
+  // the mode rather than the byte count)
+  if (src_len >= sponge->rate || dst_len > sponge->rate || (sponge->mode != SPONGE_MODE_INIT && sponge->mode != SPONGE_MODE_DUPLEX)) {
+    // invalid length or sponge used for absorb/squeeze, return error
+    return false;
+  }
+  sponge->mode = SPONGE_MODE_DUPLEX;
 
-    // absorb source, custom string, and custom string length
-    turboshake128_absorb(&(k12->ts), src, src_len);
-    turboshake128_absorb(&(k12->ts), custom, custom_len);
-    turboshake128_absorb(&(k12->ts), cl_buf, cl_buf_len);
-  } else {
-    // total size greater than a single block, so create an internal
-    // "big" kangarootwelve context, absorb the source data and the custom
-    // string into the context.
-    //
-    // (the internal kangarootwelve context takes care of multiplexing
-    // the block data between the root and child contexts)
+  // xor padded block into state
+  for (size_t i = 0; i < src_len; i++) {
+    sponge->a.u8[i] ^= src[i];
+  }
+  sponge->a.u8[src_len] ^= sponge->pad;
+  sponge->a.u8[sponge->rate - 1] ^= 0x80;
 
-    // init turboshake context with root node padding
-    turboshake128_init_custom(&(k12->ts), K12_PAD_ROOT);
+  // permute state, copy output to destination
+  (void) keccak_p1600(sponge->a.u64, sponge->num_rounds);
+  if (dst_len > 0) {
+    memcpy(dst, sponge->a.u8, dst_len);
+  }
 
-    // init big context
-    k12_big_t big;
-    k12_big_init(&big, &(k12->ts));
+  // return success
+  return true;
+}
 
-    // absorb source, custom string, and custom string length
-    k12_big_absorb(&big, src, src_len);
-    k12_big_absorb(&big, custom, custom_len);
-    k12_big_absorb(&big, cl_buf, cl_buf_len);
-    k12_big_absorb_done(&big);
+// Get number of states permuted together by batch functions.
+size_t sha3_batch_lanes(void) {
+#ifdef AVX512_YMM
+  if (avx512_ymm) {
+    return MB_YMM_LANES; // 4-way ymm multi-buffer kernel
   }
-}
+#endif /* AVX512_YMM */
 
-// one-shot k12 with custom string
-void k12_custom_once(const uint8_t *src, const size_t src_len, const uint8_t *custom, const size_t custom_len, uint8_t *dst, const size_t dst_len) {
-  k12_t k12;
-  k12_init(&k12, src, src_len, custom, custom_len);
-  k12_squeeze(&k12, dst, dst_len);
+  return MB_NUM_LANES;
 }
 
-// one-shot kangarootwelve w/o custom string
-void k12_once(const uint8_t *src, const size_t src_len, uint8_t *dst, const size_t dst_len) {
-  k12_custom_once(src, src_len, NULL, 0, dst, dst_len);
+// Use 256-bit AVX-512VL permutation instead of 512-bit AVX-512
+// permutation.
+_Bool sha3_avx512_ymm(const _Bool enable) {
+#ifdef AVX512_YMM
+  avx512_ymm = enable;
+  return true;
+#else
+  (void) enable; // unused
+  return false;
+#endif /* AVX512_YMM */
 }
 
 // Return backend name.
 const char *sha3_backend(void) {
-#if BACKEND == BACKEND_AVX512
+#ifdef AVX512_YMM
+  if (avx512_ymm) {
+    return "avx512-ymm";
+  }
+#endif /* AVX512_YMM */
+
+#if (BACKEND == BACKEND_AVX512) && defined(MB_HYBRID)
+  return "avx512-hybrid";
+#elif BACKEND == BACKEND_AVX512
   return "avx512";
+#elif (BACKEND == BACKEND_AVX2) && defined(MB_HYBRID)
+  return "avx2-hybrid";
 #elif BACKEND == BACKEND_AVX2
   return "avx2";
 #elif BACKEND == BACKEND_NEON
@@ -3185,6 +7083,14 @@ const char *sha3_backend(void) {
   return "hybrid";
 #elif BACKEND == BACKEND_SCALAR
   return "scalar";
+#elif BACKEND == BACKEND_LCOMP
+  return "lcomp";
+#elif BACKEND == BACKEND_BI32
+  return "bi32";
+#elif BACKEND == BACKEND_SCALAR_X2
+  return "scalar-x2";
+#elif BACKEND == BACKEND_NEON_SHA3
+  return "neon-sha3";
 #endif /* BACKEND */
 }
 
@@ -3430,6 +7336,33 @@ static const struct {
   .exp_len = 32,
 }};
 
+/**
+ * @brief Compare full state of permutation kernel against scalar backend.
+ *
+ * Used by the permutation tests for kernels which store the state in
+ * a different layout (complemented lanes, bit-interleaved lanes, or a
+ * separate column 4).  Permutes a state with every lane set four
+ * times, and compares all 25 lanes after each permutation.
+ *
+ * @param[in] func Name of calling test function.
+ * @param[in] permute Permutation kernel to test.
+ * @param[in] num_rounds Number of rounds.
+ */
+static void test_permute_full_state(const char *func, void (*permute)(uint64_t[static 25], const size_t), const size_t num_rounds) {
+  uint64_t got[25] = { 0 }, exp[25] = { 0 };
+  for (size_t i = 0; i < 25; i++) {
+    got[i] = exp[i] = 0x0123456789abcdefULL * (i + 1);
+  }
+
+  for (size_t i = 0; i < 4; i++) {
+    permute(got, num_rounds);
+    permute_n_scalar(exp, num_rounds);
+    if (memcmp(got, exp, sizeof(got))) {
+      fail_test(func, "full state", (uint8_t*) got, sizeof(got), (uint8_t*) exp, sizeof(exp));
+    }
+  }
+}
+
 static void test_permute_24_scalar(void) {
   for (size_t i = 0; i < sizeof(PERMUTE_24_TESTS) / sizeof(PERMUTE_24_TESTS[0]); i++) {
     const size_t exp_len = PERMUTE_24_TESTS[i].exp_len;
@@ -3444,6 +7377,42 @@ static void test_permute_24_scalar(void) {
   }
 }
 
+static void test_permute_24_lcomp(void) {
+  for (size_t i = 0; i < sizeof(PERMUTE_24_TESTS) / sizeof(PERMUTE_24_TESTS[0]); i++) {
+    const size_t exp_len = PERMUTE_24_TESTS[i].exp_len;
+
+    uint64_t got[25] = { 0 };
+    memcpy(got, PERMUTE_24_TESTS[i].a, sizeof(got));
+    permute_n_lcomp(got, 24); // call permute_n() directly
+
+    if (memcmp(got, PERMUTE_24_TESTS[i].exp, exp_len)) {
+      fail_test(__func__, "", (uint8_t*) got, exp_len, (uint8_t*) PERMUTE_24_TESTS[i].exp, exp_len);
+    }
+  }
+
+  // compare full state against scalar backend, so every lane (including
+  // the complemented ones) is checked
+  test_permute_full_state(__func__, permute_n_lcomp, 24);
+}
+
+static void test_permute_24_bi32(void) {
+  for (size_t i = 0; i < sizeof(PERMUTE_24_TESTS) / sizeof(PERMUTE_24_TESTS[0]); i++) {
+    const size_t exp_len = PERMUTE_24_TESTS[i].exp_len;
+
+    uint64_t got[25] = { 0 };
+    memcpy(got, PERMUTE_24_TESTS[i].a, sizeof(got));
+    permute_n_bi32(got, 24); // call permute_n() directly
+
+    if (memcmp(got, PERMUTE_24_TESTS[i].exp, exp_len)) {
+      fail_test(__func__, "", (uint8_t*) got, exp_len, (uint8_t*) PERMUTE_24_TESTS[i].exp, exp_len);
+    }
+  }
+
+  // compare full state against scalar backend, so the bit interleaving
+  // and de-interleaving of every lane (both 32-bit halves) is checked
+  test_permute_full_state(__func__, permute_n_bi32, 24);
+}
+
 static void test_permute_24_avx512(void) {
 #if BACKEND == BACKEND_AVX512
   for (size_t i = 0; i < sizeof(PERMUTE_24_TESTS) / sizeof(PERMUTE_24_TESTS[0]); i++) {
@@ -3460,6 +7429,26 @@ static void test_permute_24_avx512(void) {
 #endif /* BACKEND == BACKEND_AVX512 */
 }
 
+static void test_permute_24_avx512vl(void) {
+#ifdef AVX512_YMM
+  for (size_t i = 0; i < sizeof(PERMUTE_24_TESTS) / sizeof(PERMUTE_24_TESTS[0]); i++) {
+    const size_t exp_len = PERMUTE_24_TESTS[i].exp_len;
+
+    uint64_t got[25] = { 0 };
+    memcpy(got, PERMUTE_24_TESTS[i].a, sizeof(got));
+    permute_n_avx512vl(got, 24); // call permute_n() directly
+
+    if (memcmp(got, PERMUTE_24_TESTS[i].exp, exp_len)) {
+      fail_test(__func__, "", (uint8_t*) got, exp_len, (uint8_t*) PERMUTE_24_TESTS[i].exp, exp_len);
+    }
+  }
+
+  // compare full state against scalar backend, so column 4 (which is
+  // stored separately from columns 0-3) is checked
+  test_permute_full_state(__func__, permute_n_avx512vl, 24);
+#endif /* AVX512_YMM */
+}
+
 static void test_permute_24_neon(void) {
 #if BACKEND == BACKEND_NEON
   for (size_t i = 0; i < sizeof(PERMUTE_24_TESTS) / sizeof(PERMUTE_24_TESTS[0]); i++) {
@@ -3476,6 +7465,22 @@ static void test_permute_24_neon(void) {
 #endif /* BACKEND == BACKEND_NEON */
 }
 
+static void test_permute_24_neon_sha3(void) {
+#if BACKEND == BACKEND_NEON_SHA3
+  for (size_t i = 0; i < sizeof(PERMUTE_24_TESTS) / sizeof(PERMUTE_24_TESTS[0]); i++) {
+    const size_t exp_len = PERMUTE_24_TESTS[i].exp_len;
+
+    uint64_t got[25] = { 0 };
+    memcpy(got, PERMUTE_24_TESTS[i].a, sizeof(got));
+    permute_n_neon_sha3(got, 24); // call permute_n() directly
+
+    if (memcmp(got, PERMUTE_24_TESTS[i].exp, exp_len)) {
+      fail_test(__func__, "", (uint8_t*) got, exp_len, (uint8_t*) PERMUTE_24_TESTS[i].exp, exp_len);
+    }
+  }
+#endif /* BACKEND == BACKEND_NEON_SHA3 */
+}
+
 static void test_permute_24_diet_neon(void) {
 #if BACKEND == BACKEND_DIET_NEON
   for (size_t i = 0; i < sizeof(PERMUTE_24_TESTS) / sizeof(PERMUTE_24_TESTS[0]); i++) {
@@ -3532,6 +7537,42 @@ static void test_permute_12_scalar(void) {
   }
 }
 
+static void test_permute_12_lcomp(void) {
+  for (size_t i = 0; i < sizeof(PERMUTE_12_TESTS) / sizeof(PERMUTE_12_TESTS[0]); i++) {
+    const size_t exp_len = PERMUTE_12_TESTS[i].exp_len;
+
+    uint64_t got[25] = { 0 };
+    memcpy(got, PERMUTE_12_TESTS[i].a, sizeof(got));
+    permute_n_lcomp(got, 12); // call permute_n() directly
+
+    if (memcmp(got, PERMUTE_12_TESTS[i].exp, exp_len)) {
+      fail_test(__func__, "", (uint8_t*) got, exp_len, (uint8_t*) PERMUTE_12_TESTS[i].exp, exp_len);
+    }
+  }
+
+  // compare full state against scalar backend, so every lane (including
+  // the complemented ones) is checked
+  test_permute_full_state(__func__, permute_n_lcomp, 12);
+}
+
+static void test_permute_12_bi32(void) {
+  for (size_t i = 0; i < sizeof(PERMUTE_12_TESTS) / sizeof(PERMUTE_12_TESTS[0]); i++) {
+    const size_t exp_len = PERMUTE_12_TESTS[i].exp_len;
+
+    uint64_t got[25] = { 0 };
+    memcpy(got, PERMUTE_12_TESTS[i].a, sizeof(got));
+    permute_n_bi32(got, 12); // call permute_n() directly
+
+    if (memcmp(got, PERMUTE_12_TESTS[i].exp, exp_len)) {
+      fail_test(__func__, "", (uint8_t*) got, exp_len, (uint8_t*) PERMUTE_12_TESTS[i].exp, exp_len);
+    }
+  }
+
+  // compare full state against scalar backend, so the bit interleaving
+  // and de-interleaving of every lane (both 32-bit halves) is checked
+  test_permute_full_state(__func__, permute_n_bi32, 12);
+}
+
 static void test_permute_12_avx512(void) {
 #if BACKEND == BACKEND_AVX512
   for (size_t i = 0; i < sizeof(PERMUTE_12_TESTS) / sizeof(PERMUTE_12_TESTS[0]); i++) {
@@ -3548,6 +7589,26 @@ static void test_permute_12_avx512(void) {
 #endif /* BACKEND == BACKEND_AVX512 */
 }
 
+static void test_permute_12_avx512vl(void) {
+#ifdef AVX512_YMM
+  for (size_t i = 0; i < sizeof(PERMUTE_12_TESTS) / sizeof(PERMUTE_12_TESTS[0]); i++) {
+    const size_t exp_len = PERMUTE_12_TESTS[i].exp_len;
+
+    uint64_t got[25] = { 0 };
+    memcpy(got, PERMUTE_12_TESTS[i].a, sizeof(got));
+    permute_n_avx512vl(got, 12); // call permute_n() directly
+
+    if (memcmp(got, PERMUTE_12_TESTS[i].exp, exp_len)) {
+      fail_test(__func__, "", (uint8_t*) got, exp_len, (uint8_t*) PERMUTE_12_TESTS[i].exp, exp_len);
+    }
+  }
+
+  // compare full state against scalar backend, so column 4 (which is
+  // stored separately from columns 0-3) is checked
+  test_permute_full_state(__func__, permute_n_avx512vl, 12);
+#endif /* AVX512_YMM */
+}
+
 static void test_permute_12_neon(void) {
 #if BACKEND == BACKEND_NEON
   for (size_t i = 0; i < sizeof(PERMUTE_12_TESTS) / sizeof(PERMUTE_12_TESTS[0]); i++) {
@@ -3564,6 +7625,22 @@ static void test_permute_12_neon(void) {
 #endif /* BACKEND == BACKEND_NEON */
 }
 
+static void test_permute_12_neon_sha3(void) {
+#if BACKEND == BACKEND_NEON_SHA3
+  for (size_t i = 0; i < sizeof(PERMUTE_12_TESTS) / sizeof(PERMUTE_12_TESTS[0]); i++) {
+    const size_t exp_len = PERMUTE_12_TESTS[i].exp_len;
+
+    uint64_t got[25] = { 0 };
+    memcpy(got, PERMUTE_12_TESTS[i].a, sizeof(got));
+    permute_n_neon_sha3(got, 12); // call permute_n() directly
+
+    if (memcmp(got, PERMUTE_12_TESTS[i].exp, exp_len)) {
+      fail_test(__func__, "", (uint8_t*) got, exp_len, (uint8_t*) PERMUTE_12_TESTS[i].exp, exp_len);
+    }
+  }
+#endif /* BACKEND == BACKEND_NEON_SHA3 */
+}
+
 static void test_permute_12_diet_neon(void) {
 #if BACKEND == BACKEND_DIET_NEON
   for (size_t i = 0; i < sizeof(PERMUTE_12_TESTS) / sizeof(PERMUTE_12_TESTS[0]); i++) {
@@ -3596,6 +7673,98 @@ static void test_permute_12_hybrid(void) {
 #endif /* BACKEND == BACKEND_HYBRID */
 }
 
+/**
+ * @brief Compare two-state permutation kernel against scalar backend.
+ *
+ * Used by the tests for the two-state kernels.  Permutes two different
+ * states with `permute()` three times at `num_rounds` rounds, and
+ * compares both states against `permute_n_scalar()` after each
+ * permutation.
+ *
+ * @param[in] func Name of calling test function.
+ * @param[in] permute Two-state permutation kernel to test.
+ * @param[in] num_rounds Number of rounds.
+ */
+static void test_permute_x2_kernel(const char *func, void (*permute)(uint64_t[static 25], uint64_t[static 25], const size_t), const size_t num_rounds) {
+  // populate two different states
+  uint64_t got[2][25] = { 0 }, exp[2][25] = { 0 };
+  for (size_t i = 0; i < 25; i++) {
+    got[0][i] = exp[0][i] = 0x0123456789abcdefULL * (i + 1);
+    got[1][i] = exp[1][i] = 0xfedcba9876543210ULL ^ ((uint64_t) i << 40);
+  }
+
+  for (size_t i = 0; i < 3; i++) {
+    permute(got[0], got[1], num_rounds);
+    permute_n_scalar(exp[0], num_rounds);
+    permute_n_scalar(exp[1], num_rounds);
+    if (memcmp(got, exp, sizeof(got))) {
+      fail_test(func, "", (uint8_t*) got, sizeof(got), (uint8_t*) exp, sizeof(exp));
+    }
+  }
+}
+
+static void test_permute_x2(void) {
+  test_permute_x2_kernel(__func__, permute_n_x2, 24);
+  test_permute_x2_kernel(__func__, permute_n_x2, 12);
+}
+
+static void test_permute_avx512_x2(void) {
+#if BACKEND == BACKEND_AVX512
+  test_permute_x2_kernel(__func__, permute_n_avx512_x2, 24);
+  test_permute_x2_kernel(__func__, permute_n_avx512_x2, 12);
+#endif /* BACKEND == BACKEND_AVX512 */
+}
+
+static void test_permute_neon_sha3_x2(void) {
+#if BACKEND == BACKEND_NEON_SHA3
+  test_permute_x2_kernel(__func__, permute_n_neon_sha3_x2, 24);
+  test_permute_x2_kernel(__func__, permute_n_neon_sha3_x2, 12);
+#endif /* BACKEND == BACKEND_NEON_SHA3 */
+}
+
+static void test_permute_batch(void) {
+  // check fixed (24 and 12) and generic (odd and even) round counts for
+  // 1 to 17 states (covers full groups, a partial group, and a single
+  // remaining state for all lane counts)
+  static const size_t NUM_ROUNDS[] = { 24, 12, 14, 7, 1 };
+
+  // test with default permutation, then with 256-bit avx512
+  // permutation (if supported)
+  for (size_t m = 0; m < 2; m++) {
+    sha3_avx512_ymm(m == 1);
+
+    for (size_t r = 0; r < sizeof(NUM_ROUNDS) / sizeof(NUM_ROUNDS[0]); r++) {
+      for (size_t n = 1; n <= 17; n++) {
+        sha3_state_t got[17] = { 0 }, exp[17] = { 0 };
+
+        // populate states with distinct values
+        for (size_t i = 0; i < n; i++) {
+          for (size_t j = 0; j < 25; j++) {
+            got[i].u64[j] = exp[i].u64[j] = 0x0123456789abcdefULL * (i + 1) + j;
+          }
+
+          // apply rounds one at a time
+          for (size_t j = SHA3_NUM_ROUNDS - NUM_ROUNDS[r]; j < SHA3_NUM_ROUNDS; j++) {
+            permute_round(exp[i].u64, j);
+          }
+        }
+
+        permute_batch(got, n, NUM_ROUNDS[r]);
+
+        // check all states, including unused states (must be untouched)
+        if (memcmp(got, exp, sizeof(got))) {
+          char name[64];
+          snprintf(name, sizeof(name), "%zu/rounds=%zu n=%zu", m, NUM_ROUNDS[r], n);
+          fail_test(__func__, name, (uint8_t*) got, n * sizeof(sha3_state_t), (uint8_t*) exp, n * sizeof(sha3_state_t));
+        }
+      }
+    }
+  }
+
+  // restore default permutation
+  sha3_avx512_ymm(false);
+}
+
 static void test_sha3_224(void) {
   static const struct {
     const char *name; // test name
@@ -4562,24 +8731,137 @@ static void test_sha3_512_ctx(void) {
       sha3_512_init(&hash);
 
       // absorb
-      for (size_t k = 0; k < tests[i].len; k += j) {
-        const size_t absorb_len = MIN(tests[i].len - k, j);
-        sha3_512_absorb(&hash, tests[i].msg + k, absorb_len);
+      for (size_t k = 0; k < tests[i].len; k += j) {
+        const size_t absorb_len = MIN(tests[i].len - k, j);
+        sha3_512_absorb(&hash, tests[i].msg + k, absorb_len);
+      }
+
+      // finalize
+      uint8_t got[64] = { 0 };
+      sha3_512_final(&hash, got);
+
+      // check
+      if (memcmp(got, tests[i].exp, sizeof(got))) {
+        fail_test(__func__, tests[i].name, got, 64, tests[i].exp, 64);
+      }
+    }
+  }
+}
+
+static void test_shake128_ctx(void) {
+  static const struct {
+    const char *name; // test name
+    const uint8_t msg[256]; // test message
+    const size_t len; // test message length
+    const uint8_t exp[16]; // expected hash
+  } tests[] = {{
+    .name = "empty",
+    .msg = "",
+    .len = 0,
+    .exp = {
+      0x7f, 0x9c, 0x2b, 0xa4, 0xe8, 0x8f, 0x82, 0x7d,
+      0x61, 0x60, 0x45, 0x50, 0x76, 0x05, 0x85, 0x3e,
+    },
+  }, {
+    .name = "asdf",
+    .msg = "asdf",
+    .len = 4,
+    .exp = {
+      0xef, 0x02, 0x2c, 0xc5, 0x3c, 0x74, 0xb3, 0x28,
+      0x43, 0xf9, 0xc1, 0xf1, 0x14, 0x13, 0xd5, 0x9c,
+    },
+  }, {
+    .name = "a-134",
+    .msg = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+    .len = 134,
+    .exp = {
+      0xc8, 0x73, 0x5e, 0x5f, 0x6f, 0x15, 0xaf, 0xe5,
+      0x1a, 0x8c, 0x3b, 0x07, 0xc4, 0xc6, 0x8d, 0x86,
+    },
+  }, {
+    .name = "a-135",
+    .msg = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+    .len = 135,
+    .exp = {
+      0xa5, 0xe2, 0xb2, 0x27, 0x8d, 0x1b, 0x75, 0x86,
+      0x6c, 0x78, 0x77, 0xa0, 0xff, 0xa2, 0x47, 0x37,
+    },
+  }, {
+    .name = "a-136",
+    .msg = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+    .len = 136,
+    .exp = {
+      0x0d, 0x01, 0x58, 0xd4, 0x46, 0x78, 0x3a, 0x9b,
+      0x18, 0xa6, 0x90, 0x8c, 0x08, 0xbb, 0x5d, 0xe6,
+    },
+  }, {
+    .name = "ff-256",
+    .msg = {
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    },
+    .len = 256,
+    .exp = {
+      0xf3, 0x06, 0x93, 0x04, 0x16, 0x5c, 0x0e, 0xad,
+      0x13, 0x25, 0xb5, 0x26, 0x76, 0x05, 0x95, 0xed,
+    },
+  }, {
+    .name = "a-210",
+    .msg = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
+    .len = 210,
+    .exp = {
+      0xb1, 0xb4, 0xf3, 0xad, 0x3a, 0x1f, 0x67, 0x60,
+      0xe3, 0x08, 0x67, 0xdd, 0x71, 0xb3, 0x49, 0xfa,
+    },
+  }};
+
+  for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+    for (size_t len = 1; len < tests[i].len; len++) {
+      // init xof
+      sha3_xof_t xof;
+      shake128_init(&xof);
+
+      // absorb
+      for (size_t ofs = 0; ofs < tests[i].len; ofs += len) {
+        const size_t absorb_len = MIN(tests[i].len - ofs, len);
+        if (!shake128_absorb(&xof, tests[i].msg + ofs, absorb_len)) {
+          fprintf(stderr, "%s(\"%s\", %zu) failed: shake128_absorb()\n", __func__, tests[i].name, len);
+          return;
+        }
       }
 
-      // finalize
-      uint8_t got[64] = { 0 };
-      sha3_512_final(&hash, got);
+      // squeeze
+      uint8_t got[16] = { 0 };
+      shake128_squeeze(&xof, got, sizeof(got));
 
       // check
       if (memcmp(got, tests[i].exp, sizeof(got))) {
-        fail_test(__func__, tests[i].name, got, 64, tests[i].exp, 64);
+        // build test name
+        char name[64];
+        snprintf(name, sizeof(name), "%s (%zu)", tests[i].name, len);
+
+        // fail test
+        fail_test(__func__, name, got, 16, tests[i].exp, 16);
       }
     }
   }
 }
 
-static void test_shake128_ctx(void) {
+static void test_shake128(void) {
   static const struct {
     const char *name; // test name
     const uint8_t msg[256]; // test message
@@ -4662,22 +8944,9 @@ static void test_shake128_ctx(void) {
 
   for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
     for (size_t len = 1; len < tests[i].len; len++) {
-      // init xof
-      sha3_xof_t xof;
-      shake128_init(&xof);
-
-      // absorb
-      for (size_t ofs = 0; ofs < tests[i].len; ofs += len) {
-        const size_t absorb_len = MIN(tests[i].len - ofs, len);
-        if (!shake128_absorb(&xof, tests[i].msg + ofs, absorb_len)) {
-          fprintf(stderr, "%s(\"%s\", %zu) failed: shake128_absorb()\n", __func__, tests[i].name, len);
-          return;
-        }
-      }
-
-      // squeeze
-      uint8_t got[16] = { 0 };
-      shake128_squeeze(&xof, got, sizeof(got));
+      // run
+      uint8_t got[16];
+      shake128(tests[i].msg, tests[i].len, got, sizeof(got));
 
       // check
       if (memcmp(got, tests[i].exp, sizeof(got))) {
@@ -4692,51 +8961,61 @@ static void test_shake128_ctx(void) {
   }
 }
 
-static void test_shake128(void) {
+static void test_shake256_ctx(void) {
   static const struct {
     const char *name; // test name
     const uint8_t msg[256]; // test message
     const size_t len; // test message length
-    const uint8_t exp[16]; // expected hash
+    const uint8_t exp[32]; // expected hash
   } tests[] = {{
     .name = "empty",
     .msg = "",
     .len = 0,
     .exp = {
-      0x7f, 0x9c, 0x2b, 0xa4, 0xe8, 0x8f, 0x82, 0x7d,
-      0x61, 0x60, 0x45, 0x50, 0x76, 0x05, 0x85, 0x3e,
+      0x46, 0xb9, 0xdd, 0x2b, 0x0b, 0xa8, 0x8d, 0x13,
+      0x23, 0x3b, 0x3f, 0xeb, 0x74, 0x3e, 0xeb, 0x24,
+      0x3f, 0xcd, 0x52, 0xea, 0x62, 0xb8, 0x1b, 0x82,
+      0xb5, 0x0c, 0x27, 0x64, 0x6e, 0xd5, 0x76, 0x2f,
     },
   }, {
     .name = "asdf",
     .msg = "asdf",
     .len = 4,
     .exp = {
-      0xef, 0x02, 0x2c, 0xc5, 0x3c, 0x74, 0xb3, 0x28,
-      0x43, 0xf9, 0xc1, 0xf1, 0x14, 0x13, 0xd5, 0x9c,
+      0xf0, 0x0c, 0x15, 0x64, 0x33, 0x96, 0x61, 0x6a,
+      0x89, 0xa0, 0xcb, 0x79, 0x03, 0x9f, 0x74, 0x05,
+      0x75, 0xde, 0xfe, 0x9d, 0xbe, 0x30, 0x7c, 0xcc,
+      0xda, 0xf8, 0xae, 0x21, 0x0e, 0x1c, 0x9c, 0xc6,
     },
   }, {
     .name = "a-134",
     .msg = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
     .len = 134,
     .exp = {
-      0xc8, 0x73, 0x5e, 0x5f, 0x6f, 0x15, 0xaf, 0xe5,
-      0x1a, 0x8c, 0x3b, 0x07, 0xc4, 0xc6, 0x8d, 0x86,
+      0xf1, 0xe0, 0x3f, 0x37, 0x8e, 0xb7, 0x79, 0x04,
+      0xba, 0x15, 0xbb, 0x64, 0x2a, 0x84, 0xb9, 0x0d,
+      0xe5, 0x2e, 0x29, 0x3e, 0xaf, 0xc2, 0x7c, 0xef,
+      0x05, 0x88, 0x3b, 0x16, 0x56, 0xae, 0xc3, 0x41,
     },
   }, {
     .name = "a-135",
     .msg = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
     .len = 135,
     .exp = {
-      0xa5, 0xe2, 0xb2, 0x27, 0x8d, 0x1b, 0x75, 0x86,
-      0x6c, 0x78, 0x77, 0xa0, 0xff, 0xa2, 0x47, 0x37,
+      0x55, 0xb9, 0x91, 0xec, 0xe1, 0xe5, 0x67, 0xb6,
+      0xe7, 0xc2, 0xc7, 0x14, 0x44, 0x4d, 0xd2, 0x01,
+      0xcd, 0x51, 0xf4, 0xf3, 0x83, 0x2d, 0x08, 0xe1,
+      0xd2, 0x6b, 0xeb, 0xc6, 0x3e, 0x07, 0xa3, 0xd7,
     },
   }, {
     .name = "a-136",
     .msg = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
     .len = 136,
     .exp = {
-      0x0d, 0x01, 0x58, 0xd4, 0x46, 0x78, 0x3a, 0x9b,
-      0x18, 0xa6, 0x90, 0x8c, 0x08, 0xbb, 0x5d, 0xe6,
+      0x8f, 0xcc, 0x5a, 0x08, 0xf0, 0xa1, 0xf6, 0x82,
+      0x7c, 0x9c, 0xf6, 0x4e, 0xe8, 0xd1, 0x6e, 0x04,
+      0x43, 0x10, 0x63, 0x59, 0xca, 0x6c, 0x8e, 0xfd,
+      0x23, 0x07, 0x59, 0x25, 0x6f, 0x44, 0x99, 0x6a,
     },
   }, {
     .name = "ff-256",
@@ -4760,24 +9039,41 @@ static void test_shake128(void) {
     },
     .len = 256,
     .exp = {
-      0xf3, 0x06, 0x93, 0x04, 0x16, 0x5c, 0x0e, 0xad,
-      0x13, 0x25, 0xb5, 0x26, 0x76, 0x05, 0x95, 0xed,
+      0x3f, 0x25, 0xdf, 0x0e, 0x37, 0x17, 0x14, 0xdf,
+      0xb0, 0xcc, 0x3d, 0x96, 0x17, 0xe1, 0xa0, 0x71,
+      0x75, 0xa0, 0xf0, 0x84, 0xc7, 0x00, 0x29, 0x23,
+      0x5c, 0x72, 0x7c, 0x5a, 0x68, 0x5e, 0xf0, 0x14,
     },
   }, {
     .name = "a-210",
     .msg = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
     .len = 210,
     .exp = {
-      0xb1, 0xb4, 0xf3, 0xad, 0x3a, 0x1f, 0x67, 0x60,
-      0xe3, 0x08, 0x67, 0xdd, 0x71, 0xb3, 0x49, 0xfa,
+      0xc9, 0xe2, 0xd9, 0x58, 0xf2, 0xdd, 0x3d, 0x97,
+      0x53, 0x8a, 0x1b, 0xac, 0x1b, 0x4e, 0xb3, 0x2e,
+      0x28, 0x23, 0x6b, 0x5d, 0xfc, 0xe0, 0x29, 0xfc,
+      0xc8, 0x73, 0xc0, 0xf2, 0x70, 0xe1, 0x3e, 0x9f,
     },
   }};
 
   for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
     for (size_t len = 1; len < tests[i].len; len++) {
-      // run
-      uint8_t got[16];
-      shake128(tests[i].msg, tests[i].len, got, sizeof(got));
+      // init xof
+      sha3_xof_t xof;
+      shake256_init(&xof);
+
+      // absorb
+      for (size_t ofs = 0; ofs < tests[i].len; ofs += len) {
+        const size_t absorb_len = MIN(tests[i].len - ofs, len);
+        if (!shake256_absorb(&xof, tests[i].msg + ofs, absorb_len)) {
+          fprintf(stderr, "%s(\"%s\", %zu) failed: shake256_xof_absorb()\n", __func__, tests[i].name, len);
+          return;
+        }
+      }
+
+      // squeeze
+      uint8_t got[32] = { 0 };
+      shake256_squeeze(&xof, got, sizeof(got));
 
       // check
       if (memcmp(got, tests[i].exp, sizeof(got))) {
@@ -4792,7 +9088,7 @@ static void test_shake128(void) {
   }
 }
 
-static void test_shake256_ctx(void) {
+static void test_shake256(void) {
   static const struct {
     const char *name; // test name
     const uint8_t msg[256]; // test message
@@ -4887,148 +9183,626 @@ static void test_shake256_ctx(void) {
     },
   }};
 
-  for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
-    for (size_t len = 1; len < tests[i].len; len++) {
-      // init xof
-      sha3_xof_t xof;
-      shake256_init(&xof);
+  for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+    for (size_t len = 1; len < tests[i].len; len++) {
+      // run shake256
+      uint8_t got[32];
+      shake256(tests[i].msg, tests[i].len, got, sizeof(got));
+
+      // check
+      if (memcmp(got, tests[i].exp, sizeof(got))) {
+        // build test name
+        char name[64];
+        snprintf(name, sizeof(name), "%s (%zu)", tests[i].name, len);
+
+        // fail test
+        fail_test(__func__, name, got, 16, tests[i].exp, 16);
+      }
+    }
+  }
+}
+
+static void test_shake_blocks(void) {
+  // test message: 0, 1, 2, ...
+  uint8_t msg[256] = { 0 };
+  for (size_t i = 0; i < sizeof(msg); i++) {
+    msg[i] = i & 0xff;
+  }
+
+  static const struct {
+    const char *name; // test name
+    const size_t rate; // rate, in bytes
+    void (*init)(sha3_xof_t *); // init function
+    _Bool (*absorb)(sha3_xof_t *, const uint8_t *, size_t); // absorb function
+    void (*squeeze)(sha3_xof_t *, uint8_t *, size_t); // squeeze function
+    _Bool (*squeeze_blocks)(sha3_xof_t *, uint8_t *, size_t); // squeeze blocks function
+    const uint8_t *(*peek_block)(sha3_xof_t *); // peek block function
+    void (*once)(const uint8_t *, size_t, uint8_t *, size_t); // one-shot function
+  } FNS[] = {
+    { "shake128", 168, shake128_init, shake128_absorb, shake128_squeeze, shake128_squeeze_blocks, shake128_peek_block, shake128 },
+    { "shake256", 136, shake256_init, shake256_absorb, shake256_squeeze, shake256_squeeze_blocks, shake256_peek_block, shake256 },
+  };
+
+  for (size_t f = 0; f < sizeof(FNS) / sizeof(FNS[0]); f++) {
+    const size_t rate = FNS[f].rate;
+
+    // calculate expected output (5 blocks)
+    uint8_t exp[5 * 168] = { 0 };
+    FNS[f].once(msg, sizeof(msg), exp, 5 * rate);
+
+    // squeeze 2 blocks, skip 1 block, then peek at remaining blocks
+    {
+      sha3_xof_t xof;
+      FNS[f].init(&xof);
+      FNS[f].absorb(&xof, msg, sizeof(msg));
+
+      uint8_t got[2 * 168] = { 0 };
+      if (!FNS[f].squeeze_blocks(&xof, got, 2) || memcmp(got, exp, 2 * rate)) {
+        fail_test(__func__, FNS[f].name, got, 2 * rate, exp, 2 * rate);
+      }
+
+      if (!FNS[f].squeeze_blocks(&xof, NULL, 1)) {
+        fprintf(stderr, "%s: %s: skip block failed\n", __func__, FNS[f].name);
+      }
+
+      for (size_t i = 3; i < 5; i++) {
+        const uint8_t * const block = FNS[f].peek_block(&xof);
+        if (!block || memcmp(block, exp + i * rate, rate)) {
+          fail_test(__func__, FNS[f].name, block, block ? rate : 0, exp + i * rate, rate);
+        }
+        FNS[f].squeeze_blocks(&xof, NULL, 1);
+      }
+    }
+
+    // peek before any squeeze, then mix with byte-wise squeeze
+    {
+      sha3_xof_t xof;
+      FNS[f].init(&xof);
+      FNS[f].absorb(&xof, msg, sizeof(msg));
+
+      const uint8_t * const block = FNS[f].peek_block(&xof);
+      if (!block || memcmp(block, exp, rate)) {
+        fail_test(__func__, FNS[f].name, block, block ? rate : 0, exp, rate);
+      }
+
+      // squeeze partial block; block functions must fail
+      uint8_t got[5 * 168] = { 0 };
+      FNS[f].squeeze(&xof, got, 10);
+      if (FNS[f].squeeze_blocks(&xof, got + 10, 1) || FNS[f].peek_block(&xof)) {
+        fprintf(stderr, "%s: %s: block functions accepted partial block\n", __func__, FNS[f].name);
+      }
+
+      // finish block, then squeeze whole block
+      FNS[f].squeeze(&xof, got + 10, rate - 10);
+      if (!FNS[f].squeeze_blocks(&xof, got + rate, 1) || memcmp(got, exp, 2 * rate)) {
+        fail_test(__func__, FNS[f].name, got, 2 * rate, exp, 2 * rate);
+      }
+    }
+  }
+}
+
+static void test_once_short(void) {
+  // test message: 0, 1, 2, ... (read from odd offset to check unaligned
+  // input; empty messages are passed as NULL to check that the
+  // one-shot functions accept a NULL source when the length is zero)
+  uint8_t buf[256] = { 0 };
+  for (size_t i = 0; i < sizeof(buf); i++) {
+    buf[i] = i & 0xff;
+  }
+  const uint8_t * const msg = buf + 1;
+
+  // sha3 (lengths up to rate + 1)
+  {
+    static const struct {
+      const char *name; // test name
+      const size_t len; // digest length
+      void (*once)(const uint8_t *, size_t, uint8_t *); // one-shot function
+      void (*init)(sha3_t *); // init function
+      _Bool (*absorb)(sha3_t *, const uint8_t *, size_t); // absorb function
+      void (*final)(sha3_t *, uint8_t *); // final function
+    } FNS[] = {
+      { "sha3_224", 28, sha3_224, sha3_224_init, sha3_224_absorb, sha3_224_final },
+      { "sha3_256", 32, sha3_256, sha3_256_init, sha3_256_absorb, sha3_256_final },
+      { "sha3_384", 48, sha3_384, sha3_384_init, sha3_384_absorb, sha3_384_final },
+      { "sha3_512", 64, sha3_512, sha3_512_init, sha3_512_absorb, sha3_512_final },
+    };
+
+    for (size_t f = 0; f < sizeof(FNS) / sizeof(FNS[0]); f++) {
+      for (size_t len = 0; len <= 200 - 2 * FNS[f].len + 1; len++) {
+        // hash with iterative context, one byte then the rest
+        uint8_t exp[64] = { 0 };
+        sha3_t ctx;
+        FNS[f].init(&ctx);
+        FNS[f].absorb(&ctx, msg, len ? 1 : 0);
+        FNS[f].absorb(&ctx, msg + (len ? 1 : 0), len ? (len - 1) : 0);
+        FNS[f].final(&ctx, exp);
+
+        uint8_t got[64] = { 0 };
+        FNS[f].once(len ? msg : NULL, len, got);
+        if (memcmp(got, exp, FNS[f].len)) {
+          fail_test(__func__, FNS[f].name, got, FNS[f].len, exp, FNS[f].len);
+        }
+      }
+    }
+  }
+
+  // shake (lengths up to rate + 1, output longer than rate)
+  {
+    static const struct {
+      const char *name; // test name
+      const size_t rate; // rate, in bytes
+      void (*once)(const uint8_t *, size_t, uint8_t *, size_t); // one-shot function
+      void (*init)(sha3_xof_t *); // init function
+      _Bool (*absorb)(sha3_xof_t *, const uint8_t *, size_t); // absorb function
+      void (*squeeze)(sha3_xof_t *, uint8_t *, size_t); // squeeze function
+    } FNS[] = {
+      { "shake128", 168, shake128, shake128_init, shake128_absorb, shake128_squeeze },
+      { "shake256", 136, shake256, shake256_init, shake256_absorb, shake256_squeeze },
+    };
+
+    for (size_t f = 0; f < sizeof(FNS) / sizeof(FNS[0]); f++) {
+      for (size_t len = 0; len <= FNS[f].rate + 1; len++) {
+        // hash with iterative context, one byte then the rest
+        uint8_t exp[200] = { 0 };
+        sha3_xof_t xof;
+        FNS[f].init(&xof);
+        FNS[f].absorb(&xof, msg, len ? 1 : 0);
+        FNS[f].absorb(&xof, msg + (len ? 1 : 0), len ? (len - 1) : 0);
+        FNS[f].squeeze(&xof, exp, sizeof(exp));
+
+        uint8_t got[200] = { 0 };
+        FNS[f].once(len ? msg : NULL, len, got, sizeof(got));
+        if (memcmp(got, exp, sizeof(got))) {
+          fail_test(__func__, FNS[f].name, got, sizeof(got), exp, sizeof(exp));
+        }
+      }
+    }
+  }
+
+  // turboshake (lengths up to rate + 1, output longer than rate,
+  // default and custom padding)
+  {
+    static const struct {
+      const char *name; // test name
+      const size_t rate; // rate, in bytes
+      void (*once)(uint8_t, const uint8_t *, size_t, uint8_t *, size_t); // one-shot function
+      _Bool (*init)(turboshake_t *, uint8_t); // init function
+      _Bool (*absorb)(turboshake_t *, const uint8_t *, size_t); // absorb function
+      void (*squeeze)(turboshake_t *, uint8_t *, size_t); // squeeze function
+    } FNS[] = {
+      { "turboshake128", 168, turboshake128_custom, turboshake128_init_custom, turboshake128_absorb, turboshake128_squeeze },
+      { "turboshake256", 136, turboshake256_custom, turboshake256_init_custom, turboshake256_absorb, turboshake256_squeeze },
+    };
+    static const uint8_t PADS[] = { 0x1f, 0x01, 0x0b };
+
+    for (size_t f = 0; f < sizeof(FNS) / sizeof(FNS[0]); f++) {
+      for (size_t p = 0; p < sizeof(PADS); p++) {
+        for (size_t len = 0; len <= FNS[f].rate + 1; len++) {
+          // hash with iterative context, one byte then the rest
+          uint8_t exp[200] = { 0 };
+          turboshake_t ts;
+          FNS[f].init(&ts, PADS[p]);
+          FNS[f].absorb(&ts, msg, len ? 1 : 0);
+          FNS[f].absorb(&ts, msg + (len ? 1 : 0), len ? (len - 1) : 0);
+          FNS[f].squeeze(&ts, exp, sizeof(exp));
+
+          uint8_t got[200] = { 0 };
+          FNS[f].once(PADS[p], len ? msg : NULL, len, got, sizeof(got));
+          if (memcmp(got, exp, sizeof(got))) {
+            fail_test(__func__, FNS[f].name, got, sizeof(got), exp, sizeof(exp));
+          }
+        }
+      }
+    }
+  }
+}
+
+static void test_sha3_x4(void) {
+  // test message: 0, 1, 2, ...
+  uint8_t msg[3000] = { 0 };
+  for (size_t i = 0; i < sizeof(msg); i++) {
+    msg[i] = i & 0xff;
+  }
+
+  // four-lane context functions and one-shot functions
+  static const struct {
+    const char *name; // test name
+    void (*init)(sha3_x4_t *); // init function
+    _Bool (*absorb)(sha3_x4_t *, const uint8_t * const [4], const size_t [4]); // absorb function
+    void (*final)(sha3_x4_t *, uint8_t * const [4]); // final function
+    void (*once)(const uint8_t *, size_t, uint8_t *); // one-shot function
+    size_t len; // digest length
+  } FNS[] = {
+    { "sha3_224_x4", sha3_224_x4_init, sha3_224_x4_absorb, sha3_224_x4_final, sha3_224, 28 },
+    { "sha3_256_x4", sha3_256_x4_init, sha3_256_x4_absorb, sha3_256_x4_final, sha3_256, 32 },
+    { "sha3_384_x4", sha3_384_x4_init, sha3_384_x4_absorb, sha3_384_x4_final, sha3_384, 48 },
+    { "sha3_512_x4", sha3_512_x4_init, sha3_512_x4_absorb, sha3_512_x4_final, sha3_512, 64 },
+  };
+
+  // chunk lengths (lanes start at different offsets so they fill their
+  // blocks in different calls)
+  static const size_t CHUNK_LENS[] = { 1, 7, 136, 0, 72, 300, 144, 1000, 71 };
+  static const size_t NUM_CHUNK_LENS = sizeof(CHUNK_LENS) / sizeof(CHUNK_LENS[0]);
+
+  // lane message lengths
+  static const size_t LENS[][4] = {
+    { 0, 0, 0, 0 },
+    { 136, 136, 136, 136 },
+    { 0, 137, 1000, 3000 },
+    { 3000, 71, 144, 500 },
+  };
+
+  for (size_t f = 0; f < sizeof(FNS) / sizeof(FNS[0]); f++) {
+    for (size_t t = 0; t < sizeof(LENS) / sizeof(LENS[0]); t++) {
+      // calculate expected results with one-shot function
+      uint8_t exp[4][64] = { 0 };
+      for (size_t i = 0; i < 4; i++) {
+        FNS[f].once(msg, LENS[t][i], exp[i]);
+      }
+
+      // absorb chunks until every lane is done
+      sha3_x4_t ctx;
+      FNS[f].init(&ctx);
+      size_t ofs[4] = { 0 };
+      for (size_t k = 0; ofs[0] < LENS[t][0] || ofs[1] < LENS[t][1] || ofs[2] < LENS[t][2] || ofs[3] < LENS[t][3]; k++) {
+        const uint8_t *srcs[4];
+        size_t lens[4];
+        for (size_t i = 0; i < 4; i++) {
+          lens[i] = MIN(CHUNK_LENS[(k + 2 * i) % NUM_CHUNK_LENS], LENS[t][i] - ofs[i]);
+          srcs[i] = msg + ofs[i];
+          ofs[i] += lens[i];
+        }
+
+        if (!FNS[f].absorb(&ctx, srcs, lens)) {
+          fprintf(stderr, "%s: %s: absorb failed\n", __func__, FNS[f].name);
+        }
+      }
+
+      // finalize
+      uint8_t got[4][64] = { 0 };
+      uint8_t * const dsts[4] = { got[0], got[1], got[2], got[3] };
+      FNS[f].final(&ctx, dsts);
+
+      // check results
+      if (memcmp(got, exp, sizeof(got))) {
+        fail_test(__func__, FNS[f].name, (uint8_t*) got, sizeof(got), (uint8_t*) exp, sizeof(exp));
+      }
+    }
+  }
+}
+
+static void test_sha3_256_fixed(void) {
+  // test message: 0, 1, 2, ...
+  uint8_t buf[8 * 64 + 1] = { 0 };
+  for (size_t i = 0; i < sizeof(buf); i++) {
+    buf[i] = i & 0xff;
+  }
+
+  static const struct {
+    const char *name; // test name
+    const size_t len; // input length
+    void (*hash)(const uint8_t *, uint8_t *); // single function
+    void (*hash_x4)(const uint8_t * const [4], uint8_t * const [4]); // four-lane function
+    void (*hash_x8)(const uint8_t * const [8], uint8_t * const [8]); // eight-lane function
+  } FNS[] = {
+    { "sha3_256_32", 32, sha3_256_32, sha3_256_32_x4, sha3_256_32_x8 },
+    { "sha3_256_64", 64, sha3_256_64, sha3_256_64_x4, sha3_256_64_x8 },
+  };
+
+  for (size_t f = 0; f < sizeof(FNS) / sizeof(FNS[0]); f++) {
+    const size_t len = FNS[f].len;
+
+    // check aligned and unaligned inputs
+    for (size_t ofs = 0; ofs < 2; ofs++) {
+      const uint8_t *srcs[8];
+      uint8_t exp[8][32] = { 0 }, got[8][32] = { 0 }, *dsts[8];
+      for (size_t i = 0; i < 8; i++) {
+        srcs[i] = buf + ofs + i * len;
+        dsts[i] = got[i];
+        sha3_256(srcs[i], len, exp[i]);
+      }
+
+      // single
+      FNS[f].hash(srcs[0], got[0]);
+      if (memcmp(got[0], exp[0], 32)) {
+        fail_test(__func__, FNS[f].name, got[0], 32, exp[0], 32);
+      }
+
+      // four lanes
+      memset(got, 0, sizeof(got));
+      FNS[f].hash_x4(srcs, dsts);
+      for (size_t i = 0; i < 4; i++) {
+        if (memcmp(got[i], exp[i], 32)) {
+          fail_test(__func__, FNS[f].name, got[i], 32, exp[i], 32);
+        }
+      }
+
+      // eight lanes
+      memset(got, 0, sizeof(got));
+      FNS[f].hash_x8(srcs, dsts);
+      for (size_t i = 0; i < 8; i++) {
+        if (memcmp(got[i], exp[i], 32)) {
+          fail_test(__func__, FNS[f].name, got[i], 32, exp[i], 32);
+        }
+      }
+    }
+  }
+}
+
+// get first 32 bytes of shake256 output (reference for test_hash_chain())
+static void test_shake256_32(const uint8_t *src, size_t len, uint8_t *dst) {
+  shake256(src, len, dst, 32);
+}
+
+static void test_hash_chain(void) {
+  static const struct {
+    const char *name; // test name
+    void (*hash)(const uint8_t *, size_t, uint8_t *); // one-shot hash (reference)
+    void (*chain)(const uint8_t *, size_t, uint8_t *); // single chain function
+    void (*chain_x4)(const uint8_t * const [4], size_t, uint8_t * const [4]); // four-lane function
+    void (*chain_x8)(const uint8_t * const [8], size_t, uint8_t * const [8]); // eight-lane function
+  } FNS[] = {
+    { "sha3_256_iterate", sha3_256, sha3_256_iterate, sha3_256_iterate_x4, sha3_256_iterate_x8 },
+    { "shake256_chain", test_shake256_32, shake256_chain, shake256_chain_x4, shake256_chain_x8 },
+  };
+
+  static const size_t NUMS[] = { 0, 1, 2, 17, 100 };
+
+  // seeds: 0, 1, 2, ...
+  uint8_t seeds[8][32] = { 0 };
+  const uint8_t *srcs[8];
+  for (size_t i = 0; i < 8; i++) {
+    for (size_t j = 0; j < 32; j++) {
+      seeds[i][j] = (32 * i + j) & 0xff;
+    }
+    srcs[i] = seeds[i];
+  }
+
+  for (size_t f = 0; f < sizeof(FNS) / sizeof(FNS[0]); f++) {
+    for (size_t k = 0; k < sizeof(NUMS) / sizeof(NUMS[0]); k++) {
+      // calculate expected results with one-shot function
+      uint8_t exp[8][32] = { 0 };
+      for (size_t i = 0; i < 8; i++) {
+        memcpy(exp[i], seeds[i], 32);
+        for (size_t j = 0; j < NUMS[k]; j++) {
+          FNS[f].hash(exp[i], 32, exp[i]);
+        }
+      }
+
+      uint8_t got[8][32] = { 0 }, *dsts[8];
+      for (size_t i = 0; i < 8; i++) {
+        dsts[i] = got[i];
+      }
+
+      // single
+      FNS[f].chain(seeds[0], NUMS[k], got[0]);
+      if (memcmp(got[0], exp[0], 32)) {
+        fail_test(__func__, FNS[f].name, got[0], 32, exp[0], 32);
+      }
+
+      // four lanes
+      memset(got, 0, sizeof(got));
+      FNS[f].chain_x4(srcs, NUMS[k], dsts);
+      if (memcmp(got, exp, 4 * 32)) {
+        fail_test(__func__, FNS[f].name, (uint8_t*) got, 4 * 32, (uint8_t*) exp, 4 * 32);
+      }
+
+      // eight lanes
+      memset(got, 0, sizeof(got));
+      FNS[f].chain_x8(srcs, NUMS[k], dsts);
+      if (memcmp(got, exp, sizeof(exp))) {
+        fail_test(__func__, FNS[f].name, (uint8_t*) got, sizeof(got), (uint8_t*) exp, sizeof(exp));
+      }
+    }
+  }
+}
+
+static void test_shake128_sample(void) {
+  // seeds: 0, 1, 2, ... (long enough for seeds longer than the rate)
+  uint8_t buf[8 + 200] = { 0 };
+  for (size_t i = 0; i < sizeof(buf); i++) {
+    buf[i] = i & 0xff;
+  }
 
-      // absorb
-      for (size_t ofs = 0; ofs < tests[i].len; ofs += len) {
-        const size_t absorb_len = MIN(tests[i].len - ofs, len);
-        if (!shake256_absorb(&xof, tests[i].msg + ofs, absorb_len)) {
-          fprintf(stderr, "%s(\"%s\", %zu) failed: shake256_xof_absorb()\n", __func__, tests[i].name, len);
-          return;
+  static const size_t SEED_LENS[] = { 0, 34, 167, 168, 200 };
+  static const uint32_t Q12S[] = { 3329, 17, 4096 };
+  static const uint32_t Q23S[] = { 8380417, 1 << 22, 1 << 23 };
+
+  for (size_t s = 0; s < sizeof(SEED_LENS) / sizeof(SEED_LENS[0]); s++) {
+    const size_t seed_len = SEED_LENS[s];
+    const uint8_t *seeds[8];
+    for (size_t i = 0; i < 8; i++) {
+      seeds[i] = buf + i;
+    }
+
+    // 12-bit samples
+    for (size_t k = 0; k < sizeof(Q12S) / sizeof(Q12S[0]); k++) {
+      const uint16_t q = Q12S[k];
+      const size_t n = (q < 100) ? 20 : 256;
+
+      // calculate expected values from squeezed bytes
+      uint16_t exp[8][256] = { 0 };
+      for (size_t i = 0; i < 8; i++) {
+        uint8_t out[100 * 168];
+        shake128(seeds[i], seed_len, out, sizeof(out));
+        for (size_t j = 0, num = 0; num < n; j += 3) {
+          const uint16_t d0 = out[j] | ((out[j + 1] & 0xf) << 8),
+                         d1 = (out[j + 1] >> 4) | (out[j + 2] << 4);
+          if (d0 < q) {
+            exp[i][num++] = d0;
+          }
+          if (d1 < q && num < n) {
+            exp[i][num++] = d1;
+          }
         }
       }
 
-      // squeeze
-      uint8_t got[32] = { 0 };
-      shake256_squeeze(&xof, got, sizeof(got));
+      uint16_t got[8][256] = { 0 }, *dsts[8];
+      for (size_t i = 0; i < 8; i++) {
+        dsts[i] = got[i];
+      }
 
-      // check
-      if (memcmp(got, tests[i].exp, sizeof(got))) {
-        // build test name
-        char name[64];
-        snprintf(name, sizeof(name), "%s (%zu)", tests[i].name, len);
+      // single
+      if (!shake128_sample12(seeds[0], seed_len, q, got[0], n) || memcmp(got[0], exp[0], sizeof(got[0]))) {
+        fail_test(__func__, "shake128_sample12", (uint8_t*) got[0], sizeof(got[0]), (uint8_t*) exp[0], sizeof(exp[0]));
+      }
 
-        // fail test
-        fail_test(__func__, name, got, 16, tests[i].exp, 16);
+      // four seeds
+      memset(got, 0, sizeof(got));
+      if (!shake128_sample12_x4(seeds, seed_len, q, dsts, n) || memcmp(got, exp, 4 * sizeof(got[0]))) {
+        fail_test(__func__, "shake128_sample12_x4", (uint8_t*) got, 4 * sizeof(got[0]), (uint8_t*) exp, 4 * sizeof(exp[0]));
+      }
+
+      // eight seeds
+      memset(got, 0, sizeof(got));
+      if (!shake128_sample12_x8(seeds, seed_len, q, dsts, n) || memcmp(got, exp, sizeof(got))) {
+        fail_test(__func__, "shake128_sample12_x8", (uint8_t*) got, sizeof(got), (uint8_t*) exp, sizeof(exp));
       }
     }
+
+    // 23-bit samples
+    for (size_t k = 0; k < sizeof(Q23S) / sizeof(Q23S[0]); k++) {
+      const uint32_t q = Q23S[k];
+      const size_t n = 256;
+
+      // calculate expected values from squeezed bytes
+      uint32_t exp[8][256] = { 0 };
+      for (size_t i = 0; i < 8; i++) {
+        uint8_t out[20 * 168];
+        shake128(seeds[i], seed_len, out, sizeof(out));
+        for (size_t j = 0, num = 0; num < n; j += 3) {
+          const uint32_t d = out[j] | ((uint32_t) out[j + 1] << 8) | ((uint32_t) (out[j + 2] & 0x7f) << 16);
+          if (d < q) {
+            exp[i][num++] = d;
+          }
+        }
+      }
+
+      uint32_t got[8][256] = { 0 }, *dsts[8];
+      for (size_t i = 0; i < 8; i++) {
+        dsts[i] = got[i];
+      }
+
+      // single
+      if (!shake128_sample23(seeds[0], seed_len, q, got[0], n) || memcmp(got[0], exp[0], sizeof(got[0]))) {
+        fail_test(__func__, "shake128_sample23", (uint8_t*) got[0], sizeof(got[0]), (uint8_t*) exp[0], sizeof(exp[0]));
+      }
+
+      // four seeds
+      memset(got, 0, sizeof(got));
+      if (!shake128_sample23_x4(seeds, seed_len, q, dsts, n) || memcmp(got, exp, 4 * sizeof(got[0]))) {
+        fail_test(__func__, "shake128_sample23_x4", (uint8_t*) got, 4 * sizeof(got[0]), (uint8_t*) exp, 4 * sizeof(exp[0]));
+      }
+
+      // eight seeds
+      memset(got, 0, sizeof(got));
+      if (!shake128_sample23_x8(seeds, seed_len, q, dsts, n) || memcmp(got, exp, sizeof(got))) {
+        fail_test(__func__, "shake128_sample23_x8", (uint8_t*) got, sizeof(got), (uint8_t*) exp, sizeof(exp));
+      }
+    }
+  }
+
+  // check invalid bounds
+  {
+    uint16_t d12[1];
+    uint32_t d23[1];
+    if (shake128_sample12(buf, 34, 0, d12, 1) || shake128_sample12(buf, 34, 4097, d12, 1) ||
+        shake128_sample23(buf, 34, 0, d23, 1) || shake128_sample23(buf, 34, (1 << 23) + 1, d23, 1)) {
+      fprintf(stderr, "%s: accepted invalid bound\n", __func__);
+    }
   }
 }
 
-static void test_shake256(void) {
-  static const struct {
-    const char *name; // test name
-    const uint8_t msg[256]; // test message
-    const size_t len; // test message length
-    const uint8_t exp[32]; // expected hash
-  } tests[] = {{
-    .name = "empty",
-    .msg = "",
-    .len = 0,
-    .exp = {
-      0x46, 0xb9, 0xdd, 0x2b, 0x0b, 0xa8, 0x8d, 0x13,
-      0x23, 0x3b, 0x3f, 0xeb, 0x74, 0x3e, 0xeb, 0x24,
-      0x3f, 0xcd, 0x52, 0xea, 0x62, 0xb8, 0x1b, 0x82,
-      0xb5, 0x0c, 0x27, 0x64, 0x6e, 0xd5, 0x76, 0x2f,
-    },
-  }, {
-    .name = "asdf",
-    .msg = "asdf",
-    .len = 4,
-    .exp = {
-      0xf0, 0x0c, 0x15, 0x64, 0x33, 0x96, 0x61, 0x6a,
-      0x89, 0xa0, 0xcb, 0x79, 0x03, 0x9f, 0x74, 0x05,
-      0x75, 0xde, 0xfe, 0x9d, 0xbe, 0x30, 0x7c, 0xcc,
-      0xda, 0xf8, 0xae, 0x21, 0x0e, 0x1c, 0x9c, 0xc6,
-    },
-  }, {
-    .name = "a-134",
-    .msg = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
-    .len = 134,
-    .exp = {
-      0xf1, 0xe0, 0x3f, 0x37, 0x8e, 0xb7, 0x79, 0x04,
-      0xba, 0x15, 0xbb, 0x64, 0x2a, 0x84, 0xb9, 0x0d,
-      0xe5, 0x2e, 0x29, 0x3e, 0xaf, 0xc2, 0x7c, 0xef,
-      0x05, 0x88, 0x3b, 0x16, 0x56, 0xae, 0xc3, 0x41,
-    },
-  }, {
-    .name = "a-135",
-    .msg = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
-    .len = 135,
-    .exp = {
-      0x55, 0xb9, 0x91, 0xec, 0xe1, 0xe5, 0x67, 0xb6,
-      0xe7, 0xc2, 0xc7, 0x14, 0x44, 0x4d, 0xd2, 0x01,
-      0xcd, 0x51, 0xf4, 0xf3, 0x83, 0x2d, 0x08, 0xe1,
-      0xd2, 0x6b, 0xeb, 0xc6, 0x3e, 0x07, 0xa3, 0xd7,
-    },
-  }, {
-    .name = "a-136",
-    .msg = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
-    .len = 136,
-    .exp = {
-      0x8f, 0xcc, 0x5a, 0x08, 0xf0, 0xa1, 0xf6, 0x82,
-      0x7c, 0x9c, 0xf6, 0x4e, 0xe8, 0xd1, 0x6e, 0x04,
-      0x43, 0x10, 0x63, 0x59, 0xca, 0x6c, 0x8e, 0xfd,
-      0x23, 0x07, 0x59, 0x25, 0x6f, 0x44, 0x99, 0x6a,
-    },
-  }, {
-    .name = "ff-256",
-    .msg = {
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-      0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
-    },
-    .len = 256,
-    .exp = {
-      0x3f, 0x25, 0xdf, 0x0e, 0x37, 0x17, 0x14, 0xdf,
-      0xb0, 0xcc, 0x3d, 0x96, 0x17, 0xe1, 0xa0, 0x71,
-      0x75, 0xa0, 0xf0, 0x84, 0xc7, 0x00, 0x29, 0x23,
-      0x5c, 0x72, 0x7c, 0x5a, 0x68, 0x5e, 0xf0, 0x14,
-    },
-  }, {
-    .name = "a-210",
-    .msg = "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa",
-    .len = 210,
-    .exp = {
-      0xc9, 0xe2, 0xd9, 0x58, 0xf2, 0xdd, 0x3d, 0x97,
-      0x53, 0x8a, 0x1b, 0xac, 0x1b, 0x4e, 0xb3, 0x2e,
-      0x28, 0x23, 0x6b, 0x5d, 0xfc, 0xe0, 0x29, 0xfc,
-      0xc8, 0x73, 0xc0, 0xf2, 0x70, 0xe1, 0x3e, 0x9f,
-    },
-  }};
+static void test_hash_batch(void) {
+  // test message: 0, 1, 2, ...
+  uint8_t msg[1024] = { 0 };
+  for (size_t i = 0; i < sizeof(msg); i++) {
+    msg[i] = i & 0xff;
+  }
 
-  for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
-    for (size_t len = 1; len < tests[i].len; len++) {
-      // run shake256
-      uint8_t got[32];
-      shake256(tests[i].msg, tests[i].len, got, sizeof(got));
+  // 37 messages with a mix of lengths (including 0, rate - 1, rate,
+  // and rate + 1 for each rate), sources at unaligned offsets
+  static const size_t NUM_MSGS = 37;
+  const uint8_t *srcs[37];
+  size_t lens[37];
+  for (size_t i = 0; i < NUM_MSGS; i++) {
+    static const size_t LENS[] = { 0, 1, 71, 72, 73, 103, 104, 105, 135, 136, 137, 143, 144, 145, 167, 168, 169, 500, 1000 };
+    srcs[i] = msg + (i % 7);
+    lens[i] = LENS[i % (sizeof(LENS) / sizeof(LENS[0]))];
+  }
 
-      // check
-      if (memcmp(got, tests[i].exp, sizeof(got))) {
-        // build test name
-        char name[64];
-        snprintf(name, sizeof(name), "%s (%zu)", tests[i].name, len);
+  // check batch sizes from 0 to NUM_MSGS
+  for (size_t n = 0; n <= NUM_MSGS; n += (n < 10) ? 1 : 9) {
+    uint8_t got[37][400], exp[37][400];
+    uint8_t *dsts[37];
+    for (size_t i = 0; i < NUM_MSGS; i++) {
+      dsts[i] = got[i];
+    }
 
-        // fail test
-        fail_test(__func__, name, got, 16, tests[i].exp, 16);
-      }
+    // sha3-224
+    memset(got, 0, sizeof(got));
+    memset(exp, 0, sizeof(exp));
+    sha3_224_batch(srcs, lens, n, dsts);
+    for (size_t i = 0; i < n; i++) {
+      sha3_224(srcs[i], lens[i], exp[i]);
+    }
+    if (memcmp(got, exp, sizeof(got))) {
+      fail_test(__func__, "sha3_224_batch", (uint8_t*) got, n * 400, (uint8_t*) exp, n * 400);
+    }
+
+    // sha3-256
+    memset(got, 0, sizeof(got));
+    memset(exp, 0, sizeof(exp));
+    sha3_256_batch(srcs, lens, n, dsts);
+    for (size_t i = 0; i < n; i++) {
+      sha3_256(srcs[i], lens[i], exp[i]);
+    }
+    if (memcmp(got, exp, sizeof(got))) {
+      fail_test(__func__, "sha3_256_batch", (uint8_t*) got, n * 400, (uint8_t*) exp, n * 400);
+    }
+
+    // sha3-384
+    memset(got, 0, sizeof(got));
+    memset(exp, 0, sizeof(exp));
+    sha3_384_batch(srcs, lens, n, dsts);
+    for (size_t i = 0; i < n; i++) {
+      sha3_384(srcs[i], lens[i], exp[i]);
+    }
+    if (memcmp(got, exp, sizeof(got))) {
+      fail_test(__func__, "sha3_384_batch", (uint8_t*) got, n * 400, (uint8_t*) exp, n * 400);
+    }
+
+    // sha3-512
+    memset(got, 0, sizeof(got));
+    memset(exp, 0, sizeof(exp));
+    sha3_512_batch(srcs, lens, n, dsts);
+    for (size_t i = 0; i < n; i++) {
+      sha3_512(srcs[i], lens[i], exp[i]);
+    }
+    if (memcmp(got, exp, sizeof(got))) {
+      fail_test(__func__, "sha3_512_batch", (uint8_t*) got, n * 400, (uint8_t*) exp, n * 400);
+    }
+
+    // shake128 (output longer than rate)
+    memset(got, 0, sizeof(got));
+    memset(exp, 0, sizeof(exp));
+    shake128_batch(srcs, lens, n, dsts, 400);
+    for (size_t i = 0; i < n; i++) {
+      shake128(srcs[i], lens[i], exp[i], 400);
+    }
+    if (memcmp(got, exp, sizeof(got))) {
+      fail_test(__func__, "shake128_batch", (uint8_t*) got, n * 400, (uint8_t*) exp, n * 400);
+    }
+
+    // shake256 (output shorter than rate)
+    memset(got, 0, sizeof(got));
+    memset(exp, 0, sizeof(exp));
+    shake256_batch(srcs, lens, n, dsts, 32);
+    for (size_t i = 0; i < n; i++) {
+      shake256(srcs[i], lens[i], exp[i], 32);
+    }
+    if (memcmp(got, exp, sizeof(got))) {
+      fail_test(__func__, "shake256_batch", (uint8_t*) got, n * 400, (uint8_t*) exp, n * 400);
     }
   }
 }
@@ -5643,6 +10417,77 @@ static void test_kmac256(void) {
   }
 }
 
+static void test_kmac_batch(void) {
+  // test message: 0, 1, 2, ...
+  uint8_t msg[1024] = { 0 };
+  for (size_t i = 0; i < sizeof(msg); i++) {
+    msg[i] = i & 0xff;
+  }
+
+  // one-shot and batch functions
+  static const struct {
+    const char *name; // test name
+    void (*once)(const kmac_params_t, const uint8_t *, const size_t, uint8_t *, const size_t); // one-shot function
+    void (*batch)(const uint8_t *, const size_t, const uint8_t * const [], const size_t [], const size_t, const uint8_t * const [], const size_t [], uint8_t * const [], const size_t []); // batch function
+  } FNS[] = {
+    { "kmac128_batch", kmac128, kmac128_batch },
+    { "kmac256_batch", kmac256, kmac256_batch },
+  };
+
+  // key lengths (short, and longer than every rate)
+  static const size_t KEY_LENS[] = { 32, 200 };
+
+  // 19 messages with a mix of message, customization string, and output
+  // lengths (including outputs longer than the rate)
+  static const size_t NUM_MSGS = 19;
+  const uint8_t *srcs[19], *customs[19];
+  size_t lens[19], custom_lens[19], dst_lens[19];
+  for (size_t i = 0; i < NUM_MSGS; i++) {
+    static const size_t LENS[] = { 0, 1, 135, 136, 137, 167, 168, 169, 1000 };
+    static const size_t CUSTOM_LENS[] = { 0, 1, 13, 150, 200 };
+    static const size_t DST_LENS[] = { 32, 64, 1, 300, 0, 17 };
+    srcs[i] = msg + (i % 7);
+    lens[i] = LENS[i % (sizeof(LENS) / sizeof(LENS[0]))];
+    customs[i] = msg + 100 + i;
+    custom_lens[i] = CUSTOM_LENS[i % (sizeof(CUSTOM_LENS) / sizeof(CUSTOM_LENS[0]))];
+    dst_lens[i] = DST_LENS[i % (sizeof(DST_LENS) / sizeof(DST_LENS[0]))];
+  }
+
+  for (size_t f = 0; f < sizeof(FNS) / sizeof(FNS[0]); f++) {
+    for (size_t k = 0; k < sizeof(KEY_LENS) / sizeof(KEY_LENS[0]); k++) {
+      const uint8_t * const key = msg + 3;
+      const size_t key_len = KEY_LENS[k];
+
+      // check with and without customization strings
+      for (size_t c = 0; c < 2; c++) {
+        // calculate expected results with one-shot function
+        uint8_t exp[19][300] = { 0 };
+        for (size_t i = 0; i < NUM_MSGS; i++) {
+          const kmac_params_t params = {
+            .key = key,
+            .key_len = key_len,
+            .custom = c ? customs[i] : NULL,
+            .custom_len = c ? custom_lens[i] : 0,
+          };
+          FNS[f].once(params, srcs[i], lens[i], exp[i], dst_lens[i]);
+        }
+
+        // calculate batch results
+        uint8_t got[19][300] = { 0 };
+        uint8_t *dsts[19];
+        for (size_t i = 0; i < NUM_MSGS; i++) {
+          dsts[i] = got[i];
+        }
+        FNS[f].batch(key, key_len, srcs, lens, NUM_MSGS, c ? customs : NULL, c ? custom_lens : NULL, dsts, dst_lens);
+
+        if (memcmp(got, exp, sizeof(got))) {
+          fail_test(__func__, FNS[f].name, (uint8_t*) got, sizeof(got), (uint8_t*) exp, sizeof(exp));
+        }
+      }
+    }
+  }
+}
+
 static void test_kmac128_xof(void) {
   static const struct {
     const char *name; // test name
@@ -5945,6 +10790,67 @@ static void test_tuplehash128(void) {
   }
 }
 
+static void test_tuplehash_batch(void) {
+  // test data: 0, 1, 2, ...
+  uint8_t data[1024] = { 0 };
+  for (size_t i = 0; i < sizeof(data); i++) {
+    data[i] = i & 0xff;
+  }
+
+  // one-shot and batch functions
+  static const struct {
+    const char *name; // test name
+    void (*once)(const tuplehash_params_t, uint8_t *, const size_t); // one-shot function
+    void (*batch)(const tuplehash_str_t *, const size_t, const size_t, const uint8_t *, const size_t, uint8_t * const [], const size_t); // batch function
+  } FNS[] = {
+    { "tuplehash128_batch", tuplehash128, tuplehash128_batch },
+    { "tuplehash256_batch", tuplehash256, tuplehash256_batch },
+  };
+
+  // table of 13 rows and 3 columns (column-major) with a mix of
+  // element lengths (including empty elements)
+  static const size_t NUM_ROWS = 13, NUM_COLS = 3;
+  tuplehash_str_t strs[3 * 13];
+  for (size_t i = 0; i < NUM_ROWS * NUM_COLS; i++) {
+    static const size_t LENS[] = { 0, 1, 8, 135, 136, 168, 300 };
+    strs[i] = (tuplehash_str_t) { data + (i % 11), LENS[i % (sizeof(LENS) / sizeof(LENS[0]))] };
+  }
+
+  // output lengths (including longer than rate)
+  static const size_t DST_LENS[] = { 32, 64, 200 };
+
+  for (size_t f = 0; f < sizeof(FNS) / sizeof(FNS[0]); f++) {
+    for (size_t d = 0; d < sizeof(DST_LENS) / sizeof(DST_LENS[0]); d++) {
+      const size_t dst_len = DST_LENS[d];
+
+      // calculate expected results with one-shot function
+      uint8_t exp[13][200] = { 0 };
+      for (size_t i = 0; i < NUM_ROWS; i++) {
+        const tuplehash_str_t row[3] = { strs[i], strs[NUM_ROWS + i], strs[2 * NUM_ROWS + i] };
+        const tuplehash_params_t params = {
+          .strs = row,
+          .num_strs = NUM_COLS,
+          .custom = data,
+          .custom_len = 7,
+        };
+        FNS[f].once(params, exp[i], dst_len);
+      }
+
+      // calculate batch results
+      uint8_t got[13][200] = { 0 };
+      uint8_t *dsts[13];
+      for (size_t i = 0; i < NUM_ROWS; i++) {
+        dsts[i] = got[i];
+      }
+      FNS[f].batch(strs, NUM_ROWS, NUM_COLS, data, 7, dsts, dst_len);
+
+      if (memcmp(got, exp, sizeof(got))) {
+        fail_test(__func__, FNS[f].name, (uint8_t*) got, sizeof(got), (uint8_t*) exp, sizeof(exp));
+      }
+    }
+  }
+}
+
 static void test_tuplehash128_xof(void) {
   static const struct {
     const char *name; // test name
@@ -6531,6 +11437,84 @@ static void test_parallelhash256_xof(void) {
   }
 }
 
+static void test_hmac_sha3_batch(void) {
+  // test message: 0, 1, 2, ...
+  uint8_t msg[1024] = { 0 };
+  for (size_t i = 0; i < sizeof(msg); i++) {
+    msg[i] = i & 0xff;
+  }
+
+  // one-shot and batch functions
+  static const struct {
+    const char *name; // test name
+    void (*once)(const uint8_t *, const size_t, const uint8_t *, const size_t, uint8_t *); // one-shot function
+    void (*batch)(const uint8_t *, const size_t, const uint8_t * const [], const size_t [], const size_t, uint8_t * const []); // batch function
+    _Bool (*verify)(const uint8_t *, const size_t, const uint8_t * const [], const size_t [], const size_t, const uint8_t * const [], _Bool []); // verify function
+    size_t len; // mac length
+  } FNS[] = {
+    { "hmac_sha3_224_batch", hmac_sha3_224, hmac_sha3_224_batch, hmac_sha3_224_batch_verify, 28 },
+    { "hmac_sha3_256_batch", hmac_sha3_256, hmac_sha3_256_batch, hmac_sha3_256_batch_verify, 32 },
+    { "hmac_sha3_384_batch", hmac_sha3_384, hmac_sha3_384_batch, hmac_sha3_384_batch_verify, 48 },
+    { "hmac_sha3_512_batch", hmac_sha3_512, hmac_sha3_512_batch, hmac_sha3_512_batch_verify, 64 },
+  };
+
+  // key lengths (short, and longer than every rate)
+  static const size_t KEY_LENS[] = { 7, 200 };
+
+  // 37 messages with a mix of lengths (more than one verify chunk)
+  static const size_t NUM_MSGS = 37;
+  const uint8_t *srcs[37];
+  size_t lens[37];
+  for (size_t i = 0; i < NUM_MSGS; i++) {
+    static const size_t LENS[] = { 0, 1, 71, 72, 73, 103, 104, 105, 135, 136, 137, 143, 144, 145, 500, 1000 };
+    srcs[i] = msg + (i % 7);
+    lens[i] = LENS[i % (sizeof(LENS) / sizeof(LENS[0]))];
+  }
+
+  for (size_t f = 0; f < sizeof(FNS) / sizeof(FNS[0]); f++) {
+    for (size_t k = 0; k < sizeof(KEY_LENS) / sizeof(KEY_LENS[0]); k++) {
+      const uint8_t * const key = msg + 3;
+      const size_t key_len = KEY_LENS[k];
+
+      // calculate expected results with one-shot function
+      uint8_t exp[37][64] = { 0 };
+      for (size_t i = 0; i < NUM_MSGS; i++) {
+        FNS[f].once(key, key_len, srcs[i], lens[i], exp[i]);
+      }
+
+      // calculate batch results
+      uint8_t got[37][64] = { 0 };
+      uint8_t *dsts[37];
+      for (size_t i = 0; i < NUM_MSGS; i++) {
+        dsts[i] = got[i];
+      }
+      FNS[f].batch(key, key_len, srcs, lens, NUM_MSGS, dsts);
+      if (memcmp(got, exp, sizeof(got))) {
+        fail_test(__func__, FNS[f].name, (uint8_t*) got, sizeof(got), (uint8_t*) exp, sizeof(exp));
+      }
+
+      // verify expected macs
+      const uint8_t *macs[37];
+      _Bool oks[37];
+      for (size_t i = 0; i < NUM_MSGS; i++) {
+        macs[i] = exp[i];
+      }
+      if (!FNS[f].verify(key, key_len, srcs, lens, NUM_MSGS, macs, oks)) {
+        fprintf(stderr, "%s: %s: verify failed\n", __func__, FNS[f].name);
+      }
+
+      // corrupt last byte of one mac, verify again
+      exp[33][FNS[f].len - 1] ^= 1;
+      const bool ok = FNS[f].verify(key, key_len, srcs, lens, NUM_MSGS, macs, oks);
+      for (size_t i = 0; i < NUM_MSGS; i++) {
+        if (ok || oks[i] != (i != 33)) {
+          fprintf(stderr, "%s: %s: verify of corrupt mac %zu: got %d, exp %d\n", __func__, FNS[f].name, i, oks[i], i != 33);
+        }
+      }
+    }
+  }
+}
+
 static void test_hmac_sha3_224(void) {
   static const struct {
     const char *name; // test name
@@ -7482,13 +12466,88 @@ static void test_turboshake256(void) {
       turboshake256_absorb(&ts, PATTERN, len);
     }
 
-    // squeeze
-    uint8_t got[64];
-    turboshake256_squeeze(&ts, got, sizeof(got));
+    // squeeze
+    uint8_t got[64];
+    turboshake256_squeeze(&ts, got, sizeof(got));
+
+    // check
+    if (memcmp(got, tests[i].exp, sizeof(got))) {
+      fail_test(__func__, tests[i].name, got, sizeof(got), tests[i].exp, sizeof(got));
+    }
+  }
+}
+
+static void test_turboshake128_keyed(void) {
+  // test data: 0, 1, 2, ...
+  uint8_t buf[512] = { 0 };
+  for (size_t i = 0; i < sizeof(buf); i++) {
+    buf[i] = i & 0xff;
+  }
+
+  static const size_t KEY_LENS[] = { 0, 16, 32, 200 };
+  static const size_t MSG_LENS[] = { 0, 1, 8, 100, 167, 168, 169, 400 };
+  static const size_t NUMS[] = { 1, 4, 21, 22, 50 };
+
+  for (size_t k = 0; k < sizeof(KEY_LENS) / sizeof(KEY_LENS[0]); k++) {
+    const uint8_t * const key_data = buf + 100;
+    const size_t key_len = KEY_LENS[k];
+
+    // build padded key: bytepad(encode_string(key), 168)
+    uint8_t prefix[2 * 168 + 512] = { 0 };
+    size_t prefix_len = 0;
+    {
+      uint8_t key_buf[9] = { 0 };
+      const size_t key_buf_len = encode_string_prefix(key_buf, key_len);
+      const bytepad_t bp = bytepad(key_buf_len + key_len, 168);
+      memcpy(prefix, bp.prefix, bp.prefix_len);
+      memcpy(prefix + bp.prefix_len, key_buf, key_buf_len);
+      memcpy(prefix + bp.prefix_len + key_buf_len, key_data, key_len);
+      prefix_len = bp.prefix_len + key_buf_len + key_len + bp.pad_len;
+    }
+
+    turboshake128_key_t key;
+    turboshake128_key_init(&key, key_data, key_len);
+
+    const uint8_t *srcs[8];
+    size_t lens[8];
+    uint64_t exp_x8[8] = { 0 };
+
+    for (size_t m = 0; m < sizeof(MSG_LENS) / sizeof(MSG_LENS[0]); m++) {
+      const size_t len = MSG_LENS[m];
+
+      // calculate expected output with turboshake128_custom()
+      uint8_t msg[2 * 168 + 512] = { 0 };
+      memcpy(msg, prefix, prefix_len);
+      memcpy(msg + prefix_len, buf + m, len);
+      uint64_t exp[50] = { 0 };
+      turboshake128_custom(0x0d, msg, prefix_len + len, (uint8_t*) exp, sizeof(exp));
+
+      // check single value
+      const uint64_t got = turboshake128_keyed_u64(&key, buf + m, len);
+      if (got != exp[0]) {
+        fail_test(__func__, "turboshake128_keyed_u64", (const uint8_t*) &got, 8, (uint8_t*) exp, 8);
+      }
+
+      // check several values
+      for (size_t i = 0; i < sizeof(NUMS) / sizeof(NUMS[0]); i++) {
+        uint64_t gots[51] = { 0 };
+        turboshake128_keyed_u64s(&key, buf + m, len, gots, NUMS[i]);
+        if (memcmp(gots, exp, 8 * NUMS[i]) || gots[NUMS[i]]) {
+          fail_test(__func__, "turboshake128_keyed_u64s", (uint8_t*) gots, 8 * (NUMS[i] + 1), (uint8_t*) exp, 8 * NUMS[i]);
+        }
+      }
 
-    // check
-    if (memcmp(got, tests[i].exp, sizeof(got))) {
-      fail_test(__func__, tests[i].name, got, sizeof(got), tests[i].exp, sizeof(got));
+      // save for eight-lane test
+      srcs[m] = buf + m;
+      lens[m] = len;
+      exp_x8[m] = exp[0];
+    }
+
+    // check eight messages
+    uint64_t got_x8[8] = { 0 };
+    turboshake128_keyed_u64_x8(&key, srcs, lens, got_x8);
+    if (memcmp(got_x8, exp_x8, sizeof(exp_x8))) {
+      fail_test(__func__, "turboshake128_keyed_u64_x8", (uint8_t*) got_x8, sizeof(got_x8), (uint8_t*) exp_x8, sizeof(exp_x8));
     }
   }
 }
@@ -7742,6 +12801,799 @@ static void test_k12(void) {
   }
 }
 
+// check kangarootwelve messages which span several whole leaves (hashed
+// together by k12_big_leaves()) against a reference built from
+// turboshake128_custom()
+//
+// the "whole" cases are regression tests for messages where S (message,
+// customization string, and encoded customization string length) is an
+// exact multiple of the 8192 byte block size.  k12_big_absorb_done()
+// used to count the first block as a leaf in this case.
+static void test_k12_leaves(void) {
+  static const struct {
+    const char *name; // test name
+    size_t len; // message length, in bytes
+    size_t custom_len; // customization string length, in bytes
+  } tests[] = {
+    { "1 whole leaf", 2 * K12_BLOCK_LEN - 1, 0 },
+    { "2 whole leaves", 3 * K12_BLOCK_LEN - 1, 0 },
+    { "2 whole leaves, custom", 3 * K12_BLOCK_LEN - 102, 100 },
+    { "2 leaves + tail", 3 * K12_BLOCK_LEN, 0 },
+    { "9 leaves + tail", 10 * K12_BLOCK_LEN + 5, 0 },
+    { "9 whole leaves", 10 * K12_BLOCK_LEN - 1, 0 },
+    { "16 leaves + tail, custom", 17 * K12_BLOCK_LEN - 3000, 5000 },
+  };
+
+  for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+    const size_t len = tests[i].len, custom_len = tests[i].custom_len;
+
+    // build S = M || C || length_encode(|C|)
+    uint8_t cl_buf[9] = { 0 };
+    const size_t cl_len = k12_length_encode(cl_buf, custom_len);
+    const size_t s_len = len + custom_len + cl_len;
+    uint8_t * const s = malloc(s_len);
+    for (size_t j = 0; j < len + custom_len; j++) {
+      s[j] = (j * 7 + (j >> 8)) & 0xff;
+    }
+    memcpy(s + len + custom_len, cl_buf, cl_len);
+
+    // build root input: S_0 || 0x03 0^7 || CV_1 .. CV_n || length_encode(n) || 0xff 0xff
+    const size_t num_leaves = (s_len - 1) / K12_BLOCK_LEN;
+    uint8_t * const root = malloc(K12_BLOCK_LEN + 8 + 32 * num_leaves + 9 + 2);
+    size_t root_len = 0;
+    memcpy(root, s, K12_BLOCK_LEN);
+    root_len += K12_BLOCK_LEN;
+    memcpy(root + root_len, "\x03\0\0\0\0\0\0\0", 8);
+    root_len += 8;
+    for (size_t j = 0; j < num_leaves; j++) {
+      const size_t ofs = (j + 1) * K12_BLOCK_LEN;
+      turboshake128_custom(K12_PAD_CHILD, s + ofs, MIN(s_len - ofs, K12_BLOCK_LEN), root + root_len, 32);
+      root_len += 32;
+    }
+    root_len += k12_length_encode(root + root_len, num_leaves);
+    root[root_len++] = 0xff;
+    root[root_len++] = 0xff;
+
+    uint8_t exp[32] = { 0 };
+    turboshake128_custom(K12_PAD_ROOT, root, root_len, exp, sizeof(exp));
+
+    uint8_t got[32] = { 0 };
+    k12_custom_once(s, len, s + len, custom_len, got, sizeof(got));
+
+    if (memcmp(got, exp, sizeof(got))) {
+      fail_test(__func__, tests[i].name, got, sizeof(got), exp, sizeof(exp));
+    }
+
+    free(root);
+    free(s);
+  }
+}
+
+static void test_sha3_mgr(void) {
+  // test message: 0, 1, 2, ...
+  uint8_t msg[1024] = { 0 };
+  for (size_t i = 0; i < sizeof(msg); i++) {
+    msg[i] = i & 0xff;
+  }
+
+  // algorithms (one of each rate and round count, plus an xof with an
+  // output longer than the rate)
+  static const sha3_algo_t algos[] = {
+    SHA3_ALGO_SHA3_224,
+    SHA3_ALGO_SHA3_512,
+    SHA3_ALGO_SHAKE128,
+    SHA3_ALGO_TURBOSHAKE256,
+  };
+
+  // job lengths (including 0, rate - 1, rate, and rate + 1)
+  static const size_t LENS[] = { 0, 1000, 71, 72, 73, 1, 143, 144, 145, 500, 167, 168, 169, 135, 136, 137 };
+  static const size_t NUM_JOBS = 37;
+
+  for (size_t i = 0; i < sizeof(algos) / sizeof(algos[0]); i++) {
+    // calculate expected results with multi-digest context
+    uint8_t exp[37][400] = { 0 };
+    for (size_t j = 0; j < NUM_JOBS; j++) {
+      sha3_multi_t ctx;
+      sha3_multi_init(&ctx, algos + i, 1);
+      sha3_multi_absorb(&ctx, msg + (j % 7), LENS[j % 16]);
+      sha3_multi_final(&ctx, 0, exp[j], 400);
+    }
+
+    // init job manager
+    sha3_mgr_t mgr;
+    if (!sha3_mgr_init(&mgr, algos[i], 0)) {
+      fprintf(stderr, "%s: sha3_mgr_init() failed\n", __func__);
+      continue;
+    }
+
+    // submit jobs, collect finished jobs
+    sha3_job_t jobs[37];
+    uint8_t got[37][400] = { 0 };
+    size_t counts[37] = { 0 };
+    for (size_t j = 0; j < NUM_JOBS; j++) {
+      jobs[j] = (sha3_job_t) {
+        .src = msg + (j % 7),
+        .len = LENS[j % 16],
+        .dst = got[j],
+        .dst_len = 400,
+        .user_data = counts + j,
+      };
+
+      const sha3_job_t *job = sha3_mgr_submit(&mgr, jobs + j);
+      if (job) {
+        (*((size_t*) job->user_data))++;
+      }
+    }
+
+    // flush remaining jobs
+    for (const sha3_job_t *job; (job = sha3_mgr_flush(&mgr)) != NULL;) {
+      (*((size_t*) job->user_data))++;
+    }
+
+    // check results
+    for (size_t j = 0; j < NUM_JOBS; j++) {
+      if (counts[j] != 1) {
+        fprintf(stderr, "%s: algo %zu, job %zu: returned %zu times\n", __func__, i, j, counts[j]);
+      }
+
+      if (memcmp(got[j], exp[j], 400)) {
+        fail_test(__func__, "sha3_mgr_submit", got[j], 400, exp[j], 400);
+      }
+    }
+  }
+
+  // check that a partially-filled batch runs after the maximum latency
+  {
+    sha3_mgr_t mgr;
+    sha3_mgr_init(&mgr, SHA3_ALGO_SHA3_256, 1000);
+
+    uint8_t got[32] = { 0 }, exp[32] = { 0 };
+    sha3_256(msg, 10, exp);
+    sha3_job_t job = { .src = msg, .len = 10, .dst = got };
+
+    // submit one job.  with a single lane (scalar backend) the job
+    // finishes immediately, otherwise wait for the deadline
+    const sha3_job_t *done = sha3_mgr_submit(&mgr, &job);
+    const uint64_t start = mgr_now();
+    while (!done && mgr_now() - start < 1000000) {
+      done = sha3_mgr_poll(&mgr);
+    }
+
+    if (done != &job || sha3_mgr_flush(&mgr)) {
+      fprintf(stderr, "%s: sha3_mgr_poll() did not return job\n", __func__);
+    } else if (memcmp(got, exp, sizeof(exp))) {
+      fail_test(__func__, "sha3_mgr_poll", got, sizeof(got), exp, sizeof(exp));
+    }
+  }
+}
+
+// hash prefix byte and input with multi-digest context (reference for
+// test_merkle())
+static void test_merkle_hash(const sha3_algo_t algo, const uint8_t prefix, const uint8_t *src, const size_t len, uint8_t dst[static 32]) {
+  sha3_multi_t ctx;
+  sha3_multi_init(&ctx, &algo, 1);
+  sha3_multi_absorb(&ctx, &prefix, 1);
+  sha3_multi_absorb(&ctx, src, len);
+  sha3_multi_final(&ctx, 0, dst, 32);
+}
+
+static void test_merkle(void) {
+  // test leaves: 0, 1, 2, ...
+  uint8_t data[256] = { 0 };
+  for (size_t i = 0; i < sizeof(data); i++) {
+    data[i] = i & 0xff;
+  }
+
+  static const sha3_algo_t algos[] = {
+    SHA3_ALGO_SHA3_256,
+    SHA3_ALGO_SHAKE128,
+    SHA3_ALGO_SHAKE256,
+    SHA3_ALGO_TURBOSHAKE128,
+    SHA3_ALGO_TURBOSHAKE256,
+  };
+
+  // leaf lengths (including 0, rate - 1, rate, and rate + 1)
+  static const size_t LENS[] = { 0, 1, 135, 136, 137, 167, 168, 169, 32, 200 };
+  #define MAX_LEAVES 70
+
+  const uint8_t *leaves[MAX_LEAVES];
+  size_t lens[MAX_LEAVES];
+  for (size_t i = 0; i < MAX_LEAVES; i++) {
+    leaves[i] = data + (i % 13);
+    lens[i] = LENS[i % 10];
+  }
+
+  for (size_t a = 0; a < sizeof(algos) / sizeof(algos[0]); a++) {
+    for (size_t n = 1; n <= MAX_LEAVES; n++) {
+      // calculate expected root level by level
+      uint8_t exp[MAX_LEAVES][32] = { 0 };
+      for (size_t i = 0; i < n; i++) {
+        test_merkle_hash(algos[a], 0x00, leaves[i], lens[i], exp[i]);
+      }
+      for (size_t m = n; m > 1; m = (m + 1) / 2) {
+        for (size_t i = 0; i < m / 2; i++) {
+          test_merkle_hash(algos[a], 0x01, exp[2 * i], 64, exp[i]);
+        }
+        if (m & 1) {
+          memcpy(exp[m / 2], exp[m - 1], 32);
+        }
+      }
+
+      // build tree
+      sha3_merkle_t tree;
+      uint8_t nodes[2 * MAX_LEAVES + SHA3_MERKLE_MAX_DEPTH][32];
+      if (!sha3_merkle_build(&tree, algos[a], leaves, lens, n, nodes[0])) {
+        fprintf(stderr, "%s: algo %zu, n %zu: sha3_merkle_build() failed\n", __func__, a, n);
+        continue;
+      }
+
+      // check root
+      const uint8_t * const root = sha3_merkle_root(&tree);
+      if (memcmp(root, exp[0], 32)) {
+        fail_test(__func__, "sha3_merkle_root", root, 32, exp[0], 32);
+      }
+
+      // get proofs
+      uint8_t proofs[MAX_LEAVES][SHA3_MERKLE_MAX_DEPTH][32];
+      const uint8_t *proof_ptrs[MAX_LEAVES];
+      size_t proof_lens[MAX_LEAVES], indices[MAX_LEAVES];
+      for (size_t i = 0; i < n; i++) {
+        indices[i] = i;
+        proof_ptrs[i] = proofs[i][0];
+        if (!sha3_merkle_proof(&tree, i, proofs[i][0], proof_lens + i)) {
+          fprintf(stderr, "%s: algo %zu, n %zu, leaf %zu: sha3_merkle_proof() failed\n", __func__, a, n, i);
+        }
+
+        // check each proof individually
+        if (!sha3_merkle_verify(algos[a], root, n, i, leaves[i], lens[i], proofs[i][0], proof_lens[i])) {
+          fprintf(stderr, "%s: algo %zu, n %zu, leaf %zu: sha3_merkle_verify() failed\n", __func__, a, n, i);
+        }
+
+        // check wrong leaf
+        if (sha3_merkle_verify(algos[a], root, n, i, data + 1, 10, proofs[i][0], proof_lens[i])) {
+          fprintf(stderr, "%s: algo %zu, n %zu, leaf %zu: sha3_merkle_verify() passed wrong leaf\n", __func__, a, n, i);
+        }
+
+        // check tampered proof
+        if (proof_lens[i] > 0) {
+          proofs[i][proof_lens[i] - 1][7] ^= 1;
+          if (sha3_merkle_verify(algos[a], root, n, i, leaves[i], lens[i], proofs[i][0], proof_lens[i])) {
+            fprintf(stderr, "%s: algo %zu, n %zu, leaf %zu: sha3_merkle_verify() passed tampered proof\n", __func__, a, n, i);
+          }
+          proofs[i][proof_lens[i] - 1][7] ^= 1;
+        }
+      }
+
+      // check all proofs as a batch
+      _Bool oks[MAX_LEAVES];
+      if (!sha3_merkle_verify_batch(algos[a], root, n, n, indices, leaves, lens, proof_ptrs, proof_lens, oks)) {
+        fprintf(stderr, "%s: algo %zu, n %zu: sha3_merkle_verify_batch() failed\n", __func__, a, n);
+      }
+
+      // check batch with every third non-empty leaf replaced, and
+      // with an out-of-range index
+      const uint8_t *bad_leaves[MAX_LEAVES];
+      for (size_t i = 0; i < n; i++) {
+        bad_leaves[i] = (i % 3 == 1) ? data + 50 : leaves[i];
+      }
+      indices[n - 1] = n;
+
+      sha3_merkle_verify_batch(algos[a], root, n, n, indices, bad_leaves, lens, proof_ptrs, proof_lens, oks);
+      for (size_t i = 0; i < n; i++) {
+        const bool exp_ok = (i % 3 != 1 || !lens[i]) && (i != n - 1);
+        if (oks[i] != exp_ok) {
+          fprintf(stderr, "%s: algo %zu, n %zu, leaf %zu: sha3_merkle_verify_batch(): got %d, exp %d\n", __func__, a, n, i, oks[i], exp_ok);
+        }
+      }
+    }
+  }
+
+  // check unsupported algorithm and empty tree
+  {
+    sha3_merkle_t tree;
+    uint8_t nodes[1][32];
+    if (sha3_merkle_build(&tree, SHA3_ALGO_SHA3_224, leaves, lens, 1, nodes[0]) || sha3_merkle_build(&tree, SHA3_ALGO_SHA3_256, leaves, lens, 0, nodes[0])) {
+      fprintf(stderr, "%s: sha3_merkle_build() accepted invalid parameters\n", __func__);
+    }
+  }
+
+  #undef MAX_LEAVES
+}
+
+// leaf callback for test_merkle_cb(): counts calls for each leaf
+typedef struct {
+  const uint8_t *data; // leaf data
+  size_t counts[40]; // number of calls for each leaf
+} test_merkle_cb_t;
+
+static void test_merkle_cb_get(void * const cb_data, const size_t i, const uint8_t ** const ptr, size_t * const len) {
+  test_merkle_cb_t * const t = cb_data;
+  t->counts[i]++;
+  *ptr = t->data + i;
+  *len = 3 * i;
+}
+
+static void test_merkle_cb(void) {
+  uint8_t data[256] = { 0 };
+  for (size_t i = 0; i < sizeof(data); i++) {
+    data[i] = i & 0xff;
+  }
+
+  // get expected root from leaf arrays
+  const uint8_t *leaves[40];
+  size_t lens[40];
+  for (size_t i = 0; i < 40; i++) {
+    leaves[i] = data + i;
+    lens[i] = 3 * i;
+  }
+  sha3_merkle_t exp_tree;
+  uint8_t exp_nodes[2 * 40 + SHA3_MERKLE_MAX_DEPTH][32];
+  sha3_merkle_build(&exp_tree, SHA3_ALGO_SHA3_256, leaves, lens, 40, exp_nodes[0]);
+
+  // build tree from callback
+  test_merkle_cb_t t = { .data = data };
+  sha3_merkle_t tree;
+  uint8_t nodes[2 * 40 + SHA3_MERKLE_MAX_DEPTH][32];
+  if (!sha3_merkle_build_cb(&tree, SHA3_ALGO_SHA3_256, test_merkle_cb_get, &t, 40, nodes[0])) {
+    fprintf(stderr, "%s: sha3_merkle_build_cb() failed\n", __func__);
+    return;
+  }
+
+  // check root
+  if (memcmp(sha3_merkle_root(&tree), sha3_merkle_root(&exp_tree), 32)) {
+    fail_test(__func__, "root", sha3_merkle_root(&tree), 32, sha3_merkle_root(&exp_tree), 32);
+  }
+
+  // check that callback was called once for each leaf
+  for (size_t i = 0; i < 40; i++) {
+    if (t.counts[i] != 1) {
+      fprintf(stderr, "%s: leaf %zu: callback failed: got %zu calls, exp 1\n", __func__, i, t.counts[i]);
+    }
+  }
+}
+
+static void test_sha3_multi(void) {
+  // algorithms (note: SHA3-256, SHAKE256, and TurboSHAKE256 have the
+  // same rate, and SHA3_ALGO_SHA3_256 is listed twice)
+  static const sha3_algo_t algos[] = {
+    SHA3_ALGO_SHA3_224,
+    SHA3_ALGO_SHA3_256,
+    SHA3_ALGO_SHA3_384,
+    SHA3_ALGO_SHA3_512,
+    SHA3_ALGO_SHAKE128,
+    SHA3_ALGO_SHAKE256,
+    SHA3_ALGO_TURBOSHAKE256,
+    SHA3_ALGO_SHA3_256,
+  };
+  static const size_t NUM_ALGOS = sizeof(algos) / sizeof(algos[0]);
+
+  // test message lengths and absorb chunk sizes
+  static const size_t lens[] = { 0, 1, 71, 72, 135, 136, 137, 168, 1000, 20000 };
+  static const size_t chunk_lens[] = { 1, 7, 136, 168, 8192, 20000 };
+
+  // build test message
+  uint8_t * const msg = malloc(20000);
+  if (!msg) {
+    fprintf(stderr, "%s: malloc() failed\n", __func__);
+    return;
+  }
+  for (size_t i = 0; i < 20000; i++) {
+    msg[i] = i & 0xff;
+  }
+
+  for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+    // calculate expected results with one-shot functions
+    uint8_t exp[8][200] = { 0 };
+    sha3_224(msg, lens[i], exp[0]);
+    sha3_256(msg, lens[i], exp[1]);
+    sha3_384(msg, lens[i], exp[2]);
+    sha3_512(msg, lens[i], exp[3]);
+    shake128(msg, lens[i], exp[4], 200);
+    shake256(msg, lens[i], exp[5], 200);
+    turboshake256(msg, lens[i], exp[6], 200);
+    sha3_256(msg, lens[i], exp[7]);
+
+    for (size_t j = 0; j < sizeof(chunk_lens) / sizeof(chunk_lens[0]); j++) {
+      // init context
+      sha3_multi_t ctx;
+      if (!sha3_multi_init(&ctx, algos, NUM_ALGOS)) {
+        fprintf(stderr, "%s: sha3_multi_init() failed\n", __func__);
+        continue;
+      }
+
+      // absorb
+      for (size_t k = 0; k < lens[i]; k += chunk_lens[j]) {
+        sha3_multi_absorb(&ctx, msg + k, MIN(lens[i] - k, chunk_lens[j]));
+      }
+
+      // check each algorithm (in reverse order)
+      for (size_t k = NUM_ALGOS; k > 0; k--) {
+        uint8_t got[200] = { 0 };
+        sha3_multi_final(&ctx, k - 1, got, sizeof(got));
+
+        if (memcmp(got, exp[k - 1], sizeof(got))) {
+          char name[64];
+          snprintf(name, sizeof(name), "len=%zu chunk_len=%zu algo=%zu", lens[i], chunk_lens[j], k - 1);
+          fail_test(__func__, name, got, sizeof(got), exp[k - 1], sizeof(got));
+        }
+      }
+
+      // check absorb after final
+      if (sha3_multi_absorb(&ctx, msg, 1)) {
+        fprintf(stderr, "%s: sha3_multi_absorb() succeeded after final\n", __func__);
+      }
+    }
+  }
+
+  free(msg);
+
+  // check invalid parameters
+  {
+    sha3_multi_t ctx;
+    const sha3_algo_t bad_algo[] = { SHA3_ALGO_LAST };
+    if (sha3_multi_init(&ctx, algos, 0)) {
+      fprintf(stderr, "%s: sha3_multi_init() succeeded with zero algorithms\n", __func__);
+    }
+    if (sha3_multi_init(&ctx, bad_algo, 1)) {
+      fprintf(stderr, "%s: sha3_multi_init() succeeded with invalid algorithm\n", __func__);
+    }
+
+    uint8_t got[32] = { 0 };
+    if (!sha3_multi_init(&ctx, algos, 1) || sha3_multi_final(&ctx, 1, got, sizeof(got))) {
+      fprintf(stderr, "%s: sha3_multi_final() succeeded with invalid offset\n", __func__);
+    }
+  }
+}
+
+static void test_avx512_ymm(void) {
+  // get test data
+  uint8_t buf[1024] = { 0 };
+  for (size_t i = 0; i < sizeof(buf); i++) {
+    buf[i] = i & 0xff;
+  }
+
+  // batch of 9 inputs (one full avx512 multi-buffer group plus one)
+  const uint8_t *srcs[9] = { 0 };
+  size_t lens[9] = { 0 };
+  for (size_t i = 0; i < 9; i++) {
+    srcs[i] = buf + i;
+    lens[i] = sizeof(buf) - 17 * i;
+  }
+
+  // get expected results with default permutation
+  uint8_t exp_hash[32] = { 0 }, exp_ts[64] = { 0 }, exp_batch[9][32] = { 0 };
+  uint8_t *exp_dsts[9] = { 0 };
+  for (size_t i = 0; i < 9; i++) {
+    exp_dsts[i] = exp_batch[i];
+  }
+  sha3_256(buf, sizeof(buf), exp_hash);
+  turboshake128(buf, sizeof(buf), exp_ts, sizeof(exp_ts));
+  sha3_256_batch(srcs, lens, 9, exp_dsts);
+
+  // enable 256-bit permutation
+#ifdef AVX512_YMM
+  const _Bool exp_ok = true;
+#else
+  const _Bool exp_ok = false;
+#endif /* AVX512_YMM */
+  const _Bool got_ok = sha3_avx512_ymm(true);
+  if (got_ok != exp_ok) {
+    fail_test(__func__, "ok", (uint8_t*) &got_ok, 1, (uint8_t*) &exp_ok, 1);
+  }
+#ifdef AVX512_YMM
+  if (strcmp(sha3_backend(), "avx512-ymm")) {
+    const char *exp = "avx512-ymm", *got = sha3_backend();
+    fail_test(__func__, "backend", (uint8_t*) got, strlen(got), (uint8_t*) exp, strlen(exp));
+  }
+#endif /* AVX512_YMM */
+
+  // get results with 256-bit permutation
+  uint8_t got_hash[32] = { 0 }, got_ts[64] = { 0 }, got_batch[9][32] = { 0 };
+  uint8_t *got_dsts[9] = { 0 };
+  for (size_t i = 0; i < 9; i++) {
+    got_dsts[i] = got_batch[i];
+  }
+  sha3_256(buf, sizeof(buf), got_hash);
+  turboshake128(buf, sizeof(buf), got_ts, sizeof(got_ts));
+  sha3_256_batch(srcs, lens, 9, got_dsts);
+
+  // restore default permutation
+  sha3_avx512_ymm(false);
+
+  // compare results
+  if (memcmp(got_hash, exp_hash, sizeof(got_hash))) {
+    fail_test(__func__, "sha3-256", got_hash, sizeof(got_hash), exp_hash, sizeof(exp_hash));
+  }
+  if (memcmp(got_ts, exp_ts, sizeof(got_ts))) {
+    fail_test(__func__, "turboshake128", got_ts, sizeof(got_ts), exp_ts, sizeof(exp_ts));
+  }
+  if (memcmp(got_batch, exp_batch, sizeof(got_batch))) {
+    fail_test(__func__, "sha3-256 batch", (uint8_t*) got_batch, sizeof(got_batch), (uint8_t*) exp_batch, sizeof(exp_batch));
+  }
+}
+
+static void test_sha3_batch_lanes(void) {
+#if BACKEND == BACKEND_AVX512
+  size_t exp = 8;
+#elif BACKEND == BACKEND_AVX2
+  size_t exp = 4;
+#elif (BACKEND == BACKEND_SCALAR_X2) || (BACKEND == BACKEND_NEON_SHA3)
+  size_t exp = 2;
+#else
+  size_t exp = 1;
+#endif /* BACKEND */
+#if defined(MB_HYBRID) && ((BACKEND == BACKEND_AVX512) || (BACKEND == BACKEND_AVX2))
+  exp++; // extra scalar lane
+#endif /* MB_HYBRID */
+
+  const size_t got = sha3_batch_lanes();
+  if (got != exp) {
+    fprintf(stderr, "%s() failed: got %zu, exp %zu\n", __func__, got, exp);
+  }
+
+#ifdef AVX512_YMM
+  // check 4-way ymm multi-buffer kernel
+  sha3_avx512_ymm(true);
+  const size_t got_ymm = sha3_batch_lanes();
+  sha3_avx512_ymm(false);
+  if (got_ymm != 4) {
+    fprintf(stderr, "%s() failed: got %zu, exp 4 (ymm)\n", __func__, got_ymm);
+  }
+#endif /* AVX512_YMM */
+}
+
+static void test_keccak_p1600(void) {
+  // get test state
+  uint64_t src[25] = { 0 };
+  for (size_t i = 0; i < 25; i++) {
+    src[i] = 0x0123456789abcdefULL * (i + 1);
+  }
+
+  // test with default permutation, then with 256-bit avx512
+  // permutation (if supported)
+  for (size_t m = 0; m < 2; m++) {
+    sha3_avx512_ymm(m == 1);
+
+    for (unsigned num_rounds = 0; num_rounds <= 24; num_rounds++) {
+      // get expected result from step functions
+      uint64_t exp[25] = { 0 }, tmp[25] = { 0 };
+      memcpy(exp, src, sizeof(exp));
+      for (size_t i = 24 - num_rounds; i < 24; i++) {
+        theta(exp);
+        rho(exp);
+        pi(tmp, exp);
+        chi(exp, tmp);
+        iota(exp, i);
+      }
+
+      uint64_t got[25] = { 0 };
+      memcpy(got, src, sizeof(got));
+      if (!keccak_p1600(got, num_rounds)) {
+        fprintf(stderr, "%s: keccak_p1600(%u) failed\n", __func__, num_rounds);
+      }
+
+      if (memcmp(got, exp, sizeof(got))) {
+        char name[32];
+        snprintf(name, sizeof(name), "%zu/%u", m, num_rounds);
+        fail_test(__func__, name, (uint8_t*) got, sizeof(got), (uint8_t*) exp, sizeof(exp));
+      }
+    }
+  }
+
+  // restore default permutation
+  sha3_avx512_ymm(false);
+
+  // check invalid number of rounds
+  uint64_t got[25] = { 0 };
+  memcpy(got, src, sizeof(got));
+  if (keccak_p1600(got, 25)) {
+    fprintf(stderr, "%s: keccak_p1600(25) succeeded\n", __func__);
+  }
+  if (memcmp(got, src, sizeof(got))) {
+    fail_test(__func__, "25", (uint8_t*) got, sizeof(got), (uint8_t*) src, sizeof(src));
+  }
+}
+
+static void test_sha3_sponge(void) {
+  // get test data
+  uint8_t buf[1024] = { 0 };
+  for (size_t i = 0; i < sizeof(buf); i++) {
+    buf[i] = i & 0xff;
+  }
+
+  static const struct {
+    const char *name; // test name
+    size_t rate; // rate, in bytes
+    unsigned num_rounds; // number of rounds
+    uint8_t pad; // padding byte
+    void (*xof)(const uint8_t *, const size_t, uint8_t *, const size_t); // expected XOF
+  } tests[] = {
+    { "shake128", 168, 24, 0x1f, shake128 },
+    { "shake256", 136, 24, 0x1f, shake256 },
+    { "turboshake128", 168, 12, 0x1f, turboshake128 },
+    { "turboshake256", 136, 12, 0x1f, turboshake256 },
+  };
+
+  for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+    uint8_t exp[400] = { 0 };
+    tests[i].xof(buf, sizeof(buf), exp, sizeof(exp));
+
+    // absorb and squeeze in uneven chunks
+    sha3_sponge_t sponge;
+    if (!sha3_sponge_init(&sponge, tests[i].rate, tests[i].num_rounds, tests[i].pad)) {
+      fprintf(stderr, "%s: sha3_sponge_init(%s) failed\n", __func__, tests[i].name);
+    }
+    for (size_t ofs = 0, len = 1; ofs < sizeof(buf); ofs += len, len = 3 * len + 1) {
+      if (!sha3_sponge_absorb(&sponge, buf + ofs, MIN(len, sizeof(buf) - ofs))) {
+        fprintf(stderr, "%s: sha3_sponge_absorb(%s) failed\n", __func__, tests[i].name);
+      }
+    }
+
+    uint8_t got[400] = { 0 };
+    for (size_t ofs = 0, len = 1; ofs < sizeof(got); ofs += len, len = 3 * len + 1) {
+      if (!sha3_sponge_squeeze(&sponge, got + ofs, MIN(len, sizeof(got) - ofs))) {
+        fprintf(stderr, "%s: sha3_sponge_squeeze(%s) failed\n", __func__, tests[i].name);
+      }
+    }
+
+    if (memcmp(got, exp, sizeof(got))) {
+      fail_test(__func__, tests[i].name, got, sizeof(got), exp, sizeof(exp));
+    }
+
+    // check absorb after squeeze
+    if (sha3_sponge_absorb(&sponge, buf, 1)) {
+      fprintf(stderr, "%s: sha3_sponge_absorb(%s) succeeded after squeeze\n", __func__, tests[i].name);
+    }
+  }
+
+  // check sha3-256
+  {
+    uint8_t exp[32] = { 0 }, got[32] = { 0 };
+    sha3_256(buf, sizeof(buf), exp);
+
+    sha3_sponge_t sponge;
+    sha3_sponge_init(&sponge, 136, 24, 0x06);
+    sha3_sponge_absorb(&sponge, buf, sizeof(buf));
+    sha3_sponge_squeeze(&sponge, got, sizeof(got));
+
+    if (memcmp(got, exp, sizeof(got))) {
+      fail_test(__func__, "sha3-256", got, sizeof(got), exp, sizeof(exp));
+    }
+  }
+
+  // check invalid parameters
+  static const struct {
+    size_t rate; // rate, in bytes
+    unsigned num_rounds; // number of rounds
+    uint8_t pad; // padding byte
+  } bad[] = {
+    { 0, 24, 0x1f },
+    { 200, 24, 0x1f },
+    { 168, 0, 0x1f },
+    { 168, 25, 0x1f },
+    { 168, 24, 0x00 },
+    { 168, 24, 0x80 },
+  };
+
+  for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+    sha3_sponge_t sponge;
+    if (sha3_sponge_init(&sponge, bad[i].rate, bad[i].num_rounds, bad[i].pad)) {
+      fprintf(stderr, "%s: sha3_sponge_init() succeeded with invalid parameters %zu\n", __func__, i);
+    }
+  }
+}
+
+static void test_sha3_sponge_duplex(void) {
+  // first duplex call on empty state is the same as a single-block XOF
+  {
+    uint8_t exp[32] = { 0 }, got[32] = { 0 };
+    turboshake128((const uint8_t*) "abc", 3, exp, sizeof(exp));
+
+    sha3_sponge_t sponge;
+    sha3_sponge_init(&sponge, 168, 12, 0x1f);
+    if (!sha3_sponge_duplex(&sponge, (const uint8_t*) "abc", 3, got, sizeof(got))) {
+      fprintf(stderr, "%s: sha3_sponge_duplex() failed\n", __func__);
+    }
+
+    if (memcmp(got, exp, sizeof(got))) {
+      fail_test(__func__, "turboshake128", got, sizeof(got), exp, sizeof(exp));
+    }
+  }
+
+  // check sequence of duplex calls against keccak_p1600()
+  {
+    static const size_t RATE = 100;
+    static const unsigned NUM_ROUNDS = 7;
+    static const uint8_t PAD = 0x0b;
+
+    sha3_sponge_t sponge;
+    sha3_sponge_init(&sponge, RATE, NUM_ROUNDS, PAD);
+    sha3_state_t exp_state = { 0 };
+
+    for (size_t i = 0; i < 5; i++) {
+      // get input block
+      uint8_t src[99] = { 0 };
+      const size_t src_len = (37 * i) % sizeof(src);
+      for (size_t j = 0; j < src_len; j++) {
+        src[j] = (i << 4) + j;
+      }
+
+      // get expected output
+      for (size_t j = 0; j < src_len; j++) {
+        exp_state.u8[j] ^= src[j];
+      }
+      exp_state.u8[src_len] ^= PAD;
+      exp_state.u8[RATE - 1] ^= 0x80;
+      keccak_p1600(exp_state.u64, NUM_ROUNDS);
+
+      uint8_t got[100] = { 0 };
+      const size_t dst_len = (53 * i + 1) % (sizeof(got) + 1);
+      if (!sha3_sponge_duplex(&sponge, src, src_len, got, dst_len)) {
+        fprintf(stderr, "%s: sha3_sponge_duplex() failed\n", __func__);
+      }
+
+      if (memcmp(got, exp_state.u8, dst_len)) {
+        fail_test(__func__, "sequence", got, dst_len, exp_state.u8, dst_len);
+      }
+    }
+  }
+
+  // check invalid lengths and mode
+  {
+    uint8_t buf[169] = { 0 };
+    sha3_sponge_t sponge;
+    sha3_sponge_init(&sponge, 168, 24, 0x1f);
+
+    if (sha3_sponge_duplex(&sponge, buf, 168, buf, 0)) {
+      fprintf(stderr, "%s: sha3_sponge_duplex() succeeded with src_len == rate\n", __func__);
+    }
+    if (sha3_sponge_duplex(&sponge, buf, 0, buf, 169)) {
+      fprintf(stderr, "%s: sha3_sponge_duplex() succeeded with dst_len > rate\n", __func__);
+    }
+
+    sha3_sponge_absorb(&sponge, buf, 1);
+    if (sha3_sponge_duplex(&sponge, buf, 0, buf, 0)) {
+      fprintf(stderr, "%s: sha3_sponge_duplex() succeeded after absorb\n", __func__);
+    }
+  }
+
+  // check duplex after absorbing exactly `rate` bytes (regression test:
+  // the absorbed byte count wraps to zero, so it can not be used to
+  // detect absorb/duplex misuse)
+  {
+    uint8_t buf[168] = { 0 };
+    sha3_sponge_t sponge;
+    sha3_sponge_init(&sponge, 168, 24, 0x1f);
+
+    sha3_sponge_absorb(&sponge, buf, sizeof(buf));
+    if (sha3_sponge_duplex(&sponge, buf, 0, buf, 0)) {
+      fprintf(stderr, "%s: sha3_sponge_duplex() succeeded after absorbing rate bytes\n", __func__);
+    }
+  }
+
+  // check absorb and squeeze after duplex
+  {
+    uint8_t buf[16] = { 0 };
+    sha3_sponge_t sponge;
+    sha3_sponge_init(&sponge, 168, 24, 0x1f);
+
+    if (!sha3_sponge_duplex(&sponge, buf, 0, buf, 0)) {
+      fprintf(stderr, "%s: sha3_sponge_duplex() failed\n", __func__);
+    }
+    if (sha3_sponge_absorb(&sponge, buf, sizeof(buf))) {
+      fprintf(stderr, "%s: sha3_sponge_absorb() succeeded after duplex\n", __func__);
+    }
+    if (sha3_sponge_squeeze(&sponge, buf, sizeof(buf))) {
+      fprintf(stderr, "%s: sha3_sponge_squeeze() succeeded after duplex\n", __func__);
+    }
+
+    // check that the failed calls did not change the mode
+    if (!sha3_sponge_duplex(&sponge, buf, 0, buf, 0)) {
+      fprintf(stderr, "%s: sha3_sponge_duplex() failed after rejected absorb/squeeze\n", __func__);
+    }
+  }
+}
+
 int main(void) {
   test_theta();
   test_rho();
@@ -7749,15 +13601,27 @@ int main(void) {
   test_chi();
   test_iota();
   test_permute_24_scalar();
+  test_permute_24_lcomp();
+  test_permute_24_bi32();
   test_permute_24_avx512();
+  test_permute_24_avx512vl();
   test_permute_24_neon();
+  test_permute_24_neon_sha3();
   test_permute_24_diet_neon();
   test_permute_24_hybrid();
   test_permute_12_scalar();
+  test_permute_12_lcomp();
+  test_permute_12_bi32();
   test_permute_12_avx512();
+  test_permute_12_avx512vl();
   test_permute_12_neon();
+  test_permute_12_neon_sha3();
   test_permute_12_diet_neon();
   test_permute_12_hybrid();
+  test_permute_x2();
+  test_permute_avx512_x2();
+  test_permute_neon_sha3_x2();
+  test_permute_batch();
   test_sha3_224();
   test_sha3_256();
   test_sha3_384();
@@ -7770,6 +13634,13 @@ int main(void) {
   test_shake128();
   test_shake256_ctx();
   test_shake256();
+  test_shake_blocks();
+  test_once_short();
+  test_hash_batch();
+  test_sha3_x4();
+  test_sha3_256_fixed();
+  test_hash_chain();
+  test_shake128_sample();
   test_left_encode();
   test_right_encode();
   test_encode_string_prefix();
@@ -7780,10 +13651,12 @@ int main(void) {
   test_kmac256();
   test_kmac128_xof();
   test_kmac256_xof();
+  test_kmac_batch();
   test_tuplehash128();
   test_tuplehash256();
   test_tuplehash128_xof();
   test_tuplehash256_xof();
+  test_tuplehash_batch();
   test_parallelhash128();
   test_parallelhash128_xof();
   test_parallelhash256();
@@ -7796,10 +13669,22 @@ int main(void) {
   test_hmac_sha3_256_ctx();
   test_hmac_sha3_384_ctx();
   test_hmac_sha3_512_ctx();
+  test_hmac_sha3_batch();
   test_turboshake128();
   test_turboshake256();
+  test_turboshake128_keyed();
   test_k12_length_encode();
   test_k12();
+  test_k12_leaves();
+  test_sha3_multi();
+  test_sha3_mgr();
+  test_merkle();
+  test_merkle_cb();
+  test_avx512_ymm();
+  test_sha3_batch_lanes();
+  test_keccak_p1600();
+  test_sha3_sponge();
+  test_sha3_sponge_duplex();
   printf("ok (%s)\n", sha3_backend());
 }
 
@@ -22,6 +22,9 @@
  * - ParallelHash128, ParallelHash128-XOF, ParallelHash256, and ParallelHash256-XOF
  * - TurboSHAKE128 and TurboSHAKE256
  * - KangarooTwelve
+ *
+ * Also includes a multi-digest API which calculates several of the
+ * functions above over the same input in a single pass.
  */
 #ifndef SHA3_H
 #define SHA3_H
@@ -322,6 +325,466 @@ _Bool sha3_512_absorb(sha3_t *hash, const uint8_t *src, const size_t len);
  */
 void sha3_512_final(sha3_t *hash, uint8_t dst[64]);
 
+/**
+ * @brief Calculate SHA3-224 hashes of a batch of messages.
+ * @ingroup sha3
+ *
+ * Hash `n` messages, where message `i` is `lens[i]` bytes from
+ * `srcs[i]`, and write the 28 byte SHA3-224 hash of message `i` to
+ * `dsts[i]`.
+ *
+ * Messages are hashed in parallel with the multi-buffer permutation
+ * when the backend supports it (see `sha3_backend()`), and each lane
+ * is refilled with the next message as soon as its current message
+ * is finished, so messages of different lengths can be mixed freely.
+ *
+ * @param[in] srcs Array of `n` source buffers.
+ * @param[in] lens Array of `n` source buffer lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[out] dsts Array of `n` 28 byte destination buffers.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_224_batch
+ */
+void sha3_224_batch(const uint8_t * const srcs[], const size_t lens[], const size_t n, uint8_t * const dsts[]);
+
+/**
+ * @brief Calculate SHA3-256 hashes of a batch of messages.
+ * @ingroup sha3
+ *
+ * Hash `n` messages, where message `i` is `lens[i]` bytes from
+ * `srcs[i]`, and write the 32 byte SHA3-256 hash of message `i` to
+ * `dsts[i]`.
+ *
+ * Messages are hashed in parallel with the multi-buffer permutation
+ * when the backend supports it (see `sha3_backend()`), and each lane
+ * is refilled with the next message as soon as its current message
+ * is finished, so messages of different lengths can be mixed freely.
+ *
+ * @param[in] srcs Array of `n` source buffers.
+ * @param[in] lens Array of `n` source buffer lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[out] dsts Array of `n` 32 byte destination buffers.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_256_batch
+ */
+void sha3_256_batch(const uint8_t * const srcs[], const size_t lens[], const size_t n, uint8_t * const dsts[]);
+
+/**
+ * @brief Calculate SHA3-384 hashes of a batch of messages.
+ * @ingroup sha3
+ *
+ * Hash `n` messages, where message `i` is `lens[i]` bytes from
+ * `srcs[i]`, and write the 48 byte SHA3-384 hash of message `i` to
+ * `dsts[i]`.
+ *
+ * Messages are hashed in parallel with the multi-buffer permutation
+ * when the backend supports it (see `sha3_backend()`), and each lane
+ * is refilled with the next message as soon as its current message
+ * is finished, so messages of different lengths can be mixed freely.
+ *
+ * @param[in] srcs Array of `n` source buffers.
+ * @param[in] lens Array of `n` source buffer lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[out] dsts Array of `n` 48 byte destination buffers.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_384_batch
+ */
+void sha3_384_batch(const uint8_t * const srcs[], const size_t lens[], const size_t n, uint8_t * const dsts[]);
+
+/**
+ * @brief Calculate SHA3-512 hashes of a batch of messages.
+ * @ingroup sha3
+ *
+ * Hash `n` messages, where message `i` is `lens[i]` bytes from
+ * `srcs[i]`, and write the 64 byte SHA3-512 hash of message `i` to
+ * `dsts[i]`.
+ *
+ * Messages are hashed in parallel with the multi-buffer permutation
+ * when the backend supports it (see `sha3_backend()`), and each lane
+ * is refilled with the next message as soon as its current message
+ * is finished, so messages of different lengths can be mixed freely.
+ *
+ * @param[in] srcs Array of `n` source buffers.
+ * @param[in] lens Array of `n` source buffer lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[out] dsts Array of `n` 64 byte destination buffers.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_512_batch
+ */
+void sha3_512_batch(const uint8_t * const srcs[], const size_t lens[], const size_t n, uint8_t * const dsts[]);
+
+/**
+ * @brief Four-lane iterative [SHA-3][] context (all members are
+ * private).
+ * @ingroup sha3
+ *
+ * Hashes four independent messages which arrive in chunks (for example,
+ * four parallel network streams).
+ *
+ * [SHA-3]: https://en.wikipedia.org/wiki/SHA-3
+ *   "Secure Hash Algorithm 3"
+ */
+typedef struct {
+  sha3_state_t a[4]; /**< internal states */
+  size_t num_bytes[4]; /**< number of bytes absorbed into current block of each state */
+  _Bool finalized; /**< mode (absorbing or finalized) */
+} sha3_x4_t;
+
+/**
+ * @brief Initialize four-lane SHA3-224 hash context.
+ * @ingroup sha3
+ *
+ * @param[out] ctx Four-lane SHA3-224 hash context.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_224_x4
+ */
+void sha3_224_x4_init(sha3_x4_t *ctx);
+
+/**
+ * @brief Absorb chunks of data into four-lane SHA3-224 hash context.
+ * @ingroup sha3
+ *
+ * Absorb `lens[i]` bytes of input data from `srcs[i]` into lane `i` of
+ * four-lane SHA3-224 hash context `ctx`.  Can be called iteratively to
+ * absorb input data in chunks, and chunks may have different lengths
+ * (including zero).
+ *
+ * Lanes with a full block are permuted together with the multi-buffer
+ * permutation when the backend supports it (see `sha3_backend()`), so
+ * absorbing chunks of the same length into every lane is fastest.
+ *
+ * @param[in,out] ctx Four-lane SHA3-224 hash context.
+ * @param[in] srcs Array of 4 source buffers.
+ * @param[in] lens Array of 4 source buffer lengths, in bytes.
+ *
+ * @return True if data was absorbed, and false otherwise (e.g., if context has already been finalized).
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_224_x4
+ */
+_Bool sha3_224_x4_absorb(sha3_x4_t *ctx, const uint8_t * const srcs[4], const size_t lens[4]);
+
+/**
+ * @brief Finalize four-lane SHA3-224 hash context and write 28 bytes
+ * of output from lane `i` to destination buffer `dsts[i]`.
+ * @ingroup sha3
+ *
+ * @param[in,out] ctx Four-lane SHA3-224 hash context.
+ * @param[out] dsts Array of 4 destination buffers.  Each must be at least 28 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_224_x4
+ */
+void sha3_224_x4_final(sha3_x4_t *ctx, uint8_t * const dsts[4]);
+
+/**
+ * @brief Initialize four-lane SHA3-256 hash context.
+ * @ingroup sha3
+ *
+ * @param[out] ctx Four-lane SHA3-256 hash context.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_256_x4
+ */
+void sha3_256_x4_init(sha3_x4_t *ctx);
+
+/**
+ * @brief Absorb chunks of data into four-lane SHA3-256 hash context.
+ * @ingroup sha3
+ *
+ * Absorb `lens[i]` bytes of input data from `srcs[i]` into lane `i` of
+ * four-lane SHA3-256 hash context `ctx`.  Can be called iteratively to
+ * absorb input data in chunks, and chunks may have different lengths
+ * (including zero).
+ *
+ * Lanes with a full block are permuted together with the multi-buffer
+ * permutation when the backend supports it (see `sha3_backend()`), so
+ * absorbing chunks of the same length into every lane is fastest.
+ *
+ * @param[in,out] ctx Four-lane SHA3-256 hash context.
+ * @param[in] srcs Array of 4 source buffers.
+ * @param[in] lens Array of 4 source buffer lengths, in bytes.
+ *
+ * @return True if data was absorbed, and false otherwise (e.g., if context has already been finalized).
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_256_x4
+ */
+_Bool sha3_256_x4_absorb(sha3_x4_t *ctx, const uint8_t * const srcs[4], const size_t lens[4]);
+
+/**
+ * @brief Finalize four-lane SHA3-256 hash context and write 32 bytes
+ * of output from lane `i` to destination buffer `dsts[i]`.
+ * @ingroup sha3
+ *
+ * @param[in,out] ctx Four-lane SHA3-256 hash context.
+ * @param[out] dsts Array of 4 destination buffers.  Each must be at least 32 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_256_x4
+ */
+void sha3_256_x4_final(sha3_x4_t *ctx, uint8_t * const dsts[4]);
+
+/**
+ * @brief Initialize four-lane SHA3-384 hash context.
+ * @ingroup sha3
+ *
+ * @param[out] ctx Four-lane SHA3-384 hash context.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_384_x4
+ */
+void sha3_384_x4_init(sha3_x4_t *ctx);
+
+/**
+ * @brief Absorb chunks of data into four-lane SHA3-384 hash context.
+ * @ingroup sha3
+ *
+ * Absorb `lens[i]` bytes of input data from `srcs[i]` into lane `i` of
+ * four-lane SHA3-384 hash context `ctx`.  Can be called iteratively to
+ * absorb input data in chunks, and chunks may have different lengths
+ * (including zero).
+ *
+ * Lanes with a full block are permuted together with the multi-buffer
+ * permutation when the backend supports it (see `sha3_backend()`), so
+ * absorbing chunks of the same length into every lane is fastest.
+ *
+ * @param[in,out] ctx Four-lane SHA3-384 hash context.
+ * @param[in] srcs Array of 4 source buffers.
+ * @param[in] lens Array of 4 source buffer lengths, in bytes.
+ *
+ * @return True if data was absorbed, and false otherwise (e.g., if context has already been finalized).
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_384_x4
+ */
+_Bool sha3_384_x4_absorb(sha3_x4_t *ctx, const uint8_t * const srcs[4], const size_t lens[4]);
+
+/**
+ * @brief Finalize four-lane SHA3-384 hash context and write 48 bytes
+ * of output from lane `i` to destination buffer `dsts[i]`.
+ * @ingroup sha3
+ *
+ * @param[in,out] ctx Four-lane SHA3-384 hash context.
+ * @param[out] dsts Array of 4 destination buffers.  Each must be at least 48 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_384_x4
+ */
+void sha3_384_x4_final(sha3_x4_t *ctx, uint8_t * const dsts[4]);
+
+/**
+ * @brief Initialize four-lane SHA3-512 hash context.
+ * @ingroup sha3
+ *
+ * @param[out] ctx Four-lane SHA3-512 hash context.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_512_x4
+ */
+void sha3_512_x4_init(sha3_x4_t *ctx);
+
+/**
+ * @brief Absorb chunks of data into four-lane SHA3-512 hash context.
+ * @ingroup sha3
+ *
+ * Absorb `lens[i]` bytes of input data from `srcs[i]` into lane `i` of
+ * four-lane SHA3-512 hash context `ctx`.  Can be called iteratively to
+ * absorb input data in chunks, and chunks may have different lengths
+ * (including zero).
+ *
+ * Lanes with a full block are permuted together with the multi-buffer
+ * permutation when the backend supports it (see `sha3_backend()`), so
+ * absorbing chunks of the same length into every lane is fastest.
+ *
+ * @param[in,out] ctx Four-lane SHA3-512 hash context.
+ * @param[in] srcs Array of 4 source buffers.
+ * @param[in] lens Array of 4 source buffer lengths, in bytes.
+ *
+ * @return True if data was absorbed, and false otherwise (e.g., if context has already been finalized).
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_512_x4
+ */
+_Bool sha3_512_x4_absorb(sha3_x4_t *ctx, const uint8_t * const srcs[4], const size_t lens[4]);
+
+/**
+ * @brief Finalize four-lane SHA3-512 hash context and write 64 bytes
+ * of output from lane `i` to destination buffer `dsts[i]`.
+ * @ingroup sha3
+ *
+ * @param[in,out] ctx Four-lane SHA3-512 hash context.
+ * @param[out] dsts Array of 4 destination buffers.  Each must be at least 64 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_512_x4
+ */
+void sha3_512_x4_final(sha3_x4_t *ctx, uint8_t * const dsts[4]);
+
+/**
+ * @brief Calculate SHA3-256 hash of 32 byte input message.
+ * @ingroup sha3
+ *
+ * Hash 32 byte input message in buffer `src` and write 32 byte
+ * SHA3-256 hash to buffer `dst`.  Produces the same result as
+ * `sha3_256(src, 32, dst)`, but loads the message directly into the
+ * state and applies the padding as constants.
+ *
+ * @param[in] src Input message (32 bytes).
+ * @param[out] dst Destination buffer.  Must be at least 32 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_256_32
+ */
+void sha3_256_32(const uint8_t src[static 32], uint8_t dst[static 32]);
+
+/**
+ * @brief Calculate SHA3-256 hashes of four 32 byte input messages.
+ * @ingroup sha3
+ *
+ * Hash 32 byte input messages `srcs[i]` and write 32 byte SHA3-256
+ * hash of message `i` to `dsts[i]`.  The states are permuted together
+ * with the multi-buffer permutation when the backend supports it (see
+ * `sha3_backend()`).
+ *
+ * @param[in] srcs Array of 4 input messages (32 bytes each).
+ * @param[out] dsts Array of 4 destination buffers.  Each must be at least 32 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_256_32
+ */
+void sha3_256_32_x4(const uint8_t * const srcs[4], uint8_t * const dsts[4]);
+
+/**
+ * @brief Calculate SHA3-256 hashes of eight 32 byte input messages.
+ * @ingroup sha3
+ *
+ * Hash 32 byte input messages `srcs[i]` and write 32 byte SHA3-256
+ * hash of message `i` to `dsts[i]`.  The states are permuted together
+ * with the multi-buffer permutation when the backend supports it (see
+ * `sha3_backend()`).
+ *
+ * @param[in] srcs Array of 8 input messages (32 bytes each).
+ * @param[out] dsts Array of 8 destination buffers.  Each must be at least 32 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_256_32
+ */
+void sha3_256_32_x8(const uint8_t * const srcs[8], uint8_t * const dsts[8]);
+
+/**
+ * @brief Calculate SHA3-256 hash of 64 byte input message.
+ * @ingroup sha3
+ *
+ * Hash 64 byte input message in buffer `src` and write 32 byte
+ * SHA3-256 hash to buffer `dst`.  Produces the same result as
+ * `sha3_256(src, 64, dst)`, but loads the message directly into the
+ * state and applies the padding as constants.
+ *
+ * @param[in] src Input message (64 bytes).
+ * @param[out] dst Destination buffer.  Must be at least 32 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_256_64
+ */
+void sha3_256_64(const uint8_t src[static 64], uint8_t dst[static 32]);
+
+/**
+ * @brief Calculate SHA3-256 hashes of four 64 byte input messages.
+ * @ingroup sha3
+ *
+ * Hash 64 byte input messages `srcs[i]` and write 32 byte SHA3-256
+ * hash of message `i` to `dsts[i]`.  The states are permuted together
+ * with the multi-buffer permutation when the backend supports it (see
+ * `sha3_backend()`).
+ *
+ * @param[in] srcs Array of 4 input messages (64 bytes each).
+ * @param[out] dsts Array of 4 destination buffers.  Each must be at least 32 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_256_64
+ */
+void sha3_256_64_x4(const uint8_t * const srcs[4], uint8_t * const dsts[4]);
+
+/**
+ * @brief Calculate SHA3-256 hashes of eight 64 byte input messages.
+ * @ingroup sha3
+ *
+ * Hash 64 byte input messages `srcs[i]` and write 32 byte SHA3-256
+ * hash of message `i` to `dsts[i]`.  The states are permuted together
+ * with the multi-buffer permutation when the backend supports it (see
+ * `sha3_backend()`).
+ *
+ * @param[in] srcs Array of 8 input messages (64 bytes each).
+ * @param[out] dsts Array of 8 destination buffers.  Each must be at least 32 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_256_64
+ */
+void sha3_256_64_x8(const uint8_t * const srcs[8], uint8_t * const dsts[8]);
+
+/**
+ * @brief Iterate SHA3-256 on 32 byte seed.
+ * @ingroup sha3
+ *
+ * Starting from the 32 byte seed `x = seed`, replace `x` with the
+ * SHA3-256 hash of `x` `n` times, then write `x` to `dst`.  If `n` is zero,
+ * then `seed` is copied to `dst`.
+ *
+ * The chaining value stays in the Keccak state between iterations, so
+ * this is faster than calling the one-shot function `n` times.  Useful
+ * for hash-based signature chains and key stretching.
+ *
+ * @param[in] seed Seed (32 bytes).
+ * @param[in] n Number of iterations.
+ * @param[out] dst Destination buffer.  Must be at least 32 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_256_iterate
+ */
+void sha3_256_iterate(const uint8_t seed[static 32], const size_t n, uint8_t dst[static 32]);
+
+/**
+ * @brief Iterate SHA3-256 on four independent 32 byte seeds.
+ * @ingroup sha3
+ *
+ * Iterate SHA3-256 `n` times on seed `seeds[i]` (see `sha3_256_iterate()`) and
+ * write the result to `dsts[i]`.  The four chains are permuted
+ * together with the multi-buffer permutation when the backend supports
+ * it (see `sha3_backend()`).
+ *
+ * @param[in] seeds Array of 4 seeds (32 bytes each).
+ * @param[in] n Number of iterations.
+ * @param[out] dsts Array of 4 destination buffers.  Each must be at least 32 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_256_iterate
+ */
+void sha3_256_iterate_x4(const uint8_t * const seeds[4], const size_t n, uint8_t * const dsts[4]);
+
+/**
+ * @brief Iterate SHA3-256 on eight independent 32 byte seeds.
+ * @ingroup sha3
+ *
+ * Iterate SHA3-256 `n` times on seed `seeds[i]` (see `sha3_256_iterate()`) and
+ * write the result to `dsts[i]`.  The eight chains are permuted
+ * together with the multi-buffer permutation when the backend supports
+ * it (see `sha3_backend()`).
+ *
+ * @param[in] seeds Array of 8 seeds (32 bytes each).
+ * @param[in] n Number of iterations.
+ * @param[out] dsts Array of 8 destination buffers.  Each must be at least 32 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_256_iterate
+ */
+void sha3_256_iterate_x8(const uint8_t * const seeds[8], const size_t n, uint8_t * const dsts[8]);
+
 /**
  * @defgroup shake SHAKE
  *
@@ -405,6 +868,53 @@ _Bool shake128_absorb(sha3_xof_t *xof, const uint8_t *msg, const size_t len);
  */
 void shake128_squeeze(sha3_xof_t *xof, uint8_t *dst, const size_t len);
 
+/**
+ * @brief Squeeze whole 168 byte blocks from SHAKE128 [XOF][] context.
+ * @ingroup shake
+ *
+ * Squeeze `num_blocks` blocks of 168 bytes (the SHAKE128 rate)
+ * into destination buffer `dst` from SHAKE128 [XOF][] context `xof`.
+ * If `dst` is `NULL`, then the blocks are skipped.
+ *
+ * Faster than `shake128_squeeze()` for consumers which only want
+ * full blocks.  Only valid at a block boundary: fails if a partial
+ * block has already been squeezed with `shake128_squeeze()`.
+ *
+ * @param[in,out] xof SHAKE128 [XOF][] context.
+ * @param[out] dst Destination buffer (`168 * num_blocks` bytes), or `NULL`.
+ * @param[in] num_blocks Number of blocks.
+ *
+ * @return False if a partial block has already been squeezed, and true otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c shake128_blocks
+ *
+ * [xof]: https://en.wikipedia.org/wiki/Extendable-output_function
+ *   "Extendable-Output Function (XOF)"
+ */
+_Bool shake128_squeeze_blocks(sha3_xof_t *xof, uint8_t *dst, const size_t num_blocks);
+
+/**
+ * @brief Get current 168 byte output block of SHAKE128 [XOF][] context.
+ * @ingroup shake
+ *
+ * Get pointer to the next 168 bytes of output inside SHAKE128
+ * [XOF][] context `xof`, without copying them.  The block is valid
+ * until the context is next modified; call
+ * `shake128_squeeze_blocks(xof, NULL, 1)` to move to the next block.
+ *
+ * @param[in,out] xof SHAKE128 [XOF][] context.
+ *
+ * @return Pointer to 168 bytes of output, or `NULL` if a partial block has already been squeezed.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c shake128_blocks
+ *
+ * [xof]: https://en.wikipedia.org/wiki/Extendable-output_function
+ *   "Extendable-Output Function (XOF)"
+ */
+const uint8_t *shake128_peek_block(sha3_xof_t *xof);
+
 /**
  * @brief Absorb data into SHAKE128 [XOF][], then squeeze bytes out.
  * @ingroup shake
@@ -484,15 +994,62 @@ _Bool shake256_absorb(sha3_xof_t *xof, const uint8_t *msg, const size_t len);
 void shake256_squeeze(sha3_xof_t *xof, uint8_t *dst, const size_t len);
 
 /**
- * @brief Absorb data into SHAKE256 [XOF][], then squeeze bytes out.
+ * @brief Squeeze whole 136 byte blocks from SHAKE256 [XOF][] context.
  * @ingroup shake
  *
- * Absorb data in buffer `src` of length `src_len` bytes into SHAKE256
- * [XOF][] context, then squeeze `dst_len` bytes of output into
- * destination buffer `dst`.
+ * Squeeze `num_blocks` blocks of 136 bytes (the SHAKE256 rate)
+ * into destination buffer `dst` from SHAKE256 [XOF][] context `xof`.
+ * If `dst` is `NULL`, then the blocks are skipped.
  *
- * @param[in] src Source buffer.
- * @param[in] src_len Source buffer length, in bytes.
+ * Faster than `shake256_squeeze()` for consumers which only want
+ * full blocks.  Only valid at a block boundary: fails if a partial
+ * block has already been squeezed with `shake256_squeeze()`.
+ *
+ * @param[in,out] xof SHAKE256 [XOF][] context.
+ * @param[out] dst Destination buffer (`136 * num_blocks` bytes), or `NULL`.
+ * @param[in] num_blocks Number of blocks.
+ *
+ * @return False if a partial block has already been squeezed, and true otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c shake256_blocks
+ *
+ * [xof]: https://en.wikipedia.org/wiki/Extendable-output_function
+ *   "Extendable-Output Function (XOF)"
+ */
+_Bool shake256_squeeze_blocks(sha3_xof_t *xof, uint8_t *dst, const size_t num_blocks);
+
+/**
+ * @brief Get current 136 byte output block of SHAKE256 [XOF][] context.
+ * @ingroup shake
+ *
+ * Get pointer to the next 136 bytes of output inside SHAKE256
+ * [XOF][] context `xof`, without copying them.  The block is valid
+ * until the context is next modified; call
+ * `shake256_squeeze_blocks(xof, NULL, 1)` to move to the next block.
+ *
+ * @param[in,out] xof SHAKE256 [XOF][] context.
+ *
+ * @return Pointer to 136 bytes of output, or `NULL` if a partial block has already been squeezed.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c shake256_blocks
+ *
+ * [xof]: https://en.wikipedia.org/wiki/Extendable-output_function
+ *   "Extendable-Output Function (XOF)"
+ */
+const uint8_t *shake256_peek_block(sha3_xof_t *xof);
+
+/**
+ * @brief Absorb data into SHAKE256 [XOF][], then squeeze bytes out.
+ * @ingroup shake
+ *
+ * Absorb data in buffer `src` of length `src_len` bytes into SHAKE256
+ * [XOF][] context, then squeeze `dst_len` bytes of output into
+ * destination buffer `dst`.
+ *
+ * @param[in] src Source buffer.
+ * @param[in] src_len Source buffer length, in bytes.
  * @param[out] dst Destination buffer.
  * @param[in] dst_len Destination buffer length, in bytes.
  *
@@ -504,6 +1061,263 @@ void shake256_squeeze(sha3_xof_t *xof, uint8_t *dst, const size_t len);
  */
 void shake256(const uint8_t *src, const size_t src_len, uint8_t *dst, const size_t dst_len);
 
+/**
+ * @brief Absorb a batch of messages into SHAKE128 [XOF][], then
+ * squeeze bytes out of each.
+ * @ingroup shake
+ *
+ * Absorb `n` messages, where message `i` is `lens[i]` bytes from
+ * `srcs[i]`, into independent SHAKE128 contexts, then squeeze
+ * `dst_len` bytes of output from context `i` into `dsts[i]`.
+ *
+ * Messages are processed in parallel with the multi-buffer permutation
+ * when the backend supports it.
+ *
+ * @param[in] srcs Array of `n` source buffers.
+ * @param[in] lens Array of `n` source buffer lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[out] dsts Array of `n` destination buffers.
+ * @param[in] dst_len Length of each destination buffer, in bytes.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c shake128_batch
+ *
+ * [xof]: https://en.wikipedia.org/wiki/Extendable-output_function
+ *   "Extendable-Output Function (XOF)"
+ */
+void shake128_batch(const uint8_t * const srcs[], const size_t lens[], const size_t n, uint8_t * const dsts[], const size_t dst_len);
+
+/**
+ * @brief Sample uniform 12-bit integers modulo `q` from SHAKE128
+ * output.
+ * @ingroup shake
+ *
+ * Absorb `seed_len` bytes from `seed` into a SHAKE128 context, then
+ * squeeze output and write the first `n` 12-bit values which are
+ * less than `q` to `dst` (rejection sampling, FIPS 203, Algorithm 7).  Used to
+ * expand the public matrix in ML-KEM (`q = 3329`).
+ *
+ * Values are parsed directly from the SHAKE128 state one block at a
+ * time, so no output bytes are copied.
+ *
+ * @param[in] seed Seed.
+ * @param[in] seed_len Seed length, in bytes.
+ * @param[in] q Upper bound (exclusive).  Must be in the range `[1, 4096]`.
+ * @param[out] dst Destination array of `n` values.
+ * @param[in] n Number of values.
+ *
+ * @return False if `q` is out of range, and true otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c shake128_sample12
+ */
+_Bool shake128_sample12(const uint8_t *seed, const size_t seed_len, const uint16_t q, uint16_t *dst, const size_t n);
+
+/**
+ * @brief Sample uniform 12-bit integers modulo `q` from SHAKE128
+ * output of four seeds.
+ * @ingroup shake
+ *
+ * Sample `n` values less than `q` from the SHAKE128 output of each
+ * `seed_len` byte seed `seeds[i]` (see `shake128_sample12()`) and
+ * write them to `dsts[i]`.  The four states are permuted together with
+ * the multi-buffer permutation when the backend supports it (see
+ * `sha3_backend()`).
+ *
+ * @param[in] seeds Array of 4 seeds.
+ * @param[in] seed_len Length of each seed, in bytes.
+ * @param[in] q Upper bound (exclusive).  Must be in the range `[1, 4096]`.
+ * @param[out] dsts Array of 4 destination arrays of `n` values.
+ * @param[in] n Number of values per seed.
+ *
+ * @return False if `q` is out of range, and true otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c shake128_sample12
+ */
+_Bool shake128_sample12_x4(const uint8_t * const seeds[4], const size_t seed_len, const uint16_t q, uint16_t * const dsts[4], const size_t n);
+
+/**
+ * @brief Sample uniform 12-bit integers modulo `q` from SHAKE128
+ * output of eight seeds.
+ * @ingroup shake
+ *
+ * Sample `n` values less than `q` from the SHAKE128 output of each
+ * `seed_len` byte seed `seeds[i]` (see `shake128_sample12()`) and
+ * write them to `dsts[i]`.  The eight states are permuted together
+ * with the multi-buffer permutation when the backend supports it (see
+ * `sha3_backend()`).
+ *
+ * @param[in] seeds Array of 8 seeds.
+ * @param[in] seed_len Length of each seed, in bytes.
+ * @param[in] q Upper bound (exclusive).  Must be in the range `[1, 4096]`.
+ * @param[out] dsts Array of 8 destination arrays of `n` values.
+ * @param[in] n Number of values per seed.
+ *
+ * @return False if `q` is out of range, and true otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c shake128_sample12
+ */
+_Bool shake128_sample12_x8(const uint8_t * const seeds[8], const size_t seed_len, const uint16_t q, uint16_t * const dsts[8], const size_t n);
+
+/**
+ * @brief Sample uniform 23-bit integers modulo `q` from SHAKE128
+ * output.
+ * @ingroup shake
+ *
+ * Absorb `seed_len` bytes from `seed` into a SHAKE128 context, then
+ * squeeze output and write the first `n` 23-bit values which are
+ * less than `q` to `dst` (rejection sampling, FIPS 204, Algorithm 14).  Used to
+ * expand the public matrix in ML-DSA (`q = 8380417`).
+ *
+ * Values are parsed directly from the SHAKE128 state one block at a
+ * time, so no output bytes are copied.
+ *
+ * @param[in] seed Seed.
+ * @param[in] seed_len Seed length, in bytes.
+ * @param[in] q Upper bound (exclusive).  Must be in the range `[1, 8388608]`.
+ * @param[out] dst Destination array of `n` values.
+ * @param[in] n Number of values.
+ *
+ * @return False if `q` is out of range, and true otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c shake128_sample23
+ */
+_Bool shake128_sample23(const uint8_t *seed, const size_t seed_len, const uint32_t q, uint32_t *dst, const size_t n);
+
+/**
+ * @brief Sample uniform 23-bit integers modulo `q` from SHAKE128
+ * output of four seeds.
+ * @ingroup shake
+ *
+ * Sample `n` values less than `q` from the SHAKE128 output of each
+ * `seed_len` byte seed `seeds[i]` (see `shake128_sample23()`) and
+ * write them to `dsts[i]`.  The four states are permuted together with
+ * the multi-buffer permutation when the backend supports it (see
+ * `sha3_backend()`).
+ *
+ * @param[in] seeds Array of 4 seeds.
+ * @param[in] seed_len Length of each seed, in bytes.
+ * @param[in] q Upper bound (exclusive).  Must be in the range `[1, 8388608]`.
+ * @param[out] dsts Array of 4 destination arrays of `n` values.
+ * @param[in] n Number of values per seed.
+ *
+ * @return False if `q` is out of range, and true otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c shake128_sample23
+ */
+_Bool shake128_sample23_x4(const uint8_t * const seeds[4], const size_t seed_len, const uint32_t q, uint32_t * const dsts[4], const size_t n);
+
+/**
+ * @brief Sample uniform 23-bit integers modulo `q` from SHAKE128
+ * output of eight seeds.
+ * @ingroup shake
+ *
+ * Sample `n` values less than `q` from the SHAKE128 output of each
+ * `seed_len` byte seed `seeds[i]` (see `shake128_sample23()`) and
+ * write them to `dsts[i]`.  The eight states are permuted together
+ * with the multi-buffer permutation when the backend supports it (see
+ * `sha3_backend()`).
+ *
+ * @param[in] seeds Array of 8 seeds.
+ * @param[in] seed_len Length of each seed, in bytes.
+ * @param[in] q Upper bound (exclusive).  Must be in the range `[1, 8388608]`.
+ * @param[out] dsts Array of 8 destination arrays of `n` values.
+ * @param[in] n Number of values per seed.
+ *
+ * @return False if `q` is out of range, and true otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c shake128_sample23
+ */
+_Bool shake128_sample23_x8(const uint8_t * const seeds[8], const size_t seed_len, const uint32_t q, uint32_t * const dsts[8], const size_t n);
+
+/**
+ * @brief Absorb a batch of messages into SHAKE256 [XOF][], then
+ * squeeze bytes out of each.
+ * @ingroup shake
+ *
+ * Absorb `n` messages, where message `i` is `lens[i]` bytes from
+ * `srcs[i]`, into independent SHAKE256 contexts, then squeeze
+ * `dst_len` bytes of output from context `i` into `dsts[i]`.
+ *
+ * Messages are processed in parallel with the multi-buffer permutation
+ * when the backend supports it.
+ *
+ * @param[in] srcs Array of `n` source buffers.
+ * @param[in] lens Array of `n` source buffer lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[out] dsts Array of `n` destination buffers.
+ * @param[in] dst_len Length of each destination buffer, in bytes.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c shake256_batch
+ *
+ * [xof]: https://en.wikipedia.org/wiki/Extendable-output_function
+ *   "Extendable-Output Function (XOF)"
+ */
+void shake256_batch(const uint8_t * const srcs[], const size_t lens[], const size_t n, uint8_t * const dsts[], const size_t dst_len);
+
+/**
+ * @brief Iterate SHAKE256 on 32 byte seed.
+ * @ingroup shake
+ *
+ * Starting from the 32 byte seed `x = seed`, replace `x` with the
+ * first 32 bytes of SHAKE256 output of `x` `n` times, then write `x` to `dst`.  If `n` is zero,
+ * then `seed` is copied to `dst`.
+ *
+ * The chaining value stays in the Keccak state between iterations, so
+ * this is faster than calling the one-shot function `n` times.  Useful
+ * for hash-based signature chains and key stretching.
+ *
+ * @param[in] seed Seed (32 bytes).
+ * @param[in] n Number of iterations.
+ * @param[out] dst Destination buffer.  Must be at least 32 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c shake256_chain
+ */
+void shake256_chain(const uint8_t seed[static 32], const size_t n, uint8_t dst[static 32]);
+
+/**
+ * @brief Iterate SHAKE256 on four independent 32 byte seeds.
+ * @ingroup shake
+ *
+ * Iterate SHAKE256 `n` times on seed `seeds[i]` (see `shake256_chain()`) and
+ * write the result to `dsts[i]`.  The four chains are permuted
+ * together with the multi-buffer permutation when the backend supports
+ * it (see `sha3_backend()`).
+ *
+ * @param[in] seeds Array of 4 seeds (32 bytes each).
+ * @param[in] n Number of iterations.
+ * @param[out] dsts Array of 4 destination buffers.  Each must be at least 32 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c shake256_chain
+ */
+void shake256_chain_x4(const uint8_t * const seeds[4], const size_t n, uint8_t * const dsts[4]);
+
+/**
+ * @brief Iterate SHAKE256 on eight independent 32 byte seeds.
+ * @ingroup shake
+ *
+ * Iterate SHAKE256 `n` times on seed `seeds[i]` (see `shake256_chain()`) and
+ * write the result to `dsts[i]`.  The eight chains are permuted
+ * together with the multi-buffer permutation when the backend supports
+ * it (see `sha3_backend()`).
+ *
+ * @param[in] seeds Array of 8 seeds (32 bytes each).
+ * @param[in] n Number of iterations.
+ * @param[out] dsts Array of 8 destination buffers.  Each must be at least 32 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c shake256_chain
+ */
+void shake256_chain_x8(const uint8_t * const seeds[8], const size_t n, uint8_t * const dsts[8]);
+
 /**
  * @defgroup hmac HMAC
  *
@@ -624,190 +1438,438 @@ void hmac_sha3_384(const uint8_t *key, const size_t key_len, const uint8_t *msg,
 void hmac_sha3_512(const uint8_t *key, const size_t key_len, const uint8_t *msg, const size_t msg_len, uint8_t mac[64]);
 
 /**
- * @brief HMAC-SHA3 (Hash-based [Message Authentication Code][MAC])
- * context (all members are private).
+ * @brief Calculate HMAC-SHA3-224 of a batch of messages with one key.
  * @ingroup hmac
  *
- * [mac]: https://en.wikipedia.org/wiki/Message_authentication_code
- *   "Message authentication code (MAC)"
- */
-typedef struct {
-  sha3_t inner, /**< Inner hash context (private) */
-         outer; /**< Outer hash context (private) */
-  _Bool finalized; /**< Is this context finalized (private) */
-} hmac_sha3_t;
-
-/**
- * @brief Initialize HMAC-SHA3-224 ([FIPS 202][], Section 7) context.
- * @ingroup hmac
+ * Calculate HMAC-SHA3-224 ([FIPS 202][], Section 7) of `n` messages
+ * with key in buffer `key` of length `key_len`, where message `i` is
+ * `lens[i]` bytes from `msgs[i]`, and write the 28 byte [message
+ * authentication code (MAC)][mac] of message `i` to `macs[i]`.
+ *
+ * The key is processed once, then the inner hashes of every message
+ * and the outer hashes of every inner hash are calculated with the
+ * multi-buffer permutation when the backend supports it (see
+ * `sha3_backend()`).
  *
- * @param[out] ctx HMAC-SHA3-224 context.
  * @param[in] key Key.
  * @param[in] key_len Key length, in bytes.
+ * @param[in] msgs Array of `n` input messages.
+ * @param[in] lens Array of `n` input message lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[out] macs Array of `n` [MAC][] destination buffers.  Each must be at least 28 bytes in length.
  *
  * Example:
- * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_224_absorb
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_224_batch
  *
  * [FIPS 202]: https://csrc.nist.gov/pubs/fips/202/final
  *   "SHA-3 Standard: Permutation-Based Hash and Extendable-Output Functions"
+ * [mac]: https://en.wikipedia.org/wiki/Message_authentication_code
+ *   "Message authentication code (MAC)"
  */
-void hmac_sha3_224_init(hmac_sha3_t *ctx, const uint8_t *key, const size_t key_len);
+void hmac_sha3_224_batch(const uint8_t *key, const size_t key_len, const uint8_t * const msgs[], const size_t lens[], const size_t n, uint8_t * const macs[]);
 
 /**
- * @brief Absorb data into HMAC-SHA3-224 context.
+ * @brief Verify HMAC-SHA3-224 of a batch of messages with one key.
  * @ingroup hmac
  *
- * Absorb input data in `src` of length `len` bytes into HMAC-SHA3-224
- * context `hmac`.  Can be called iteratively to absorb input data in
- * chunks.
- *
- * @param[in,out] ctx HMAC-SHA3-224 context.
- * @param[in] src Input data.
- * @param[in] len Input data length, in bytes.
+ * Calculate HMAC-SHA3-224 of `n` messages with key in buffer `key` of
+ * length `key_len` (see `hmac_sha3_224_batch()`), and compare the
+ * [MAC][] of message `i` with the expected 28 byte [MAC][] in
+ * `macs[i]`.
  *
- * @return True if data was absorbed, and false otherwise (e.g., if context has already been finalized).
+ * Each comparison takes the same amount of time whether or not the
+ * [MAC][]s match.  If `oks` is not `NULL`, then the result for message
+ * `i` is written to `oks[i]`.
  *
- * Example:
- * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_224_absorb
- */
-_Bool hmac_sha3_224_absorb(hmac_sha3_t *ctx, const uint8_t *src, const size_t len);
-
-/**
- * @brief Finalize HMAC-SHA3-224 context and write 28 byte [MAC][]
- * to destination buffer.
- * @ingroup hmac
+ * @param[in] key Key.
+ * @param[in] key_len Key length, in bytes.
+ * @param[in] msgs Array of `n` input messages.
+ * @param[in] lens Array of `n` input message lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[in] macs Array of `n` expected 28 byte [MAC][]s.
+ * @param[out] oks Array of `n` results (optional, may be `NULL`).
  *
- * @param[in,out] ctx HMAC-SHA3-224 context.
- * @param[out] mac [MAC][] destination buffer.  Must be at least 28 bytes in length.
+ * @return True if every [MAC][] matched, and false otherwise.
  *
  * Example:
- * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_224_absorb
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_224_batch
  *
  * [mac]: https://en.wikipedia.org/wiki/Message_authentication_code
  *   "Message authentication code (MAC)"
  */
-void hmac_sha3_224_final(hmac_sha3_t *ctx, uint8_t mac[28]);
+_Bool hmac_sha3_224_batch_verify(const uint8_t *key, const size_t key_len, const uint8_t * const msgs[], const size_t lens[], const size_t n, const uint8_t * const macs[], _Bool oks[]);
 
 /**
- * @brief Initialize HMAC-SHA3-256 ([FIPS 202][], Section 7) context.
+ * @brief Calculate HMAC-SHA3-256 of a batch of messages with one key.
  * @ingroup hmac
  *
- * @param[out] ctx HMAC-SHA3-256 context.
+ * Calculate HMAC-SHA3-256 ([FIPS 202][], Section 7) of `n` messages
+ * with key in buffer `key` of length `key_len`, where message `i` is
+ * `lens[i]` bytes from `msgs[i]`, and write the 32 byte [message
+ * authentication code (MAC)][mac] of message `i` to `macs[i]`.
+ *
+ * The key is processed once, then the inner hashes of every message
+ * and the outer hashes of every inner hash are calculated with the
+ * multi-buffer permutation when the backend supports it (see
+ * `sha3_backend()`).
+ *
  * @param[in] key Key.
  * @param[in] key_len Key length, in bytes.
+ * @param[in] msgs Array of `n` input messages.
+ * @param[in] lens Array of `n` input message lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[out] macs Array of `n` [MAC][] destination buffers.  Each must be at least 32 bytes in length.
  *
  * Example:
- * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_256_absorb
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_256_batch
  *
  * [FIPS 202]: https://csrc.nist.gov/pubs/fips/202/final
  *   "SHA-3 Standard: Permutation-Based Hash and Extendable-Output Functions"
+ * [mac]: https://en.wikipedia.org/wiki/Message_authentication_code
+ *   "Message authentication code (MAC)"
  */
-void hmac_sha3_256_init(hmac_sha3_t *ctx, const uint8_t *key, const size_t key_len);
+void hmac_sha3_256_batch(const uint8_t *key, const size_t key_len, const uint8_t * const msgs[], const size_t lens[], const size_t n, uint8_t * const macs[]);
 
 /**
- * @brief Absorb data into HMAC-SHA3-256 context.
+ * @brief Verify HMAC-SHA3-256 of a batch of messages with one key.
  * @ingroup hmac
  *
- * Absorb input data in `src` of length `len` bytes into HMAC-SHA3-256
- * context `ctx`.  Can be called iteratively to absorb input data in
- * chunks.
- *
- * @param[in,out] ctx HMAC-SHA3-256 context.
- * @param[in] src Input data.
- * @param[in] len Input data length, in bytes.
+ * Calculate HMAC-SHA3-256 of `n` messages with key in buffer `key` of
+ * length `key_len` (see `hmac_sha3_256_batch()`), and compare the
+ * [MAC][] of message `i` with the expected 32 byte [MAC][] in
+ * `macs[i]`.
  *
- * @return True if data was absorbed, and false otherwise (e.g., if context has already been finalized).
+ * Each comparison takes the same amount of time whether or not the
+ * [MAC][]s match.  If `oks` is not `NULL`, then the result for message
+ * `i` is written to `oks[i]`.
  *
- * Example:
- * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_256_absorb
- */
-_Bool hmac_sha3_256_absorb(hmac_sha3_t *ctx, const uint8_t *src, const size_t len);
-
-/**
- * @brief Finalize HMAC-SHA3-256 context and write 32 byte [MAC][] to
- * destination buffer.
- * @ingroup hmac
+ * @param[in] key Key.
+ * @param[in] key_len Key length, in bytes.
+ * @param[in] msgs Array of `n` input messages.
+ * @param[in] lens Array of `n` input message lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[in] macs Array of `n` expected 32 byte [MAC][]s.
+ * @param[out] oks Array of `n` results (optional, may be `NULL`).
  *
- * @param[in,out] ctx HMAC-SHA3-256 context.
- * @param[out] mac [MAC][] destination buffer.  Must be at least 32 bytes in length.
+ * @return True if every [MAC][] matched, and false otherwise.
  *
  * Example:
- * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_256_absorb
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_256_batch
  *
  * [mac]: https://en.wikipedia.org/wiki/Message_authentication_code
  *   "Message authentication code (MAC)"
  */
-void hmac_sha3_256_final(hmac_sha3_t *ctx, uint8_t mac[32]);
+_Bool hmac_sha3_256_batch_verify(const uint8_t *key, const size_t key_len, const uint8_t * const msgs[], const size_t lens[], const size_t n, const uint8_t * const macs[], _Bool oks[]);
 
 /**
- * @brief Initialize HMAC-SHA3-384 ([FIPS 202][], Section 7) context.
+ * @brief Calculate HMAC-SHA3-384 of a batch of messages with one key.
  * @ingroup hmac
  *
- * @param[out] ctx HMAC-SHA3-384 context.
+ * Calculate HMAC-SHA3-384 ([FIPS 202][], Section 7) of `n` messages
+ * with key in buffer `key` of length `key_len`, where message `i` is
+ * `lens[i]` bytes from `msgs[i]`, and write the 48 byte [message
+ * authentication code (MAC)][mac] of message `i` to `macs[i]`.
+ *
+ * The key is processed once, then the inner hashes of every message
+ * and the outer hashes of every inner hash are calculated with the
+ * multi-buffer permutation when the backend supports it (see
+ * `sha3_backend()`).
+ *
  * @param[in] key Key.
  * @param[in] key_len Key length, in bytes.
+ * @param[in] msgs Array of `n` input messages.
+ * @param[in] lens Array of `n` input message lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[out] macs Array of `n` [MAC][] destination buffers.  Each must be at least 48 bytes in length.
  *
  * Example:
- * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_384_absorb
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_384_batch
  *
  * [FIPS 202]: https://csrc.nist.gov/pubs/fips/202/final
  *   "SHA-3 Standard: Permutation-Based Hash and Extendable-Output Functions"
+ * [mac]: https://en.wikipedia.org/wiki/Message_authentication_code
+ *   "Message authentication code (MAC)"
  */
-void hmac_sha3_384_init(hmac_sha3_t *ctx, const uint8_t *key, const size_t key_len);
+void hmac_sha3_384_batch(const uint8_t *key, const size_t key_len, const uint8_t * const msgs[], const size_t lens[], const size_t n, uint8_t * const macs[]);
 
 /**
- * @brief Absorb data into HMAC-SHA3-384 context.
+ * @brief Verify HMAC-SHA3-384 of a batch of messages with one key.
  * @ingroup hmac
  *
- * Absorb input data in `src` of length `len` bytes into HMAC-SHA3-384
- * context `ctx`.  Can be called iteratively to absorb input data in
- * chunks.
- *
- * @param[in,out] ctx HMAC-SHA3-384 context.
- * @param[in] src Input data.
- * @param[in] len Input data length, in bytes.
+ * Calculate HMAC-SHA3-384 of `n` messages with key in buffer `key` of
+ * length `key_len` (see `hmac_sha3_384_batch()`), and compare the
+ * [MAC][] of message `i` with the expected 48 byte [MAC][] in
+ * `macs[i]`.
  *
- * @return True if data was absorbed, and false otherwise (e.g., if context has already been finalized).
+ * Each comparison takes the same amount of time whether or not the
+ * [MAC][]s match.  If `oks` is not `NULL`, then the result for message
+ * `i` is written to `oks[i]`.
  *
- * Example:
- * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_384_absorb
- */
-_Bool hmac_sha3_384_absorb(hmac_sha3_t *ctx, const uint8_t *src, const size_t len);
-
-/**
- * @brief Finalize HMAC-SHA3-384 context and write 48 byte [MAC][] to
- * destination buffer.
- * @ingroup hmac
+ * @param[in] key Key.
+ * @param[in] key_len Key length, in bytes.
+ * @param[in] msgs Array of `n` input messages.
+ * @param[in] lens Array of `n` input message lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[in] macs Array of `n` expected 48 byte [MAC][]s.
+ * @param[out] oks Array of `n` results (optional, may be `NULL`).
  *
- * @param[in,out] ctx HMAC-SHA3-384 context.
- * @param[out] mac [MAC][] destination buffer.  Must be at least 48 bytes in length.
+ * @return True if every [MAC][] matched, and false otherwise.
  *
  * Example:
- * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_512_absorb
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_384_batch
  *
  * [mac]: https://en.wikipedia.org/wiki/Message_authentication_code
  *   "Message authentication code (MAC)"
  */
-void hmac_sha3_384_final(hmac_sha3_t *ctx, uint8_t mac[48]);
+_Bool hmac_sha3_384_batch_verify(const uint8_t *key, const size_t key_len, const uint8_t * const msgs[], const size_t lens[], const size_t n, const uint8_t * const macs[], _Bool oks[]);
 
 /**
- * @brief Initialize HMAC-SHA3-512 ([FIPS 202][], Section 7) context.
+ * @brief Calculate HMAC-SHA3-512 of a batch of messages with one key.
  * @ingroup hmac
  *
- * @param[out] ctx HMAC-SHA3-512 context.
+ * Calculate HMAC-SHA3-512 ([FIPS 202][], Section 7) of `n` messages
+ * with key in buffer `key` of length `key_len`, where message `i` is
+ * `lens[i]` bytes from `msgs[i]`, and write the 64 byte [message
+ * authentication code (MAC)][mac] of message `i` to `macs[i]`.
+ *
+ * The key is processed once, then the inner hashes of every message
+ * and the outer hashes of every inner hash are calculated with the
+ * multi-buffer permutation when the backend supports it (see
+ * `sha3_backend()`).
+ *
  * @param[in] key Key.
  * @param[in] key_len Key length, in bytes.
+ * @param[in] msgs Array of `n` input messages.
+ * @param[in] lens Array of `n` input message lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[out] macs Array of `n` [MAC][] destination buffers.  Each must be at least 64 bytes in length.
  *
  * Example:
- * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_512_absorb
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_512_batch
  *
  * [FIPS 202]: https://csrc.nist.gov/pubs/fips/202/final
  *   "SHA-3 Standard: Permutation-Based Hash and Extendable-Output Functions"
+ * [mac]: https://en.wikipedia.org/wiki/Message_authentication_code
+ *   "Message authentication code (MAC)"
  */
-void hmac_sha3_512_init(hmac_sha3_t *ctx, const uint8_t *key, const size_t key_len);
+void hmac_sha3_512_batch(const uint8_t *key, const size_t key_len, const uint8_t * const msgs[], const size_t lens[], const size_t n, uint8_t * const macs[]);
 
 /**
- * @brief Absorb data into HMAC-SHA3-512 context.
+ * @brief Verify HMAC-SHA3-512 of a batch of messages with one key.
+ * @ingroup hmac
+ *
+ * Calculate HMAC-SHA3-512 of `n` messages with key in buffer `key` of
+ * length `key_len` (see `hmac_sha3_512_batch()`), and compare the
+ * [MAC][] of message `i` with the expected 64 byte [MAC][] in
+ * `macs[i]`.
+ *
+ * Each comparison takes the same amount of time whether or not the
+ * [MAC][]s match.  If `oks` is not `NULL`, then the result for message
+ * `i` is written to `oks[i]`.
+ *
+ * @param[in] key Key.
+ * @param[in] key_len Key length, in bytes.
+ * @param[in] msgs Array of `n` input messages.
+ * @param[in] lens Array of `n` input message lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[in] macs Array of `n` expected 64 byte [MAC][]s.
+ * @param[out] oks Array of `n` results (optional, may be `NULL`).
+ *
+ * @return True if every [MAC][] matched, and false otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_512_batch
+ *
+ * [mac]: https://en.wikipedia.org/wiki/Message_authentication_code
+ *   "Message authentication code (MAC)"
+ */
+_Bool hmac_sha3_512_batch_verify(const uint8_t *key, const size_t key_len, const uint8_t * const msgs[], const size_t lens[], const size_t n, const uint8_t * const macs[], _Bool oks[]);
+
+/**
+ * @brief HMAC-SHA3 (Hash-based [Message Authentication Code][MAC])
+ * context (all members are private).
+ * @ingroup hmac
+ *
+ * [mac]: https://en.wikipedia.org/wiki/Message_authentication_code
+ *   "Message authentication code (MAC)"
+ */
+typedef struct {
+  sha3_t inner, /**< Inner hash context (private) */
+         outer; /**< Outer hash context (private) */
+  _Bool finalized; /**< Is this context finalized (private) */
+} hmac_sha3_t;
+
+/**
+ * @brief Initialize HMAC-SHA3-224 ([FIPS 202][], Section 7) context.
+ * @ingroup hmac
+ *
+ * @param[out] ctx HMAC-SHA3-224 context.
+ * @param[in] key Key.
+ * @param[in] key_len Key length, in bytes.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_224_absorb
+ *
+ * [FIPS 202]: https://csrc.nist.gov/pubs/fips/202/final
+ *   "SHA-3 Standard: Permutation-Based Hash and Extendable-Output Functions"
+ */
+void hmac_sha3_224_init(hmac_sha3_t *ctx, const uint8_t *key, const size_t key_len);
+
+/**
+ * @brief Absorb data into HMAC-SHA3-224 context.
+ * @ingroup hmac
+ *
+ * Absorb input data in `src` of length `len` bytes into HMAC-SHA3-224
+ * context `hmac`.  Can be called iteratively to absorb input data in
+ * chunks.
+ *
+ * @param[in,out] ctx HMAC-SHA3-224 context.
+ * @param[in] src Input data.
+ * @param[in] len Input data length, in bytes.
+ *
+ * @return True if data was absorbed, and false otherwise (e.g., if context has already been finalized).
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_224_absorb
+ */
+_Bool hmac_sha3_224_absorb(hmac_sha3_t *ctx, const uint8_t *src, const size_t len);
+
+/**
+ * @brief Finalize HMAC-SHA3-224 context and write 28 byte [MAC][]
+ * to destination buffer.
+ * @ingroup hmac
+ *
+ * @param[in,out] ctx HMAC-SHA3-224 context.
+ * @param[out] mac [MAC][] destination buffer.  Must be at least 28 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_224_absorb
+ *
+ * [mac]: https://en.wikipedia.org/wiki/Message_authentication_code
+ *   "Message authentication code (MAC)"
+ */
+void hmac_sha3_224_final(hmac_sha3_t *ctx, uint8_t mac[28]);
+
+/**
+ * @brief Initialize HMAC-SHA3-256 ([FIPS 202][], Section 7) context.
+ * @ingroup hmac
+ *
+ * @param[out] ctx HMAC-SHA3-256 context.
+ * @param[in] key Key.
+ * @param[in] key_len Key length, in bytes.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_256_absorb
+ *
+ * [FIPS 202]: https://csrc.nist.gov/pubs/fips/202/final
+ *   "SHA-3 Standard: Permutation-Based Hash and Extendable-Output Functions"
+ */
+void hmac_sha3_256_init(hmac_sha3_t *ctx, const uint8_t *key, const size_t key_len);
+
+/**
+ * @brief Absorb data into HMAC-SHA3-256 context.
+ * @ingroup hmac
+ *
+ * Absorb input data in `src` of length `len` bytes into HMAC-SHA3-256
+ * context `ctx`.  Can be called iteratively to absorb input data in
+ * chunks.
+ *
+ * @param[in,out] ctx HMAC-SHA3-256 context.
+ * @param[in] src Input data.
+ * @param[in] len Input data length, in bytes.
+ *
+ * @return True if data was absorbed, and false otherwise (e.g., if context has already been finalized).
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_256_absorb
+ */
+_Bool hmac_sha3_256_absorb(hmac_sha3_t *ctx, const uint8_t *src, const size_t len);
+
+/**
+ * @brief Finalize HMAC-SHA3-256 context and write 32 byte [MAC][] to
+ * destination buffer.
+ * @ingroup hmac
+ *
+ * @param[in,out] ctx HMAC-SHA3-256 context.
+ * @param[out] mac [MAC][] destination buffer.  Must be at least 32 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_256_absorb
+ *
+ * [mac]: https://en.wikipedia.org/wiki/Message_authentication_code
+ *   "Message authentication code (MAC)"
+ */
+void hmac_sha3_256_final(hmac_sha3_t *ctx, uint8_t mac[32]);
+
+/**
+ * @brief Initialize HMAC-SHA3-384 ([FIPS 202][], Section 7) context.
+ * @ingroup hmac
+ *
+ * @param[out] ctx HMAC-SHA3-384 context.
+ * @param[in] key Key.
+ * @param[in] key_len Key length, in bytes.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_384_absorb
+ *
+ * [FIPS 202]: https://csrc.nist.gov/pubs/fips/202/final
+ *   "SHA-3 Standard: Permutation-Based Hash and Extendable-Output Functions"
+ */
+void hmac_sha3_384_init(hmac_sha3_t *ctx, const uint8_t *key, const size_t key_len);
+
+/**
+ * @brief Absorb data into HMAC-SHA3-384 context.
+ * @ingroup hmac
+ *
+ * Absorb input data in `src` of length `len` bytes into HMAC-SHA3-384
+ * context `ctx`.  Can be called iteratively to absorb input data in
+ * chunks.
+ *
+ * @param[in,out] ctx HMAC-SHA3-384 context.
+ * @param[in] src Input data.
+ * @param[in] len Input data length, in bytes.
+ *
+ * @return True if data was absorbed, and false otherwise (e.g., if context has already been finalized).
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_384_absorb
+ */
+_Bool hmac_sha3_384_absorb(hmac_sha3_t *ctx, const uint8_t *src, const size_t len);
+
+/**
+ * @brief Finalize HMAC-SHA3-384 context and write 48 byte [MAC][] to
+ * destination buffer.
+ * @ingroup hmac
+ *
+ * @param[in,out] ctx HMAC-SHA3-384 context.
+ * @param[out] mac [MAC][] destination buffer.  Must be at least 48 bytes in length.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_512_absorb
+ *
+ * [mac]: https://en.wikipedia.org/wiki/Message_authentication_code
+ *   "Message authentication code (MAC)"
+ */
+void hmac_sha3_384_final(hmac_sha3_t *ctx, uint8_t mac[48]);
+
+/**
+ * @brief Initialize HMAC-SHA3-512 ([FIPS 202][], Section 7) context.
+ * @ingroup hmac
+ *
+ * @param[out] ctx HMAC-SHA3-512 context.
+ * @param[in] key Key.
+ * @param[in] key_len Key length, in bytes.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c hmac_sha3_512_absorb
+ *
+ * [FIPS 202]: https://csrc.nist.gov/pubs/fips/202/final
+ *   "SHA-3 Standard: Permutation-Based Hash and Extendable-Output Functions"
+ */
+void hmac_sha3_512_init(hmac_sha3_t *ctx, const uint8_t *key, const size_t key_len);
+
+/**
+ * @brief Absorb data into HMAC-SHA3-512 context.
  * @ingroup hmac
  *
  * Absorb input data in `src` of length `len` bytes into HMAC-SHA3-512
@@ -1163,6 +2225,80 @@ void kmac128(const kmac_params_t params, const uint8_t *src, const size_t src_le
  */
 void kmac256(const kmac_params_t params, const uint8_t *src, const size_t src_len, uint8_t *dst, const size_t dst_len);
 
+/**
+ * @brief Calculate KMAC128 of a batch of messages with one key.
+ * @ingroup kmac
+ *
+ * Calculate KMAC128 (Keccak Message Authentication Code, as defined in
+ * section 4 of [NIST SP 800-185][800-185]) of `n` messages with key in
+ * buffer `key` of length `key_len`, where message `i` is `lens[i]`
+ * bytes from `msgs[i]`, and write `dst_lens[i]` bytes of output for
+ * message `i` to `dsts[i]`.
+ *
+ * If `customs` is not `NULL`, then message `i` uses the customization
+ * string of `custom_lens[i]` bytes from `customs[i]`.  If `customs` is
+ * `NULL`, then every message uses an empty customization string, and
+ * the key is absorbed once and shared by every message.
+ *
+ * Messages (and, with per-message customization strings, the
+ * customization and key blocks) are absorbed with the multi-buffer
+ * permutation when the backend supports it (see `sha3_backend()`).
+ *
+ * @param[in] key Key.
+ * @param[in] key_len Key length, in bytes.
+ * @param[in] msgs Array of `n` input messages.
+ * @param[in] lens Array of `n` input message lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[in] customs Array of `n` customization strings (may be `NULL`).
+ * @param[in] custom_lens Array of `n` customization string lengths, in bytes (ignored if `customs` is `NULL`).
+ * @param[out] dsts Array of `n` destination buffers.
+ * @param[in] dst_lens Array of `n` destination buffer lengths, in bytes.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c kmac128_batch
+ *
+ * [800-185]: https://csrc.nist.gov/pubs/sp/800/185/final
+ *   "SHA-3 Derived Functions: cSHAKE, KMAC, TupleHash, and ParallelHash"
+ */
+void kmac128_batch(const uint8_t *key, const size_t key_len, const uint8_t * const msgs[], const size_t lens[], const size_t n, const uint8_t * const customs[], const size_t custom_lens[], uint8_t * const dsts[], const size_t dst_lens[]);
+
+/**
+ * @brief Calculate KMAC256 of a batch of messages with one key.
+ * @ingroup kmac
+ *
+ * Calculate KMAC256 (Keccak Message Authentication Code, as defined in
+ * section 4 of [NIST SP 800-185][800-185]) of `n` messages with key in
+ * buffer `key` of length `key_len`, where message `i` is `lens[i]`
+ * bytes from `msgs[i]`, and write `dst_lens[i]` bytes of output for
+ * message `i` to `dsts[i]`.
+ *
+ * If `customs` is not `NULL`, then message `i` uses the customization
+ * string of `custom_lens[i]` bytes from `customs[i]`.  If `customs` is
+ * `NULL`, then every message uses an empty customization string, and
+ * the key is absorbed once and shared by every message.
+ *
+ * Messages (and, with per-message customization strings, the
+ * customization and key blocks) are absorbed with the multi-buffer
+ * permutation when the backend supports it (see `sha3_backend()`).
+ *
+ * @param[in] key Key.
+ * @param[in] key_len Key length, in bytes.
+ * @param[in] msgs Array of `n` input messages.
+ * @param[in] lens Array of `n` input message lengths, in bytes.
+ * @param[in] n Number of messages.
+ * @param[in] customs Array of `n` customization strings (may be `NULL`).
+ * @param[in] custom_lens Array of `n` customization string lengths, in bytes (ignored if `customs` is `NULL`).
+ * @param[out] dsts Array of `n` destination buffers.
+ * @param[in] dst_lens Array of `n` destination buffer lengths, in bytes.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c kmac256_batch
+ *
+ * [800-185]: https://csrc.nist.gov/pubs/sp/800/185/final
+ *   "SHA-3 Derived Functions: cSHAKE, KMAC, TupleHash, and ParallelHash"
+ */
+void kmac256_batch(const uint8_t *key, const size_t key_len, const uint8_t * const msgs[], const size_t lens[], const size_t n, const uint8_t * const customs[], const size_t custom_lens[], uint8_t * const dsts[], const size_t dst_lens[]);
+
 /**
  * @brief Initialize KMAC128 [XOF][] context.
  * @ingroup kmac
@@ -1485,48 +2621,116 @@ void tuplehash128(const tuplehash_params_t params, uint8_t *dst, const size_t le
 void tuplehash256(const tuplehash_params_t params, uint8_t *dst, const size_t len);
 
 /**
- * @brief Initialize a TupleHash128 [XOF][] context.
+ * @brief Calculate TupleHash128 of each row of a table of [tuples][tuple].
  * @ingroup tuplehash
  *
- * Initialize TupleHash128 [XOF][] (TupleHash eXtendable Output
- * Function, as defined in section 5.3.1 of [NIST SP 800-185][800-185])
- * context with configuration parameters `params`.
+ * Calculate TupleHash128 ([NIST SP 800-185][800-185], section 5) of
+ * `num_rows` [tuples][tuple] of `num_cols` elements each, with
+ * customization string `custom` of length `custom_len`, and write `len`
+ * bytes of output for row `i` to `dsts[i]`.
  *
- * @note TupleHash128 and TupleHash128 [XOF][] produce different output,
- * because TupleHash128 encodes the fixed output size as part of the
- * input while TupleHash128 [XOF][] does not.  See section 5.3.1 of
- * [NIST SP 800-185][800-185] for details.
+ * `strs` is a column-major array of `num_rows * num_cols` elements:
+ * element `j` of row `i` is `strs[j * num_rows + i]`.
  *
- * @param[out] xof TupleHash128 [XOF][] context.
- * @param[in] params TupleHash configuration parameters.
+ * The shared initial state (function name and customization string) is
+ * calculated once, and rows are absorbed with the multi-buffer
+ * permutation when the backend supports it (see `sha3_backend()`).
+ *
+ * @param[in] strs Column-major array of `num_rows * num_cols` [tuple][] elements.
+ * @param[in] num_rows Number of rows.
+ * @param[in] num_cols Number of columns.
+ * @param[in] custom Customization string.
+ * @param[in] custom_len Customization string length, in bytes.
+ * @param[out] dsts Array of `num_rows` destination buffers.
+ * @param[in] len Destination buffer length, in bytes.
  *
  * Example:
- * @snippet{trimleft} 06-all/all-fns.c tuplehash128_xof
+ * @snippet{trimleft} 06-all/all-fns.c tuplehash128_batch
  *
  * [800-185]: https://csrc.nist.gov/pubs/sp/800/185/final
  *   "SHA-3 Derived Functions: cSHAKE, KMAC, TupleHash, and ParallelHash"
  * [tuple]: https://en.wikipedia.org/wiki/Tuple
  *   "Ordered list of elements."
- * [xof]: https://en.wikipedia.org/wiki/Extendable-output_function
- *   "Extendable-Output Function (XOF)"
  */
-void tuplehash128_xof_init(sha3_xof_t *xof, const tuplehash_params_t params);
+void tuplehash128_batch(const tuplehash_str_t *strs, const size_t num_rows, const size_t num_cols, const uint8_t *custom, const size_t custom_len, uint8_t * const dsts[], const size_t len);
 
 /**
- * @brief Squeeze data from TupleHash128 [XOF][] context.
+ * @brief Calculate TupleHash256 of each row of a table of [tuples][tuple].
  * @ingroup tuplehash
  *
- * Squeeze `len` bytes of output into destination buffer `dst` from
- * TupleHash128 [XOF][] context `xof`.  Can be called iteratively to
- * squeeze output data in chunks.
+ * Calculate TupleHash256 ([NIST SP 800-185][800-185], section 5) of
+ * `num_rows` [tuples][tuple] of `num_cols` elements each, with
+ * customization string `custom` of length `custom_len`, and write `len`
+ * bytes of output for row `i` to `dsts[i]`.
  *
- * @note TupleHash128 and TupleHash128 [XOF][] produce different output,
- * because TupleHash128 encodes the fixed output size as part of the
- * input while TupleHash128 [XOF][] does not.  See section 5.3.1 of
- * [NIST SP 800-185][800-185] for details.
+ * `strs` is a column-major array of `num_rows * num_cols` elements:
+ * element `j` of row `i` is `strs[j * num_rows + i]`.
  *
- * @param[in,out] xof TupleHash128 [XOF][] context.
- * @param[out] dst Destination buffer.
+ * The shared initial state (function name and customization string) is
+ * calculated once, and rows are absorbed with the multi-buffer
+ * permutation when the backend supports it (see `sha3_backend()`).
+ *
+ * @param[in] strs Column-major array of `num_rows * num_cols` [tuple][] elements.
+ * @param[in] num_rows Number of rows.
+ * @param[in] num_cols Number of columns.
+ * @param[in] custom Customization string.
+ * @param[in] custom_len Customization string length, in bytes.
+ * @param[out] dsts Array of `num_rows` destination buffers.
+ * @param[in] len Destination buffer length, in bytes.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c tuplehash256_batch
+ *
+ * [800-185]: https://csrc.nist.gov/pubs/sp/800/185/final
+ *   "SHA-3 Derived Functions: cSHAKE, KMAC, TupleHash, and ParallelHash"
+ * [tuple]: https://en.wikipedia.org/wiki/Tuple
+ *   "Ordered list of elements."
+ */
+void tuplehash256_batch(const tuplehash_str_t *strs, const size_t num_rows, const size_t num_cols, const uint8_t *custom, const size_t custom_len, uint8_t * const dsts[], const size_t len);
+
+/**
+ * @brief Initialize a TupleHash128 [XOF][] context.
+ * @ingroup tuplehash
+ *
+ * Initialize TupleHash128 [XOF][] (TupleHash eXtendable Output
+ * Function, as defined in section 5.3.1 of [NIST SP 800-185][800-185])
+ * context with configuration parameters `params`.
+ *
+ * @note TupleHash128 and TupleHash128 [XOF][] produce different output,
+ * because TupleHash128 encodes the fixed output size as part of the
+ * input while TupleHash128 [XOF][] does not.  See section 5.3.1 of
+ * [NIST SP 800-185][800-185] for details.
+ *
+ * @param[out] xof TupleHash128 [XOF][] context.
+ * @param[in] params TupleHash configuration parameters.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c tuplehash128_xof
+ *
+ * [800-185]: https://csrc.nist.gov/pubs/sp/800/185/final
+ *   "SHA-3 Derived Functions: cSHAKE, KMAC, TupleHash, and ParallelHash"
+ * [tuple]: https://en.wikipedia.org/wiki/Tuple
+ *   "Ordered list of elements."
+ * [xof]: https://en.wikipedia.org/wiki/Extendable-output_function
+ *   "Extendable-Output Function (XOF)"
+ */
+void tuplehash128_xof_init(sha3_xof_t *xof, const tuplehash_params_t params);
+
+/**
+ * @brief Squeeze data from TupleHash128 [XOF][] context.
+ * @ingroup tuplehash
+ *
+ * Squeeze `len` bytes of output into destination buffer `dst` from
+ * TupleHash128 [XOF][] context `xof`.  Can be called iteratively to
+ * squeeze output data in chunks.
+ *
+ * @note TupleHash128 and TupleHash128 [XOF][] produce different output,
+ * because TupleHash128 encodes the fixed output size as part of the
+ * input while TupleHash128 [XOF][] does not.  See section 5.3.1 of
+ * [NIST SP 800-185][800-185] for details.
+ *
+ * @param[in,out] xof TupleHash128 [XOF][] context.
+ * @param[out] dst Destination buffer.
  * @param[in] len Destination buffer length, in bytes.
  *
  * Example:
@@ -2265,6 +3469,100 @@ _Bool turboshake256_absorb(turboshake_t *ts, const uint8_t *src, const size_t le
  */
 void turboshake256_squeeze(turboshake_t *ts, uint8_t *dst, const size_t len);
 
+/**
+ * @brief Keyed TurboSHAKE128 hash key (all members are private).
+ * @ingroup turboshake
+ *
+ * Holds the TurboSHAKE128 state after absorbing the padded key, so the
+ * key is only processed once.  See `turboshake128_key_init()`.
+ */
+typedef struct {
+  sha3_state_t a; /**< State after absorbing padded key (private) */
+} turboshake128_key_t;
+
+/**
+ * @brief Initialize keyed TurboSHAKE128 hash key.
+ * @ingroup turboshake
+ *
+ * Absorb `bytepad(encode_string(k), 168)` (see [SP 800-185][800-185])
+ * into a TurboSHAKE128 state and save the state in `key`.
+ *
+ * The keyed hash of message `m` is the TurboSHAKE128 output of
+ * `bytepad(encode_string(k), 168) || m` with domain separation byte
+ * `0x0d`, read as little-endian 64-bit integers.  It is intended for
+ * DoS-resistant hash tables and Bloom filters, in place of SipHash.
+ *
+ * @param[out] key Keyed TurboSHAKE128 hash key.
+ * @param[in] k Key.
+ * @param[in] k_len Key length, in bytes.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c turboshake128_keyed
+ *
+ * [800-185]: https://csrc.nist.gov/pubs/sp/800/185/final
+ *   "SHA-3 Derived Functions: cSHAKE, KMAC, TupleHash, and ParallelHash"
+ */
+void turboshake128_key_init(turboshake128_key_t *key, const uint8_t *k, const size_t k_len);
+
+/**
+ * @brief Calculate 64-bit keyed TurboSHAKE128 hash.
+ * @ingroup turboshake
+ *
+ * Calculate keyed TurboSHAKE128 hash (see `turboshake128_key_init()`)
+ * of `len` bytes from `src` and return the first 64-bit value.
+ *
+ * @param[in] key Keyed TurboSHAKE128 hash key.
+ * @param[in] src Source buffer.
+ * @param[in] len Source buffer length, in bytes.
+ *
+ * @return 64-bit hash value.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c turboshake128_keyed
+ */
+uint64_t turboshake128_keyed_u64(const turboshake128_key_t *key, const uint8_t *src, const size_t len);
+
+/**
+ * @brief Calculate several 64-bit keyed TurboSHAKE128 hash values.
+ * @ingroup turboshake
+ *
+ * Calculate keyed TurboSHAKE128 hash (see `turboshake128_key_init()`)
+ * of `len` bytes from `src` and write the first `n` 64-bit values to
+ * `dst`.  Useful for Bloom filters which need several independent
+ * hash values per item.  Up to 21 values come from a single
+ * permutation.
+ *
+ * @param[in] key Keyed TurboSHAKE128 hash key.
+ * @param[in] src Source buffer.
+ * @param[in] len Source buffer length, in bytes.
+ * @param[out] dst Destination array of `n` 64-bit values.
+ * @param[in] n Number of values.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c turboshake128_keyed
+ */
+void turboshake128_keyed_u64s(const turboshake128_key_t *key, const uint8_t *src, const size_t len, uint64_t *dst, const size_t n);
+
+/**
+ * @brief Calculate 64-bit keyed TurboSHAKE128 hashes of eight messages.
+ * @ingroup turboshake
+ *
+ * Calculate keyed TurboSHAKE128 hash (see `turboshake128_key_init()`)
+ * of `lens[i]` bytes from `srcs[i]` and write the first 64-bit value
+ * to `dst[i]`.  The final permutations of the eight messages run
+ * together with the multi-buffer permutation when the backend
+ * supports it (see `sha3_backend()`).
+ *
+ * @param[in] key Keyed TurboSHAKE128 hash key.
+ * @param[in] srcs Array of 8 source buffers.
+ * @param[in] lens Array of 8 source buffer lengths, in bytes.
+ * @param[out] dst Array of 8 64-bit hash values.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c turboshake128_keyed
+ */
+void turboshake128_keyed_u64_x8(const turboshake128_key_t *key, const uint8_t * const srcs[8], const size_t lens[8], uint64_t dst[8]);
+
 /**
  * @defgroup k12 KangarooTwelve
  * @brief Faster, reduced-round [XOF][] with a customzation string, as
@@ -2367,6 +3665,623 @@ void k12_init(k12_t *k12, const uint8_t *src, const size_t src_len, const uint8_
  */
 void k12_squeeze(k12_t *k12, uint8_t *dst, const size_t len);
 
+/**
+ * @defgroup multi Multi-Digest
+ * @brief Calculate several hashes and [XOF][] outputs of the same input
+ * in a single pass.
+ *
+ * Each chunk of input is absorbed into every selected algorithm while
+ * it is still in cache, so large inputs only need to be read once.
+ * Algorithms with the same rate and number of rounds (for example,
+ * SHA3-256 and SHAKE256) share a single internal state and only differ
+ * when they are finalized, so they only pay the absorb cost once.
+ *
+ * [xof]: https://en.wikipedia.org/wiki/Extendable-output_function
+ *   "Extendable-Output Function (XOF)"
+ */
+
+/**
+ * @brief Multi-digest algorithm identifier.
+ * @ingroup multi
+ */
+typedef enum {
+  SHA3_ALGO_SHA3_224, /**< SHA3-224 */
+  SHA3_ALGO_SHA3_256, /**< SHA3-256 */
+  SHA3_ALGO_SHA3_384, /**< SHA3-384 */
+  SHA3_ALGO_SHA3_512, /**< SHA3-512 */
+  SHA3_ALGO_SHAKE128, /**< SHAKE128 */
+  SHA3_ALGO_SHAKE256, /**< SHAKE256 */
+  SHA3_ALGO_TURBOSHAKE128, /**< TurboSHAKE128 (default padding byte) */
+  SHA3_ALGO_TURBOSHAKE256, /**< TurboSHAKE256 (default padding byte) */
+  SHA3_ALGO_LAST, /**< Number of algorithms (not a valid algorithm) */
+} sha3_algo_t;
+
+/**
+ * @brief Maximum number of algorithms in a multi-digest context.
+ * @ingroup multi
+ */
+#define SHA3_MULTI_MAX_ALGOS 8
+
+/**
+ * @brief Multi-digest context (all members are private).
+ * @ingroup multi
+ */
+typedef struct {
+  struct {
+    size_t num_bytes; /**< number of bytes absorbed */
+    sha3_state_t a; /**< internal state */
+  } states[SHA3_MULTI_MAX_ALGOS]; /**< one state per distinct rate and round count */
+  uint8_t algos[SHA3_MULTI_MAX_ALGOS]; /**< algorithm IDs */
+  uint8_t state_ids[SHA3_MULTI_MAX_ALGOS]; /**< state index of each algorithm */
+  size_t num_algos, /**< number of algorithms */
+         num_states; /**< number of distinct states */
+  _Bool finalized; /**< mode (absorbing or finalized) */
+} sha3_multi_t;
+
+/**
+ * @brief Initialize multi-digest context.
+ * @ingroup multi
+ *
+ * Initialize multi-digest context `ctx` which calculates the algorithms
+ * in `algos` (an array of `num_algos` algorithm IDs) in a single pass.
+ *
+ * @param[out] ctx Multi-digest context.
+ * @param[in] algos Array of algorithm IDs.
+ * @param[in] num_algos Number of algorithm IDs.
+ *
+ * @return False if `num_algos` is zero, `num_algos` is greater than
+ * `SHA3_MULTI_MAX_ALGOS`, or `algos` contains an invalid algorithm ID,
+ * and true otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_multi
+ */
+_Bool sha3_multi_init(sha3_multi_t *ctx, const sha3_algo_t *algos, const size_t num_algos);
+
+/**
+ * @brief Absorb data into multi-digest context.
+ * @ingroup multi
+ *
+ * Absorb `len` bytes of input data from `src` into every algorithm of
+ * multi-digest context `ctx`.  Can be called iteratively to absorb
+ * input data in chunks.
+ *
+ * @param[in,out] ctx Multi-digest context.
+ * @param[in] src Source buffer.
+ * @param[in] len Source buffer length, in bytes.
+ *
+ * @return False if the context has already been finalized, and true
+ * otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_multi
+ */
+_Bool sha3_multi_absorb(sha3_multi_t *ctx, const uint8_t *src, const size_t len);
+
+/**
+ * @brief Get output of algorithm from multi-digest context.
+ * @ingroup multi
+ *
+ * Finalize multi-digest context `ctx` (if necessary), then write the
+ * first `dst_len` bytes of output of the algorithm at offset `i` of the
+ * algorithm list passed to `sha3_multi_init()` to `dst`.
+ *
+ * For the fixed-length SHA3 algorithms, `dst_len` is clamped to the
+ * digest size.  Can be called for each algorithm, in any order.
+ *
+ * @param[in,out] ctx Multi-digest context.
+ * @param[in] i Algorithm offset.
+ * @param[out] dst Destination buffer.
+ * @param[in] dst_len Destination buffer length, in bytes.
+ *
+ * @return False if `i` is out of range, and true otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_multi
+ */
+_Bool sha3_multi_final(sha3_multi_t *ctx, const size_t i, uint8_t *dst, const size_t dst_len);
+
+/**
+ * @defgroup mgr Job Manager
+ * @brief Hash messages which arrive one at a time with the multi-buffer
+ * backends.
+ *
+ * The job manager keeps one message per lane of the multi-buffer
+ * permutation.  Submitted jobs wait in a lane until every lane is busy,
+ * then all lanes are permuted together until at least one job
+ * finishes.  Finished lanes are refilled by the next submitted job, so
+ * short messages do not wait for the longest message in the batch.
+ *
+ * Jobs are returned in the order they finish, which is not necessarily
+ * the order they were submitted.  Use `sha3_job_t.user_data` to match
+ * returned jobs to requests.
+ *
+ * If the maximum latency passed to `sha3_mgr_init()` is non-zero, then
+ * `sha3_mgr_submit()` and `sha3_mgr_poll()` also run partially-filled
+ * batches once the oldest job in the manager has waited longer than the
+ * maximum latency.
+ */
+
+/**
+ * @brief Maximum number of lanes in a job manager.
+ * @ingroup mgr
+ */
+#define SHA3_MGR_MAX_LANES 8
+
+/**
+ * @brief Job manager job.
+ * @ingroup mgr
+ *
+ * The input and output buffers must remain valid until the job is
+ * returned by the job manager.
+ */
+typedef struct {
+  const uint8_t *src; /**< Input message */
+  size_t len; /**< Input message length, in bytes */
+  uint8_t *dst; /**< Output buffer */
+  size_t dst_len; /**< Output length, in bytes (ignored for SHA3) */
+  void *user_data; /**< Caller data (not used by the job manager) */
+} sha3_job_t;
+
+/**
+ * @brief Job manager context (all members are private).
+ * @ingroup mgr
+ */
+typedef struct {
+  sha3_state_t a[SHA3_MGR_MAX_LANES]; /**< lane states */
+  struct {
+    sha3_job_t *job; /**< job */
+    const uint8_t *ptr; /**< remaining input */
+    size_t len; /**< length of remaining input */
+    uint64_t time; /**< submission time, in microseconds */
+  } lanes[SHA3_MGR_MAX_LANES]; /**< busy lanes */
+  sha3_job_t *done[SHA3_MGR_MAX_LANES]; /**< finished jobs */
+  size_t num_lanes, /**< number of busy lanes */
+         done_ofs, /**< offset of first finished job */
+         num_done; /**< number of finished jobs */
+  uint64_t max_latency; /**< maximum latency, in microseconds */
+  uint8_t algo; /**< algorithm ID */
+} sha3_mgr_t;
+
+/**
+ * @brief Initialize job manager.
+ * @ingroup mgr
+ *
+ * Initialize job manager `mgr` which hashes jobs with algorithm `algo`.
+ *
+ * If `max_latency` is non-zero, then jobs are run without waiting for
+ * every lane to be busy once the oldest job has waited for more than
+ * `max_latency` microseconds.  If `max_latency` is zero, then jobs wait
+ * until every lane is busy or the manager is flushed.
+ *
+ * @param[out] mgr Job manager.
+ * @param[in] algo Algorithm ID.
+ * @param[in] max_latency Maximum latency, in microseconds (0 to disable).
+ *
+ * @return False if `algo` is invalid, and true otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_mgr
+ */
+_Bool sha3_mgr_init(sha3_mgr_t *mgr, const sha3_algo_t algo, const uint64_t max_latency);
+
+/**
+ * @brief Submit job to job manager.
+ * @ingroup mgr
+ *
+ * Add job `job` to a free lane of job manager `mgr`.  If every lane is
+ * busy (or the maximum latency has expired), then permute the lanes
+ * until at least one job finishes.
+ *
+ * @param[in,out] mgr Job manager.
+ * @param[in] job Job.
+ *
+ * @return Finished job, or `NULL` if no job has finished yet.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_mgr
+ */
+sha3_job_t *sha3_mgr_submit(sha3_mgr_t *mgr, sha3_job_t *job);
+
+/**
+ * @brief Return finished job if maximum latency has expired.
+ * @ingroup mgr
+ *
+ * Return a previously finished job from job manager `mgr`, if there is
+ * one.  Otherwise, if the oldest job in the manager has waited for more
+ * than the maximum latency, permute the lanes until at least one job
+ * finishes and return it.
+ *
+ * Call periodically (e.g. from an event loop timeout) when jobs may
+ * stop arriving.
+ *
+ * @param[in,out] mgr Job manager.
+ *
+ * @return Finished job, or `NULL` if no job is ready.
+ */
+sha3_job_t *sha3_mgr_poll(sha3_mgr_t *mgr);
+
+/**
+ * @brief Flush job manager.
+ * @ingroup mgr
+ *
+ * Return the next finished job from job manager `mgr`, permuting
+ * partially-filled lanes if necessary.  Call repeatedly until it
+ * returns `NULL` to drain the manager.
+ *
+ * @param[in,out] mgr Job manager.
+ *
+ * @return Finished job, or `NULL` if the manager is empty.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_mgr
+ */
+sha3_job_t *sha3_mgr_flush(sha3_mgr_t *mgr);
+
+/**
+ * @defgroup merkle Merkle Tree
+ * @brief Build [Merkle trees][merkle], generate inclusion proofs, and
+ * verify batches of inclusion proofs.
+ *
+ * Leaves are hashed as `H(0x00 || leaf)` and interior nodes as
+ * `H(0x01 || left || right)`, so a leaf can never be mistaken for an
+ * interior node.  If a level has an odd number of nodes, then the last
+ * node is promoted to the next level unchanged.  Every node is 32
+ * bytes.
+ *
+ * The leaf hashes and the nodes of each level are independent, so they
+ * are hashed with the multi-buffer permutation when the backend
+ * supports it (see `sha3_backend()`).  Batches of proofs are verified
+ * one level at a time for the same reason.
+ *
+ * Supported hash functions: `SHA3_ALGO_SHA3_256`, `SHA3_ALGO_SHAKE128`,
+ * `SHA3_ALGO_SHAKE256`, `SHA3_ALGO_TURBOSHAKE128`, and
+ * `SHA3_ALGO_TURBOSHAKE256` (XOFs produce 32 bytes of output).
+ *
+ * [merkle]: https://en.wikipedia.org/wiki/Merkle_tree
+ *   "Merkle tree"
+ */
+
+/**
+ * @brief Maximum number of hashes in a Merkle tree inclusion proof.
+ * @ingroup merkle
+ */
+#define SHA3_MERKLE_MAX_DEPTH 64
+
+/**
+ * @brief Merkle tree (all members are private).
+ * @ingroup merkle
+ */
+typedef struct {
+  uint8_t *nodes; /**< 32 byte nodes, one level after another (leaf hashes first, root last) */
+  size_t num_leaves; /**< number of leaves */
+  uint8_t algo; /**< algorithm ID */
+} sha3_merkle_t;
+
+/**
+ * @brief Merkle tree leaf callback.
+ * @ingroup merkle
+ *
+ * Set `ptr` and `len` to the contents of leaf `i`.  The contents must
+ * remain valid until the tree is built.
+ *
+ * The callback is called exactly once for each leaf, in increasing
+ * order of `i`.
+ */
+typedef void (*sha3_merkle_leaf_cb_t)(void *cb_data, const size_t i, const uint8_t **ptr, size_t *len);
+
+/**
+ * @brief Get number of nodes in a Merkle tree.
+ * @ingroup merkle
+ *
+ * Get the number of 32 byte nodes in a Merkle tree with `num_leaves`
+ * leaves (at most `2 * num_leaves`).
+ *
+ * @param[in] num_leaves Number of leaves.
+ *
+ * @return Number of nodes.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_merkle
+ */
+size_t sha3_merkle_num_nodes(const size_t num_leaves);
+
+/**
+ * @brief Build Merkle tree from array of leaves.
+ * @ingroup merkle
+ *
+ * Build Merkle tree `tree` with hash function `algo` over `num_leaves`
+ * leaves, where leaf `i` is `lens[i]` bytes from `leaves[i]`.
+ *
+ * `nodes` is a caller-provided buffer of `32 * sha3_merkle_num_nodes(num_leaves)`
+ * bytes, which must remain valid while the tree is in use.
+ *
+ * @param[out] tree Merkle tree.
+ * @param[in] algo Hash function.
+ * @param[in] leaves Array of `num_leaves` leaves.
+ * @param[in] lens Array of `num_leaves` leaf lengths, in bytes.
+ * @param[in] num_leaves Number of leaves.
+ * @param[out] nodes Node buffer.
+ *
+ * @return False if `algo` is not supported or `num_leaves` is zero, and
+ * true otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_merkle
+ */
+_Bool sha3_merkle_build(sha3_merkle_t *tree, const sha3_algo_t algo, const uint8_t * const leaves[], const size_t lens[], const size_t num_leaves, uint8_t *nodes);
+
+/**
+ * @brief Build Merkle tree from leaf callback.
+ * @ingroup merkle
+ *
+ * Build Merkle tree `tree` with hash function `algo` over `num_leaves`
+ * leaves, where the contents of each leaf are returned by callback
+ * `cb`.  Useful for large trees where building arrays of leaf pointers
+ * and lengths is inconvenient.
+ *
+ * See `sha3_merkle_build()` for the `nodes` buffer.
+ *
+ * @param[out] tree Merkle tree.
+ * @param[in] algo Hash function.
+ * @param[in] cb Leaf callback.
+ * @param[in] cb_data Leaf callback data.
+ * @param[in] num_leaves Number of leaves.
+ * @param[out] nodes Node buffer.
+ *
+ * @return False if `algo` is not supported or `num_leaves` is zero, and
+ * true otherwise.
+ */
+_Bool sha3_merkle_build_cb(sha3_merkle_t *tree, const sha3_algo_t algo, sha3_merkle_leaf_cb_t cb, void *cb_data, const size_t num_leaves, uint8_t *nodes);
+
+/**
+ * @brief Get root of Merkle tree.
+ * @ingroup merkle
+ *
+ * @param[in] tree Merkle tree.
+ *
+ * @return Pointer to 32 byte root hash.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_merkle
+ */
+const uint8_t *sha3_merkle_root(const sha3_merkle_t *tree);
+
+/**
+ * @brief Get inclusion proof for leaf of Merkle tree.
+ * @ingroup merkle
+ *
+ * Write the 32 byte sibling hashes on the path from leaf `i` of Merkle
+ * tree `tree` to the root to `proof`, and write the number of hashes to
+ * `proof_len`.
+ *
+ * @param[in] tree Merkle tree.
+ * @param[in] i Leaf index.
+ * @param[out] proof Proof buffer.  Must be at least `32 * SHA3_MERKLE_MAX_DEPTH` bytes in length.
+ * @param[out] proof_len Number of hashes written to `proof`.
+ *
+ * @return False if `i` is out of range, and true otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_merkle
+ */
+_Bool sha3_merkle_proof(const sha3_merkle_t *tree, const size_t i, uint8_t *proof, size_t *proof_len);
+
+/**
+ * @brief Verify Merkle tree inclusion proof.
+ * @ingroup merkle
+ *
+ * Check that leaf `leaf` of length `leaf_len` bytes is leaf `i` of a
+ * Merkle tree with `num_leaves` leaves, hash function `algo`, and root
+ * `root`, using inclusion proof `proof` of `proof_len` hashes.
+ *
+ * @param[in] algo Hash function.
+ * @param[in] root 32 byte root hash.
+ * @param[in] num_leaves Number of leaves in tree.
+ * @param[in] i Leaf index.
+ * @param[in] leaf Leaf.
+ * @param[in] leaf_len Leaf length, in bytes.
+ * @param[in] proof Inclusion proof (`proof_len` 32 byte hashes).
+ * @param[in] proof_len Number of hashes in inclusion proof.
+ *
+ * @return True if the proof is valid, and false otherwise.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_merkle
+ */
+_Bool sha3_merkle_verify(const sha3_algo_t algo, const uint8_t root[32], const size_t num_leaves, const size_t i, const uint8_t *leaf, const size_t leaf_len, const uint8_t *proof, const size_t proof_len);
+
+/**
+ * @brief Verify batch of Merkle tree inclusion proofs.
+ * @ingroup merkle
+ *
+ * Verify `n` inclusion proofs against a Merkle tree with `num_leaves`
+ * leaves, hash function `algo`, and root `root`.  Proof `j` claims that
+ * `lens[j]` bytes from `leaves[j]` is leaf `indices[j]`, with
+ * `proof_lens[j]` hashes from `proofs[j]`.
+ *
+ * If `oks` is not `NULL`, then the result for proof `j` is written to
+ * `oks[j]`.
+ *
+ * @param[in] algo Hash function.
+ * @param[in] root 32 byte root hash.
+ * @param[in] num_leaves Number of leaves in tree.
+ * @param[in] n Number of proofs.
+ * @param[in] indices Array of `n` leaf indices.
+ * @param[in] leaves Array of `n` leaves.
+ * @param[in] lens Array of `n` leaf lengths, in bytes.
+ * @param[in] proofs Array of `n` inclusion proofs.
+ * @param[in] proof_lens Array of `n` inclusion proof lengths, in hashes.
+ * @param[out] oks Array of `n` results (optional, may be `NULL`).
+ *
+ * @return True if every proof is valid, and false otherwise.
+ */
+_Bool sha3_merkle_verify_batch(const sha3_algo_t algo, const uint8_t root[32], const size_t num_leaves, const size_t n, const size_t indices[], const uint8_t * const leaves[], const size_t lens[], const uint8_t * const proofs[], const size_t proof_lens[], _Bool oks[]);
+
+/**
+ * @defgroup sponge Sponge
+ * @brief Raw Keccak-p[1600, n] permutation, and [sponge][] and
+ * [duplex][] constructions with a configurable rate, number of rounds,
+ * and padding byte.
+ *
+ * These are building blocks for protocols which need a custom
+ * construction (e.g. transcript hashing or domain-separated XOFs).
+ * They use the same backend as the rest of the library (see
+ * `sha3_backend()`).
+ *
+ * [sponge]: https://en.wikipedia.org/wiki/Sponge_function
+ *   "Sponge function"
+ * [duplex]: https://keccak.team/files/SpongeDuplex.pdf
+ *   "Duplexing the sponge"
+ */
+
+/**
+ * @brief Apply Keccak-p[1600, n] permutation to state.
+ * @ingroup sponge
+ *
+ * Apply the last `num_rounds` rounds of the 24 round Keccak-f[1600]
+ * permutation to the 25 64-bit lanes of state `s`, as defined in
+ * section 3.3 of [FIPS 202][].  For example, 24 rounds is the
+ * permutation used by SHA-3 and SHAKE, and 12 rounds is the permutation
+ * used by TurboSHAKE and KangarooTwelve.
+ *
+ * Lane `i` of the state is stored in `s[i]` in host byte order, which
+ * matches the byte order of the state used by the hash functions on
+ * little-endian systems.
+ *
+ * @param[in,out] s Keccak state (array of 25 64-bit integers).
+ * @param[in] num_rounds Number of rounds, in the range [0, 24].
+ *
+ * @return True if the state was permuted, or false if `num_rounds` is
+ * greater than 24 (the state is not modified).
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c keccak_p1600
+ *
+ * [FIPS 202]: https://nvlpubs.nist.gov/nistpubs/FIPS/NIST.FIPS.202.pdf
+ *   "SHA-3 Standard: Permutation-Based Hash and Extendable-Output Functions"
+ */
+_Bool keccak_p1600(uint64_t s[25], const unsigned num_rounds);
+
+/**
+ * @brief Sponge context (all members are private).
+ * @ingroup sponge
+ */
+typedef struct {
+  sha3_state_t a; /**< internal state */
+  size_t num_bytes; /**< number of bytes absorbed or squeezed */
+  size_t rate; /**< rate, in bytes */
+  unsigned num_rounds; /**< number of permutation rounds */
+  uint8_t pad; /**< padding byte */
+  uint8_t mode; /**< mode (unused, absorbing, squeezing, or duplexing) */
+} sha3_sponge_t;
+
+/**
+ * @brief Initialize sponge context.
+ * @ingroup sponge
+ *
+ * Initialize sponge context with rate `rate` (in bytes), a Keccak-p
+ * permutation with `num_rounds` rounds, and padding byte `pad`.
+ *
+ * The padding byte contains the domain separation bits followed by the
+ * first bit of the `pad10*1` padding, in the same format as the
+ * TurboSHAKE padding byte.  For example:
+ *
+ * - SHA-3 (`rate = 200 - 2 * digest length`, 24 rounds): `0x06`
+ * - SHAKE128/SHAKE256 (`rate = 168/136`, 24 rounds): `0x1F`
+ * - TurboSHAKE128/TurboSHAKE256 (`rate = 168/136`, 12 rounds): `0x01`
+ *   to `0x7F` (default: `0x1F`)
+ * - Original Keccak (24 rounds): `0x01`
+ *
+ * @param[out] sponge Sponge context.
+ * @param[in] rate Rate, in bytes, in the range [1, 199].
+ * @param[in] num_rounds Number of rounds, in the range [1, 24].
+ * @param[in] pad Padding byte, in the range [0x01, 0x7F].
+ *
+ * @return True if the context was initialized, or false if a parameter
+ * is out of range.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_sponge
+ */
+_Bool sha3_sponge_init(sha3_sponge_t *sponge, const size_t rate, const unsigned num_rounds, const uint8_t pad);
+
+/**
+ * @brief Absorb data into sponge context.
+ * @ingroup sponge
+ *
+ * Absorb `src_len` bytes of input from source buffer `src` into sponge
+ * context `sponge`.  Can be called iteratively to absorb input data in
+ * chunks.
+ *
+ * @param[in,out] sponge Sponge context.
+ * @param[in] src Source buffer.
+ * @param[in] src_len Source buffer length, in bytes.
+ *
+ * @return True if the data was absorbed, or false if the sponge has
+ * already been squeezed or used for duplex calls.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_sponge
+ */
+_Bool sha3_sponge_absorb(sha3_sponge_t *sponge, const uint8_t *src, const size_t src_len);
+
+/**
+ * @brief Squeeze data from sponge context.
+ * @ingroup sponge
+ *
+ * Squeeze `dst_len` bytes of output into destination buffer `dst` from
+ * sponge context `sponge`.  On the first call, the absorbed input is
+ * padded with the padding byte and the sponge switches from absorbing
+ * to squeezing.  Can be called iteratively to squeeze output data in
+ * chunks.
+ *
+ * @param[in,out] sponge Sponge context.
+ * @param[out] dst Destination buffer.
+ * @param[in] dst_len Destination buffer length, in bytes.
+ *
+ * @return True if the data was squeezed, or false if the sponge has
+ * been used for duplex calls.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_sponge
+ */
+_Bool sha3_sponge_squeeze(sha3_sponge_t *sponge, uint8_t *dst, const size_t dst_len);
+
+/**
+ * @brief Duplex call: absorb and pad a block, permute, then squeeze.
+ * @ingroup sponge
+ *
+ * Absorb `src_len` bytes of input from source buffer `src` into sponge
+ * context `sponge`, append the padding byte and the final padding bit,
+ * apply the permutation, and then copy the first `dst_len` bytes of the
+ * state to destination buffer `dst`.  This is the `duplexing()` call
+ * of the [duplex construction][duplex]; a sequence of duplex calls
+ * produces output which depends on all previous inputs.
+ *
+ * A sponge context used for duplex calls must not also be used with
+ * `sha3_sponge_absorb()` or `sha3_sponge_squeeze()`.
+ *
+ * @param[in,out] sponge Sponge context.
+ * @param[in] src Source buffer.
+ * @param[in] src_len Source buffer length, in bytes.  Must be less than
+ * the rate.
+ * @param[out] dst Destination buffer (may be `NULL` if `dst_len` is 0).
+ * @param[in] dst_len Destination buffer length, in bytes.  Must be less
+ * than or equal to the rate.
+ *
+ * @return True on success, or false if `src_len` or `dst_len` is too
+ * long or if the sponge context has been used with
+ * `sha3_sponge_absorb()` or `sha3_sponge_squeeze()`.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_sponge_duplex
+ *
+ * [duplex]: https://keccak.team/files/SpongeDuplex.pdf
+ *   "Duplexing the sponge"
+ */
+_Bool sha3_sponge_duplex(sha3_sponge_t *sponge, const uint8_t *src, const size_t src_len, uint8_t *dst, const size_t dst_len);
+
 /**
  * @defgroup misc Miscellaneous
  * @brief Miscellaneous functions.
@@ -2384,6 +4299,54 @@ void k12_squeeze(k12_t *k12, uint8_t *dst, const size_t len);
  */
 const char *sha3_backend(void);
 
+/**
+ * @brief Get number of states permuted together by batch functions.
+ * @ingroup misc
+ *
+ * Get the number of independent Keccak states which the multi-buffer
+ * permutation of the active backend permutes at once (e.g. 8 for the
+ * AVX-512 backend, 4 for the AVX2 backend, or 1 if the backend has no
+ * multi-buffer permutation).  Batch functions (`sha3_256_batch()`,
+ * etc), the job manager, and KangarooTwelve are most efficient when the
+ * number of messages is a multiple of this value.
+ *
+ * @return Number of states.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_batch_lanes
+ */
+size_t sha3_batch_lanes(void);
+
+/**
+ * @brief Use 256-bit AVX-512VL permutation instead of 512-bit
+ * AVX-512 permutation.
+ * @ingroup misc
+ *
+ * On some Intel CPUs (e.g. Skylake-SP and Cascade Lake), 512-bit
+ * AVX-512 instructions lower the core clock frequency, which also
+ * slows down unrelated code running on the same core.  If `enable` is
+ * true, then the AVX-512 backend uses a permutation which only
+ * uses 256-bit AVX-512VL instructions, and the batch functions use a
+ * 4-way 256-bit multi-buffer kernel instead of the 8-way 512-bit
+ * multi-buffer kernel (see `sha3_batch_lanes()`).  If `enable` is
+ * false, then the default 512-bit permutation is used.
+ *
+ * This setting is global.  It should be changed before other threads
+ * call any functions in this library.
+ *
+ * When enabled, `sha3_backend()` returns `"avx512-ymm"`.
+ *
+ * @param[in] enable True to use 256-bit permutation, false to use
+ * 512-bit permutation.
+ *
+ * @return True if the setting was applied, or false if the backend is
+ * not the AVX-512 backend or the CPU does not support AVX-512VL.
+ *
+ * Example:
+ * @snippet{trimleft} 06-all/all-fns.c sha3_avx512_ymm
+ */
+_Bool sha3_avx512_ymm(const _Bool enable);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -13,9 +13,9 @@
 // https://cpucycles.cr.yp.to/security.html
 //
 
-#include <stdlib.h> // exit(), qsort()
+#include <stdlib.h> // exit(), qsort(), getenv()
 #include <stdio.h> // printf()
-#include <string.h> // memcmp()
+#include <string.h> // memcmp(), strcmp()
 #include <math.h> // sqrt(), pow()
 #include <cpucycles.h> // cpucycles()
 #include "sha3.h" // sha3_*(), shake*()
@@ -25,7 +25,9 @@
 #define NUM_TRIALS 2000
 
 // input sizes (used for hashes and xofs)
-static const size_t SRC_LENS[] = { 64, 256, 1024, 4096, 16384 };
+// (65536 is 8 kangarootwelve chunks, so the k12 row covers batched
+// leaves)
+static const size_t SRC_LENS[] = { 64, 256, 1024, 4096, 16384, 65536 };
 #define NUM_SRC_LENS (sizeof(SRC_LENS)/sizeof(SRC_LENS[0]))
 
 // output sizes (used for xofs)
@@ -169,15 +171,100 @@ static stats_t get_stats(long long * const vals, const size_t num_vals, const si
     free(dst); \
   }
 
+// number of messages hashed per trial by batch benchmarks.  least
+// common multiple of the avx2 (4), hybrid avx2 (5), avx512 (8), and
+// hybrid avx512 (9) multi-buffer lane counts, so every backend only
+// runs full groups.
+#define BATCH_SIZE 360
+
+// define batch hash benchmark function.  cpb is per message byte
+// (total cycles divided by BATCH_SIZE * src_len).
+#define DEF_BENCH_BATCH(FN, OUT_LEN) \
+  static void bench_ ## FN (double * const cpbs, const size_t num_trials) { \
+    /* allocate times, src, and dst buffers */ \
+    long long *times = checked_calloc(__func__, num_trials, sizeof(long long)); \
+    uint8_t *src = checked_calloc(__func__, BATCH_SIZE, get_max_src_len()); \
+    uint8_t *dst = checked_calloc(__func__, BATCH_SIZE, OUT_LEN); \
+    \
+    /* populate source and destination pointers */ \
+    const uint8_t *srcs[BATCH_SIZE]; \
+    uint8_t *dsts[BATCH_SIZE]; \
+    size_t lens[BATCH_SIZE]; \
+    for (size_t i = 0; i < BATCH_SIZE; i++) { \
+      srcs[i] = src + i * get_max_src_len(); \
+      dsts[i] = dst + i * OUT_LEN; \
+    } \
+    \
+    for (size_t i = 0; i < NUM_SRC_LENS; i++) { \
+      const size_t src_len = SRC_LENS[i]; /* get source length */ \
+      for (size_t j = 0; j < BATCH_SIZE; j++) { \
+        lens[j] = src_len; \
+      } \
+      \
+      /* generate random source data (once per length, because */ \
+      /* generating BATCH_SIZE messages per trial dominates run time) */ \
+      for (size_t k = 0; k < BATCH_SIZE; k++) { \
+        rand_bytes(src + k * get_max_src_len(), src_len); \
+      } \
+      \
+      /* run trials */ \
+      for (size_t j = 0; j < num_trials; j++) { \
+        /* call function */ \
+        const long long t0 = cpucycles(); \
+        FN (srcs, lens, BATCH_SIZE, dsts); \
+        const long long t1 = cpucycles() - t0; \
+        \
+        /* save time */ \
+        times[j] = t1; \
+      } \
+      \
+      /* generate summary stats, save cpb */ \
+      cpbs[i] = 1.0 * get_stats(times, num_trials, BATCH_SIZE * src_len).median_cpb; \
+    } \
+    \
+    /* free buffers */ \
+    free(times); \
+    free(src); \
+    free(dst); \
+  }
+
+// number of scalar integer iterations run after each hash by the
+// co-workload benchmark
+#define COWORK_NUM_ITERS 10000
+
+// Hash message with sha3-256, then run a loop of scalar integer work
+// which depends on the hash.  Used by the co-workload benchmark to
+// measure how the permutation slows down unrelated code on the same
+// core (e.g. AVX-512 frequency drops); compare runs with and without
+// AVX512_YMM=1.
+static void sha3_256_cowork(const uint8_t *src, const size_t src_len, uint8_t dst[static 32]) {
+  sha3_256(src, src_len, dst);
+
+  // xorshift64 (serial dependency chain, not vectorized)
+  uint64_t x = dst[0] | 1;
+  for (size_t i = 0; i < COWORK_NUM_ITERS; i++) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+  }
+  dst[0] ^= x & 0xff;
+}
+
 // define xof benchmarks
 DEF_BENCH_XOF(shake128)
 DEF_BENCH_XOF(shake256)
+DEF_BENCH_XOF(turboshake128)
+DEF_BENCH_XOF(k12_once)
 
 // define hash benchmarks
 DEF_BENCH_HASH(sha3_224, 28)
 DEF_BENCH_HASH(sha3_256, 32)
 DEF_BENCH_HASH(sha3_384, 48)
 DEF_BENCH_HASH(sha3_512, 64)
+DEF_BENCH_HASH(sha3_256_cowork, 32)
+
+// define batch hash benchmarks
+DEF_BENCH_BATCH(sha3_256_batch, 32)
 
 // print function stats to standard output as CSV row.
 static void print_row(const char *name, const size_t dst_len, double * const cpbs) {
@@ -199,6 +286,14 @@ int main(int argc, char *argv[]) {
     return -1;
   }
 
+  // use 256-bit avx512 permutation if the AVX512_YMM environment
+  // variable is set to "1" (see sha3_avx512_ymm())
+  const char * const ymm = getenv("AVX512_YMM");
+  if (ymm && !strcmp(ymm, "1") && !sha3_avx512_ymm(1)) {
+    fprintf(stderr, "AVX512_YMM=1 requires avx512 backend with AVX-512VL\n");
+    return -1;
+  }
+
   // print metadata to stderr
   fprintf(stderr,"info: cpucycles: version=%s implementation=%s persecond=%lld\ninfo: backend=%s num_trials=%zu src_lens", cpucycles_version(), cpucycles_implementation(), cpucycles_persecond(), sha3_backend(), num_trials);
   for (size_t i = 0; i < NUM_SRC_LENS; i++) {
@@ -233,6 +328,14 @@ int main(int argc, char *argv[]) {
   bench_sha3_512(cpbs, num_trials);
   print_row("sha3_512", 64, cpbs);
 
+  // sha3-256 batch
+  bench_sha3_256_batch(cpbs, num_trials);
+  print_row("sha3_256_batch", 32, cpbs);
+
+  // sha3-256 followed by scalar co-workload
+  bench_sha3_256_cowork(cpbs, num_trials);
+  print_row("sha3_256_cowork", 32, cpbs);
+
   // test xofs
   for (size_t i = 0; i < NUM_DST_LENS; i++) {
     const size_t dst_len = DST_LENS[i];
@@ -244,6 +347,14 @@ int main(int argc, char *argv[]) {
     // shake256
     bench_shake256(cpbs, num_trials, dst_len);
     print_row("shake256", dst_len, cpbs);
+
+    // turboshake128 (12 rounds; compare with 24 round shake128)
+    bench_turboshake128(cpbs, num_trials, dst_len);
+    print_row("turboshake128", dst_len, cpbs);
+
+    // kangarootwelve (12 round leaves are permuted in batches)
+    bench_k12_once(cpbs, num_trials, dst_len);
+    print_row("k12", dst_len, cpbs);
   }
 
   // return success
@@ -0,0 +1,228 @@
+// test neon-sha3 backend (ARMv8.2 SHA3 extension) against scalar
+// counterparts.
+//
+// sha3.c is included directly (built with BACKEND=10, see Makefile), so
+// the code under test is the same code used by the library.
+
+#include <stdio.h> // fprintf()
+#include <stdint.h> // uint64_t
+#include <string.h> // memcmp(), memcpy()
+#include <inttypes.h> // PRIx64
+#include "sha3.c"
+
+#if BACKEND != BACKEND_NEON_SHA3
+#error "BACKEND must be 10 (neon-sha3)"
+#endif /* BACKEND != BACKEND_NEON_SHA3 */
+
+// number of failed tests
+static size_t num_fails = 0;
+
+// test values
+static const uint64_t VALS[] = {
+  0x0000000000000000ULL, 0xffffffffffffffffULL, 0x8000000000000001ULL,
+  0x0123456789abcdefULL, 0xfedcba9876543210ULL, 0x5555aaaa5555aaaaULL,
+};
+#define NUM_VALS (sizeof(VALS) / sizeof(VALS[0]))
+
+// check both lanes of vector against expected values
+static void check_lanes(const char *func, const size_t test_id, const uint64x2_t got, const uint64_t exp_lo, const uint64_t exp_hi) {
+  const uint64_t got_lo = vgetq_lane_u64(got, 0),
+                 got_hi = vgetq_lane_u64(got, 1);
+  if (got_lo != exp_lo || got_hi != exp_hi) {
+    fprintf(stderr, "%s[%zu] failed: got { 0x%016" PRIx64 ", 0x%016" PRIx64 " }, exp { 0x%016" PRIx64 ", 0x%016" PRIx64 " }\n", func, test_id, got_lo, got_hi, exp_lo, exp_hi);
+    num_fails++;
+  }
+}
+
+// check state against expected state
+static void check_state(const char *func, const size_t test_id, const uint64_t got[static 25], const uint64_t exp[static 25]) {
+  if (!memcmp(got, exp, 25*sizeof(uint64_t))) {
+    return;
+  }
+
+  fprintf(stderr, "%s[%zu] failed:\n", func, test_id);
+  for (size_t i = 0; i < 25; i++) {
+    if (got[i] != exp[i]) {
+      fprintf(stderr, "  %2zu: got 0x%016" PRIx64 ", exp 0x%016" PRIx64 "\n", i, got[i], exp[i]);
+    }
+  }
+  num_fails++;
+}
+
+// pack two values into vector
+static inline uint64x2_t pack(const uint64_t lo, const uint64_t hi) {
+  return vcombine_u64(vcreate_u64(lo), vcreate_u64(hi));
+}
+
+// d = a ^ b ^ c
+static void test_veor3(void) {
+  for (size_t i = 0; i < NUM_VALS; i++) {
+    const uint64_t a = VALS[i], b = VALS[(i + 1) % NUM_VALS], c = VALS[(i + 3) % NUM_VALS];
+    check_lanes(__func__, i, veor3q_u64(pack(a, b), pack(b, c), pack(c, a)), a ^ b ^ c, b ^ c ^ a);
+  }
+}
+
+// d = a ^ rol(b, 1)
+static void test_vrax1(void) {
+  for (size_t i = 0; i < NUM_VALS; i++) {
+    const uint64_t a = VALS[i], b = VALS[(i + 1) % NUM_VALS];
+    check_lanes(__func__, i, vrax1q_u64(pack(a, b), pack(b, a)), a ^ ROL(b, 1), b ^ ROL(a, 1));
+  }
+}
+
+// d = ror(a ^ b, n).  the backend uses xar with 64 - rho offset to
+// rotate left, so check the rotate direction for a few offsets
+static void test_vxar(void) {
+  for (size_t i = 0; i < NUM_VALS; i++) {
+    const uint64_t a = VALS[i], b = VALS[(i + 1) % NUM_VALS], c = a ^ b;
+    check_lanes(__func__, 4 * i + 0, vxarq_u64(pack(a, b), pack(b, a),  1), ROL(c, 63), ROL(c, 63));
+    check_lanes(__func__, 4 * i + 1, vxarq_u64(pack(a, b), pack(b, a), 20), ROL(c, 44), ROL(c, 44));
+    check_lanes(__func__, 4 * i + 2, vxarq_u64(pack(a, b), pack(b, a), 50), ROL(c, 14), ROL(c, 14));
+    check_lanes(__func__, 4 * i + 3, vxarq_u64(pack(a, b), pack(b, a), 63), ROL(c,  1), ROL(c,  1));
+  }
+}
+
+// d = a ^ (b & ~c)
+static void test_vbcax(void) {
+  for (size_t i = 0; i < NUM_VALS; i++) {
+    const uint64_t a = VALS[i], b = VALS[(i + 1) % NUM_VALS], c = VALS[(i + 3) % NUM_VALS];
+    check_lanes(__func__, i, vbcaxq_u64(pack(a, b), pack(b, c), pack(c, a)), a ^ (b & ~c), b ^ (c & ~a));
+  }
+}
+
+// scalar keccak permutation
+// (reference implementation)
+static void permute_ref(uint64_t a[static 25], const size_t num_rounds) {
+  // rho rotate offsets, indexed by lane
+  static const int RHO[25] = {
+     0,  1, 62, 28, 27,
+    36, 44,  6, 55, 20,
+     3, 10, 43, 25, 39,
+    41, 45, 15, 21,  8,
+    18,  2, 61, 56, 14,
+  };
+
+  for (size_t i = 24 - num_rounds; i < 24; i++) {
+    // theta
+    uint64_t c[5] = { 0 };
+    for (size_t x = 0; x < 5; x++) {
+      c[x] = a[x] ^ a[x + 5] ^ a[x + 10] ^ a[x + 15] ^ a[x + 20];
+    }
+    for (size_t x = 0; x < 5; x++) {
+      const uint64_t d = c[(x + 4) % 5] ^ ROL(c[(x + 1) % 5], 1);
+      for (size_t y = 0; y < 5; y++) {
+        a[x + 5 * y] ^= d;
+      }
+    }
+
+    // rho and pi
+    uint64_t b[25] = { 0 };
+    for (size_t x = 0; x < 5; x++) {
+      for (size_t y = 0; y < 5; y++) {
+        const uint64_t v = a[x + 5 * y];
+        const int n = RHO[x + 5 * y];
+        b[y + 5 * ((2 * x + 3 * y) % 5)] = n ? ROL(v, n) : v;
+      }
+    }
+
+    // chi
+    for (size_t y = 0; y < 5; y++) {
+      for (size_t x = 0; x < 5; x++) {
+        a[x + 5 * y] = b[x + 5 * y] ^ (~b[(x + 1) % 5 + 5 * y] & b[(x + 2) % 5 + 5 * y]);
+      }
+    }
+
+    // iota
+    a[0] ^= RCS[i];
+  }
+}
+
+// check single-state permutation against reference
+static void test_permute(void) {
+  static const size_t NUM_ROUNDS[] = { 24, 12 };
+  for (size_t r = 0; r < 2; r++) {
+    uint64_t got[25] = { 0 }, exp[25] = { 0 };
+    for (size_t i = 0; i < 25; i++) {
+      got[i] = exp[i] = 0x0123456789abcdefULL * (i + 1);
+    }
+
+    for (size_t i = 0; i < 4; i++) {
+      permute_n_neon_sha3(got, NUM_ROUNDS[r]);
+      permute_ref(exp, NUM_ROUNDS[r]);
+      check_state(__func__, 4 * r + i, got, exp);
+    }
+  }
+}
+
+// check two-state permutation against reference
+static void test_permute_x2(void) {
+  static const size_t NUM_ROUNDS[] = { 24, 12 };
+  for (size_t r = 0; r < 2; r++) {
+    uint64_t got[2][25] = { 0 }, exp[2][25] = { 0 };
+    for (size_t i = 0; i < 25; i++) {
+      got[0][i] = exp[0][i] = 0x0123456789abcdefULL * (i + 1);
+      got[1][i] = exp[1][i] = 0xfedcba9876543210ULL ^ (i << 40);
+    }
+
+    for (size_t i = 0; i < 4; i++) {
+      permute_n_neon_sha3_x2(got[0], got[1], NUM_ROUNDS[r]);
+      permute_ref(exp[0], NUM_ROUNDS[r]);
+      permute_ref(exp[1], NUM_ROUNDS[r]);
+      check_state(__func__, 8 * r + 2 * i + 0, got[0], exp[0]);
+      check_state(__func__, 8 * r + 2 * i + 1, got[1], exp[1]);
+    }
+  }
+}
+
+// check sha3-256 of "abc" with single-state and batch functions
+static void test_sha3_256(void) {
+  static const uint8_t EXP[32] = {
+    0x3a, 0x98, 0x5d, 0xa7, 0x4f, 0xe2, 0x25, 0xb2,
+    0x04, 0x5c, 0x17, 0x2d, 0x6b, 0xd3, 0x90, 0xbd,
+    0x85, 0x5f, 0x08, 0x6e, 0x3e, 0x9d, 0x52, 0x5b,
+    0x46, 0xbf, 0xe2, 0x45, 0x11, 0x43, 0x15, 0x32,
+  };
+
+  // single-state
+  uint8_t got[3][32] = { 0 };
+  sha3_256((const uint8_t*) "abc", 3, got[0]);
+  if (memcmp(got[0], EXP, 32)) {
+    fprintf(stderr, "%s[0] failed\n", __func__);
+    num_fails++;
+  }
+
+  // batch of 3 (one two-state group and one single state)
+  const uint8_t *srcs[3] = { (const uint8_t*) "abc", (const uint8_t*) "abc", (const uint8_t*) "abc" };
+  const size_t lens[3] = { 3, 3, 3 };
+  uint8_t *dsts[3] = { got[0], got[1], got[2] };
+  sha3_256_batch(srcs, lens, 3, dsts);
+  for (size_t i = 0; i < 3; i++) {
+    if (memcmp(got[i], EXP, 32)) {
+      fprintf(stderr, "%s[%zu] failed\n", __func__, 1 + i);
+      num_fails++;
+    }
+  }
+}
+
+int main(void) {
+  // test instructions
+  test_veor3();
+  test_vrax1();
+  test_vxar();
+  test_vbcax();
+
+  // test permute
+  test_permute();
+  test_permute_x2();
+
+  // test hash
+  test_sha3_256();
+
+  // print/return result
+  if (num_fails > 0) {
+    fprintf(stderr, "%zu failed\n", num_fails);
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}